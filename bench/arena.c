@@ -0,0 +1,40 @@
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+typedef struct ArenaBench {
+	Arena arena;
+	size_t len;
+} ArenaBench;
+
+static void run_alloc_release(void* ctx) {
+	ArenaBench* b = ctx;
+	ArenaRef ref = arena_alloc(&b->arena, b->len);
+	bench_sink = (size_t)ref.ptr;
+	arena_release(&b->arena, ref);
+}
+
+static void run_malloc_free(void* ctx) {
+	ArenaBench* b = ctx;
+	void* ptr = malloc(b->len);
+	bench_sink = (size_t)ptr;
+	free(ptr);
+}
+
+void bench_arena(void) {
+	char name[96];
+	size_t sizes[3] = { 64, 4096, 65536 };
+	for (size_t sdx = 0; sdx < 3; ++sdx) {
+		ArenaBench b = {
+			.arena = arena_init(),
+			.len = sizes[sdx],
+		};
+		snprintf(name, sizeof(name), "arena_alloc+release/%zu", b.len);
+		bench_run(name, run_alloc_release, &b, 0);
+		snprintf(name, sizeof(name), "malloc+free/%zu", b.len);
+		bench_run(name, run_malloc_free, &b, 0);
+		arena_free(&b.arena);
+	}
+}
@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+typedef struct Base64Bench {
+	Slice src;
+	Vec text;
+	Slice out;
+	Base64Alphabet alphabet;
+} Base64Bench;
+
+static void run_encode(void* ctx) {
+	Base64Bench* b = ctx;
+	b->text.len = 0;
+	base64_encode(&b->text, b->src, b->alphabet);
+	bench_sink = b->text.len;
+}
+
+static void run_decode(void* ctx) {
+	Base64Bench* b = ctx;
+	Base64Result res = base64_decode_into(b->out, vec_as_slice(&b->text), b->alphabet);
+	bench_sink = GET_VARIANT_BODY(res, Ok);
+}
+
+void bench_base64(void) {
+	size_t len = 1 << 16;
+	unsigned char* buf = malloc(len);
+	unsigned char* out = malloc(len);
+	for (size_t idx = 0; idx < len; ++idx) {
+		buf[idx] = (unsigned char)(idx * 131 + 7);
+	}
+	Base64Bench b = {
+		.text = vec_init(base64_encoded_len(len, BASE64_STANDARD), 1),
+		.out = slice_new(out, len),
+	};
+	char name[64];
+	const char* levels[3] = { "scalar", "ssse3", "best" };
+	unsigned int masks[3] = { 0, CPU_SSE2 | CPU_SSSE3, ~0u };
+	size_t sizes[2] = { 256, 65536 };
+	unsigned int old = cpu_restrict(0);
+	for (size_t alpha = 0; alpha < 2; ++alpha) {
+		b.alphabet = (Base64Alphabet)alpha;
+		const char* which = alpha == BASE64_STANDARD ? "" : ", url";
+		for (size_t sdx = 0; sdx < 2; ++sdx) {
+			b.src = slice_new(buf, sizes[sdx]);
+			for (size_t lvl = 0; lvl < 3; ++lvl) {
+				cpu_restrict(masks[lvl] & old);
+				snprintf(name, sizeof(name), "base64_encode/%s%s/%zu", levels[lvl], which, sizes[sdx]);
+				bench_run(name, run_encode, &b, sizes[sdx]);
+			}
+			for (size_t lvl = 0; lvl < 3; ++lvl) {
+				cpu_restrict(masks[lvl] & old);
+				/* Throughput is counted in decoded bytes, as for encoding. */
+				snprintf(name, sizeof(name), "base64_decode/%s%s/%zu", levels[lvl], which, sizes[sdx]);
+				bench_run(name, run_decode, &b, sizes[sdx]);
+			}
+		}
+	}
+	cpu_restrict(old);
+
+	vec_free(&b.text);
+	free(out);
+	free(buf);
+}
@@ -0,0 +1,404 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "bench.h"
+
+volatile size_t bench_sink = 0;
+
+/**
+ * How long each benchmark is measured for, in nanoseconds.
+ */
+#define BENCH_TARGET_NS 200000000ULL
+
+/**
+ * How long latency samples are collected for, in nanoseconds, after the mean
+ * has been measured.
+ */
+#define BENCH_SAMPLE_NS 100000000ULL
+
+/**
+ * The most latency samples taken for one benchmark.
+ */
+#define BENCH_SAMPLES_MAX 65536
+
+/**
+ * The shortest time a latency sample may cover, in nanoseconds. Cheap work is
+ * repeated within a sample until it takes this long, so that reading the clock
+ * does not dominate the measurement.
+ */
+#define BENCH_SAMPLE_MIN_NS 1000
+
+/**
+ * The number of hardware counters collected: cycles, cache misses, and branch
+ * misses, in that order.
+ */
+#define BENCH_COUNTERS 3
+
+/**
+ * The hardware counters of one measurement, totalled over every invocation.
+ */
+typedef struct BenchCounts {
+	uint64_t values[BENCH_COUNTERS];
+} BenchCounts;
+
+static const char* const bench_counter_names[BENCH_COUNTERS] = {
+	"cycles",
+	"cache_misses",
+	"branch_misses",
+};
+
+static FILE* bench_json = NULL;
+static bool bench_json_first = true;
+static const char* bench_group_name = "";
+static int bench_perf_fds[BENCH_COUNTERS] = { -1, -1, -1 };
+
+static bool bench_counters_open(void);
+static void bench_counters_close(void);
+static void bench_counters_start(void);
+static bool bench_counters_stop(BenchCounts* const out);
+static size_t bench_sample(BenchFn fn, void* ctx, double ns, double* samples);
+static int bench_compare(const void* a, const void* b);
+static double bench_percentile(const double* sorted, size_t len, double rank);
+static void bench_json_string(const char* text);
+
+/**
+ * Apply the command-line settings. This must be called before any benchmark
+ * runs.
+ *
+ * Hardware counters that cannot be opened, as when the kernel forbids it, are
+ * reported and then left out of the results.
+ * @param opts The settings.
+ * @return false if the JSON file could not be created.
+ */
+bool bench_configure(BenchOptions opts) {
+	if (opts.counters && !bench_counters_open()) {
+		printf("Hardware counters are unavailable: %s\n", strerror(errno));
+	}
+	if (opts.json_path == NULL) {
+		return true;
+	}
+	bench_json = fopen(opts.json_path, "w");
+	if (bench_json == NULL) {
+		printf("Cannot create %s: %s\n", opts.json_path, strerror(errno));
+		return false;
+	}
+#ifdef __OPTIMIZE__
+	const char* optimized = "true";
+#else
+	const char* optimized = "false";
+#endif
+	fprintf(bench_json, "{\n  \"compiler\": ");
+	bench_json_string(__VERSION__);
+	fprintf(bench_json, ",\n  \"optimized\": %s,\n  \"results\": [", optimized);
+	return true;
+}
+
+/**
+ * Begin a group of benchmarks, printing its heading. Results are labelled with
+ * the group in the JSON output.
+ * @param name The name of the group, such as a module name.
+ */
+void bench_group(const char* name) {
+	bench_group_name = name;
+	printf("\nBenchmarking %s!\n", name);
+}
+
+/**
+ * Complete the JSON output and release the hardware counters.
+ */
+void bench_finish(void) {
+	if (bench_json != NULL) {
+		fprintf(bench_json, "\n  ]\n}\n");
+		fclose(bench_json);
+		bench_json = NULL;
+	}
+	bench_counters_close();
+}
+
+/**
+ * Read the monotonic clock.
+ * @return The current time in nanoseconds, from an arbitrary epoch.
+ */
+uint64_t bench_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Time a closure and print its cost per invocation.
+ *
+ * The closure is run in doubling batches until one batch takes a measurable
+ * amount of time, and then for enough batches of that size to fill the target
+ * duration; the hardware counters cover those batches. It is then timed again
+ * in short samples, whose spread gives the percentiles.
+ * @param name The label printed beside the result.
+ * @param fn The work to measure.
+ * @param ctx The context passed to every invocation of `fn`.
+ * @param bytes The number of bytes one invocation processes, used to report
+ * throughput. Zero suppresses the throughput column.
+ */
+void bench_run(const char* name, BenchFn fn, void* ctx, size_t bytes) {
+	size_t batch = 1;
+	uint64_t elapsed = 0;
+	/* Warm up, and find a batch size that takes at least a millisecond. */
+	for (;;) {
+		uint64_t start = bench_now();
+		for (size_t idx = 0; idx < batch; ++idx) {
+			fn(ctx);
+		}
+		elapsed = bench_now() - start;
+		if (elapsed >= 1000000ULL || batch >= ((size_t)1 << 40)) {
+			break;
+		}
+		batch *= 2;
+	}
+	size_t ops = 0;
+	elapsed = 0;
+	BenchCounts counts;
+	bench_counters_start();
+	while (elapsed < BENCH_TARGET_NS) {
+		uint64_t start = bench_now();
+		for (size_t idx = 0; idx < batch; ++idx) {
+			fn(ctx);
+		}
+		elapsed += bench_now() - start;
+		ops += batch;
+	}
+	bool counted = bench_counters_stop(&counts);
+	double ns = (double)elapsed / (double)ops;
+
+	double* samples = malloc(BENCH_SAMPLES_MAX * sizeof(double));
+	size_t taken = 0;
+	if (samples != NULL) {
+		taken = bench_sample(fn, ctx, ns, samples);
+		qsort(samples, taken, sizeof(double), bench_compare);
+	}
+	double p50 = bench_percentile(samples, taken, 0.5);
+	double p99 = bench_percentile(samples, taken, 0.99);
+	double p999 = bench_percentile(samples, taken, 0.999);
+	free(samples);
+
+	if (bytes > 0) {
+		printf("%-44s %12.2f ns/op %10.3f GB/s", name, ns, (double)bytes / ns);
+	}
+	else {
+		printf("%-44s %12.2f ns/op %15s", name, ns, "");
+	}
+	printf("   p50 %.2f  p99 %.2f  p99.9 %.2f\n", p50, p99, p999);
+	if (counted) {
+		printf(
+			"%-44s %12.1f cycles %8.2f cache misses %8.2f branch misses\n",
+			"",
+			(double)counts.values[0] / (double)ops,
+			(double)counts.values[1] / (double)ops,
+			(double)counts.values[2] / (double)ops
+		);
+	}
+
+	if (bench_json == NULL) {
+		return;
+	}
+	fprintf(bench_json, "%s\n    {\"group\": ", bench_json_first ? "" : ",");
+	bench_json_first = false;
+	bench_json_string(bench_group_name);
+	fprintf(bench_json, ", \"name\": ");
+	bench_json_string(name);
+	fprintf(bench_json, ", \"ops\": %zu, \"ns_per_op\": %.3f", ops, ns);
+	if (bytes > 0) {
+		fprintf(bench_json, ", \"gb_per_s\": %.4f", (double)bytes / ns);
+	}
+	else {
+		fprintf(bench_json, ", \"gb_per_s\": null");
+	}
+	fprintf(bench_json, ", \"p50_ns\": %.3f, \"p99_ns\": %.3f, \"p999_ns\": %.3f", p50, p99, p999);
+	for (size_t idx = 0; idx < BENCH_COUNTERS; ++idx) {
+		if (counted) {
+			fprintf(
+				bench_json,
+				", \"%s_per_op\": %.4f",
+				bench_counter_names[idx],
+				(double)counts.values[idx] / (double)ops
+			);
+		}
+		else {
+			fprintf(bench_json, ", \"%s_per_op\": null", bench_counter_names[idx]);
+		}
+	}
+	fprintf(bench_json, "}");
+	fflush(bench_json);
+}
+
+/**
+ * INTERNAL: Open the hardware counters as one group, so that they are
+ * scheduled onto the processor together.
+ * @return true if every counter could be opened. Otherwise none are kept, and
+ * `errno` says why.
+ */
+static bool bench_counters_open(void) {
+#ifdef __linux__
+	static const uint64_t configs[BENCH_COUNTERS] = {
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_CACHE_MISSES,
+		PERF_COUNT_HW_BRANCH_MISSES,
+	};
+	for (size_t idx = 0; idx < BENCH_COUNTERS; ++idx) {
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = configs[idx];
+		attr.disabled = idx == 0;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP;
+		int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, bench_perf_fds[0], 0);
+		if (fd < 0) {
+			int err = errno;
+			bench_counters_close();
+			errno = err;
+			return false;
+		}
+		bench_perf_fds[idx] = fd;
+	}
+	return true;
+#else
+	errno = ENOSYS;
+	return false;
+#endif
+}
+
+/**
+ * INTERNAL: Close whichever hardware counters are open.
+ */
+static void bench_counters_close(void) {
+#ifdef __linux__
+	for (size_t idx = 0; idx < BENCH_COUNTERS; ++idx) {
+		if (bench_perf_fds[idx] >= 0) {
+			close(bench_perf_fds[idx]);
+			bench_perf_fds[idx] = -1;
+		}
+	}
+#endif
+}
+
+/**
+ * INTERNAL: Zero the hardware counters and start them, if they are open.
+ */
+static void bench_counters_start(void) {
+#ifdef __linux__
+	if (bench_perf_fds[0] >= 0) {
+		ioctl(bench_perf_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(bench_perf_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+#endif
+}
+
+/**
+ * INTERNAL: Stop the hardware counters and read them.
+ * @param out Receives the counts since `bench_counters_start()`.
+ * @return false if the counters are not open or could not be read.
+ */
+static bool bench_counters_stop(BenchCounts* const out) {
+#ifdef __linux__
+	if (bench_perf_fds[0] < 0) {
+		return false;
+	}
+	ioctl(bench_perf_fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+	struct {
+		uint64_t nr;
+		uint64_t values[BENCH_COUNTERS];
+	} group;
+	if (read(bench_perf_fds[0], &group, sizeof(group)) != (ssize_t)sizeof(group)) {
+		return false;
+	}
+	memcpy(out->values, group.values, sizeof(out->values));
+	return true;
+#else
+	(void)out;
+	return false;
+#endif
+}
+
+/**
+ * INTERNAL: Time a closure repeatedly in short samples.
+ * @param fn The work to measure.
+ * @param ctx The context passed to `fn`.
+ * @param ns The mean cost of one invocation, used to size the samples.
+ * @param samples Receives the cost per invocation in each sample. It must have
+ * room for `BENCH_SAMPLES_MAX` values.
+ * @return The number of samples taken, which is at least one.
+ */
+static size_t bench_sample(BenchFn fn, void* ctx, double ns, double* samples) {
+	size_t per_sample = 1;
+	if (ns < BENCH_SAMPLE_MIN_NS) {
+		per_sample = (size_t)(BENCH_SAMPLE_MIN_NS / ns) + 1;
+	}
+	size_t taken = 0;
+	uint64_t spent = 0;
+	while (taken == 0 || (taken < BENCH_SAMPLES_MAX && spent < BENCH_SAMPLE_NS)) {
+		uint64_t start = bench_now();
+		for (size_t idx = 0; idx < per_sample; ++idx) {
+			fn(ctx);
+		}
+		uint64_t took = bench_now() - start;
+		samples[taken++] = (double)took / (double)per_sample;
+		spent += took;
+	}
+	return taken;
+}
+
+/**
+ * INTERNAL: Order two samples for `qsort()`.
+ */
+static int bench_compare(const void* a, const void* b) {
+	double x = *(const double*)a;
+	double y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+/**
+ * INTERNAL: Find a percentile of sorted samples.
+ * @param sorted The samples, in ascending order.
+ * @param len The number of samples.
+ * @param rank The fraction of samples that fall below the result.
+ * @return The sample at that rank, or zero if there are none.
+ */
+static double bench_percentile(const double* sorted, size_t len, double rank) {
+	if (len == 0) {
+		return 0.0;
+	}
+	size_t idx = (size_t)(rank * (double)len);
+	return sorted[idx < len ? idx : len - 1];
+}
+
+/**
+ * INTERNAL: Write text to the JSON output as a quoted string.
+ * @param text The text to quote.
+ */
+static void bench_json_string(const char* text) {
+	fputc('"', bench_json);
+	for (const char* cur = text; *cur != '\0'; ++cur) {
+		unsigned char c = (unsigned char)*cur;
+		if (c == '"' || c == '\\') {
+			fprintf(bench_json, "\\%c", c);
+		}
+		else if (c < ' ') {
+			fprintf(bench_json, "\\u%04x", c);
+		}
+		else {
+			fputc(c, bench_json);
+		}
+	}
+	fputc('"', bench_json);
+}
@@ -0,0 +1,51 @@
+/**
+ * Shared harness for the `wyz-bench` executable.
+ *
+ * Each module's benchmarks live in `bench/<module>.c` and register timed
+ * closures with `bench_run()`, which calibrates the repetition count and prints
+ * one result line per closure: the mean cost, the throughput, and percentiles
+ * of the cost measured over many short samples. Hardware counters and a JSON
+ * copy of every result are optional, and set up by `bench_configure()`.
+ */
+
+#ifndef WYZYRDRY_BENCH_H
+#define WYZYRDRY_BENCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A unit of benchmarked work. It is invoked repeatedly with the same context.
+ */
+typedef void (*BenchFn)(void* ctx);
+
+/**
+ * Settings for a run of the harness, taken from the command line.
+ */
+typedef struct BenchOptions {
+	/**
+	 * The file to which results are also written as JSON, or NULL.
+	 */
+	const char* json_path;
+	/**
+	 * Whether to count cycles, cache misses, and branch misses with
+	 * `perf_event_open()`.
+	 */
+	bool counters;
+} BenchOptions;
+
+/**
+ * Results must be written here so that the compiler cannot discard the work
+ * that produced them.
+ */
+extern volatile size_t bench_sink;
+
+bool bench_configure(BenchOptions opts);
+void bench_group(const char* name);
+void bench_finish(void);
+
+uint64_t bench_now(void);
+void bench_run(const char* name, BenchFn fn, void* ctx, size_t bytes);
+
+#endif
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+/**
+ * The number of subscribers to each message.
+ */
+#define BC_READERS 3
+/**
+ * The number of messages written before the readers catch up, in the burst
+ * benchmarks.
+ */
+#define BC_BURST 64
+
+typedef struct BroadcastBench {
+	RingBuf rings[BC_READERS];
+	RingBuf shared;
+	Broadcast bc;
+	Slice msg;
+} BroadcastBench;
+
+/**
+ * Copy each message into one ring per subscriber, and have each subscriber
+ * checksum its copy in place.
+ */
+static void run_copies(void* ctx) {
+	BroadcastBench* b = ctx;
+	uint32_t acc = 0;
+	for (size_t idx = 0; idx < BC_READERS; ++idx) {
+		ringbuf_write_slice(&b->rings[idx], b->msg);
+	}
+	for (size_t idx = 0; idx < BC_READERS; ++idx) {
+		acc ^= ringbuf_peek_checksum(&b->rings[idx]);
+		ringbuf_pop(&b->rings[idx]);
+	}
+	bench_sink = acc;
+}
+
+/**
+ * Write each message once, and have each subscriber checksum it in place.
+ */
+static void run_broadcast(void* ctx) {
+	BroadcastBench* b = ctx;
+	uint32_t acc = 0;
+	broadcast_write_slice(&b->bc, b->msg);
+	for (size_t id = 0; id < BC_READERS; ++id) {
+		Slice parts[2];
+		broadcast_peek(&b->bc, id, parts);
+		acc ^= hash_crc32c(hash_crc32c(0, parts[0]), parts[1]);
+		broadcast_pop(&b->bc, id);
+	}
+	bench_sink = acc;
+}
+
+/**
+ * As `run_copies()`, but the readers catch up only after a burst of messages,
+ * so that they lag behind the producer by a burst.
+ */
+static void run_copies_burst(void* ctx) {
+	BroadcastBench* b = ctx;
+	uint32_t acc = 0;
+	for (size_t num = 0; num < BC_BURST; ++num) {
+		for (size_t idx = 0; idx < BC_READERS; ++idx) {
+			ringbuf_write_slice(&b->rings[idx], b->msg);
+		}
+	}
+	for (size_t idx = 0; idx < BC_READERS; ++idx) {
+		while (b->rings[idx].count > 0) {
+			acc ^= ringbuf_peek_checksum(&b->rings[idx]);
+			ringbuf_pop(&b->rings[idx]);
+		}
+	}
+	bench_sink = acc;
+}
+
+static void run_broadcast_burst(void* ctx) {
+	BroadcastBench* b = ctx;
+	uint32_t acc = 0;
+	for (size_t num = 0; num < BC_BURST; ++num) {
+		broadcast_write_slice(&b->bc, b->msg);
+	}
+	for (size_t id = 0; id < BC_READERS; ++id) {
+		Slice parts[2];
+		while (broadcast_peek(&b->bc, id, parts)) {
+			acc ^= hash_crc32c(hash_crc32c(0, parts[0]), parts[1]);
+			broadcast_pop(&b->bc, id);
+		}
+	}
+	bench_sink = acc;
+}
+
+void bench_broadcast(void) {
+	size_t len = 4096;
+	unsigned char* buf = malloc(len);
+	for (size_t idx = 0; idx < len; ++idx) {
+		buf[idx] = (unsigned char)(idx * 131 + 7);
+	}
+	BroadcastBench b;
+	char name[96];
+	size_t sizes[3] = { 64, 256, 4096 };
+	for (size_t sdx = 0; sdx < 3; ++sdx) {
+		b.msg = slice_new(buf, sizes[sdx]);
+		/* Room for 15.5 messages, so that some wrap, as in the RingBuf group. */
+		size_t sz = 31 * str_size((StrLen)sizes[sdx]) / 2;
+		for (size_t idx = 0; idx < BC_READERS; ++idx) {
+			b.rings[idx] = ringbuf_init(slice_new(malloc(sz), sz));
+		}
+		snprintf(name, sizeof(name), "ringbuf per reader, %d readers/%zu", BC_READERS, sizes[sdx]);
+		bench_run(name, run_copies, &b, sizes[sdx]);
+		for (size_t idx = 0; idx < BC_READERS; ++idx) {
+			ringbuf_free(&b.rings[idx]);
+		}
+
+		b.shared = ringbuf_init(slice_new(malloc(sz), sz));
+		b.bc = broadcast_init(&b.shared, BROADCAST_WAIT);
+		for (size_t idx = 0; idx < BC_READERS; ++idx) {
+			broadcast_add(&b.bc);
+		}
+		snprintf(name, sizeof(name), "broadcast, %d readers/%zu", BC_READERS, sizes[sdx]);
+		bench_run(name, run_broadcast, &b, sizes[sdx]);
+		broadcast_free(&b.bc);
+		ringbuf_free(&b.shared);
+	}
+
+	/* Each ring holds a whole burst, so that the readers may lag by one. */
+	size_t burst_sizes[2] = { 256, 4096 };
+	for (size_t sdx = 0; sdx < 2; ++sdx) {
+		b.msg = slice_new(buf, burst_sizes[sdx]);
+		size_t sz = BC_BURST * str_size((StrLen)burst_sizes[sdx]);
+		for (size_t idx = 0; idx < BC_READERS; ++idx) {
+			b.rings[idx] = ringbuf_init(slice_new(malloc(sz), sz));
+		}
+		snprintf(name, sizeof(name), "ringbuf per reader, bursts of %d/%zu", BC_BURST, burst_sizes[sdx]);
+		bench_run(name, run_copies_burst, &b, BC_BURST * burst_sizes[sdx]);
+		for (size_t idx = 0; idx < BC_READERS; ++idx) {
+			ringbuf_free(&b.rings[idx]);
+		}
+
+		b.shared = ringbuf_init(slice_new(malloc(sz), sz));
+		b.bc = broadcast_init(&b.shared, BROADCAST_WAIT);
+		for (size_t idx = 0; idx < BC_READERS; ++idx) {
+			broadcast_add(&b.bc);
+		}
+		snprintf(name, sizeof(name), "broadcast, bursts of %d/%zu", BC_BURST, burst_sizes[sdx]);
+		bench_run(name, run_broadcast_burst, &b, BC_BURST * burst_sizes[sdx]);
+		broadcast_free(&b.bc);
+		ringbuf_free(&b.shared);
+	}
+	free(buf);
+}
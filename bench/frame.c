@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+typedef struct FrameBench {
+	Slice stream;
+	size_t piece;
+	FrameDecoder decoder;
+	RingBuf ring;
+} FrameBench;
+
+/**
+ * The usual hand-written receiver: append every piece to a buffer, parse the
+ * complete frames from its front, and shift the remainder down.
+ */
+static void run_naive_decode(void* ctx) {
+	FrameBench* b = ctx;
+	Vec acc = vec_init(4096, 1);
+	size_t total = 0;
+	for (size_t idx = 0; idx < b->stream.len; idx += b->piece) {
+		size_t len = b->stream.len - idx < b->piece ? b->stream.len - idx : b->piece;
+		vec_reserve(&acc, len);
+		memcpy(&acc.buf[acc.len], &b->stream.ptr[idx], len);
+		acc.len += len;
+		size_t at = 0;
+		while (acc.len - at >= sizeof(StrLen)) {
+			size_t frame = str_len_from_wire(&acc.buf[at]);
+			if (acc.len - at - sizeof(StrLen) < frame) {
+				break;
+			}
+			total += frame;
+			at += sizeof(StrLen) + frame;
+		}
+		memmove(acc.buf, &acc.buf[at], acc.len - at);
+		acc.len -= at;
+	}
+	bench_sink = total;
+	vec_free(&acc);
+}
+
+static void run_decoder(void* ctx) {
+	FrameBench* b = ctx;
+	size_t total = 0;
+	frame_decoder_reset(&b->decoder);
+	for (size_t idx = 0; idx < b->stream.len; idx += b->piece) {
+		size_t len = b->stream.len - idx < b->piece ? b->stream.len - idx : b->piece;
+		frame_decoder_feed(&b->decoder, slice_new(&b->stream.ptr[idx], len));
+		FrameResult res = frame_decoder_next(&b->decoder);
+		while (GET_VARIANT_TYPE(res) == ENUM_VAR(FrameResult, Frame)) {
+			total += GET_VARIANT_BODY(res, Frame).len;
+			res = frame_decoder_next(&b->decoder);
+		}
+	}
+	bench_sink = total;
+}
+
+static void run_decoder_into_ringbuf(void* ctx) {
+	FrameBench* b = ctx;
+	size_t count = 0;
+	frame_decoder_reset(&b->decoder);
+	for (size_t idx = 0; idx < b->stream.len; idx += b->piece) {
+		size_t len = b->stream.len - idx < b->piece ? b->stream.len - idx : b->piece;
+		frame_decoder_feed(&b->decoder, slice_new(&b->stream.ptr[idx], len));
+		while (GET_VARIANT_TYPE(frame_decoder_into_ringbuf(&b->decoder, &b->ring)) == ENUM_VAR(FrameResult, Full)) {
+			count += b->ring.count;
+			ringbuf_wipe(&b->ring);
+		}
+	}
+	count += b->ring.count;
+	ringbuf_wipe(&b->ring);
+	bench_sink = count;
+}
+
+void bench_frame(void) {
+	Vec stream = vec_init(1 << 20, 1);
+	unsigned char payload[512];
+	memset(payload, 'f', sizeof(payload));
+	for (size_t idx = 0; stream.len < (1 << 20) - 600; ++idx) {
+		frame_encode(&stream, slice_new(payload, 20 + idx * 37 % 200));
+	}
+	size_t sz = 1 << 16;
+	FrameBench b = {
+		.stream = vec_as_slice(&stream),
+		.decoder = frame_decoder_init(FRAME_MAX_LEN),
+		.ring = ringbuf_init(slice_new(malloc(sz), sz)),
+	};
+	size_t pieces[2] = { 1500, 65536 };
+	char name[64];
+	for (size_t idx = 0; idx < 2; ++idx) {
+		b.piece = pieces[idx];
+		snprintf(name, sizeof(name), "naive accumulate and shift/%zuB reads", b.piece);
+		bench_run(name, run_naive_decode, &b, stream.len);
+		snprintf(name, sizeof(name), "frame_decoder_next/%zuB reads", b.piece);
+		bench_run(name, run_decoder, &b, stream.len);
+		snprintf(name, sizeof(name), "frame_decoder_into_ringbuf/%zuB reads", b.piece);
+		bench_run(name, run_decoder_into_ringbuf, &b, stream.len);
+	}
+	frame_decoder_free(&b.decoder);
+	ringbuf_free(&b.ring);
+	vec_free(&stream);
+}
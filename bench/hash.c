@@ -0,0 +1,59 @@
+#include <stdio.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+static void run_crc32c(void* ctx) {
+	Slice* s = ctx;
+	bench_sink = hash_crc32c(0, *s);
+}
+
+static void run_xxh64(void* ctx) {
+	Slice* s = ctx;
+	bench_sink = hash_xxh64(*s, 0);
+}
+
+static void run_hasher(void* ctx) {
+	Slice* s = ctx;
+	Hasher h = hasher_init(0);
+	for (size_t idx = 0; idx < s->len; idx += 1500) {
+		size_t len = s->len - idx < 1500 ? s->len - idx : 1500;
+		hasher_update(&h, slice_new(&s->ptr[idx], len));
+	}
+	bench_sink = hasher_finish(&h);
+}
+
+static void bench_hash_size(unsigned char* buf, size_t len) {
+	Slice s = slice_new(buf, len);
+	char name[64];
+	unsigned int old = cpu_restrict(0);
+	snprintf(name, sizeof(name), "hash_crc32c/table/%zu", len);
+	bench_run(name, run_crc32c, &s, len);
+	cpu_restrict(CPU_SSE2 | CPU_SSE42);
+	if (cpu_has(CPU_SSE42)) {
+		snprintf(name, sizeof(name), "hash_crc32c/sse4.2/%zu", len);
+		bench_run(name, run_crc32c, &s, len);
+	}
+	cpu_restrict(old);
+	if (cpu_has(CPU_SSE42 | CPU_PCLMUL)) {
+		snprintf(name, sizeof(name), "hash_crc32c/pclmul/%zu", len);
+		bench_run(name, run_crc32c, &s, len);
+	}
+	snprintf(name, sizeof(name), "hash_xxh64/%zu", len);
+	bench_run(name, run_xxh64, &s, len);
+	snprintf(name, sizeof(name), "hasher_update 1500B pieces/%zu", len);
+	bench_run(name, run_hasher, &s, len);
+}
+
+void bench_hash(void) {
+	size_t len = 1 << 20;
+	unsigned char* buf = malloc(len);
+	for (size_t idx = 0; idx < len; ++idx) {
+		buf[idx] = (unsigned char)(idx * 2654435761u >> 13);
+	}
+	bench_hash_size(buf, 16);
+	bench_hash_size(buf, 256);
+	bench_hash_size(buf, 4096);
+	bench_hash_size(buf, len);
+	free(buf);
+}
@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+typedef struct HexBench {
+	Slice src;
+	Vec dst;
+	FILE* sink;
+} HexBench;
+
+static void run_encode(void* ctx) {
+	HexBench* b = ctx;
+	b->dst.len = 0;
+	hex_encode(&b->dst, b->src);
+	bench_sink = b->dst.len;
+}
+
+static void run_decode(void* ctx) {
+	HexBench* b = ctx;
+	Vec* text = &b->dst;
+	Slice out = slice_new(b->src.ptr, b->src.len);
+	HexResult res = hex_decode_into(out, vec_as_slice(text));
+	bench_sink = GET_VARIANT_BODY(res, Ok);
+}
+
+static void run_dump(void* ctx) {
+	HexBench* b = ctx;
+	hex_dump(b->sink, b->src, 0);
+}
+
+/**
+ * Print through `hex_print()`, which writes to standard output, with standard
+ * output pointed at the sink. glibc allows `stdout` to be reassigned.
+ */
+static void run_print(void* ctx) {
+	HexBench* b = ctx;
+	FILE* out = stdout;
+	stdout = b->sink;
+	hex_print(b->src);
+	stdout = out;
+}
+
+/**
+ * The formatting `hex_print()` used before it was built on `hex_dump()`: one
+ * `printf()` per byte for the hexadecimal, and again for the ASCII.
+ */
+static void run_printf_per_byte(void* ctx) {
+	HexBench* b = ctx;
+	for (size_t idx = 0; idx < b->src.len; ++idx) {
+		fprintf(b->sink, "%02X ", b->src.ptr[idx]);
+	}
+	for (size_t idx = 0; idx < b->src.len; ++idx) {
+		unsigned char c = b->src.ptr[idx];
+		fprintf(b->sink, "%c", c >= ' ' ? c : '.');
+	}
+	fprintf(b->sink, "\n");
+}
+
+void bench_hex(void) {
+	size_t len = 1 << 16;
+	unsigned char* buf = malloc(len);
+	for (size_t idx = 0; idx < len; ++idx) {
+		buf[idx] = (unsigned char)(idx * 131 + 7);
+	}
+	HexBench b = {
+		.src = slice_new(buf, len),
+		.dst = vec_init(2 * len, 1),
+		.sink = fopen("/dev/null", "w"),
+	};
+	if (b.sink == NULL) {
+		printf("Cannot open /dev/null; skipping.\n");
+		return;
+	}
+
+	unsigned int old = cpu_restrict(0);
+	bench_run("hex_encode/scalar/65536", run_encode, &b, len);
+	cpu_restrict(CPU_SSE2 | CPU_SSSE3);
+	bench_run("hex_encode/ssse3/65536", run_encode, &b, len);
+	cpu_restrict(old);
+	bench_run("hex_encode/best/65536", run_encode, &b, len);
+	bench_run("hex_decode/65536", run_decode, &b, len);
+
+	bench_run("hex_dump to /dev/null/65536", run_dump, &b, len);
+	bench_run("hex_print to /dev/null/65536", run_print, &b, len);
+	bench_run("printf per byte to /dev/null/65536", run_printf_per_byte, &b, len);
+
+	fclose(b.sink);
+	vec_free(&b.dst);
+	free(buf);
+}
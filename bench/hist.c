@@ -0,0 +1,58 @@
+#include <stdio.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+typedef struct HistBench {
+	Hist* hist;
+	Hist* other;
+	uint64_t* values;
+	size_t len;
+} HistBench;
+
+/**
+ * Record a batch of latency-like values, spread over several powers of two.
+ */
+static void run_record(void* ctx) {
+	HistBench* b = ctx;
+	for (size_t idx = 0; idx < b->len; ++idx) {
+		hist_record(b->hist, b->values[idx]);
+	}
+	bench_sink = (size_t)b->hist->total;
+}
+
+static void run_percentile(void* ctx) {
+	HistBench* b = ctx;
+	bench_sink = (size_t)hist_percentile(b->hist, 99.9);
+}
+
+static void run_merge(void* ctx) {
+	HistBench* b = ctx;
+	hist_merge(b->other, b->hist);
+	bench_sink = (size_t)b->other->total;
+}
+
+void bench_hist(void) {
+	HistBench b = {
+		.hist = malloc(sizeof(Hist)),
+		.other = malloc(sizeof(Hist)),
+		.len = 1024,
+	};
+	b.values = malloc(b.len * sizeof(uint64_t));
+	uint64_t state = 88172645463325252ull;
+	for (size_t idx = 0; idx < b.len; ++idx) {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		/* Mostly hundreds of nanoseconds, with a tail into milliseconds */
+		b.values[idx] = 100 + (state & 0x3ff) + ((state >> 10) % 64 == 0 ? (state >> 20) % 5000000 : 0);
+	}
+	hist_init(b.hist);
+	hist_init(b.other);
+	bench_run("hist_record x 1024", run_record, &b, 0);
+	bench_run("hist_percentile/99.9", run_percentile, &b, 0);
+	bench_run("hist_merge", run_merge, &b, sizeof(Hist));
+	free(b.values);
+	free(b.other);
+	free(b.hist);
+}
@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+/**
+ * The number of distinct field names in the benchmarked vocabulary.
+ */
+#define INTERN_BENCH_WORDS 64
+
+typedef struct InternBench {
+	Interner interner;
+	Slice words[INTERN_BENCH_WORDS];
+	Str* copies[INTERN_BENCH_WORDS];
+	Str* interned[INTERN_BENCH_WORDS];
+	size_t next;
+} InternBench;
+
+static void run_str_from_slice(void* ctx) {
+	InternBench* b = ctx;
+	Str* str = str_from_slice(b->words[b->next++ % INTERN_BENCH_WORDS]);
+	bench_sink = str->len;
+	str_free(str);
+}
+
+static void run_intern(void* ctx) {
+	InternBench* b = ctx;
+	bench_sink = (size_t)interner_intern(&b->interner, b->words[b->next++ % INTERN_BENCH_WORDS]);
+}
+
+static void run_compare_bytes(void* ctx) {
+	InternBench* b = ctx;
+	size_t idx = b->next++;
+	Str* lhs = b->copies[idx % INTERN_BENCH_WORDS];
+	Str* rhs = b->copies[(idx / INTERN_BENCH_WORDS) % INTERN_BENCH_WORDS];
+	bench_sink = slice_eq(str_as_slice(lhs), str_as_slice(rhs));
+}
+
+static void run_compare_pointers(void* ctx) {
+	InternBench* b = ctx;
+	size_t idx = b->next++;
+	Str* lhs = b->interned[idx % INTERN_BENCH_WORDS];
+	Str* rhs = b->interned[(idx / INTERN_BENCH_WORDS) % INTERN_BENCH_WORDS];
+	bench_sink = lhs == rhs;
+}
+
+void bench_intern(void) {
+	static char text[INTERN_BENCH_WORDS][48];
+	InternBench b;
+	interner_init(&b.interner);
+	b.next = 0;
+	for (size_t idx = 0; idx < INTERN_BENCH_WORDS; ++idx) {
+		int len = snprintf(text[idx], sizeof(text[idx]), "telemetry.vehicle.sensor.field_%02zu", idx);
+		b.words[idx] = slice_new((unsigned char*)text[idx], (size_t)len);
+		b.copies[idx] = str_from_slice(b.words[idx]);
+		b.interned[idx] = interner_intern(&b.interner, b.words[idx]);
+	}
+
+	bench_run("str_from_slice + str_free per message", run_str_from_slice, &b, 0);
+	bench_run("interner_intern per message", run_intern, &b, 0);
+	bench_run("compare copied Strs by bytes", run_compare_bytes, &b, 0);
+	bench_run("compare interned Strs by pointer", run_compare_pointers, &b, 0);
+
+	for (size_t idx = 0; idx < INTERN_BENCH_WORDS; ++idx) {
+		str_free(b.copies[idx]);
+	}
+	interner_free(&b.interner);
+}
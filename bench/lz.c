@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+typedef struct LzBench {
+	Slice src;
+	Vec packed;
+	Vec out;
+} LzBench;
+
+typedef struct LzRingBench {
+	RingBuf ring;
+	Slice src;
+	size_t msg;
+	unsigned char* out;
+} LzRingBench;
+
+static void run_compress(void* ctx) {
+	LzBench* b = ctx;
+	b->packed.len = 0;
+	lz_compress(&b->packed, b->src);
+	bench_sink = b->packed.len;
+}
+
+static void run_decompress(void* ctx) {
+	LzBench* b = ctx;
+	b->out.len = 0;
+	LzResult res = lz_decompress(&b->out, vec_as_slice(&b->packed), b->src.len);
+	bench_sink = GET_VARIANT_BODY(res, Ok);
+}
+
+/**
+ * Pass a corpus through a RingBuf as fixed-size messages, reading them all back
+ * whenever the ring may be too full for the next.
+ */
+static void run_ring(void* ctx) {
+	LzRingBench* b = ctx;
+	size_t sum = 0;
+	for (size_t idx = 0; idx + b->msg <= b->src.len; idx += b->msg) {
+		/* Drain before a write could fail, which would print an error. */
+		if (ringbuf_space_free(&b->ring) < str_size((StrLen)(b->msg + 1))) {
+			while (b->ring.count > 0) {
+				sum += ringbuf_read(&b->ring, slice_new(b->out, b->msg));
+			}
+		}
+		ringbuf_write_slice(&b->ring, slice_new(&b->src.ptr[idx], b->msg));
+	}
+	while (b->ring.count > 0) {
+		sum += ringbuf_read(&b->ring, slice_new(b->out, b->msg));
+	}
+	bench_sink = sum;
+}
+
+/**
+ * Fill a buffer with lines like those of an HTTP server's access log.
+ */
+static size_t fill_log(unsigned char* buf, size_t len) {
+	static const char* const paths[4] = { "/", "/index.html", "/api/v1/items", "/static/app.js" };
+	size_t at = 0;
+	for (size_t idx = 0; at + 128 < len; ++idx) {
+		at += (size_t)snprintf(
+			(char*)&buf[at],
+			128,
+			"10.0.%zu.%zu - - [01/May/2024:12:%02zu:%02zu +0000] \"GET %s HTTP/1.1\" 200 %zu\n",
+			idx * 7 % 16,
+			idx * 13 % 256,
+			idx / 60 % 60,
+			idx % 60,
+			paths[idx * 5 % 4],
+			idx * 37 % 20000
+		);
+	}
+	memset(&buf[at], '\n', len - at);
+	return len;
+}
+
+/**
+ * Fill a buffer with words drawn from a small vocabulary, as prose repeats its
+ * words but rarely whole phrases.
+ */
+static size_t fill_words(unsigned char* buf, size_t len) {
+	static const char* const words[16] = {
+		"the", "ring", "of", "buffer", "and", "a", "message", "queue",
+		"data", "is", "to", "compress", "length", "fast", "with", "bytes",
+	};
+	uint64_t state = 0x243F6A8885A308D3;
+	size_t at = 0;
+	while (at + 16 < len) {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		const char* word = words[state % 16];
+		size_t wlen = strlen(word);
+		memcpy(&buf[at], word, wlen);
+		at += wlen;
+		buf[at++] = (state >> 8) % 9 == 0 ? '\n' : ' ';
+	}
+	memset(&buf[at], ' ', len - at);
+	return len;
+}
+
+/**
+ * Fill a buffer with bytes that do not compress.
+ */
+static size_t fill_random(unsigned char* buf, size_t len) {
+	uint64_t state = 0x9E3779B97F4A7C15;
+	for (size_t idx = 0; idx < len; ++idx) {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		buf[idx] = (unsigned char)state;
+	}
+	return len;
+}
+
+void bench_lz(void) {
+	size_t len = 1 << 20;
+	unsigned char* buf = malloc(len);
+	const char* names[3] = { "access log", "words", "random" };
+	size_t (*fills[3])(unsigned char*, size_t) = { fill_log, fill_words, fill_random };
+	char name[96];
+	for (size_t idx = 0; idx < 3; ++idx) {
+		fills[idx](buf, len);
+		LzBench b = {
+			.src = slice_new(buf, len),
+			.packed = vec_init(lz_bound(len), 1),
+			.out = vec_init(len, 1),
+		};
+		run_compress(&b);
+		printf("%s: ratio %.2f\n", names[idx], (double)len / (double)b.packed.len);
+		snprintf(name, sizeof(name), "lz_compress/%s", names[idx]);
+		bench_run(name, run_compress, &b, len);
+		snprintf(name, sizeof(name), "lz_decompress/%s", names[idx]);
+		bench_run(name, run_decompress, &b, len);
+		vec_free(&b.out);
+		vec_free(&b.packed);
+	}
+
+	/* How many 512-byte log messages a 64 KiB ring holds, and at what cost. */
+	fill_log(buf, len);
+	size_t sz = 1 << 16;
+	LzRingBench r = {
+		.ring = ringbuf_init(slice_new(malloc(sz), sz)),
+		.src = slice_new(buf, len),
+		.msg = 512,
+		.out = malloc(512),
+	};
+	for (int compress = 0; compress < 2; ++compress) {
+		ringbuf_set_compression(&r.ring, compress, 64);
+		size_t held = 0;
+		while (ringbuf_write_slice(&r.ring, slice_new(&buf[held * r.msg], r.msg)) > 0) {
+			++held;
+		}
+		while (r.ring.count > 0) {
+			ringbuf_pop(&r.ring);
+		}
+		printf("ringbuf %s: %zu messages of 512 bytes in 64 KiB\n", compress ? "compressed" : "plain", held);
+		snprintf(name, sizeof(name), "ringbuf write+read/%s", compress ? "compressed" : "plain");
+		bench_run(name, run_ring, &r, len);
+	}
+	free(r.out);
+	ringbuf_free(&r.ring);
+	free(buf);
+}
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+
+void bench_arena(void);
+void bench_base64(void);
+void bench_broadcast(void);
+void bench_frame(void);
+void bench_hash(void);
+void bench_hex(void);
+void bench_hist(void);
+void bench_intern(void);
+void bench_lz(void);
+void bench_map(void);
+void bench_pages(void);
+void bench_pool(void);
+void bench_reactor(void);
+void bench_ringset(void);
+void bench_ringbuf(void);
+void bench_rope(void);
+void bench_slice(void);
+void bench_split(void);
+void bench_str(void);
+void bench_utf8(void);
+void bench_vec(void);
+
+/**
+ * Decide whether a command-line argument is an option rather than a group.
+ */
+static int is_option(const char* arg) {
+	return strncmp(arg, "--", 2) == 0;
+}
+
+/**
+ * Decide whether a benchmark group was requested on the command line. With no
+ * groups named, every group runs.
+ */
+static int selected(int argc, char* argv[], const char* group) {
+	int any = 0;
+	for (int idx = 1; idx < argc; ++idx) {
+		if (is_option(argv[idx])) {
+			continue;
+		}
+		any = 1;
+		if (strcmp(argv[idx], group) == 0) {
+			return 1;
+		}
+	}
+	return !any;
+}
+
+int main(int argc, char* argv[]) {
+#ifndef __OPTIMIZE__
+	printf("Warning: this is an unoptimized build; configure with -DCMAKE_BUILD_TYPE=Release.\n");
+#endif
+	BenchOptions opts = { .json_path = NULL, .counters = false };
+	for (int idx = 1; idx < argc; ++idx) {
+		if (strncmp(argv[idx], "--json=", 7) == 0) {
+			opts.json_path = &argv[idx][7];
+		}
+		else if (strcmp(argv[idx], "--counters") == 0) {
+			opts.counters = true;
+		}
+		else if (is_option(argv[idx])) {
+			printf("Usage: %s [--json=FILE] [--counters] [group...]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (!bench_configure(opts)) {
+		return 1;
+	}
+	if (selected(argc, argv, "vec")) {
+		bench_group("Vec");
+		bench_vec();
+	}
+	if (selected(argc, argv, "slice")) {
+		bench_group("Slice");
+		bench_slice();
+	}
+	if (selected(argc, argv, "str")) {
+		bench_group("Str");
+		bench_str();
+	}
+	if (selected(argc, argv, "hash")) {
+		bench_group("Hash");
+		bench_hash();
+	}
+	if (selected(argc, argv, "hex")) {
+		bench_group("Hex");
+		bench_hex();
+	}
+	if (selected(argc, argv, "hist")) {
+		bench_group("Hist");
+		bench_hist();
+	}
+	if (selected(argc, argv, "map")) {
+		bench_group("Map");
+		bench_map();
+	}
+	if (selected(argc, argv, "intern")) {
+		bench_group("Intern");
+		bench_intern();
+	}
+	if (selected(argc, argv, "ringbuf")) {
+		bench_group("RingBuf");
+		bench_ringbuf();
+	}
+	if (selected(argc, argv, "rope")) {
+		bench_group("Rope");
+		bench_rope();
+	}
+	if (selected(argc, argv, "split")) {
+		bench_group("Split");
+		bench_split();
+	}
+	if (selected(argc, argv, "frame")) {
+		bench_group("Frame");
+		bench_frame();
+	}
+	if (selected(argc, argv, "lz")) {
+		bench_group("LZ");
+		bench_lz();
+	}
+	if (selected(argc, argv, "pool")) {
+		bench_group("Pool");
+		bench_pool();
+	}
+	if (selected(argc, argv, "reactor")) {
+		bench_group("Reactor");
+		bench_reactor();
+	}
+	if (selected(argc, argv, "ringset")) {
+		bench_group("RingSet");
+		bench_ringset();
+	}
+	if (selected(argc, argv, "arena")) {
+		bench_group("Arena");
+		bench_arena();
+	}
+	if (selected(argc, argv, "base64")) {
+		bench_group("Base64");
+		bench_base64();
+	}
+	if (selected(argc, argv, "utf8")) {
+		bench_group("Utf8");
+		bench_utf8();
+	}
+	if (selected(argc, argv, "broadcast")) {
+		bench_group("Broadcast");
+		bench_broadcast();
+	}
+	if (selected(argc, argv, "pages")) {
+		bench_group("Pages");
+		bench_pages();
+	}
+	bench_finish();
+	return 0;
+}
@@ -0,0 +1,110 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+/**
+ * The number of distinct keys each lookup benchmark cycles through, so that
+ * large tables are probed at scattered slots rather than one hot one.
+ */
+#define MAP_BENCH_PROBES 65536
+
+/**
+ * The length of a long key. Long keys share a prefix, like topic names do, so
+ * that comparing them reads the whole key.
+ */
+#define MAP_BENCH_LONG 64
+
+typedef struct MapBench {
+	Map map;
+	unsigned char* probes;
+	size_t key_len;
+	size_t next;
+} MapBench;
+
+/**
+ * Write the key for a number, either 12 or `MAP_BENCH_LONG` bytes long.
+ */
+static Slice bench_key(unsigned char* buf, size_t key_len, size_t num) {
+	if (key_len > 12) {
+		memcpy(buf, "/telemetry/fleet/vehicle/sensors/engine/temperature/reading/", key_len - 12);
+	}
+	for (size_t idx = key_len; idx > key_len - 12; --idx) {
+		buf[idx - 1] = (unsigned char)('0' + num % 10);
+		num /= 10;
+	}
+	return slice_new(buf, key_len);
+}
+
+static void run_get(void* ctx) {
+	MapBench* b = ctx;
+	size_t idx = b->next++ & (MAP_BENCH_PROBES - 1);
+	bench_sink = (size_t)map_get(&b->map, slice_new(&b->probes[idx * b->key_len], b->key_len));
+}
+
+static void bench_map_size(size_t count, size_t key_len) {
+	unsigned char key[MAP_BENCH_LONG];
+	MapBench b = {
+		.map = map_init(0, MAP_COPY_KEYS),
+		.probes = malloc(MAP_BENCH_PROBES * key_len),
+		.key_len = key_len,
+		.next = 0,
+	};
+	char name[64];
+
+	uint64_t start = bench_now();
+	for (size_t idx = 0; idx < count; ++idx) {
+		map_insert(&b.map, bench_key(key, key_len, idx), (void*)(uintptr_t)idx);
+	}
+	double ns = (double)(bench_now() - start) / (double)count;
+	snprintf(name, sizeof(name), "map_insert %zuB keys, growing/%zu", key_len, count);
+	printf("%-44s %12.2f ns/op\n", name, ns);
+	map_free(&b.map);
+
+	b.map = map_init(count, MAP_COPY_KEYS);
+	start = bench_now();
+	for (size_t idx = 0; idx < count; ++idx) {
+		map_insert(&b.map, bench_key(key, key_len, idx), (void*)(uintptr_t)idx);
+	}
+	ns = (double)(bench_now() - start) / (double)count;
+	snprintf(name, sizeof(name), "map_insert %zuB keys, reserved/%zu", key_len, count);
+	printf("%-44s %12.2f ns/op\n", name, ns);
+
+	/* Scatter the probes over the whole table with a multiplicative step. */
+	for (size_t idx = 0; idx < MAP_BENCH_PROBES; ++idx) {
+		bench_key(&b.probes[idx * key_len], key_len, idx * 2654435761u % count);
+	}
+	snprintf(name, sizeof(name), "map_get %zuB keys, hit/%zu", key_len, count);
+	bench_run(name, run_get, &b, 0);
+
+	for (size_t idx = 0; idx < MAP_BENCH_PROBES; ++idx) {
+		bench_key(&b.probes[idx * key_len], key_len, count + idx * 2654435761u % count);
+	}
+	snprintf(name, sizeof(name), "map_get %zuB keys, miss/%zu", key_len, count);
+	bench_run(name, run_get, &b, 0);
+
+	size_t cursor = 0;
+	size_t total = 0;
+	MapEntry entry;
+	start = bench_now();
+	while (map_next(&b.map, &cursor, &entry)) {
+		total += (size_t)entry.value;
+	}
+	bench_sink = total;
+	ns = (double)(bench_now() - start) / (double)count;
+	snprintf(name, sizeof(name), "map_next %zuB keys/%zu", key_len, count);
+	printf("%-44s %12.2f ns/op\n", name, ns);
+
+	map_free(&b.map);
+	free(b.probes);
+}
+
+void bench_map(void) {
+	size_t counts[3] = { 1000, 1000000, 10000000 };
+	for (size_t idx = 0; idx < 3; ++idx) {
+		bench_map_size(counts[idx], 12);
+		bench_map_size(counts[idx], MAP_BENCH_LONG);
+	}
+}
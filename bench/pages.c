@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+/**
+ * The size of the rings, large enough that page faults and TLB misses show.
+ */
+#define PAGES_BENCH_STORE (64 * 1024 * 1024)
+/**
+ * The size of each message.
+ */
+#define PAGES_BENCH_MSG 4096
+
+typedef struct PagesBench {
+	RingBuf ring;
+	/**
+	 * The flags for `ringbuf_init_pages()`, or `~0u` for a store from
+	 * `malloc()`.
+	 */
+	unsigned int flags;
+	Slice msg;
+	Slice out;
+} PagesBench;
+
+/**
+ * Fill the ring with messages, then read them all back, as a burst does.
+ */
+static size_t run_lap(RingBuf* const ring, const Slice msg, const Slice out) {
+	size_t acc = 0;
+	while (ringbuf_fits(ring, (StrLen)msg.len)) {
+		ringbuf_write_slice(ring, msg);
+	}
+	while (ring->count > 0) {
+		acc += ringbuf_read(ring, out);
+	}
+	return acc;
+}
+
+static RingBuf make_ring(unsigned int flags) {
+	if (flags == ~0u) {
+		return ringbuf_init(slice_new(malloc(PAGES_BENCH_STORE), PAGES_BENCH_STORE));
+	}
+	return ringbuf_init_pages(PAGES_BENCH_STORE, flags, PAGES_ANY_NODE);
+}
+
+/**
+ * Make a ring, take it through one lap, and free it, so that every page is
+ * faulted in anew.
+ */
+static void run_fresh(void* ctx) {
+	PagesBench* b = ctx;
+	RingBuf ring = make_ring(b->flags);
+	bench_sink = run_lap(&ring, b->msg, b->out);
+	ringbuf_free(&ring);
+}
+
+/**
+ * Take a ring whose pages are all in place through one lap.
+ */
+static void run_warm(void* ctx) {
+	PagesBench* b = ctx;
+	bench_sink = run_lap(&b->ring, b->msg, b->out);
+}
+
+void bench_pages(void) {
+	unsigned char* buf = malloc(2 * PAGES_BENCH_MSG);
+	for (size_t idx = 0; idx < PAGES_BENCH_MSG; ++idx) {
+		buf[idx] = (unsigned char)(idx * 131 + 7);
+	}
+	PagesBench b = {
+		.msg = slice_new(buf, PAGES_BENCH_MSG),
+		.out = slice_new(&buf[PAGES_BENCH_MSG], PAGES_BENCH_MSG),
+	};
+	/* Every message that fits, as run_lap() writes them. */
+	size_t lap = PAGES_BENCH_STORE / str_size(PAGES_BENCH_MSG) * PAGES_BENCH_MSG;
+	const char* names[4] = { "malloc", "pages", "huge pages", "prefaulted pages" };
+	unsigned int flags[4] = { ~0u, 0, PAGES_HUGE, PAGES_PREFAULT };
+	char name[96];
+	for (size_t idx = 0; idx < 4; ++idx) {
+		b.flags = flags[idx];
+		snprintf(name, sizeof(name), "fresh ring lap, %s/%d", names[idx], PAGES_BENCH_STORE);
+		bench_run(name, run_fresh, &b, lap);
+	}
+	for (size_t idx = 0; idx < 3; ++idx) {
+		b.ring = make_ring(flags[idx]);
+		run_lap(&b.ring, b.msg, b.out);
+		snprintf(name, sizeof(name), "warm ring lap, %s/%d", names[idx], PAGES_BENCH_STORE);
+		bench_run(name, run_warm, &b, lap);
+		ringbuf_free(&b.ring);
+	}
+	free(buf);
+}
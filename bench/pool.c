@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+typedef struct PoolBench {
+	Pool* pool;
+	Slice src;
+	Slice dst;
+} PoolBench;
+
+static void run_crc32c(void* ctx) {
+	PoolBench* b = ctx;
+	bench_sink = pool_crc32c(b->pool, 0, b->src);
+}
+
+static void run_count(void* ctx) {
+	PoolBench* b = ctx;
+	bench_sink = pool_count_byte(b->pool, b->src, 0x41);
+}
+
+static void run_copy(void* ctx) {
+	PoolBench* b = ctx;
+	bench_sink = pool_copy(b->pool, b->dst, b->src);
+}
+
+static void run_hex(void* ctx) {
+	PoolBench* b = ctx;
+	bench_sink = pool_hex_encode_into(b->pool, b->dst, b->src);
+}
+
+void bench_pool(void) {
+	size_t len = 64 << 20;
+	unsigned char* src = malloc(len);
+	unsigned char* dst = malloc(2 * len);
+	for (size_t idx = 0; idx < len; ++idx) {
+		src[idx] = (unsigned char)(idx * 2654435761u >> 13);
+	}
+	memset(dst, 0, 2 * len);
+	PoolBench b = {
+		.src = slice_new(src, len),
+		.dst = slice_new(dst, 2 * len),
+	};
+	char name[96];
+	/* One thread is the plain single-threaded path, for comparison. */
+	size_t counts[3] = { 1, 2, 0 };
+	for (size_t tdx = 0; tdx < 3; ++tdx) {
+		Pool pool;
+		if (!pool_init(&pool, counts[tdx], 0)) {
+			continue;
+		}
+		b.pool = &pool;
+		snprintf(name, sizeof(name), "pool_crc32c/%zu threads/64M", pool.threads);
+		bench_run(name, run_crc32c, &b, len);
+		snprintf(name, sizeof(name), "pool_count_byte/%zu threads/64M", pool.threads);
+		bench_run(name, run_count, &b, len);
+		snprintf(name, sizeof(name), "pool_copy/%zu threads/64M", pool.threads);
+		bench_run(name, run_copy, &b, len);
+		snprintf(name, sizeof(name), "pool_hex_encode_into/%zu threads/64M", pool.threads);
+		bench_run(name, run_hex, &b, len);
+		pool_free(&pool);
+	}
+	free(dst);
+	free(src);
+}
@@ -0,0 +1,149 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+/**
+ * The number of messages sent and received by each timed call.
+ */
+#define BATCH 64
+
+/**
+ * One thread's socket pair, with a ring sending into one end and a ring
+ * receiving from the other.
+ */
+typedef struct ReactorBench {
+	int fds[2];
+	RingBuf out;
+	RingBuf in;
+	Reactor reactor;
+	size_t msg_len;
+	/**
+	 * The time from writing each message into `out` to reading it from `in`.
+	 */
+	Hist* hist;
+	unsigned char buf[512];
+} ReactorBench;
+
+static bool setup(ReactorBench* const b, size_t msg_len, Hist* hist) {
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, b->fds) != 0) {
+		return false;
+	}
+	size_t sz = 64 * 1024 - 1;
+	b->out = ringbuf_init(slice_new(malloc(sz), sz));
+	b->in = ringbuf_init(slice_new(malloc(sz), sz));
+	b->msg_len = msg_len;
+	b->hist = hist;
+	memset(b->buf, 0x41, sizeof(b->buf));
+	reactor_init(&b->reactor);
+	return reactor_add(&b->reactor, b->fds[0], &b->out, REACTOR_WRITE)
+		&& reactor_add(&b->reactor, b->fds[1], &b->in, REACTOR_READ);
+}
+
+static void teardown(ReactorBench* const b) {
+	reactor_free(&b->reactor);
+	ringbuf_free(&b->out);
+	ringbuf_free(&b->in);
+	close(b->fds[0]);
+	close(b->fds[1]);
+}
+
+/**
+ * Send a batch of messages, each stamped with the time it was queued, through
+ * the socket pair, and take them out of the receiving ring.
+ */
+static void run_batch(void* ctx) {
+	ReactorBench* b = ctx;
+	for (size_t idx = 0; idx < BATCH; ++idx) {
+		uint64_t now = bench_now();
+		memcpy(b->buf, &now, sizeof(now));
+		ringbuf_write_slice(&b->out, slice_new(b->buf, b->msg_len));
+	}
+	size_t got = 0;
+	while (got < BATCH) {
+		reactor_poll(&b->reactor, 0);
+		while (b->in.count > 0) {
+			ringbuf_read(&b->in, slice_new(b->buf, sizeof(b->buf)));
+			uint64_t then;
+			memcpy(&then, b->buf, sizeof(then));
+			hist_record(b->hist, bench_now() - then);
+			++got;
+		}
+	}
+	bench_sink = got;
+}
+
+/**
+ * Run batches on one thread's own socket pair, reactor, and rings.
+ */
+static void* run_thread(void* ctx) {
+	ReactorBench* b = ctx;
+	for (size_t rep = 0; rep < 2000; ++rep) {
+		run_batch(b);
+	}
+	return NULL;
+}
+
+void bench_reactor(void) {
+	char name[96];
+	size_t sizes[3] = { 16, 256, 512 };
+	for (size_t sdx = 0; sdx < 3; ++sdx) {
+		Hist* hist = malloc(sizeof(Hist));
+		hist_init(hist);
+		ReactorBench* b = malloc(sizeof(ReactorBench));
+		if (!setup(b, sizes[sdx], hist)) {
+			free(b);
+			free(hist);
+			continue;
+		}
+		snprintf(name, sizeof(name), "reactor round trip, %d messages/%zu", BATCH, sizes[sdx]);
+		bench_run(name, run_batch, b, BATCH * sizes[sdx]);
+		printf("  per-message latency, in ns: ");
+		hist_debug_print(hist);
+		teardown(b);
+		free(b);
+		free(hist);
+	}
+
+	/* One reactor per core, each with its own socket pair and rings. */
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	size_t threads = cpus > 0 ? (size_t)cpus : 1;
+	ReactorBench* benches = malloc(threads * sizeof(ReactorBench));
+	Hist* hists = malloc(threads * sizeof(Hist));
+	pthread_t* handles = malloc(threads * sizeof(pthread_t));
+	size_t ready = 0;
+	for (; ready < threads; ++ready) {
+		hist_init(&hists[ready]);
+		if (!setup(&benches[ready], 64, &hists[ready])) {
+			break;
+		}
+	}
+	uint64_t start = bench_now();
+	for (size_t idx = 0; idx < ready; ++idx) {
+		pthread_create(&handles[idx], NULL, run_thread, &benches[idx]);
+	}
+	for (size_t idx = 0; idx < ready; ++idx) {
+		pthread_join(handles[idx], NULL);
+	}
+	uint64_t elapsed = bench_now() - start;
+	for (size_t idx = 1; idx < ready; ++idx) {
+		hist_merge(&hists[0], &hists[idx]);
+	}
+	if (ready > 0) {
+		printf("  %zu reactor threads, 64-byte messages: %.0f messages/s; latency in ns: ",
+			ready,
+			(double)hists[0].total * 1e9 / (double)elapsed
+		);
+		hist_debug_print(&hists[0]);
+	}
+	for (size_t idx = 0; idx < ready; ++idx) {
+		teardown(&benches[idx]);
+	}
+	free(handles);
+	free(hists);
+	free(benches);
+}
@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+/**
+ * The number of messages written before any is read, in the burst benchmarks.
+ */
+#define RING_BURST 256
+
+typedef struct RingBench {
+	RingBuf ring;
+	Slice msg;
+	Str* str;
+	Vec vec;
+	unsigned char* out;
+	Arena* arena;
+	Slice parts[3];
+} RingBench;
+
+/**
+ * Write one message and read one back, with the queue kept half full so that
+ * the cursors travel around the store.
+ */
+static void run_slice(void* ctx) {
+	RingBench* b = ctx;
+	ringbuf_write_slice(&b->ring, b->msg);
+	bench_sink = ringbuf_read(&b->ring, slice_new(b->out, b->msg.len));
+}
+
+static void run_str(void* ctx) {
+	RingBench* b = ctx;
+	ringbuf_write_str(&b->ring, b->str);
+	bench_sink = ringbuf_read(&b->ring, slice_new(b->out, b->msg.len));
+}
+
+static void run_vec(void* ctx) {
+	RingBench* b = ctx;
+	ringbuf_write_vec(&b->ring, &b->vec);
+	bench_sink = ringbuf_read(&b->ring, slice_new(b->out, b->msg.len));
+}
+
+/**
+ * Join a header, body, and trailer in a temporary Vec and write that, as
+ * callers did before `ringbuf_write_gather()`.
+ */
+static void run_concat(void* ctx) {
+	RingBench* b = ctx;
+	Vec tmp = vec_init(b->msg.len, 1);
+	for (size_t idx = 0; idx < 3; ++idx) {
+		vec_push_slice(&tmp, b->parts[idx]);
+	}
+	ringbuf_write_vec(&b->ring, &tmp);
+	vec_free(&tmp);
+	bench_sink = ringbuf_read(&b->ring, slice_new(b->out, b->msg.len));
+}
+
+static void run_gather(void* ctx) {
+	RingBench* b = ctx;
+	ringbuf_write_gather(&b->ring, b->parts, 3);
+	bench_sink = ringbuf_read(&b->ring, slice_new(b->out, b->msg.len));
+}
+
+/**
+ * Pass a block through the queue by reference, as a producer that fills blocks
+ * in place and a consumer that releases them would.
+ */
+static void run_ref(void* ctx) {
+	RingBench* b = ctx;
+	ArenaRef ref = arena_alloc(b->arena, b->msg.len);
+	ref.ptr[0] = 1;
+	ringbuf_write_ref(&b->ring, ref);
+	ringbuf_read_ref(&b->ring, &ref);
+	bench_sink = ref.ptr[0];
+	arena_release(b->arena, ref);
+}
+
+/**
+ * Write a burst of messages into a queue and then read them all back.
+ */
+static void run_burst(void* ctx) {
+	RingBench* b = ctx;
+	for (size_t idx = 0; idx < RING_BURST; ++idx) {
+		ringbuf_write_slice(&b->ring, b->msg);
+	}
+	while (b->ring.count > 0) {
+		bench_sink = ringbuf_read(&b->ring, slice_new(b->out, b->msg.len));
+	}
+}
+
+/**
+ * Carry a burst through a new queue that starts at 64 bytes and grows to hold
+ * it, so that every resize is counted.
+ */
+static void run_burst_fresh(void* ctx) {
+	RingBench* b = ctx;
+	b->ring = ringbuf_init(slice_new(malloc(64), 64));
+	ringbuf_set_growth(&b->ring, 2, 1 << 20);
+	run_burst(b);
+	ringbuf_free(&b->ring);
+}
+
+/**
+ * Build a half-full RingBuf whose store holds `slots` messages of some size.
+ * A fractional count of slots makes one message in each pass around the store
+ * split across its end.
+ */
+static RingBuf half_full(const Slice msg, double slots) {
+	size_t sz = (size_t)(slots * (double)str_size((StrLen)msg.len));
+	RingBuf ring = ringbuf_init(slice_new(malloc(sz), sz));
+	for (size_t idx = 0; idx < (size_t)slots / 2; ++idx) {
+		ringbuf_write_slice(&ring, msg);
+	}
+	return ring;
+}
+
+/**
+ * Measure how often a write is split across the end of the store.
+ */
+static double wrap_rate(RingBench* b) {
+	size_t splits = 0;
+	size_t rounds = 10000;
+	for (size_t idx = 0; idx < rounds; ++idx) {
+		size_t before = b->ring.tail;
+		splits += before + str_size((StrLen)b->msg.len) > b->ring.store.len
+			&& before < b->ring.store.len;
+		run_slice(b);
+	}
+	return (double)splits / (double)rounds;
+}
+
+void bench_ringbuf(void) {
+	size_t len = 4096;
+	unsigned char* buf = malloc(len);
+	for (size_t idx = 0; idx < len; ++idx) {
+		buf[idx] = (unsigned char)(idx * 131 + 7);
+	}
+	RingBench b = {
+		.out = malloc(len),
+	};
+	char name[96];
+	size_t sizes[3] = { 16, 256, 4096 };
+	/* Whole slots never split a message; the others split one per pass. */
+	double slots[3] = { 15.0, 15.5, 3.5 };
+	for (size_t sdx = 0; sdx < 3; ++sdx) {
+		b.msg = slice_new(buf, sizes[sdx]);
+		for (size_t wdx = 0; wdx < 3; ++wdx) {
+			b.ring = half_full(b.msg, slots[wdx]);
+			double rate = wrap_rate(&b);
+			snprintf(name, sizeof(name), "ringbuf write+read/%zu, %.1f%% split", sizes[sdx], 100.0 * rate);
+			bench_run(name, run_slice, &b, sizes[sdx]);
+			ringbuf_free(&b.ring);
+		}
+	}
+
+	b.msg = slice_new(buf, 256);
+	b.str = str_from_slice(b.msg);
+	b.vec = vec_init(256, 1);
+	vec_push_slice(&b.vec, b.msg);
+	b.ring = half_full(b.msg, 15.5);
+	bench_run("ringbuf_write_str+read/256", run_str, &b, 256);
+	bench_run("ringbuf_write_vec+read/256", run_vec, &b, 256);
+	ringbuf_free(&b.ring);
+
+	/* A 16-byte header and 4-byte trailer around each body. */
+	size_t bodies[2] = { 64, 1024 };
+	for (size_t sdx = 0; sdx < 2; ++sdx) {
+		b.parts[0] = slice_new(buf, 16);
+		b.parts[1] = slice_new(&buf[16], bodies[sdx]);
+		b.parts[2] = slice_new(&buf[16 + bodies[sdx]], 4);
+		b.msg = slice_new(buf, 20 + bodies[sdx]);
+		b.ring = half_full(b.msg, 15.5);
+		snprintf(name, sizeof(name), "ringbuf concat+write_vec+read/%zu", b.msg.len);
+		bench_run(name, run_concat, &b, b.msg.len);
+		snprintf(name, sizeof(name), "ringbuf write_gather+read/%zu", b.msg.len);
+		bench_run(name, run_gather, &b, b.msg.len);
+		ringbuf_free(&b.ring);
+	}
+
+	/*
+	 * Bursts of 256 messages: through a store sized for them, through a
+	 * growing store once it has grown, and through a new one that must grow
+	 * from 64 bytes each time.
+	 */
+	b.msg = slice_new(buf, 64);
+	size_t burst = RING_BURST * str_size(64);
+	b.ring = ringbuf_init(slice_new(malloc(burst), burst));
+	bench_run("ringbuf burst/256x64, fixed", run_burst, &b, RING_BURST * 64);
+	ringbuf_free(&b.ring);
+	b.ring = ringbuf_init(slice_new(malloc(64), 64));
+	ringbuf_set_growth(&b.ring, 2, 1 << 20);
+	bench_run("ringbuf burst/256x64, grown", run_burst, &b, RING_BURST * 64);
+	ringbuf_free(&b.ring);
+	bench_run("ringbuf burst/256x64, growing from 64", run_burst_fresh, &b, RING_BURST * 64);
+
+	/* Stamping costs two clock reads and a histogram update per message. */
+	Hist* hist = malloc(sizeof(Hist));
+	hist_init(hist);
+	size_t lat_sizes[2] = { 16, 256 };
+	for (size_t sdx = 0; sdx < 2; ++sdx) {
+		b.msg = slice_new(buf, lat_sizes[sdx]);
+		size_t sz = (size_t)(15.5 * (double)str_size((StrLen)(lat_sizes[sdx] + sizeof(uint64_t))));
+		b.ring = ringbuf_init(slice_new(malloc(sz), sz));
+		ringbuf_set_latency(&b.ring, hist);
+		for (size_t idx = 0; idx < 7; ++idx) {
+			ringbuf_write_slice(&b.ring, b.msg);
+		}
+		snprintf(name, sizeof(name), "ringbuf write+read, latency/%zu", lat_sizes[sdx]);
+		bench_run(name, run_slice, &b, lat_sizes[sdx]);
+		ringbuf_free(&b.ring);
+	}
+	printf("  queueing latency over the runs above, in ns: ");
+	hist_debug_print(hist);
+	free(hist);
+
+	/*
+	 * Large messages in a 1 KiB store: written and read through an Arena they
+	 * are still copied in and out, and by reference they are not copied.
+	 */
+	size_t big = 65535;
+	unsigned char* big_buf = calloc(big, 1);
+	unsigned char* big_out = malloc(big);
+	unsigned char* small_out = b.out;
+	b.out = big_out;
+	Arena arena = arena_init();
+	b.arena = &arena;
+	size_t ref_sizes[3] = { 4096, 16384, 65535 };
+	for (size_t sdx = 0; sdx < 3; ++sdx) {
+		b.msg = slice_new(big_buf, ref_sizes[sdx]);
+		b.ring = ringbuf_init(slice_new(malloc(1024), 1024));
+		ringbuf_set_arena(&b.ring, &arena, 256);
+		snprintf(name, sizeof(name), "ringbuf write+read, arena/%zu", ref_sizes[sdx]);
+		bench_run(name, run_slice, &b, ref_sizes[sdx]);
+		snprintf(name, sizeof(name), "ringbuf write_ref+read_ref/%zu", ref_sizes[sdx]);
+		bench_run(name, run_ref, &b, ref_sizes[sdx]);
+		ringbuf_free(&b.ring);
+	}
+	arena_free(&arena);
+	b.out = small_out;
+	free(big_out);
+	free(big_buf);
+	vec_free(&b.vec);
+	str_free(b.str);
+	free(b.out);
+	free(buf);
+}
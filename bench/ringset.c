@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+/**
+ * The number of rings that have traffic; the rest stay idle.
+ */
+#define BUSY 4
+
+typedef struct RingSetBench {
+	RingSet set;
+	RingBuf* rings;
+	size_t count;
+	/**
+	 * Which busy ring is written next.
+	 */
+	size_t turn;
+	/**
+	 * Where the polling scan resumes.
+	 */
+	size_t scan;
+	unsigned char buf[64];
+} RingSetBench;
+
+/**
+ * The busy rings are spread across the set, so that both ways of finding them
+ * must pass over idle rings.
+ */
+static size_t busy_ring(const RingSetBench* const b, size_t idx) {
+	return (idx % BUSY) * (b->count / BUSY) + b->count / BUSY - 1;
+}
+
+static void run_ringset(void* ctx) {
+	RingSetBench* b = ctx;
+	ringset_write_slice(&b->set, busy_ring(b, b->turn++), slice_new(b->buf, 32));
+	size_t id = ringset_next(&b->set);
+	bench_sink = ringbuf_read(&b->rings[id], slice_new(b->buf, sizeof(b->buf)));
+}
+
+/**
+ * The alternative to a RingSet: check every ring in turn for a message.
+ */
+static void run_polling(void* ctx) {
+	RingSetBench* b = ctx;
+	ringbuf_write_slice(&b->rings[busy_ring(b, b->turn++)], slice_new(b->buf, 32));
+	for (size_t seen = 0; seen < b->count; ++seen) {
+		size_t id = b->scan;
+		b->scan = (b->scan + 1) % b->count;
+		if (ringbuf_peek_len(&b->rings[id]) > 0) {
+			bench_sink = ringbuf_read(&b->rings[id], slice_new(b->buf, sizeof(b->buf)));
+			break;
+		}
+	}
+}
+
+void bench_ringset(void) {
+	char name[96];
+	size_t counts[3] = { 16, 256, RINGSET_MAX };
+	for (size_t cdx = 0; cdx < 3; ++cdx) {
+		RingSetBench b = {
+			.set = ringset_init(RINGSET_FAIR),
+			.rings = malloc(counts[cdx] * sizeof(RingBuf)),
+			.count = counts[cdx],
+			.turn = 0,
+			.scan = 0,
+		};
+		memset(b.buf, 0x41, sizeof(b.buf));
+		for (size_t idx = 0; idx < b.count; ++idx) {
+			b.rings[idx] = ringbuf_init(slice_new(malloc(256), 256));
+			ringset_add(&b.set, &b.rings[idx], 256);
+		}
+		snprintf(name, sizeof(name), "ringset write+next+read/%zu rings", b.count);
+		bench_run(name, run_ringset, &b, 32);
+		snprintf(name, sizeof(name), "polling write+scan+read/%zu rings", b.count);
+		bench_run(name, run_polling, &b, 32);
+		for (size_t idx = 0; idx < b.count; ++idx) {
+			ringbuf_free(&b.rings[idx]);
+		}
+		free(b.rings);
+		ringset_free(&b.set);
+	}
+}
@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+typedef struct RopeBench {
+	Slice piece;
+	size_t total;
+} RopeBench;
+
+static void run_vec_append(void* ctx) {
+	RopeBench* b = ctx;
+	Vec vec = vec_init(4096, 1);
+	for (size_t done = 0; done < b->total; done += b->piece.len) {
+		vec_reserve(&vec, b->piece.len);
+		memcpy(&vec.buf[vec.len], b->piece.ptr, b->piece.len);
+		vec.len += b->piece.len;
+	}
+	bench_sink = vec.len;
+	vec_free(&vec);
+}
+
+static void run_rope_append(void* ctx) {
+	RopeBench* b = ctx;
+	Rope rope = rope_init(4096);
+	for (size_t done = 0; done < b->total; done += b->piece.len) {
+		rope_push_slice(&rope, b->piece);
+	}
+	bench_sink = rope.len;
+	rope_free(&rope);
+}
+
+static void run_rope_flatten(void* ctx) {
+	RopeBench* b = ctx;
+	Rope rope = rope_init(4096);
+	for (size_t done = 0; done < b->total; done += b->piece.len) {
+		rope_push_slice(&rope, b->piece);
+	}
+	Vec vec = rope_flatten(&rope);
+	bench_sink = vec.len;
+	vec_free(&vec);
+}
+
+static void run_rope_read(void* ctx) {
+	Rope* rope = ctx;
+	unsigned char buf[64];
+	static size_t offset = 0;
+	offset = (offset + 2654435761u) % (rope->len - sizeof(buf));
+	bench_sink = rope_read(rope, offset, slice_new(buf, sizeof(buf)));
+}
+
+void bench_rope(void) {
+	unsigned char piece[4096];
+	memset(piece, 'r', sizeof(piece));
+	size_t totals[2] = { (size_t)1 << 20, (size_t)256 << 20 };
+	char name[64];
+	for (size_t idx = 0; idx < 2; ++idx) {
+		RopeBench b = {
+			.piece = slice_new(piece, sizeof(piece)),
+			.total = totals[idx],
+		};
+		snprintf(name, sizeof(name), "Vec append 4K pieces/%zu", b.total);
+		bench_run(name, run_vec_append, &b, b.total);
+		snprintf(name, sizeof(name), "rope_push_slice 4K pieces/%zu", b.total);
+		bench_run(name, run_rope_append, &b, b.total);
+		snprintf(name, sizeof(name), "rope_push_slice + rope_flatten/%zu", b.total);
+		bench_run(name, run_rope_flatten, &b, b.total);
+
+		Rope rope = rope_init(4096);
+		for (size_t done = 0; done < b.total; done += b.piece.len) {
+			rope_push_slice(&rope, b.piece);
+		}
+		snprintf(name, sizeof(name), "rope_read 64B at random offsets/%zu", b.total);
+		bench_run(name, run_rope_read, &rope, 64);
+		rope_free(&rope);
+	}
+}
@@ -0,0 +1,230 @@
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+typedef struct SliceBench {
+	Slice hay;
+	Slice other;
+	Slice set;
+	Slice needle;
+	unsigned char byte;
+	unsigned char table[256];
+} SliceBench;
+
+static void run_find_byte(void* ctx) {
+	SliceBench* b = ctx;
+	bench_sink = slice_find_byte(b->hay, b->byte);
+}
+
+static void run_memchr(void* ctx) {
+	SliceBench* b = ctx;
+	bench_sink = (size_t)memchr(b->hay.ptr, b->byte, b->hay.len);
+}
+
+static void run_naive_find_byte(void* ctx) {
+	SliceBench* b = ctx;
+	size_t idx = 0;
+	while (idx < b->hay.len && b->hay.ptr[idx] != b->byte) {
+		++idx;
+	}
+	bench_sink = idx;
+}
+
+static void run_find_any(void* ctx) {
+	SliceBench* b = ctx;
+	bench_sink = slice_find_any(b->hay, b->set);
+}
+
+static void run_naive_find_any(void* ctx) {
+	SliceBench* b = ctx;
+	size_t idx = 0;
+	for (; idx < b->hay.len; ++idx) {
+		if (memchr(b->set.ptr, b->hay.ptr[idx], b->set.len) != NULL) {
+			break;
+		}
+	}
+	bench_sink = idx;
+}
+
+static void run_find_subslice(void* ctx) {
+	SliceBench* b = ctx;
+	bench_sink = slice_find_subslice(b->hay, b->needle);
+}
+
+static void run_naive_find_subslice(void* ctx) {
+	SliceBench* b = ctx;
+	size_t idx = 0;
+	size_t last = b->hay.len - b->needle.len;
+	for (; idx <= last; ++idx) {
+		if (memcmp(&b->hay.ptr[idx], b->needle.ptr, b->needle.len) == 0) {
+			break;
+		}
+	}
+	bench_sink = idx;
+}
+
+static void run_count_byte(void* ctx) {
+	SliceBench* b = ctx;
+	bench_sink = slice_count_byte(b->hay, b->byte);
+}
+
+static void run_naive_count_byte(void* ctx) {
+	SliceBench* b = ctx;
+	size_t ret = 0;
+	for (size_t idx = 0; idx < b->hay.len; ++idx) {
+		ret += b->hay.ptr[idx] == b->byte;
+	}
+	bench_sink = ret;
+}
+
+static void run_cmp(void* ctx) {
+	SliceBench* b = ctx;
+	bench_sink = (size_t)slice_cmp(b->hay, b->other);
+}
+
+static void run_memcmp(void* ctx) {
+	SliceBench* b = ctx;
+	bench_sink = (size_t)memcmp(b->hay.ptr, b->other.ptr, b->hay.len);
+}
+
+static void run_naive_cmp(void* ctx) {
+	SliceBench* b = ctx;
+	size_t idx = 0;
+	while (idx < b->hay.len && b->hay.ptr[idx] == b->other.ptr[idx]) {
+		++idx;
+	}
+	bench_sink = idx;
+}
+
+static size_t callback_total = 0;
+
+static void add_to_total(unsigned char c) {
+	callback_total += c;
+}
+
+static void run_for_each_callback(void* ctx) {
+	SliceBench* b = ctx;
+	callback_total = 0;
+	slice_for_each(b->hay, add_to_total);
+	bench_sink = callback_total;
+}
+
+static uint64_t add_byte(uint64_t acc, unsigned char c, void* ctx) {
+	(void)ctx;
+	return acc + c;
+}
+
+static void run_fold(void* ctx) {
+	SliceBench* b = ctx;
+	bench_sink = slice_fold(b->hay, 0, add_byte, NULL);
+}
+
+static void run_map_into(void* ctx) {
+	SliceBench* b = ctx;
+	bench_sink = slice_map_into(b->other, b->hay, b->table);
+}
+
+static void run_naive_map(void* ctx) {
+	SliceBench* b = ctx;
+	for (size_t idx = 0; idx < b->hay.len; ++idx) {
+		b->other.ptr[idx] = b->table[b->hay.ptr[idx]];
+	}
+	bench_sink = b->other.ptr[0];
+}
+
+static void run_to_lower(void* ctx) {
+	SliceBench* b = ctx;
+	bench_sink = slice_to_ascii_lower(b->other, b->hay);
+}
+
+/**
+ * Run every library kernel at one feature level.
+ */
+static void bench_slice_level(SliceBench* b, const char* level, size_t len) {
+	char name[64];
+	snprintf(name, sizeof(name), "slice_find_byte/%s/%zu", level, len);
+	bench_run(name, run_find_byte, b, len);
+	snprintf(name, sizeof(name), "slice_find_any(4)/%s/%zu", level, len);
+	bench_run(name, run_find_any, b, len);
+	snprintf(name, sizeof(name), "slice_find_subslice/%s/%zu", level, len);
+	bench_run(name, run_find_subslice, b, len);
+	snprintf(name, sizeof(name), "slice_count_byte/%s/%zu", level, len);
+	bench_run(name, run_count_byte, b, len);
+	snprintf(name, sizeof(name), "slice_cmp/%s/%zu", level, len);
+	bench_run(name, run_cmp, b, len);
+	snprintf(name, sizeof(name), "slice_map_into/%s/%zu", level, len);
+	bench_run(name, run_map_into, b, len);
+	snprintf(name, sizeof(name), "slice_to_ascii_lower/%s/%zu", level, len);
+	bench_run(name, run_to_lower, b, len);
+}
+
+static void bench_slice_size(size_t len) {
+	unsigned char* hay = malloc(len);
+	unsigned char* other = malloc(len);
+	/* Lowercase text with no newlines or punctuation, then a match at the end. */
+	for (size_t idx = 0; idx < len; ++idx) {
+		hay[idx] = (unsigned char)('a' + (idx * 7 + idx / 13) % 26);
+	}
+	memcpy(&hay[len - 8], "\r\nSTOP\r\n", 8);
+	memcpy(other, hay, len);
+	other[len - 1] = '!';
+
+	SliceBench b = {
+		.hay = slice_new(hay, len),
+		.other = slice_new(other, len),
+		.set = slice_new((unsigned char*)"\r\n:;", 4),
+		.needle = slice_new((unsigned char*)"STOP", 4),
+		.byte = '\n',
+	};
+	for (size_t idx = 0; idx < 256; ++idx) {
+		b.table[idx] = (unsigned char)(255 - idx);
+	}
+
+	char name[64];
+	snprintf(name, sizeof(name), "naive find_byte/%zu", len);
+	bench_run(name, run_naive_find_byte, &b, len);
+	snprintf(name, sizeof(name), "memchr/%zu", len);
+	bench_run(name, run_memchr, &b, len);
+	snprintf(name, sizeof(name), "naive find_any(4)/%zu", len);
+	bench_run(name, run_naive_find_any, &b, len);
+	snprintf(name, sizeof(name), "naive find_subslice/%zu", len);
+	bench_run(name, run_naive_find_subslice, &b, len);
+	snprintf(name, sizeof(name), "naive count_byte/%zu", len);
+	bench_run(name, run_naive_count_byte, &b, len);
+	snprintf(name, sizeof(name), "naive cmp/%zu", len);
+	bench_run(name, run_naive_cmp, &b, len);
+	snprintf(name, sizeof(name), "memcmp/%zu", len);
+	bench_run(name, run_memcmp, &b, len);
+	snprintf(name, sizeof(name), "naive map/%zu", len);
+	bench_run(name, run_naive_map, &b, len);
+	snprintf(name, sizeof(name), "slice_for_each callback sum/%zu", len);
+	bench_run(name, run_for_each_callback, &b, len);
+	snprintf(name, sizeof(name), "slice_fold sum/%zu", len);
+	bench_run(name, run_fold, &b, len);
+
+	unsigned int old = cpu_restrict(0);
+	bench_slice_level(&b, "scalar", len);
+	cpu_restrict(CPU_SSE2);
+	if (cpu_has(CPU_SSE2)) {
+		bench_slice_level(&b, "sse2", len);
+	}
+	cpu_restrict(CPU_SSE2 | CPU_AVX2);
+	if (cpu_has(CPU_AVX2)) {
+		bench_slice_level(&b, "avx2", len);
+	}
+	cpu_restrict(old);
+	if (cpu_has(CPU_AVX512BW)) {
+		bench_slice_level(&b, "avx512", len);
+	}
+
+	free(hay);
+	free(other);
+}
+
+void bench_slice(void) {
+	bench_slice_size(64);
+	bench_slice_size(4096);
+	bench_slice_size(1 << 20);
+}
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+typedef struct SplitBench {
+	Slice text;
+	Slice delims;
+	size_t piece;
+} SplitBench;
+
+/**
+ * The usual hand-written splitter: test every byte, and copy every record into
+ * a buffer as it goes.
+ */
+static void run_naive_split(void* ctx) {
+	SplitBench* b = ctx;
+	Vec rec = vec_init(256, 1);
+	size_t count = 0;
+	for (size_t idx = 0; idx < b->text.len; ++idx) {
+		unsigned char c = b->text.ptr[idx];
+		if (memchr(b->delims.ptr, c, b->delims.len) != NULL) {
+			count += rec.len;
+			rec.len = 0;
+		}
+		else {
+			vec_push_byte(&rec, c);
+		}
+	}
+	bench_sink = count;
+	vec_free(&rec);
+}
+
+static void run_splitter(void* ctx) {
+	SplitBench* b = ctx;
+	Splitter s = splitter_init(b->delims);
+	size_t count = 0;
+	Slice rec;
+	for (size_t idx = 0; idx < b->text.len; idx += b->piece) {
+		size_t len = b->text.len - idx < b->piece ? b->text.len - idx : b->piece;
+		splitter_feed(&s, slice_new(&b->text.ptr[idx], len));
+		while (splitter_next(&s, &rec)) {
+			count += rec.len;
+		}
+	}
+	bench_sink = count;
+	splitter_free(&s);
+}
+
+void bench_split(void) {
+	size_t len = 1 << 20;
+	unsigned char* text = malloc(len);
+	for (size_t idx = 0; idx < len; ++idx) {
+		text[idx] = (unsigned char)('a' + (idx * 7 + idx / 13) % 26);
+	}
+	/* Records of about 80 bytes. */
+	for (size_t idx = 79; idx < len; idx += 61 + idx % 37) {
+		text[idx] = '\n';
+	}
+	SplitBench b = {
+		.text = slice_new(text, len),
+		.delims = slice_new((unsigned char*)"\n", 1),
+		.piece = 1500,
+	};
+	bench_run("naive split \\n", run_naive_split, &b, len);
+	bench_run("splitter \\n, 1500B pieces", run_splitter, &b, len);
+	b.piece = 65536;
+	bench_run("splitter \\n, 64K pieces", run_splitter, &b, len);
+	b.delims = slice_new((unsigned char*)"\n\0\x1e", 3);
+	bench_run("naive split \\n\\0\\x1e", run_naive_split, &b, len);
+	bench_run("splitter \\n\\0\\x1e, 64K pieces", run_splitter, &b, len);
+	free(text);
+}
@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+typedef struct StrBench {
+	Slice src;
+	Slice dst;
+	Slice parts[3];
+} StrBench;
+
+/**
+ * Build a Str on the heap and free it, as a caller holding it briefly would.
+ */
+static void run_from_slice(void* ctx) {
+	StrBench* b = ctx;
+	Str* s = str_from_slice(b->src);
+	bench_sink = s->len;
+	str_free(s);
+}
+
+static void run_from_slice_in_place(void* ctx) {
+	StrBench* b = ctx;
+	Str* s = str_from_slice_in_place(b->dst, b->src);
+	bench_sink = s->len;
+}
+
+/**
+ * Build a Str from a header, body, and trailer joined in a temporary Vec.
+ */
+static void run_from_concat(void* ctx) {
+	StrBench* b = ctx;
+	Vec tmp = vec_init(b->src.len, 1);
+	for (size_t idx = 0; idx < 3; ++idx) {
+		vec_push_slice(&tmp, b->parts[idx]);
+	}
+	Str* s = str_from_vec(&tmp);
+	vec_free(&tmp);
+	bench_sink = s->len;
+	str_free(s);
+}
+
+static void run_from_slices(void* ctx) {
+	StrBench* b = ctx;
+	Str* s = str_from_slices(b->parts, 3);
+	bench_sink = s->len;
+	str_free(s);
+}
+
+void bench_str(void) {
+	size_t len = 1 << 15;
+	unsigned char* buf = malloc(len);
+	unsigned char* dst = malloc(str_size((StrLen)len));
+	for (size_t idx = 0; idx < len; ++idx) {
+		buf[idx] = (unsigned char)(idx * 131 + 7);
+	}
+	StrBench b = {
+		.dst = slice_new(dst, str_size((StrLen)len)),
+	};
+	char name[64];
+	size_t sizes[4] = { 16, 256, 4096, 32768 };
+	for (size_t idx = 0; idx < 4; ++idx) {
+		b.src = slice_new(buf, sizes[idx]);
+		snprintf(name, sizeof(name), "str_from_slice/%zu", sizes[idx]);
+		bench_run(name, run_from_slice, &b, sizes[idx]);
+		snprintf(name, sizeof(name), "str_from_slice_in_place/%zu", sizes[idx]);
+		bench_run(name, run_from_slice_in_place, &b, sizes[idx]);
+	}
+	/* A 16-byte header and 4-byte trailer around each body. */
+	for (size_t idx = 1; idx < 3; ++idx) {
+		b.src = slice_new(buf, sizes[idx] + 20);
+		b.parts[0] = slice_new(buf, 16);
+		b.parts[1] = slice_new(&buf[16], sizes[idx]);
+		b.parts[2] = slice_new(&buf[16 + sizes[idx]], 4);
+		snprintf(name, sizeof(name), "str_from_vec, concatenated/%zu", b.src.len);
+		bench_run(name, run_from_concat, &b, b.src.len);
+		snprintf(name, sizeof(name), "str_from_slices/%zu", b.src.len);
+		bench_run(name, run_from_slices, &b, b.src.len);
+	}
+	free(dst);
+	free(buf);
+}
@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+typedef struct Utf8Bench {
+	Slice src;
+	Vec out;
+} Utf8Bench;
+
+static void run_validate(void* ctx) {
+	Utf8Bench* b = ctx;
+	bench_sink = utf8_validate(b->src);
+}
+
+static void run_is_ascii(void* ctx) {
+	Utf8Bench* b = ctx;
+	bench_sink = utf8_is_ascii(b->src);
+}
+
+static void run_count(void* ctx) {
+	Utf8Bench* b = ctx;
+	bench_sink = utf8_count(b->src);
+}
+
+static void run_to_utf16(void* ctx) {
+	Utf8Bench* b = ctx;
+	b->out.len = 0;
+	Utf8Result res = utf8_to_utf16(&b->out, b->src);
+	bench_sink = GET_VARIANT_BODY(res, Ok);
+}
+
+static void run_from_utf16(void* ctx) {
+	Utf8Bench* b = ctx;
+	b->out.len = 0;
+	Utf8Result res = utf16_to_utf8(&b->out, b->src);
+	bench_sink = GET_VARIANT_BODY(res, Ok);
+}
+
+void bench_utf8(void) {
+	size_t len = 1 << 16;
+	unsigned char* ascii = malloc(len);
+	unsigned char* mixed = malloc(len);
+	for (size_t idx = 0; idx < len; ++idx) {
+		ascii[idx] = (unsigned char)(' ' + idx * 37 % 95);
+	}
+	/* Mostly ASCII, with a two-, three-, or four-byte character every few
+	 * words, as in European text with the odd symbol. */
+	const char* chars[6] = { "the ", "caf\xC3\xA9 ", "na\xC3\xAFve ", "and ", "\xE2\x82\xAC""5 ", "\xF0\x9F\x98\x80 " };
+	size_t mixed_len = 0;
+	for (size_t idx = 0; mixed_len + 8 <= len; ++idx) {
+		const char* word = chars[idx * 5 % 6];
+		memcpy(&mixed[mixed_len], word, strlen(word));
+		mixed_len += strlen(word);
+	}
+	Utf8Bench b = { .out = vec_init(2 * len, 1) };
+	char name[64];
+	const char* levels[3] = { "scalar", "ssse3", "best" };
+	unsigned int masks[3] = { 0, CPU_SSE2 | CPU_SSSE3, ~0u };
+	Slice texts[2] = { slice_new(ascii, len), slice_new(mixed, mixed_len) };
+	const char* kinds[2] = { "ascii", "mixed" };
+	unsigned int old = cpu_restrict(0);
+	for (size_t kind = 0; kind < 2; ++kind) {
+		b.src = texts[kind];
+		for (size_t lvl = 0; lvl < 3; ++lvl) {
+			cpu_restrict(masks[lvl] & old);
+			snprintf(name, sizeof(name), "utf8_validate/%s/%s", levels[lvl], kinds[kind]);
+			bench_run(name, run_validate, &b, b.src.len);
+		}
+		for (size_t lvl = 0; lvl < 3; lvl += 2) {
+			cpu_restrict(masks[lvl] & old);
+			snprintf(name, sizeof(name), "utf8_count/%s/%s", levels[lvl], kinds[kind]);
+			bench_run(name, run_count, &b, b.src.len);
+		}
+	}
+	b.src = texts[0];
+	for (size_t lvl = 0; lvl < 3; lvl += 2) {
+		cpu_restrict(masks[lvl] & old);
+		snprintf(name, sizeof(name), "utf8_is_ascii/%s/ascii", levels[lvl]);
+		bench_run(name, run_is_ascii, &b, b.src.len);
+	}
+	cpu_restrict(old);
+
+	Vec wide = vec_init(2 * len, 1);
+	for (size_t kind = 0; kind < 2; ++kind) {
+		b.src = texts[kind];
+		snprintf(name, sizeof(name), "utf8_to_utf16/%s", kinds[kind]);
+		bench_run(name, run_to_utf16, &b, b.src.len);
+		wide.len = 0;
+		utf8_to_utf16(&wide, texts[kind]);
+		b.src = vec_as_slice(&wide);
+		/* Throughput is counted in UTF-8 bytes, as for the other way. */
+		snprintf(name, sizeof(name), "utf16_to_utf8/%s", kinds[kind]);
+		bench_run(name, run_from_utf16, &b, texts[kind].len);
+	}
+
+	vec_free(&wide);
+	vec_free(&b.out);
+	free(mixed);
+	free(ascii);
+}
@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <wyzyrdry.h>
+
+#include "bench.h"
+
+typedef struct VecBench {
+	Vec vec;
+	Slice src;
+	size_t count;
+} VecBench;
+
+/**
+ * Push bytes into a Vec that already has the room, so only the push is timed.
+ */
+static void run_push_byte(void* ctx) {
+	VecBench* b = ctx;
+	b->vec.len = 0;
+	for (size_t idx = 0; idx < b->count; ++idx) {
+		vec_push_byte(&b->vec, (unsigned char)idx);
+	}
+	bench_sink = b->vec.len;
+}
+
+/**
+ * Push bytes into a new Vec, so that its growth is timed as well.
+ */
+static void run_push_byte_grow(void* ctx) {
+	VecBench* b = ctx;
+	Vec vec = vec_init(1, 1);
+	for (size_t idx = 0; idx < b->count; ++idx) {
+		vec_push_byte(&vec, (unsigned char)idx);
+	}
+	bench_sink = vec.len;
+	vec_free(&vec);
+}
+
+static void run_push_slice(void* ctx) {
+	VecBench* b = ctx;
+	b->vec.len = 0;
+	for (size_t idx = 0; idx < b->count; ++idx) {
+		vec_push_slice(&b->vec, b->src);
+	}
+	bench_sink = b->vec.len;
+}
+
+void bench_vec(void) {
+	size_t len = 1 << 16;
+	unsigned char* buf = malloc(len);
+	for (size_t idx = 0; idx < len; ++idx) {
+		buf[idx] = (unsigned char)(idx * 131 + 7);
+	}
+	VecBench b = {
+		.vec = vec_init(len, 1),
+		.count = len,
+	};
+	bench_run("vec_push_byte/65536, reserved", run_push_byte, &b, len);
+	bench_run("vec_push_byte/65536, from empty", run_push_byte_grow, &b, len);
+
+	char name[64];
+	size_t sizes[3] = { 16, 256, 4096 };
+	for (size_t idx = 0; idx < 3; ++idx) {
+		b.src = slice_new(buf, sizes[idx]);
+		b.count = len / sizes[idx];
+		snprintf(name, sizeof(name), "vec_push_slice/%zu x %zu", b.count, sizes[idx]);
+		bench_run(name, run_push_slice, &b, len);
+	}
+	vec_free(&b.vec);
+	free(buf);
+}
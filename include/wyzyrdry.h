@@ -6,10 +6,29 @@
 #ifndef WYZYRDRY_LIB_H
 #define WYZYRDRY_LIB_H
 
+#include "wyzyrdry/arena.h"
+#include "wyzyrdry/base64.h"
+#include "wyzyrdry/broadcast.h"
+#include "wyzyrdry/cpu.h"
 #include "wyzyrdry/enum.h"
+#include "wyzyrdry/frame.h"
+#include "wyzyrdry/hash.h"
+#include "wyzyrdry/hex.h"
+#include "wyzyrdry/hist.h"
+#include "wyzyrdry/instrument.h"
+#include "wyzyrdry/intern.h"
+#include "wyzyrdry/lz.h"
+#include "wyzyrdry/map.h"
+#include "wyzyrdry/pages.h"
+#include "wyzyrdry/pool.h"
+#include "wyzyrdry/reactor.h"
 #include "wyzyrdry/ringbuf.h"
+#include "wyzyrdry/ringset.h"
+#include "wyzyrdry/rope.h"
 #include "wyzyrdry/slice.h"
+#include "wyzyrdry/split.h"
 #include "wyzyrdry/str.h"
+#include "wyzyrdry/utf8.h"
 #include "wyzyrdry/vec.h"
 
 void hex_print(Slice item);
@@ -0,0 +1,98 @@
+/**
+ * This module hands out blocks of memory for message payloads, so that large
+ * messages can be passed through a `RingBuf` by reference instead of being
+ * copied into and out of its store.
+ *
+ * Blocks come in power-of-two size classes from 64 bytes to 64 KiB, carved
+ * from 64 KiB chunks. Released blocks go on a free list for their class and
+ * are reused before any new chunk is allocated, so once an Arena has grown to
+ * its working size, allocating and releasing are a few loads and stores each.
+ * Chunks are only returned to the system when the Arena is freed.
+ *
+ * Each block is described by an `ArenaRef`, a fixed-size descriptor which can
+ * be copied freely. Whoever holds the descriptor owns the block, and passes it
+ * on, or gives it back with `arena_release()`.
+ *
+ * An Arena is not synchronized, and belongs to one thread, like the RingBufs
+ * that carry its blocks.
+ */
+
+#ifndef WYZYRDRY_ARENA_H
+#define WYZYRDRY_ARENA_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "slice.h"
+#include "vec.h"
+
+/**
+ * The size of the smallest blocks is `1 << ARENA_MIN_SHIFT` bytes.
+ */
+#define ARENA_MIN_SHIFT 6
+/**
+ * The number of block sizes.
+ */
+#define ARENA_CLASSES 11
+/**
+ * The size of the largest blocks, and of each chunk allocated from the system.
+ */
+#define ARENA_CHUNK ((size_t)1 << (ARENA_MIN_SHIFT + ARENA_CLASSES - 1))
+
+/**
+ * A block of an Arena, and the length of the payload in it.
+ */
+typedef struct ArenaRef {
+	/**
+	 * The start of the block, or NULL if allocation failed.
+	 */
+	unsigned char* ptr;
+	/**
+	 * The number of bytes of the block in use.
+	 */
+	uint32_t len;
+	/**
+	 * The size class of the block, which says which free list it returns to.
+	 */
+	uint32_t cls;
+} ArenaRef;
+
+/**
+ * A pool of blocks in several sizes.
+ */
+typedef struct Arena {
+	/**
+	 * For each class, the blocks ready for reuse, as an array of pointers. Its
+	 * capacity is kept at the number of blocks in the class, so releasing a
+	 * block never allocates.
+	 */
+	Vec free[ARENA_CLASSES];
+	/**
+	 * For each class, the number of blocks carved so far.
+	 */
+	size_t blocks[ARENA_CLASSES];
+	/**
+	 * The chunks obtained from the system, as an array of pointers.
+	 */
+	Vec chunks;
+	/**
+	 * The number of blocks handed out and not yet released.
+	 */
+	size_t live;
+} Arena;
+
+Arena arena_init(void);
+void arena_free(Arena* const self);
+
+ArenaRef arena_alloc(Arena* const self, size_t len);
+void arena_release(Arena* const self, const ArenaRef ref);
+/**
+ * Describe the payload in a block.
+ * @param ref The block.
+ * @return A Slice over the `len` bytes of the payload.
+ */
+static inline Slice arena_as_slice(const ArenaRef ref) {
+	return slice_new(ref.ptr, ref.len);
+}
+
+#endif
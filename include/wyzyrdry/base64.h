@@ -0,0 +1,65 @@
+/**
+ * This module converts bytes to and from base64 text, so that `Str` payloads
+ * can pass through layers that only carry text, such as JSON logs and HTTP
+ * headers.
+ *
+ * Both alphabets of RFC 4648 are supported. Encoding and decoding use SSSE3 or
+ * AVX2 where available, translating whole blocks of characters with shuffle
+ * lookups, and fall back to a portable table-driven loop elsewhere. Decoding
+ * validates its input and reports the position of the first bad character.
+ */
+
+#ifndef WYZYRDRY_BASE64_H
+#define WYZYRDRY_BASE64_H
+
+#include "enum.h"
+#include "slice.h"
+#include "vec.h"
+
+/**
+ * The two base64 alphabets, which differ in their last two characters and in
+ * whether encoded text is padded.
+ */
+typedef enum Base64Alphabet {
+	/**
+	 * RFC 4648 section 4: `+` and `/`, padded with `=` to a multiple of four
+	 * characters.
+	 */
+	BASE64_STANDARD,
+	/**
+	 * RFC 4648 section 5: `-` and `_`, which need no escaping in URLs or file
+	 * names, and unpadded.
+	 */
+	BASE64_URL,
+} Base64Alphabet;
+
+/**
+ * The outcome of decoding base64 text.
+ *
+ * The Ok variant carries the number of bytes written to the destination.
+ *
+ * The Err variant carries the index of the first input character that could not
+ * be decoded. A final group of one character, or one whose unused low bits are
+ * not zero, reports its last character.
+ */
+ENUM(Base64Result, size_t, Ok, size_t, Err);
+
+size_t base64_encoded_len(size_t len, Base64Alphabet alphabet);
+void base64_encode(Vec* const dst, const Slice src, Base64Alphabet alphabet);
+size_t base64_encode_into(
+	const Slice dst,
+	const Slice src,
+	Base64Alphabet alphabet
+);
+Base64Result base64_decode(
+	Vec* const dst,
+	const Slice src,
+	Base64Alphabet alphabet
+);
+Base64Result base64_decode_into(
+	const Slice dst,
+	const Slice src,
+	Base64Alphabet alphabet
+);
+
+#endif
@@ -0,0 +1,117 @@
+/**
+ * This module delivers one stream of messages to several readers through a
+ * single `RingBuf`, in the manner of the Disruptor: each message is written
+ * once, and every reader walks the queue with its own cursor, seeing each
+ * message in place without copying it.
+ *
+ * A message is popped from the ring once the slowest reader has passed it, so
+ * the ring holds the span between the slowest reader and the producer. When
+ * that span fills the ring, the producer either waits for the slowest reader,
+ * or pushes it forward past the oldest messages, which it then misses.
+ *
+ * Readers keep their place as a count of messages and of bytes since the
+ * stream began, not as an index into the store, so a growing ring may move its
+ * messages freely. Readers see messages as stored, as the peek functions of
+ * `RingBuf` do, so a ring that compresses messages or keeps them in an `Arena`
+ * is of little use here.
+ *
+ * A Broadcast and its ring belong to one thread, as the ring does.
+ */
+
+#ifndef WYZYRDRY_BROADCAST_H
+#define WYZYRDRY_BROADCAST_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "ringbuf.h"
+#include "slice.h"
+#include "str.h"
+#include "vec.h"
+
+/**
+ * Returned by `broadcast_add()` on failure.
+ */
+#define BROADCAST_NONE ((size_t)-1)
+
+/**
+ * What a write does when the ring is full.
+ */
+typedef enum BroadcastPolicy {
+	/**
+	 * Refuse the message, until the slowest reader makes room.
+	 */
+	BROADCAST_WAIT,
+	/**
+	 * Pop the oldest messages until the new one fits, moving the readers that
+	 * had not seen them past them.
+	 */
+	BROADCAST_DROP,
+} BroadcastPolicy;
+
+/**
+ * One reader's place in the stream.
+ */
+typedef struct BroadcastReader {
+	/**
+	 * The number of the next message the reader will see, counting every
+	 * message written.
+	 */
+	size_t seq;
+	/**
+	 * The offset of that message's record in the stream of bytes written.
+	 */
+	size_t at;
+	/**
+	 * The messages the reader was moved past without seeing them.
+	 */
+	size_t missed;
+	/**
+	 * Whether the reader is registered, or its id is unused.
+	 */
+	bool active;
+} BroadcastReader;
+
+/**
+ * A ring, and the readers sharing it.
+ */
+typedef struct Broadcast {
+	RingBuf* ring;
+	BroadcastPolicy policy;
+	/**
+	 * The readers, as an array of `BroadcastReader`, indexed by id.
+	 */
+	Vec readers;
+	/**
+	 * The number of active readers.
+	 */
+	size_t active;
+	/**
+	 * The number of the message at the head of the ring.
+	 */
+	size_t base;
+	/**
+	 * The offset of that message's record in the stream of bytes written.
+	 */
+	size_t base_at;
+} Broadcast;
+
+Broadcast broadcast_init(RingBuf* const ring, BroadcastPolicy policy);
+void broadcast_free(Broadcast* const self);
+
+size_t broadcast_add(Broadcast* const self);
+void broadcast_remove(Broadcast* const self, size_t id);
+
+StrLen broadcast_write_slice(Broadcast* const self, const Slice in);
+StrLen broadcast_write_gather(
+	Broadcast* const self,
+	const Slice* const parts,
+	size_t n
+);
+
+size_t broadcast_pending(const Broadcast* const self, size_t id);
+size_t broadcast_missed(const Broadcast* const self, size_t id);
+bool broadcast_peek(const Broadcast* const self, size_t id, Slice parts[2]);
+void broadcast_pop(Broadcast* const self, size_t id);
+
+#endif
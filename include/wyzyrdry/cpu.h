@@ -0,0 +1,45 @@
+/**
+ * This module detects the instruction set extensions of the running processor
+ * so that other modules can select accelerated kernels at runtime.
+ *
+ * The library is compiled for the baseline of its target architecture. Modules
+ * that carry SIMD kernels compile each kernel with `WYZYRDRY_TARGET()` and only
+ * call it after `cpu_has()` confirms that the processor supports it. Every
+ * kernel has a portable scalar sibling that is used everywhere else.
+ */
+
+#ifndef WYZYRDRY_CPU_H
+#define WYZYRDRY_CPU_H
+
+#include <stdbool.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+/**
+ * Defined when x86 SIMD kernels can be compiled into the library.
+ */
+#define WYZYRDRY_X86 1
+/**
+ * Compile a single function for an instruction set beyond the baseline.
+ */
+#define WYZYRDRY_TARGET(_isa) __attribute__((target(_isa)))
+#endif
+
+/**
+ * Instruction set extensions that the library knows how to use.
+ */
+typedef enum CpuFeature {
+	CPU_SSE2 = 1 << 0,
+	CPU_SSSE3 = 1 << 1,
+	CPU_SSE42 = 1 << 2,
+	CPU_PCLMUL = 1 << 3,
+	CPU_AVX2 = 1 << 4,
+	CPU_AVX512BW = 1 << 5,
+	CPU_BMI2 = 1 << 6,
+	CPU_AVX512VBMI = 1 << 7,
+} CpuFeature;
+
+unsigned int cpu_features(void);
+bool cpu_has(unsigned int features);
+unsigned int cpu_restrict(unsigned int mask);
+
+#endif
@@ -11,6 +11,21 @@
  * enum. The enum values are of the form <type name>Tag_<variant name>, because
  * enum values are not scoped but are globally accessible symbols.
  *
+ * ENUM_PACKED(<type name>, <<variant type>, <variant name>>*);
+ * ENUM_WIDTH(<type name>, <tag type>, <<variant type>, <variant name>>*);
+ *
+ * These declare the same items, but store the tag in the given integer type
+ * (`uint8_t` for ENUM_PACKED) directly after the union, with no padding. This
+ * saves the space of a full `enum` and its alignment padding, at the cost of
+ * unaligned fields when such a struct is placed in an array.
+ *
+ * Every form also defines static inline helpers for each variant:
+ *
+ * <type name>_is_<variant name>(<value>) tests the tag;
+ * <type name>_as_<variant name>(<value>) returns the body, and asserts that the
+ * tag matches unless NDEBUG is defined;
+ * <type name>_tag(<value>) returns the tag as the enum type.
+ *
  * SET_VARIANT(<type name>, <variant name>, <variant body>);
  *
  * This creates an instance of the struct defined by an ENUM() declaration, and
@@ -27,15 +42,18 @@
  *
  * The C compiler won't help maintain type safety on these, so client code will
  * have to manually ensure that is extracting the same discriminant that was put
- * in.
+ * in. The _as_ helpers catch mistakes in debug builds.
  *
- * Note: ENUM() currently only supports up to thirteen variants in a single enum
- * set. If more than thirteen are required ... awkward.
+ * Note: ENUM() supports up to thirty-two variants in a single enum set.
  */
 
 #ifndef WYZYRDRY_ENUM_H
 #define WYZYRDRY_ENUM_H
 
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
 /*
  * These two macros permit counting the number of arguments given to a variadic
  * macro. It is necessary for permitting appropriate dispatch.
@@ -44,12 +62,19 @@
  * appropriate number is in the argument slot that will be used as the count. C
  * macros are ... not great.
  */
-#define _ARGC(_a, _b, _c, _d, _e, _f, _g, _h, _i, _j, _k, _l, _m, _n, _o, _p, \
-_q, _r, _s, _t, _u, _v, _w, _x, _y, _z, n, ...) n
-#define ARGC(...) _ARGC(__VA_ARGS__, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, \
+#define _ARGC(_a1, _a2, _a3, _a4, _a5, _a6, _a7, _a8, _a9, _a10, _a11, _a12, \
+_a13, _a14, _a15, _a16, _a17, _a18, _a19, _a20, _a21, _a22, _a23, _a24, \
+_a25, _a26, _a27, _a28, _a29, _a30, _a31, _a32, _a33, _a34, _a35, _a36, \
+_a37, _a38, _a39, _a40, _a41, _a42, _a43, _a44, _a45, _a46, _a47, _a48, \
+_a49, _a50, _a51, _a52, _a53, _a54, _a55, _a56, _a57, _a58, _a59, _a60, \
+_a61, _a62, _a63, _a64, n, ...) n
+#define ARGC(...) _ARGC(__VA_ARGS__, 64, 63, 62, 61, 60, 59, 58, 57, 56, 55, \
+54, 53, 52, 51, 50, 49, 48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, \
+35, 34, 33, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, \
 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1)
 
 #define JOIN(_name, _var) _name ## _ ## _var
+#define JOIN3(_name, _mid, _var) _name ## _ ## _mid ## _ ## _var
 
 /*
  * I don't know why this many layers of indirection are necessary, but here we
@@ -60,77 +85,100 @@ _q, _r, _s, _t, _u, _v, _w, _x, _y, _z, n, ...) n
 #define MUX(op, count) MUX1(op, count)
 
 /*
- * Build enum and union items for a type/name pair
+ * Apply a macro to each type/name pair, passing it the name of the enum as
+ * well. As C does not support direct recursion, each of these simply pops a
+ * pair out of varargs and hands the rest off to the next macro down the line.
  */
-#define SPLIT_2(_name, _ty, _var, ...) JOIN(_name, _var)
-#define LIST_2(_ty, _var, ...) _ty _var;
+#define EACH_2(_m, _name, _ty, _var) _m(_name, _ty, _var)
+#define EACH_4(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_2(_m, _name, __VA_ARGS__)
+#define EACH_6(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_4(_m, _name, __VA_ARGS__)
+#define EACH_8(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_6(_m, _name, __VA_ARGS__)
+#define EACH_10(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_8(_m, _name, __VA_ARGS__)
+#define EACH_12(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_10(_m, _name, __VA_ARGS__)
+#define EACH_14(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_12(_m, _name, __VA_ARGS__)
+#define EACH_16(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_14(_m, _name, __VA_ARGS__)
+#define EACH_18(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_16(_m, _name, __VA_ARGS__)
+#define EACH_20(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_18(_m, _name, __VA_ARGS__)
+#define EACH_22(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_20(_m, _name, __VA_ARGS__)
+#define EACH_24(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_22(_m, _name, __VA_ARGS__)
+#define EACH_26(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_24(_m, _name, __VA_ARGS__)
+#define EACH_28(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_26(_m, _name, __VA_ARGS__)
+#define EACH_30(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_28(_m, _name, __VA_ARGS__)
+#define EACH_32(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_30(_m, _name, __VA_ARGS__)
+#define EACH_34(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_32(_m, _name, __VA_ARGS__)
+#define EACH_36(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_34(_m, _name, __VA_ARGS__)
+#define EACH_38(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_36(_m, _name, __VA_ARGS__)
+#define EACH_40(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_38(_m, _name, __VA_ARGS__)
+#define EACH_42(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_40(_m, _name, __VA_ARGS__)
+#define EACH_44(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_42(_m, _name, __VA_ARGS__)
+#define EACH_46(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_44(_m, _name, __VA_ARGS__)
+#define EACH_48(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_46(_m, _name, __VA_ARGS__)
+#define EACH_50(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_48(_m, _name, __VA_ARGS__)
+#define EACH_52(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_50(_m, _name, __VA_ARGS__)
+#define EACH_54(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_52(_m, _name, __VA_ARGS__)
+#define EACH_56(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_54(_m, _name, __VA_ARGS__)
+#define EACH_58(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_56(_m, _name, __VA_ARGS__)
+#define EACH_60(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_58(_m, _name, __VA_ARGS__)
+#define EACH_62(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_60(_m, _name, __VA_ARGS__)
+#define EACH_64(_m, _name, _ty, _var, ...) _m(_name, _ty, _var) EACH_62(_m, _name, __VA_ARGS__)
 
 /*
- * Build enum and union items for two type/name pairs. As C does not support
- * direct recursion, this (and all subsequent) simply pops a pair out of varargs
- * and hands the rest off to the next macro down the line.
+ * Apply a macro to each type/name pair in a list.
  */
-#define SPLIT_4(_name, _ty, _var, ...) JOIN(_name, _var), SPLIT_2(_name, __VA_ARGS__)
-#define LIST_4(_ty, _var, ...) _ty _var; LIST_2(__VA_ARGS__)
-
-#define SPLIT_6(_name, _ty, _var, ...) JOIN(_name, _var), SPLIT_4(_name, __VA_ARGS__)
-#define LIST_6(_ty, _var, ...) _ty _var; LIST_4(__VA_ARGS__)
-
-#define SPLIT_8(_name, _ty, _var, ...) JOIN(_name, _var), SPLIT_6(_name, __VA_ARGS__)
-#define LIST_8(_ty, _var, ...) _ty _var; LIST_6(__VA_ARGS__)
-
-#define SPLIT_10(_name, _ty, _var, ...) JOIN(_name, _var), SPLIT_8(_name, __VA_ARGS__)
-#define LIST_10(_ty, _var, ...) _ty _var; LIST_8(__VA_ARGS__)
-
-#define SPLIT_12(_name, _ty, _var, ...) JOIN(_name, _var), SPLIT_10(_name, __VA_ARGS__)
-#define LIST_12(_ty, _var, ...) _ty _var; LIST_10(__VA_ARGS__)
-
-#define SPLIT_14(_name, _ty, _var, ...) JOIN(_name, _var), SPLIT_12(_name, __VA_ARGS__)
-#define LIST_14(_ty, _var, ...) _ty _var; LIST_12(__VA_ARGS__)
-
-#define SPLIT_16(_name, _ty, _var, ...) JOIN(_name, _var), SPLIT_14(_name, __VA_ARGS__)
-#define LIST_16(_ty, _var, ...) _ty _var; LIST_14(__VA_ARGS__)
-
-#define SPLIT_18(_name, _ty, _var, ...) JOIN(_name, _var), SPLIT_16(_name, __VA_ARGS__)
-#define LIST_18(_ty, _var, ...) _ty _var; LIST_16(__VA_ARGS__)
-
-#define SPLIT_20(_name, _ty, _var, ...) JOIN(_name, _var), SPLIT_18(_name, __VA_ARGS__)
-#define LIST_20(_ty, _var, ...) _ty _var; LIST_18(__VA_ARGS__)
-
-#define SPLIT_22(_name, _ty, _var, ...) JOIN(_name, _var), SPLIT_20(_name, __VA_ARGS__)
-#define LIST_22(_ty, _var, ...) _ty _var; LIST_20(__VA_ARGS__)
-
-#define SPLIT_24(_name, _ty, _var, ...) JOIN(_name, _var), SPLIT_22(_name, __VA_ARGS__)
-#define LIST_24(_ty, _var, ...) _ty _var; LIST_22(__VA_ARGS__)
+#define EACH(_m, _name, ...) \
+MUX(EACH, ARGC(__VA_ARGS__))(_m, _name, __VA_ARGS__)
 
 /*
- * Hope nobody needs an enum with more than thirteen variants.
+ * Build an enum tag, a union variant, or the helpers for one type/name pair.
  */
-#define SPLIT_26(_name, _ty, _var, ...) JOIN(_name, _var), SPLIT_24(_name, __VA_ARGS__)
-#define LIST_26(_ty, _var, ...) _ty _var; LIST_24(__VA_ARGS__)
+#define TAG_ITEM(_name, _ty, _var) JOIN(_name, _var),
+#define VAL_ITEM(_name, _ty, _var) _ty _var;
+#define HELPER_ITEM(_name, _ty, _var) \
+static inline bool JOIN3(_name, is, _var)(const _name self) { \
+	return self.tag == JOIN(_name, _var); \
+} \
+static inline _ty JOIN3(_name, as, _var)(const _name self) { \
+	assert(self.tag == JOIN(_name, _var)); \
+	return self.body._var; \
+}
 
 /*
  * Build enum tags out of a type/pair list
  */
-#define TAGS(_name, ...) \
-MUX(SPLIT, ARGC(__VA_ARGS__))(_name, __VA_ARGS__)
+#define TAGS(_name, ...) EACH(TAG_ITEM, _name, __VA_ARGS__)
 /*
  * Build union variants out of a type/pair list
  */
-#define VALS(...) \
-MUX(LIST, ARGC(__VA_ARGS__))(__VA_ARGS__)
+#define VALS(...) EACH(VAL_ITEM, _, __VA_ARGS__)
+
+#if defined(__GNUC__)
+#define ENUM_PACK __attribute__((packed))
+#else
+#define ENUM_PACK
+#endif
 
 /*
- * Declare a full enum and tagged-union set from a name and type/pair sequence.
+ * Declare a full enum and tagged-union set from a name, the layout of its
+ * struct, and a type/pair sequence. The final prototype repeats the one for the
+ * `_tag` helper, so that the declaration can end with a semicolon.
  */
-#define ENUM(_name, ...) \
+#define ENUM_LAYOUT(_name, _tagty, _attr, ...) \
 typedef enum ENUM_TAG(_name) { \
 	TAGS(_name, __VA_ARGS__) \
 } ENUM_TAG(_name); \
-typedef struct _name { \
+typedef struct _attr _name { \
 	union { VALS(__VA_ARGS__) } body; \
-	ENUM_TAG(_name) tag; \
-} _name
+	_tagty tag; \
+} _name; \
+static inline ENUM_TAG(_name) JOIN(_name, tag)(const _name self) { \
+	return (ENUM_TAG(_name))self.tag; \
+} \
+EACH(HELPER_ITEM, _name, __VA_ARGS__) \
+static inline ENUM_TAG(_name) JOIN(_name, tag)(const _name self)
+
+#define ENUM(_name, ...) ENUM_LAYOUT(_name, ENUM_TAG(_name), , __VA_ARGS__)
+#define ENUM_WIDTH(_name, _tagty, ...) ENUM_LAYOUT(_name, _tagty, ENUM_PACK, __VA_ARGS__)
+#define ENUM_PACKED(_name, ...) ENUM_WIDTH(_name, uint8_t, __VA_ARGS__)
 
 #define ENUM_TAG(_enum) _enum ## Tag
 #define ENUM_VAR(_enum, _tag) JOIN(_enum, _tag)
@@ -0,0 +1,119 @@
+/**
+ * This module sends `Str`s over byte streams as frames: the `StrLen` length in
+ * network byte order, followed by that many bytes of data.
+ *
+ * A FrameDecoder accepts a stream in pieces of any size, as they come from
+ * `read()` or `recv()`, and produces each complete frame. A piece may end
+ * anywhere, including in the middle of a length prefix. Frames that lie within
+ * one piece are returned in place, without copying; only a frame that spans
+ * pieces is gathered in the decoder's own buffer. Frames can also be moved
+ * directly into a `RingBuf` as `Str` messages.
+ *
+ * Frames longer than the decoder's limit are rejected, as a corrupt or hostile
+ * stream must not be able to make the receiver buffer arbitrary amounts.
+ */
+
+#ifndef WYZYRDRY_FRAME_H
+#define WYZYRDRY_FRAME_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "enum.h"
+#include "ringbuf.h"
+#include "slice.h"
+#include "str.h"
+#include "vec.h"
+
+/**
+ * The longest frame payload that can be decoded, which is the longest that a
+ * `RingBuf` message can hold.
+ */
+#define FRAME_MAX_LEN ((size_t)(StrLen)~(StrLen)0 - sizeof(StrLen))
+
+/**
+ * The outcome of decoding.
+ *
+ * The Frame variant carries the payload of a complete frame.
+ *
+ * The More variant means that the input is used up; it carries the number of
+ * bytes still needed to complete the frame in progress, or to read the next
+ * length prefix.
+ *
+ * The TooLarge variant carries the length of a frame that exceeds the limit.
+ * The stream cannot be resynchronized after this, so the decoder keeps
+ * reporting it until it is reset.
+ *
+ * The Full variant carries the length of a complete frame that the target
+ * `RingBuf` has no room for. The frame is kept, and delivered on the next call.
+ */
+ENUM(FrameResult, Slice, Frame, size_t, More, size_t, TooLarge, size_t, Full);
+
+/**
+ * The state of an incremental frame decoder.
+ */
+typedef struct FrameDecoder {
+	/**
+	 * The longest payload accepted.
+	 */
+	size_t max_len;
+	/**
+	 * The unread remainder of the current piece of input.
+	 */
+	Slice input;
+	/**
+	 * The bytes of a length prefix that spans pieces of input.
+	 */
+	unsigned char prefix[sizeof(StrLen)];
+	/**
+	 * The number of bytes in `prefix`.
+	 */
+	size_t prefix_len;
+	/**
+	 * The payload length of the frame in progress, once its prefix is read.
+	 */
+	size_t frame_len;
+	/**
+	 * Whether a frame's prefix has been read and its payload is being
+	 * gathered into `partial`.
+	 */
+	bool in_frame;
+	/**
+	 * The payload of a frame that spans pieces of input. Its capacity is
+	 * `max_len`, allocated once.
+	 */
+	Vec partial;
+	/**
+	 * Whether `partial` holds a frame that was returned, and must be
+	 * discarded before decoding resumes.
+	 */
+	bool yielded_partial;
+	/**
+	 * A decoded frame waiting for room in a `RingBuf`.
+	 */
+	Slice held;
+	/**
+	 * Whether `held` is set.
+	 */
+	bool holding;
+	/**
+	 * Whether the stream announced a frame longer than `max_len`.
+	 */
+	bool failed;
+} FrameDecoder;
+
+bool frame_encode(Vec* const dst, const Slice payload);
+size_t frame_encode_into(const Slice dst, const Slice payload);
+
+FrameDecoder frame_decoder_init(size_t max_len);
+void frame_decoder_free(FrameDecoder* const self);
+void frame_decoder_reset(FrameDecoder* const self);
+
+void frame_decoder_feed(FrameDecoder* const self, const Slice input);
+FrameResult frame_decoder_next(FrameDecoder* const self);
+FrameResult frame_decoder_into_ringbuf(
+	FrameDecoder* const self,
+	RingBuf* const ring
+);
+
+#endif
@@ -0,0 +1,59 @@
+/**
+ * This module computes checksums and hashes over Slices.
+ *
+ * CRC-32C (Castagnoli) detects corruption of data in transit or at rest. It
+ * uses the SSE4.2 `crc32` instruction where available, running three streams
+ * in parallel and folding them together with PCLMUL, and a table-driven
+ * implementation elsewhere.
+ *
+ * XXH64 is a fast 64-bit non-cryptographic hash, for deduplication and hash
+ * tables. It must not be used where an adversary chooses the input and
+ * benefits from collisions.
+ *
+ * Both are incremental. A CRC is continued by passing its previous value back
+ * in, and XXH64 is computed over several Slices with a `Hasher`.
+ */
+
+#ifndef WYZYRDRY_HASH_H
+#define WYZYRDRY_HASH_H
+
+#include <stdint.h>
+
+#include "slice.h"
+
+/**
+ * The state of an incremental XXH64 computation.
+ */
+typedef struct Hasher {
+	/**
+	 * The four lanes of the 32-byte stripe accumulator.
+	 */
+	uint64_t acc[4];
+	/**
+	 * The seed the hash was started with.
+	 */
+	uint64_t seed;
+	/**
+	 * The total number of bytes hashed so far.
+	 */
+	uint64_t total;
+	/**
+	 * Bytes received that do not yet make up a full stripe.
+	 */
+	unsigned char buf[32];
+	/**
+	 * The number of bytes held in `buf`.
+	 */
+	unsigned int buf_len;
+} Hasher;
+
+uint32_t hash_crc32c(uint32_t crc, const Slice data);
+uint32_t hash_crc32c_combine(uint32_t first, uint32_t second, size_t second_len);
+
+uint64_t hash_xxh64(const Slice data, uint64_t seed);
+
+Hasher hasher_init(uint64_t seed);
+void hasher_update(Hasher* const self, const Slice data);
+uint64_t hasher_finish(const Hasher* const self);
+
+#endif
@@ -0,0 +1,40 @@
+/**
+ * This module converts bytes to and from hexadecimal text, and formats byte
+ * buffers as `xxd`-style dumps for debugging.
+ *
+ * Encoding produces uppercase digits; decoding accepts either case.
+ */
+
+#ifndef WYZYRDRY_HEX_H
+#define WYZYRDRY_HEX_H
+
+#include <stdio.h>
+
+#include "enum.h"
+#include "slice.h"
+#include "vec.h"
+
+/**
+ * The outcome of decoding hexadecimal text.
+ *
+ * The Ok variant carries the number of bytes written to the destination.
+ *
+ * The Err variant carries the index of the first input character that could not
+ * be decoded. An odd-length input reports the index of its final character.
+ */
+ENUM(HexResult, size_t, Ok, size_t, Err);
+
+/**
+ * The number of bytes shown on each line of a dump.
+ */
+#define HEX_DUMP_WIDTH 16
+
+void hex_encode(Vec* const dst, const Slice src);
+size_t hex_encode_into(const Slice dst, const Slice src);
+HexResult hex_decode(Vec* const dst, const Slice src);
+HexResult hex_decode_into(const Slice dst, const Slice src);
+
+void hex_dump(FILE* const out, const Slice src, size_t offset);
+void hex_dump_vec(Vec* const dst, const Slice src, size_t offset);
+
+#endif
@@ -0,0 +1,62 @@
+/**
+ * This module counts values, such as latencies, in a log-linear histogram so
+ * that percentiles can be read back cheaply and histograms from different
+ * sources can be merged.
+ *
+ * Values below `2^HIST_SUB_BITS` are counted exactly. Above that, each power of
+ * two is split into `2^(HIST_SUB_BITS - 1)` equal buckets, so every value is
+ * counted with a relative error under `2^-(HIST_SUB_BITS - 1)`, about 1.6%,
+ * across the whole range of `uint64_t`. Recording is a count leading zeros, a
+ * shift, and an increment.
+ */
+
+#ifndef WYZYRDRY_HIST_H
+#define WYZYRDRY_HIST_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * The number of bits of each value that select its bucket.
+ */
+#define HIST_SUB_BITS 7
+/**
+ * The number of buckets in a `Hist`.
+ */
+#define HIST_BUCKETS ((66 - HIST_SUB_BITS) << (HIST_SUB_BITS - 1))
+
+/**
+ * A histogram of `uint64_t` values.
+ *
+ * It is about 30 KiB, so it is initialized in place rather than returned.
+ */
+typedef struct Hist {
+	/**
+	 * The number of values recorded.
+	 */
+	uint64_t total;
+	/**
+	 * The sum of the values recorded, for the mean.
+	 */
+	uint64_t sum;
+	/**
+	 * The smallest value recorded, or `UINT64_MAX` if none has been.
+	 */
+	uint64_t min;
+	/**
+	 * The largest value recorded, or zero if none has been.
+	 */
+	uint64_t max;
+	uint64_t counts[HIST_BUCKETS];
+} Hist;
+
+void hist_init(Hist* const self);
+void hist_record(Hist* const self, uint64_t value);
+void hist_merge(Hist* const self, const Hist* const other);
+
+uint64_t hist_percentile(const Hist* const self, double pct);
+double hist_mean(const Hist* const self);
+
+void hist_debug_print(const Hist* const self);
+
+#endif
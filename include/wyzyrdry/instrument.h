@@ -0,0 +1,164 @@
+/**
+ * This module counts the library's allocations and bulk copies, so that their
+ * share of a program's work can be measured.
+ *
+ * It is compiled only when `WYZYRDRY_INSTRUMENT` is defined, as by configuring
+ * with `-DWYZYRDRY_INSTRUMENT=ON`. Otherwise the `INSTRUMENT_*` macros below
+ * expand to plain calls of `malloc()`, `memcpy()`, and so on, and none of the
+ * functions or types exist.
+ *
+ * Each use of a macro is a call site, and is counted separately, under the
+ * name of the module it is in. Counters are kept per thread, so counting takes
+ * no locks and a snapshot shows only the calling thread's work. A trace
+ * callback can also be installed to see each event as it happens.
+ */
+
+#ifndef WYZYRDRY_INSTRUMENT_H
+#define WYZYRDRY_INSTRUMENT_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef WYZYRDRY_INSTRUMENT
+
+/**
+ * The most call sites that are counted separately. Sites beyond this share one
+ * set of counters, reported with a NULL site.
+ */
+#define INSTRUMENT_SITES_MAX 128
+
+/**
+ * A place in the library that allocates or copies.
+ */
+typedef struct InstrumentSite {
+	/**
+	 * The name of the module, such as "vec".
+	 */
+	const char* module;
+	const char* file;
+	int line;
+	/**
+	 * The site's index in the counter tables, assigned on first use, or -1.
+	 */
+	int id;
+} InstrumentSite;
+
+/**
+ * Counts of the work done by one thread, at one site or in total.
+ */
+typedef struct InstrumentCounts {
+	uint64_t allocs;
+	uint64_t reallocs;
+	uint64_t frees;
+	/**
+	 * The bytes requested from `malloc()` and `realloc()`.
+	 */
+	uint64_t bytes_allocated;
+	uint64_t copies;
+	uint64_t bytes_copied;
+} InstrumentCounts;
+
+/**
+ * A copy of one thread's counters.
+ */
+typedef struct InstrumentSnapshot {
+	/**
+	 * The sum over every site.
+	 */
+	InstrumentCounts total;
+	/**
+	 * The number of entries in `sites`.
+	 */
+	size_t sites_len;
+	/**
+	 * The sites at which this thread did any work, in the order that they
+	 * were first used by any thread.
+	 */
+	struct {
+		const InstrumentSite* site;
+		InstrumentCounts counts;
+	} sites[INSTRUMENT_SITES_MAX + 1];
+} InstrumentSnapshot;
+
+/**
+ * The kinds of event given to a trace callback.
+ */
+typedef enum InstrumentEvent {
+	INSTRUMENT_ALLOC,
+	INSTRUMENT_REALLOC,
+	INSTRUMENT_FREE,
+	INSTRUMENT_COPY,
+} InstrumentEvent;
+
+/**
+ * A function told of every instrumented event, on the thread where it
+ * happened.
+ * @param event What happened.
+ * @param site Where it happened.
+ * @param ptr The memory allocated, freed, or copied into.
+ * @param len The bytes allocated or copied; zero for a free.
+ * @param ctx The pointer given with the callback.
+ */
+typedef void (*InstrumentTrace)(
+	InstrumentEvent event,
+	const InstrumentSite* site,
+	const void* ptr,
+	size_t len,
+	void* ctx
+);
+
+void instrument_snapshot(InstrumentSnapshot* const out);
+InstrumentCounts instrument_module(
+	const InstrumentSnapshot* const snap,
+	const char* module
+);
+void instrument_reset(void);
+void instrument_set_trace(InstrumentTrace trace, void* ctx);
+
+void* instrument_malloc(InstrumentSite* const site, size_t size);
+void* instrument_realloc(InstrumentSite* const site, void* ptr, size_t size);
+void instrument_free(InstrumentSite* const site, void* ptr);
+void* instrument_copy(
+	InstrumentSite* const site,
+	void* dst,
+	const void* src,
+	size_t len
+);
+void* instrument_move(
+	InstrumentSite* const site,
+	void* dst,
+	const void* src,
+	size_t len
+);
+
+/**
+ * Declare the call site at which this is expanded, once, and give its address.
+ */
+#define INSTRUMENT_SITE(mod) (__extension__ ({ \
+	static InstrumentSite instrument_site_ = { (mod), __FILE__, __LINE__, -1 }; \
+	&instrument_site_; \
+}))
+
+#define INSTRUMENT_MALLOC(mod, size) \
+	instrument_malloc(INSTRUMENT_SITE(mod), (size))
+#define INSTRUMENT_REALLOC(mod, ptr, size) \
+	instrument_realloc(INSTRUMENT_SITE(mod), (ptr), (size))
+#define INSTRUMENT_FREE(mod, ptr) \
+	instrument_free(INSTRUMENT_SITE(mod), (ptr))
+#define INSTRUMENT_COPY(mod, dst, src, len) \
+	instrument_copy(INSTRUMENT_SITE(mod), (dst), (src), (len))
+#define INSTRUMENT_MOVE(mod, dst, src, len) \
+	instrument_move(INSTRUMENT_SITE(mod), (dst), (src), (len))
+
+#else
+
+#define INSTRUMENT_MALLOC(mod, size) malloc(size)
+#define INSTRUMENT_REALLOC(mod, ptr, size) realloc((ptr), (size))
+#define INSTRUMENT_FREE(mod, ptr) free(ptr)
+#define INSTRUMENT_COPY(mod, dst, src, len) memcpy((dst), (src), (len))
+#define INSTRUMENT_MOVE(mod, dst, src, len) memmove((dst), (src), (len))
+
+#endif
+
+#endif
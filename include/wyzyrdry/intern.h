@@ -0,0 +1,60 @@
+/**
+ * This module deduplicates byte strings into canonical `Str`s.
+ *
+ * An Interner hands out one `Str*` per distinct value, so interned strings are
+ * equal exactly when their pointers are, and a vocabulary that repeats across
+ * many messages is stored once. Interned `Str`s live until the Interner is
+ * freed, and must not be modified or freed by the caller.
+ *
+ * The table is split into shards, each guarded by its own reader-writer lock,
+ * and the shard is chosen by the key's hash. Lookups of values already
+ * interned take a shared lock and allocate nothing, so any number of threads
+ * can look up concurrently; only the first interning of a value takes a
+ * shard's exclusive lock.
+ */
+
+#ifndef WYZYRDRY_INTERN_H
+#define WYZYRDRY_INTERN_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+#include "map.h"
+#include "slice.h"
+#include "str.h"
+
+/**
+ * The number of independently locked shards in an Interner. A power of two.
+ */
+#define INTERN_SHARDS 16
+
+/**
+ * One independently locked part of an Interner.
+ */
+typedef struct InternShard {
+	/**
+	 * Guards `map`: shared for lookups, exclusive for insertions.
+	 */
+	pthread_rwlock_t lock;
+	/**
+	 * The interned values of this shard. Keys are borrowed from the
+	 * canonical `Str`s, which are the values.
+	 */
+	Map map;
+} InternShard;
+
+/**
+ * A thread-safe table of canonical `Str`s.
+ */
+typedef struct Interner {
+	InternShard shards[INTERN_SHARDS];
+} Interner;
+
+bool interner_init(Interner* const self);
+void interner_free(Interner* const self);
+
+Str* interner_intern(Interner* const self, const Slice value);
+Str* interner_find(Interner* const self, const Slice value);
+size_t interner_len(Interner* const self);
+
+#endif
@@ -0,0 +1,43 @@
+/**
+ * This module compresses bytes with a fast LZ77 coder, for payloads such as
+ * logs and captures that repeat themselves heavily.
+ *
+ * The output is the LZ4 block format: a sequence of tokens, each giving a run
+ * of literal bytes and then a copy of earlier output, with the final token
+ * holding only literals. A block does not record its decompressed length, so
+ * whatever stores the block must keep that length alongside it.
+ *
+ * Compression is a greedy single pass with a small hash table, and trades ratio
+ * for speed; decompression checks every length and offset against both
+ * buffers, so corrupt or hostile input is reported rather than read or written
+ * out of bounds.
+ */
+
+#ifndef WYZYRDRY_LZ_H
+#define WYZYRDRY_LZ_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "enum.h"
+#include "slice.h"
+#include "vec.h"
+
+/**
+ * The outcome of decompressing a block.
+ *
+ * The Ok variant carries the number of bytes written to the destination.
+ *
+ * The Err variant carries the index in the block at which it was found to be
+ * corrupt, or to describe more output than the destination can hold.
+ */
+ENUM(LzResult, size_t, Ok, size_t, Err);
+
+size_t lz_bound(size_t len);
+
+bool lz_compress(Vec* const dst, const Slice src);
+size_t lz_compress_into(const Slice dst, const Slice src);
+LzResult lz_decompress(Vec* const dst, const Slice src, size_t len);
+LzResult lz_decompress_into(const Slice dst, const Slice src);
+
+#endif
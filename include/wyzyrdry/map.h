@@ -0,0 +1,136 @@
+/**
+ * This module defines a Map structure -- an open-addressing hash table from
+ * byte-string keys to pointer values.
+ *
+ * The table follows the SwissTable layout. Every slot has a control byte that
+ * holds seven bits of the key's hash, or marks the slot as empty or erased.
+ * Lookups compare sixteen control bytes at a time and only touch the slots
+ * whose hash bits match, so most misses never read a key at all.
+ *
+ * Keys are looked up by `Slice`, without allocating. The Map either copies the
+ * bytes of each inserted key into an arena that it owns, or keeps the caller's
+ * `Slice`, in which case the caller must keep the key's memory alive and
+ * unchanged until the entry is erased or the Map is freed. A `Str` is used as a
+ * key through `str_as_slice()`.
+ */
+
+#ifndef WYZYRDRY_MAP_H
+#define WYZYRDRY_MAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "slice.h"
+#include "vec.h"
+
+/**
+ * The number of control bytes examined by each probe of the table.
+ */
+#define MAP_GROUP 16
+
+/**
+ * How a Map holds the keys that are inserted into it.
+ */
+typedef enum MapKeys {
+	/**
+	 * Copy the bytes of every key into memory owned by the Map.
+	 */
+	MAP_COPY_KEYS,
+	/**
+	 * Keep the caller's `Slice`. The memory it describes must outlive the
+	 * entry.
+	 */
+	MAP_BORROW_KEYS,
+} MapKeys;
+
+/**
+ * One key-value pair stored in a Map.
+ */
+typedef struct MapEntry {
+	/**
+	 * The key's bytes, either in the Map's arena or in caller memory.
+	 */
+	Slice key;
+	/**
+	 * The value associated with the key.
+	 */
+	void* value;
+} MapEntry;
+
+/**
+ * A hash table from byte-string keys to pointer values.
+ */
+typedef struct Map {
+	/**
+	 * One control byte per slot, followed by copies of the first
+	 * `MAP_GROUP` control bytes so that a probe can read a full group from
+	 * any slot.
+	 */
+	unsigned char* ctrl;
+	/**
+	 * The slots. Only those whose control byte marks them full are valid.
+	 */
+	MapEntry* slots;
+	/**
+	 * The number of slots. This is zero or a power of two.
+	 */
+	size_t cap;
+	/**
+	 * The number of entries in the Map.
+	 */
+	size_t len;
+	/**
+	 * The number of entries that may be inserted before the table must be
+	 * rebuilt.
+	 */
+	size_t growth_left;
+	/**
+	 * Whether keys are copied or borrowed.
+	 */
+	MapKeys mode;
+	/**
+	 * The blocks of the key arena, as an array of pointers. Unused when keys
+	 * are borrowed.
+	 */
+	Vec blocks;
+	/**
+	 * The next free byte of the newest arena block.
+	 */
+	unsigned char* arena_top;
+	/**
+	 * The number of free bytes remaining in the newest arena block.
+	 */
+	size_t arena_room;
+	/**
+	 * The number of arena bytes held by erased keys, which are reclaimed when
+	 * the table is next rebuilt.
+	 */
+	size_t arena_dead;
+} Map;
+
+Map map_init(size_t capacity, MapKeys mode);
+void map_free(Map* const self);
+void map_clear(Map* const self);
+
+bool map_reserve(Map* const self, size_t additional);
+
+uint64_t map_hash(const Slice key);
+
+void** map_get(const Map* const self, const Slice key);
+void** map_get_hashed(const Map* const self, const Slice key, uint64_t hash);
+void** map_entry(Map* const self, const Slice key, bool* const inserted);
+void** map_entry_hashed(
+	Map* const self,
+	const Slice key,
+	uint64_t hash,
+	bool* const inserted
+);
+bool map_insert(Map* const self, const Slice key, void* value);
+bool map_erase(Map* const self, const Slice key);
+
+bool map_next(const Map* const self, size_t* const cursor, MapEntry* const out);
+
+void map_debug_print(const Map* const self);
+
+#endif
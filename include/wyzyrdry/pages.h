@@ -0,0 +1,73 @@
+/**
+ * This module allocates large stores straight from the kernel, for the backing
+ * memory of `RingBuf`s and `Vec`s of many megabytes.
+ *
+ * A store may ask for huge pages, which spare a large store most of its TLB
+ * misses. Explicit huge pages (`MAP_HUGETLB`) are tried first, as they are sure
+ * to be huge once the system has reserved them; failing that, the store is
+ * aligned to `PAGES_HUGE_SIZE` and transparent huge pages are requested with
+ * `madvise()`; failing that, it keeps ordinary pages.
+ *
+ * A store may also be placed on a NUMA node, such as the one its consumer runs
+ * on. The node is set as the store's preferred policy with `mbind()`; where the
+ * kernel refuses that, a thread pinned to the node's processors touches every
+ * page first, so that the kernel places them there.
+ *
+ * A store may be prefaulted, touching every page as it is allocated, so that
+ * the first messages written to it take no page faults.
+ *
+ * Each of these falls back cleanly: a store that gets none of what it asked for
+ * is still a valid store of ordinary pages. `pages_alloc()` reports what it got.
+ */
+
+#ifndef WYZYRDRY_PAGES_H
+#define WYZYRDRY_PAGES_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "slice.h"
+
+/**
+ * The size of a huge page, as on x86-64 and most 64-bit ARM systems.
+ */
+#define PAGES_HUGE_SIZE ((size_t)2 * 1024 * 1024)
+/**
+ * Passed as the node to place a store wherever the kernel likes.
+ */
+#define PAGES_ANY_NODE (-1)
+
+/**
+ * What a store asks for, and what it got.
+ */
+typedef enum PagesFlag {
+	/**
+	 * Back the store with huge pages, if the system has them.
+	 */
+	PAGES_HUGE = 1 << 0,
+	/**
+	 * Touch every page as the store is allocated.
+	 */
+	PAGES_PREFAULT = 1 << 1,
+	/**
+	 * Reported for every store from `pages_alloc()`, which must be released
+	 * with `pages_free()`.
+	 */
+	PAGES_MAPPED = 1 << 2,
+	/**
+	 * Reported, with `PAGES_HUGE`, for a store of explicit huge pages. A store
+	 * for which transparent huge pages were requested reports `PAGES_HUGE`
+	 * alone; whether the kernel supplies them depends on its settings.
+	 */
+	PAGES_HUGETLB = 1 << 3,
+	/**
+	 * Reported for a store placed on the node asked for.
+	 */
+	PAGES_NODE = 1 << 4,
+} PagesFlag;
+
+Slice pages_alloc(size_t len, unsigned int flags, int node, unsigned int* const got);
+void pages_free(const Slice pages);
+size_t pages_round(size_t len, unsigned int flags);
+
+#endif
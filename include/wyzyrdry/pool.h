@@ -0,0 +1,124 @@
+/**
+ * This module runs loops over index ranges on a pool of threads, and provides
+ * parallel versions of bulk `Slice` operations built on it.
+ *
+ * `pool_for()` cuts a range into chunks of at least the grain size and deals
+ * them out evenly, one contiguous run per thread. Each thread takes chunks from
+ * the front of its own run, and a thread that runs out steals the back half of
+ * another's, so uneven chunks still keep every thread busy. The calling thread
+ * works alongside the pool and returns once every chunk is done.
+ *
+ * A range no longer than the grain runs on the calling thread alone, so small
+ * inputs pay nothing for the pool. The grain of the `Slice` operations is in
+ * bytes, and should be large enough that a chunk outweighs the cost of handing
+ * it to another core; the default is 256 KiB.
+ */
+
+#ifndef WYZYRDRY_POOL_H
+#define WYZYRDRY_POOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "slice.h"
+
+/**
+ * The grain used when none is given to `pool_init()`.
+ */
+#define POOL_GRAIN_DEFAULT (256 * 1024)
+
+/**
+ * A unit of work: process the indices `[start, end)`.
+ */
+typedef void (*PoolFn)(size_t start, size_t end, void* ctx);
+
+/**
+ * The chunks left to one thread, as the indices `[lo, hi)` of the current
+ * job's chunks packed into one word, `hi` in the upper half. The owner takes
+ * from `lo` and thieves take from `hi`, each with a compare-and-swap.
+ */
+typedef struct PoolDeque {
+	uint64_t range;
+	/**
+	 * Keeps each thread's deque on its own cache line.
+	 */
+	unsigned char pad[56];
+} PoolDeque;
+
+/**
+ * A pool of worker threads.
+ */
+typedef struct Pool {
+	/**
+	 * The number of threads that work on each job, including the caller.
+	 */
+	size_t threads;
+	/**
+	 * The smallest chunk handed to a thread by the `Slice` operations, and by
+	 * `pool_for()` when it is given a grain of zero. May be changed between
+	 * jobs.
+	 */
+	size_t grain;
+	pthread_t* handles;
+	/**
+	 * One deque per thread; the caller uses the first.
+	 */
+	PoolDeque* deques;
+	/**
+	 * Held by a call of `pool_for()` for its whole run, so that jobs from
+	 * different threads take turns.
+	 */
+	pthread_mutex_t run_lock;
+	/**
+	 * Guards the job, `generation`, `active`, and `stop`.
+	 */
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	pthread_cond_t done;
+	/**
+	 * Counts jobs, so that workers can tell a new one from a spurious wakeup.
+	 */
+	uint64_t generation;
+	/**
+	 * The number of workers still in the current job.
+	 */
+	size_t active;
+	/**
+	 * The number of workers that have started, which gives each its deque.
+	 */
+	size_t started;
+	bool stop;
+	/* The current job. */
+	PoolFn fn;
+	void* ctx;
+	size_t start;
+	size_t end;
+	size_t chunk;
+	/**
+	 * The number of chunks of the current job not yet finished.
+	 */
+	size_t remaining;
+} Pool;
+
+bool pool_init(Pool* const self, size_t threads, size_t grain);
+void pool_free(Pool* const self);
+
+void pool_for(
+	Pool* const self,
+	size_t start,
+	size_t end,
+	size_t grain,
+	PoolFn fn,
+	void* ctx
+);
+
+size_t pool_copy(Pool* const self, const Slice dst, const Slice src);
+void pool_fill(Pool* const self, const Slice dst, unsigned char byte);
+size_t pool_find_byte(Pool* const self, const Slice src, unsigned char byte);
+size_t pool_count_byte(Pool* const self, const Slice src, unsigned char byte);
+uint32_t pool_crc32c(Pool* const self, uint32_t crc, const Slice data);
+size_t pool_hex_encode_into(Pool* const self, const Slice dst, const Slice src);
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * This module moves messages between `RingBuf`s and sockets, pipes, or other
+ * non-blocking file descriptors, using edge-triggered `epoll`.
+ *
+ * Each descriptor is linked to a RingBuf to fill from it, a RingBuf to drain
+ * into it, or both. Incoming bytes are decoded as frames (see `frame.h`)
+ * straight into the receiving RingBuf. Outgoing messages are framed and sent
+ * with `writev()`, many to a call, directly from the RingBuf's store, so
+ * neither direction copies a message more than once.
+ *
+ * When a receiving RingBuf is full, the Reactor stops reading that descriptor
+ * and leaves the data in the kernel, so a slow consumer pushes back on the
+ * sender instead of growing a buffer. Reading resumes at the next
+ * `reactor_pump()` once the RingBuf has room. In the same way, a descriptor
+ * that cannot take more data keeps its messages queued until `epoll` reports
+ * it writable again.
+ *
+ * A Reactor and its RingBufs belong to one thread. To use several cores, run
+ * one Reactor per thread, each with its own descriptors and RingBufs.
+ */
+
+#ifndef WYZYRDRY_REACTOR_H
+#define WYZYRDRY_REACTOR_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "frame.h"
+#include "ringbuf.h"
+#include "vec.h"
+
+/**
+ * The number of bytes read from a descriptor at a time.
+ */
+#define REACTOR_READ_SIZE (64 * 1024)
+/**
+ * The most messages sent by one `writev()`.
+ */
+#define REACTOR_BATCH 64
+
+/**
+ * Which way a link carries messages.
+ */
+typedef enum ReactorDir {
+	/**
+	 * Read frames from the descriptor into the RingBuf.
+	 */
+	REACTOR_READ,
+	/**
+	 * Write messages from the RingBuf to the descriptor.
+	 */
+	REACTOR_WRITE,
+} ReactorDir;
+
+/**
+ * One descriptor and the RingBufs that it fills and drains.
+ */
+typedef struct ReactorLink {
+	int fd;
+	/**
+	 * Receives frames read from `fd`, or NULL.
+	 */
+	RingBuf* in;
+	/**
+	 * Holds messages to be written to `fd`, or NULL.
+	 */
+	RingBuf* out;
+	/**
+	 * Whether `fd` may have data to read: set by `epoll`, and cleared when a
+	 * read would block.
+	 */
+	bool readable;
+	/**
+	 * Whether `fd` may take more data: set by `epoll`, and cleared when a write
+	 * would block.
+	 */
+	bool writable;
+	/**
+	 * Whether reading has stopped, because `fd` reached the end of its input or
+	 * failed, or sent a frame too long for `in`.
+	 */
+	bool in_closed;
+	/**
+	 * Whether writing has stopped, because `fd` failed.
+	 */
+	bool out_closed;
+	/**
+	 * Whether `fd` is a socket, and can be written without raising `SIGPIPE`.
+	 */
+	bool socket;
+	/**
+	 * Decodes the frames read from `fd`, when `in` is set.
+	 */
+	FrameDecoder decoder;
+	/**
+	 * The buffer that reads land in, of `REACTOR_READ_SIZE` bytes.
+	 */
+	unsigned char* input;
+	/**
+	 * The number of bytes of the first queued message's frame already written.
+	 */
+	size_t sent;
+} ReactorLink;
+
+/**
+ * An `epoll` instance and the links registered with it.
+ */
+typedef struct Reactor {
+	int epfd;
+	/**
+	 * The links, as an array of `ReactorLink`, indexed by the `epoll` data of
+	 * their descriptors.
+	 */
+	Vec links;
+} Reactor;
+
+bool reactor_init(Reactor* const self);
+void reactor_free(Reactor* const self);
+
+bool reactor_add(Reactor* const self, int fd, RingBuf* const ring, ReactorDir dir);
+ReactorLink* reactor_link(const Reactor* const self, int fd);
+
+int reactor_poll(Reactor* const self, int timeout_ms);
+size_t reactor_pump(Reactor* const self);
+
+#endif
@@ -1,9 +1,15 @@
 #ifndef WYZYRDRY_RINGBUF_H
 #define WYZYRDRY_RINGBUF_H
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 
+#include "arena.h"
 #include "enum.h"
+#include "hist.h"
+#include "lz.h"
+#include "pages.h"
 #include "slice.h"
 #include "str.h"
 #include "vec.h"
@@ -13,6 +19,30 @@
  * circular FIFO queue.
  *
  * `RingBuf`s store their contents as `Str`s.
+ *
+ * With compression enabled, each `Str` begins with a byte that says whether the
+ * rest is the message as written or an `LZ` block, which `ringbuf_read()`
+ * decompresses. Functions that look at messages in place, such as
+ * `ringbuf_peek_slices()`, see these stored bytes.
+ *
+ * With an `Arena` installed, each `Str` likewise begins with a byte that says
+ * whether the rest is the message itself, kept inline, or an `ArenaRef` to the
+ * block that holds it. The queue owns such a block until the message is read,
+ * when it is copied out and released, or popped, when it is released, or taken
+ * with `ringbuf_read_ref()`, when it passes to the caller.
+ *
+ * With latency recording enabled, each `Str` also begins with the time at which
+ * it was written. This stamp is part of the record's header: the peek functions
+ * skip it, and `ringbuf_read()` and `ringbuf_pop()` use it to record how long
+ * the message waited.
+ *
+ * With growth enabled, a write that does not fit moves the messages, in order,
+ * into a larger store, and a queue that stays lightly loaded moves them into a
+ * smaller one. Either move invalidates Slices and cursors into the store.
+ *
+ * A queue made with `ringbuf_init_pages()` has its store from `pages_alloc()`,
+ * and takes every store it grows or shrinks into from there too, with the same
+ * flags and node.
  */
 typedef struct RingBuf {
 	/**
@@ -32,23 +62,145 @@ typedef struct RingBuf {
 	 * The count of how many items are currently stored in the queue.
 	 */
 	size_t count;
+	/**
+	 * Whether messages are stored with a compression header.
+	 */
+	bool compress;
+	/**
+	 * The shortest message that is compressed, when `compress` is set.
+	 */
+	StrLen compress_min;
+	/**
+	 * Working space for compressing and decompressing messages.
+	 */
+	Vec scratch;
+	/**
+	 * The histogram that receives each message's time in the queue, in
+	 * nanoseconds, or NULL if messages are not stamped.
+	 */
+	Hist* latency;
+	/**
+	 * The Arena that holds messages longer than `inline_max`, or NULL if every
+	 * message is stored in the queue.
+	 */
+	Arena* arena;
+	/**
+	 * The longest message kept in the queue itself, when `arena` is set.
+	 */
+	StrLen inline_max;
+	/**
+	 * The factor by which the store grows when a message does not fit, or zero
+	 * if its size is fixed.
+	 */
+	unsigned grow;
+	/**
+	 * The smallest size to which a growing store shrinks.
+	 */
+	size_t store_min;
+	/**
+	 * The largest size to which a growing store grows.
+	 */
+	size_t store_max;
+	/**
+	 * The bytes removed from a growing queue since it was last more than lightly
+	 * loaded, which pay for shrinking its store.
+	 */
+	size_t idle;
+	/**
+	 * For a store from `pages_alloc()`, the `PagesFlag`s asked for and those
+	 * reported, which always include `PAGES_MAPPED`; or zero for a store from
+	 * `malloc()`.
+	 */
+	unsigned int pages;
+	/**
+	 * The NUMA node asked for a store from `pages_alloc()`.
+	 */
+	int node;
 } RingBuf;
 
+/**
+ * A place in a walk over the messages of a `RingBuf` with `ringbuf_next()`.
+ * Zero-initialize it to start at the first message.
+ */
+typedef struct RingBufCursor {
+	/**
+	 * The number of messages already visited.
+	 */
+	size_t seen;
+	/**
+	 * The index in the store of the next message's length prefix.
+	 */
+	size_t pos;
+} RingBufCursor;
+
 RingBuf ringbuf_init(const Slice store);
+RingBuf ringbuf_init_pages(size_t len, unsigned int flags, int node);
 void ringbuf_free(RingBuf* const self);
 void ringbuf_wipe(RingBuf* const self);
+bool ringbuf_set_compression(RingBuf* const self, bool enable, StrLen min_len);
+bool ringbuf_set_latency(RingBuf* const self, Hist* const hist);
+bool ringbuf_set_arena(RingBuf* const self, Arena* const arena, StrLen inline_max);
+bool ringbuf_set_growth(RingBuf* const self, unsigned factor, size_t max);
 
-size_t ringbuf_space_free(const RingBuf* const self);
-size_t ringbuf_space_used(const RingBuf* const self);
+bool ringbuf_fits(const RingBuf* const self, StrLen len);
+size_t ringbuf_stored_size(const RingBuf* const self, StrLen len);
 StrLen ringbuf_peek_len(const RingBuf* const self);
+StrLen ringbuf_peek_read_len(const RingBuf* const self);
+StrLen ringbuf_peek_slices(const RingBuf* const self, Slice parts[2]);
+bool ringbuf_next(
+	const RingBuf* const self,
+	RingBufCursor* const cursor,
+	Slice parts[2]
+);
+uint32_t ringbuf_peek_checksum(const RingBuf* const self);
+uint64_t ringbuf_peek_hash(const RingBuf* const self, uint64_t seed);
 
 StrLen ringbuf_read(RingBuf* const self, const Slice out);
+bool ringbuf_read_ref(RingBuf* const self, ArenaRef* const out);
 StrLen ringbuf_write_slice(RingBuf* const self, const Slice in);
 StrLen ringbuf_write_str(RingBuf* const self, const Str* const in);
 StrLen ringbuf_write_vec(RingBuf* const self, const Vec* const in);
+StrLen ringbuf_write_gather(RingBuf* const self, const Slice* const parts, size_t n);
+StrLen ringbuf_write_ref(RingBuf* const self, const ArenaRef ref);
 
 void ringbuf_pop(RingBuf* const self);
 
 void ringbuf_debug_print(const RingBuf* const self);
 
+/**
+ * Calculates how many bytes of the store are in active use.
+ * @param self The `RingBuf` to inspect.
+ * @return A count of unavailable bytes.
+ */
+static inline size_t ringbuf_space_used(const RingBuf* const self) {
+	if (self->count == 0) {
+		return 0;
+	}
+	if (self->head < self->tail) {
+		return self->tail - self->head;
+	}
+	else {
+		return self->store.len - self->head + self->tail;
+	}
+}
+
+/**
+ * Calculates how many bytes of the store are not in active use.
+ * @param self The `RingBuf` to inspect.
+ * @return A count of available bytes.
+ */
+static inline size_t ringbuf_space_free(const RingBuf* const self) {
+	return self->store.len - ringbuf_space_used(self);
+}
+
+/**
+ * Calculates the most bytes the store can hold: its size, or for a growing
+ * queue, the size to which it may grow.
+ * @param self The `RingBuf` to inspect.
+ * @return A count of bytes.
+ */
+static inline size_t ringbuf_space_max(const RingBuf* const self) {
+	return self->grow != 0 ? self->store_max : self->store.len;
+}
+
 #endif
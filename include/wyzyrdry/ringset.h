@@ -0,0 +1,108 @@
+/**
+ * This module schedules a consumer across many `RingBuf`s, choosing which ring
+ * to take each message from by strict priority or by weighted fair sharing.
+ *
+ * A RingSet keeps one bit per ring that says it may hold messages, in a
+ * two-level bitmap: a summary word has a bit for each word of ring bits that is
+ * not zero. Finding the next ready ring is two count-trailing-zeros, so the cost
+ * of a dequeue does not grow with the number of rings, and empty rings are
+ * never visited. A bit is set when a message is written through the RingSet or
+ * the ring is marked, and cleared when the ring is next chosen and found empty.
+ *
+ * In priority mode, messages come from the ready ring that was added first.
+ * In fair mode, rings take turns by deficit round robin: each turn adds the
+ * ring's quantum to its allowance of bytes, and the ring is served until its
+ * next message exceeds the allowance. Over time each busy ring receives a share
+ * of the bytes proportional to its quantum, whatever the sizes of its messages.
+ *
+ * A RingSet and its rings belong to one thread, as the rings do.
+ */
+
+#ifndef WYZYRDRY_RINGSET_H
+#define WYZYRDRY_RINGSET_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "ringbuf.h"
+#include "slice.h"
+#include "str.h"
+#include "vec.h"
+
+/**
+ * The most rings a RingSet can hold: one bit of ring bits per summary bit.
+ */
+#define RINGSET_MAX (64 * 64)
+/**
+ * Returned by `ringset_next()` when no ring has a message, and by
+ * `ringset_add()` on failure.
+ */
+#define RINGSET_NONE ((size_t)-1)
+
+/**
+ * How a RingSet chooses between ready rings.
+ */
+typedef enum RingSetMode {
+	/**
+	 * Always serve the ready ring with the lowest id.
+	 */
+	RINGSET_PRIORITY,
+	/**
+	 * Serve ready rings in turn, by deficit round robin on bytes.
+	 */
+	RINGSET_FAIR,
+} RingSetMode;
+
+/**
+ * One ring of a RingSet, and its share of the bytes.
+ */
+typedef struct RingSetMember {
+	RingBuf* ring;
+	/**
+	 * The bytes added to `deficit` at the start of each turn.
+	 */
+	size_t quantum;
+	/**
+	 * The bytes the ring may still send in its current turn, carried over to
+	 * its next turn while it stays busy.
+	 */
+	size_t deficit;
+} RingSetMember;
+
+/**
+ * A set of rings, and the state of the consumer's walk over them.
+ */
+typedef struct RingSet {
+	RingSetMode mode;
+	/**
+	 * The members, as an array of `RingSetMember`, indexed by id.
+	 */
+	Vec members;
+	/**
+	 * Bit `i` is set if `ready[i]` is not zero.
+	 */
+	uint64_t summary;
+	/**
+	 * Bit `i % 64` of word `i / 64` is set if ring `i` may have a message.
+	 */
+	uint64_t ready[RINGSET_MAX / 64];
+	/**
+	 * The ring whose turn it is in fair mode, or `RINGSET_NONE` between turns.
+	 */
+	size_t current;
+	/**
+	 * The ring whose turn was last, from which the next turn is sought.
+	 */
+	size_t last;
+} RingSet;
+
+RingSet ringset_init(RingSetMode mode);
+void ringset_free(RingSet* const self);
+
+size_t ringset_add(RingSet* const self, RingBuf* const ring, size_t quantum);
+void ringset_mark(RingSet* const self, size_t id);
+StrLen ringset_write_slice(RingSet* const self, size_t id, const Slice in);
+
+size_t ringset_next(RingSet* const self);
+
+#endif
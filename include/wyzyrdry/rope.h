@@ -0,0 +1,91 @@
+/**
+ * This module defines a Rope structure -- a growable buffer of bytes held in a
+ * chain of separately allocated chunks.
+ *
+ * Unlike a `Vec`, a Rope never moves bytes once they are written. Growing it
+ * allocates a new chunk rather than reallocating and copying everything, so
+ * appending is O(1) amortized with no copies of old data, memory use never
+ * spikes during growth, and a `Slice` into a Rope stays valid until the Rope is
+ * freed.
+ *
+ * Chunks start small and double in size up to `ROPE_CHUNK_MAX`, so small Ropes
+ * stay small and large ones are held in a modest number of chunks.
+ */
+
+#ifndef WYZYRDRY_ROPE_H
+#define WYZYRDRY_ROPE_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <sys/uio.h>
+
+#include "slice.h"
+#include "vec.h"
+
+/**
+ * The size to which chunks grow, after which each new chunk is this size.
+ */
+#define ROPE_CHUNK_MAX ((size_t)64 << 20)
+
+/**
+ * One contiguous chunk of a Rope.
+ */
+typedef struct RopeChunk {
+	/**
+	 * The chunk's memory.
+	 */
+	unsigned char* ptr;
+	/**
+	 * The number of bytes written to the chunk.
+	 */
+	size_t len;
+	/**
+	 * The number of bytes the chunk can hold.
+	 */
+	size_t cap;
+	/**
+	 * The offset within the Rope of the chunk's first byte.
+	 */
+	size_t start;
+} RopeChunk;
+
+/**
+ * A growable buffer of bytes that never moves its contents.
+ */
+typedef struct Rope {
+	/**
+	 * The chunks, as an array of `RopeChunk`, in order.
+	 */
+	Vec chunks;
+	/**
+	 * The total number of bytes in the Rope.
+	 */
+	size_t len;
+	/**
+	 * The capacity of the next chunk to be allocated.
+	 */
+	size_t next_cap;
+} Rope;
+
+Rope rope_init(size_t first_chunk);
+void rope_free(Rope* const self);
+
+bool rope_push_byte(Rope* const self, unsigned char byte);
+bool rope_push_slice(Rope* const self, const Slice slice);
+
+size_t rope_chunk_count(const Rope* const self);
+bool rope_next(const Rope* const self, size_t* const cursor, Slice* const out);
+Slice rope_slice_at(const Rope* const self, size_t offset);
+size_t rope_read(const Rope* const self, size_t offset, const Slice out);
+size_t rope_iovec(
+	const Rope* const self,
+	size_t offset,
+	struct iovec* const out,
+	size_t max
+);
+
+Vec rope_flatten(Rope* const self);
+
+void rope_debug_print(const Rope* const self);
+
+#endif
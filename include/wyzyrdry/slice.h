@@ -4,11 +4,22 @@
  * Slices are useful in that they carry the length of their targeted buffer
  * alongside the pointer and do not rely on sentinel values for determining the
  * end of the buffer.
+ *
+ * The search functions return the index of the first match, or the length of
+ * the searched Slice if there is no match.
+ *
+ * Iteration that should be inlined and vectorized at the call site is provided
+ * here as macros and `static inline` functions. When the callback handed to one
+ * of the inline functions is visible to the compiler, it is inlined too. The
+ * constructor and accessors are `static inline` as well, so that building and
+ * taking apart a Slice costs no call.
  */
 
 #ifndef WYZYRDRY_SLICE_H
 #define WYZYRDRY_SLICE_H
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 typedef struct Slice {
@@ -16,12 +27,181 @@ typedef struct Slice {
 	size_t len;
 } Slice;
 
-const Slice slice_new(unsigned char* ptr, size_t len);
-unsigned char* slice_ptr(const Slice self);
-size_t slice_len(const Slice self);
+/**
+ * Make a new Slice out of a pointer and length.
+ *
+ * This presumes that the pointer is not null, and that the memory described by
+ * the pointer and length is all valid.
+ * @param ptr A pointer to valid memory.
+ * @param len The length of memory captured by the slice.
+ * @return A new Slice describing the memory.
+ */
+static inline Slice slice_new(unsigned char* const ptr, size_t len) {
+	Slice ret = {
+		.ptr = ptr,
+		.len = len,
+	};
+	return ret;
+}
+
+/**
+ * Accessor to the Slice's pointer.
+ * @param self The Slice on which to act.
+ * @return The Slice's pointer field.
+ */
+static inline unsigned char* slice_ptr(const Slice self) {
+	return self.ptr;
+}
+
+/**
+ * Accessor to the slice's length.
+ * @param self The Slice on which to act.
+ * @return The Slice's length field.
+ */
+static inline size_t slice_len(const Slice self) {
+	return self.len;
+}
 
 void slice_for_each(const Slice self, void (*callback)(unsigned char c));
 
+size_t slice_map_into(
+	const Slice dst,
+	const Slice src,
+	const unsigned char table[256]
+);
+size_t slice_to_ascii_lower(const Slice dst, const Slice src);
+size_t slice_to_ascii_upper(const Slice dst, const Slice src);
+
+size_t slice_find_byte(const Slice self, unsigned char byte);
+size_t slice_find_any(const Slice self, const Slice set);
+size_t slice_find_subslice(const Slice self, const Slice needle);
+size_t slice_count_byte(const Slice self, unsigned char byte);
+bool slice_eq(const Slice self, const Slice other);
+int slice_cmp(const Slice self, const Slice other);
+bool slice_validate_utf8(const Slice self);
+
 void slice_debug_print(const Slice self);
 
+/**
+ * The size of the blocks handed to chunked iteration.
+ */
+#define SLICE_CHUNK 64
+
+/**
+ * Loop over a Slice, with `_ptr` declared as an `unsigned char*` to each byte in
+ * turn. `break` and `continue` behave as in any loop.
+ *
+ * `_slice` is evaluated on every iteration, so it should be a plain variable.
+ */
+#define SLICE_FOR_EACH(_ptr, _slice) \
+for (unsigned char* _ptr = (_slice).ptr; \
+	_ptr < (_slice).ptr + (_slice).len; \
+	++_ptr)
+
+/**
+ * Loop over a Slice in blocks of `SLICE_CHUNK` bytes, with `_chunk` declared as
+ * a Slice over each block in turn. Only the final block may be shorter.
+ *
+ * `_slice` is evaluated on every iteration, so it should be a plain variable.
+ */
+#define SLICE_FOR_EACH_CHUNK(_chunk, _slice) \
+for (Slice _chunk = slice_chunk_at((_slice), 0); \
+	_chunk.len != 0; \
+	_chunk = slice_chunk_at((_slice), \
+		(size_t)(_chunk.ptr - (_slice).ptr) + _chunk.len))
+
+/**
+ * Get the block of a Slice that starts at some index.
+ * @param self The Slice being divided into blocks.
+ * @param start The index of the start of the block. This must not exceed
+ * `self.len`.
+ * @return A Slice over at most `SLICE_CHUNK` bytes, which is empty once `start`
+ * reaches the end of `self`.
+ */
+static inline Slice slice_chunk_at(const Slice self, size_t start) {
+	size_t rest = self.len - start;
+	Slice ret = {
+		.ptr = self.ptr + start,
+		.len = rest < SLICE_CHUNK ? rest : SLICE_CHUNK,
+	};
+	return ret;
+}
+
+/**
+ * Invoke a function on each byte in the Slice, with a context pointer for the
+ * function to keep its state in.
+ * @param self The Slice over which to loop.
+ * @param callback The function to be invoked with each byte.
+ * @param ctx Passed to every invocation of `callback`.
+ */
+static inline void slice_for_each_with(
+	const Slice self,
+	void (*callback)(unsigned char c, void* ctx),
+	void* ctx
+) {
+	for (size_t idx = 0; idx < self.len; ++idx) {
+		callback(self.ptr[idx], ctx);
+	}
+}
+
+/**
+ * Invoke a function on each `SLICE_CHUNK`-byte block of the Slice, with a
+ * context pointer. Only the final block may be shorter.
+ * @param self The Slice over which to loop.
+ * @param callback The function to be invoked with each block.
+ * @param ctx Passed to every invocation of `callback`.
+ */
+static inline void slice_for_each_chunk(
+	const Slice self,
+	void (*callback)(const Slice chunk, void* ctx),
+	void* ctx
+) {
+	SLICE_FOR_EACH_CHUNK(chunk, self) {
+		callback(chunk, ctx);
+	}
+}
+
+/**
+ * Combine each byte of the Slice into an accumulator.
+ * @param self The Slice to fold.
+ * @param init The starting value of the accumulator.
+ * @param step Produces the next accumulator from the current one and a byte.
+ * @param ctx Passed to every invocation of `step`.
+ * @return The final accumulator.
+ */
+static inline uint64_t slice_fold(
+	const Slice self,
+	uint64_t init,
+	uint64_t (*step)(uint64_t acc, unsigned char c, void* ctx),
+	void* ctx
+) {
+	uint64_t acc = init;
+	for (size_t idx = 0; idx < self.len; ++idx) {
+		acc = step(acc, self.ptr[idx], ctx);
+	}
+	return acc;
+}
+
+/**
+ * Combine each `SLICE_CHUNK`-byte block of the Slice into an accumulator. Only
+ * the final block may be shorter.
+ * @param self The Slice to fold.
+ * @param init The starting value of the accumulator.
+ * @param step Produces the next accumulator from the current one and a block.
+ * @param ctx Passed to every invocation of `step`.
+ * @return The final accumulator.
+ */
+static inline uint64_t slice_fold_chunks(
+	const Slice self,
+	uint64_t init,
+	uint64_t (*step)(uint64_t acc, const Slice chunk, void* ctx),
+	void* ctx
+) {
+	uint64_t acc = init;
+	SLICE_FOR_EACH_CHUNK(chunk, self) {
+		acc = step(acc, chunk, ctx);
+	}
+	return acc;
+}
+
 #endif
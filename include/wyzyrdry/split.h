@@ -0,0 +1,85 @@
+/**
+ * This module splits a stream of bytes into delimited records, where the
+ * stream arrives in pieces and records may straddle them.
+ *
+ * A Splitter is fed one `Slice` at a time and yields each complete record in
+ * turn. A record that lies wholly within the current piece is yielded as a
+ * `Slice` into that piece, without copying. Only a record that spans pieces is
+ * copied, into a `Vec` owned by the Splitter, as its bytes arrive.
+ *
+ * The delimiter scan uses the SIMD search kernels of the `Slice` module.
+ *
+ * A Splitter can also draw its input directly from the messages of a `RingBuf`,
+ * including messages that wrap around the end of its store, popping each
+ * message once every record in it has been yielded.
+ */
+
+#ifndef WYZYRDRY_SPLIT_H
+#define WYZYRDRY_SPLIT_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "ringbuf.h"
+#include "slice.h"
+#include "vec.h"
+
+/**
+ * The largest number of distinct delimiter bytes a Splitter accepts.
+ */
+#define SPLIT_DELIMS_MAX 16
+
+/**
+ * The state of an incremental record splitter.
+ */
+typedef struct Splitter {
+	/**
+	 * The bytes that end a record.
+	 */
+	unsigned char delims[SPLIT_DELIMS_MAX];
+	/**
+	 * The number of bytes in `delims`.
+	 */
+	size_t delims_len;
+	/**
+	 * The unscanned remainder of the current piece of input.
+	 */
+	Slice input;
+	/**
+	 * A second piece of input, scanned after `input`, used when a `RingBuf`
+	 * message wraps.
+	 */
+	Slice queued;
+	/**
+	 * The start of a record whose end has not yet arrived.
+	 */
+	Vec partial;
+	/**
+	 * Whether `partial` holds a record that was yielded, and must be
+	 * discarded before scanning resumes.
+	 */
+	bool yielded_partial;
+	/**
+	 * Whether the input is the head message of a `RingBuf`, which must be
+	 * popped once it has been scanned.
+	 */
+	bool ring_held;
+	/**
+	 * The delimiter that ended the most recent record.
+	 */
+	unsigned char last_delim;
+} Splitter;
+
+Splitter splitter_init(const Slice delims);
+void splitter_free(Splitter* const self);
+
+void splitter_feed(Splitter* const self, const Slice input);
+bool splitter_next(Splitter* const self, Slice* const record);
+bool splitter_next_ringbuf(
+	Splitter* const self,
+	RingBuf* const ring,
+	Slice* const record
+);
+bool splitter_finish(Splitter* const self, Slice* const record);
+
+#endif
@@ -8,12 +8,15 @@
  * The in-memory representation of a Str is the StrLen length of the data, in
  * native endianness, followed by that many bytes of data. The length prefix
  * will need to be set to network endianness before transferring between
- * machines.
+ * machines; `str_len_to_wire()` and `str_len_from_wire()` convert it, and the
+ * `Frame` module reads and writes whole Strs in that form.
  */
 
 #ifndef WYZYRDRY_STR_H
 #define WYZYRDRY_STR_H
 
+#include <stdint.h>
+
 #include "slice.h"
 #include "vec.h"
 
@@ -29,18 +32,81 @@ typedef struct Str {
 	unsigned char data[];
 } Str;
 
+/**
+ * The longest payload a Str can hold, such that the whole Str, length prefix
+ * included, still has a size that `str_size()` can express.
+ */
+#define STR_MAX_LEN ((size_t)(StrLen)~(StrLen)0 - sizeof(StrLen))
+
 Str* str_from_vec(const Vec* const src);
 Str* str_from_vec_in_place(const Slice dst, const Vec* const src);
 Str* str_from_slice(const Slice src);
 Str* str_from_slice_in_place(const Slice dst, const Slice src);
+Str* str_from_slices(const Slice* const parts, size_t n);
 void str_free(Str* const self);
 
-
-const Slice str_as_slice(Str* const self);
+uint32_t str_checksum(const Str* const self);
+bool str_validate_utf8(const Str* const self);
 
 void str_debug_print(const Str* const self);
 
-StrLen str_size(StrLen len);
-StrLen str_capacity(StrLen size);
+/**
+ * Get a Slice over a Str's data payload.
+ * @param self The Str to be described as a Slice.
+ * @return A Slice describing the Str.
+ */
+static inline Slice str_as_slice(Str* const self) {
+	return slice_new(self->data, self->len);
+}
+
+/**
+ * INTERNAL USE: Get the size of a Str that wraps a certain amount of data.
+ * @param len The amount of data to wrap with a Str.
+ * @return The size of the Str that will wrap the given data.
+ */
+static inline StrLen str_size(StrLen len) {
+	return (StrLen)(len + sizeof(StrLen));
+}
+
+/**
+ * INTERNAL USE: Get the data capacity of a Str.
+ * @param size The length of a data buffer.
+ * @return The amount of data that buffer can hold formatted as a Str.
+ */
+static inline StrLen str_capacity(StrLen size) {
+	if (size > sizeof(StrLen)) {
+		return (StrLen)(size - sizeof(StrLen));
+	}
+	else {
+		return 0;
+	}
+}
+
+/**
+ * Write a Str length prefix in network byte order (big-endian), for sending to
+ * another machine.
+ * @param out Receives the `sizeof(StrLen)` bytes of the prefix.
+ * @param len The length to write.
+ */
+static inline void str_len_to_wire(unsigned char out[sizeof(StrLen)], StrLen len) {
+	for (size_t idx = sizeof(StrLen); idx > 0; --idx) {
+		out[idx - 1] = (unsigned char)(len & 0xFF);
+		len = (StrLen)(len >> 8);
+	}
+}
+
+/**
+ * Read a Str length prefix received in network byte order (big-endian).
+ * @param in The `sizeof(StrLen)` bytes of the prefix, which need not be
+ * aligned.
+ * @return The length, in native byte order.
+ */
+static inline StrLen str_len_from_wire(const unsigned char in[sizeof(StrLen)]) {
+	StrLen ret = 0;
+	for (size_t idx = 0; idx < sizeof(StrLen); ++idx) {
+		ret = (StrLen)((ret << 8) | in[idx]);
+	}
+	return ret;
+}
 
 #endif
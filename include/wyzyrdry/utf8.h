@@ -0,0 +1,45 @@
+/**
+ * This module validates UTF-8 text, counts its code points, and transcodes it
+ * to and from UTF-16, so that `Str` payloads from untrusted producers can be
+ * checked before they are forwarded as text.
+ *
+ * Validation follows RFC 3629: overlong forms, surrogates, and code points past
+ * U+10FFFF are rejected, as are truncated and stray continuation bytes. With
+ * SSSE3 or AVX2 it checks 16 or 32 bytes at a time by the lookup-table method
+ * of Keiser and Lemire: three nibble lookups per byte classify every pair of
+ * adjacent bytes, and a saturating subtract finds the bytes that must continue
+ * a three- or four-byte sequence. Runs of ASCII skip even that.
+ *
+ * UTF-16 is held in native byte order, two bytes per code unit, in a `Slice`
+ * or `Vec` of bytes.
+ */
+
+#ifndef WYZYRDRY_UTF8_H
+#define WYZYRDRY_UTF8_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "enum.h"
+#include "slice.h"
+#include "vec.h"
+
+/**
+ * The outcome of transcoding.
+ *
+ * The Ok variant carries the number of bytes appended to the destination.
+ *
+ * The Err variant carries the byte index in the source of the first sequence
+ * that is not valid: the lead byte of bad UTF-8, or an unpaired surrogate or
+ * odd final byte of UTF-16.
+ */
+ENUM(Utf8Result, size_t, Ok, size_t, Err);
+
+size_t utf8_validate(const Slice src);
+bool utf8_is_ascii(const Slice src);
+size_t utf8_count(const Slice src);
+
+Utf8Result utf8_to_utf16(Vec* const dst, const Slice src);
+Utf8Result utf16_to_utf8(Vec* const dst, const Slice src);
+
+#endif
@@ -1,28 +1,54 @@
 /**
  * This module defines a Vec structure -- a growable, heap-allocated buffer of
  * bytes. Bytes must be added with `vec_push()`.
+ *
+ * A Vec made with `vec_init_pages()` takes its buffer from `pages_alloc()`
+ * instead, and grows by moving into a larger store from there, with the same
+ * flags and node.
  */
 
 #ifndef WYZYRDRY_VEC_H
 #define WYZYRDRY_VEC_H
 
+#include <stdbool.h>
 #include <stdlib.h>
 
+#include "pages.h"
 #include "slice.h"
 
 typedef struct Vec {
 	unsigned char* buf;
 	size_t len;
 	size_t cap;
+	/**
+	 * For a buffer from `pages_alloc()`, the `PagesFlag`s asked for and those
+	 * reported, which always include `PAGES_MAPPED`; or zero for a buffer from
+	 * `malloc()`.
+	 */
+	unsigned int pages;
+	/**
+	 * The NUMA node asked for a buffer from `pages_alloc()`.
+	 */
+	int node;
 } Vec;
 
 Vec vec_init(size_t capacity, size_t item_size);
+Vec vec_init_pages(size_t capacity, unsigned int flags, int node);
 void vec_free(Vec* const self);
 void vec_push_byte(Vec* const self, unsigned char byte);
 void vec_push_slice(Vec* const self, const Slice slice);
+bool vec_reserve(Vec* const self, size_t additional);
 void vec_trim(Vec* const self);
-Slice vec_as_slice(const Vec* const self);
 
 void vec_debug_print(const Vec* const self);
 
+/**
+ * Gets a reference to the interior contents of the Vec.
+ * @param self The Vec on which to act.
+ * @return A Slice (pointer and length) of the Vec's contents.
+ */
+static inline Slice vec_as_slice(const Vec* const self) {
+	return slice_new(self->buf, self->len);
+}
+
 #endif
@@ -0,0 +1,114 @@
+#include <string.h>
+
+#include <wyzyrdry.h>
+
+static size_t arena_class(size_t len);
+static bool arena_refill(Arena* const self, size_t cls);
+
+/**
+ * Initialize an Arena with no blocks.
+ * @return An Arena structure. Nothing is allocated until a block is requested.
+ */
+Arena arena_init(void) {
+	Arena ret;
+	memset(&ret, 0, sizeof(ret));
+	return ret;
+}
+
+/**
+ * Deallocate an Arena and all of its chunks.
+ *
+ * Every block becomes invalid, including any that have not been released.
+ * @param self The Arena on which to act.
+ */
+void arena_free(Arena* const self) {
+	unsigned char** chunks = (unsigned char**)self->chunks.buf;
+	for (size_t idx = 0; idx < self->chunks.len / sizeof(unsigned char*); ++idx) {
+		INSTRUMENT_FREE("arena", chunks[idx]);
+	}
+	vec_free(&self->chunks);
+	for (size_t cls = 0; cls < ARENA_CLASSES; ++cls) {
+		vec_free(&self->free[cls]);
+	}
+	*self = arena_init();
+}
+
+/**
+ * Take a block large enough for a payload.
+ * @param self The Arena on which to act.
+ * @param len The length of the payload, which becomes the `len` of the block.
+ * @return The block, now owned by the caller, or one whose `ptr` is NULL if
+ * `len` exceeds `ARENA_CHUNK` or allocation failed.
+ */
+ArenaRef arena_alloc(Arena* const self, size_t len) {
+	ArenaRef ret = { .ptr = NULL, .len = 0, .cls = 0 };
+	if (len > ARENA_CHUNK) {
+		return ret;
+	}
+	size_t cls = arena_class(len);
+	Vec* stack = &self->free[cls];
+	if (stack->len == 0 && !arena_refill(self, cls)) {
+		return ret;
+	}
+	stack->len -= sizeof(ret.ptr);
+	memcpy(&ret.ptr, &stack->buf[stack->len], sizeof(ret.ptr));
+	ret.len = (uint32_t)len;
+	ret.cls = (uint32_t)cls;
+	++self->live;
+	return ret;
+}
+
+/**
+ * Give a block back to the Arena for reuse.
+ * @param self The Arena from which the block came.
+ * @param ref The block. It must not be used again.
+ */
+void arena_release(Arena* const self, const ArenaRef ref) {
+	if (ref.ptr == NULL) {
+		return;
+	}
+	Vec* stack = &self->free[ref.cls];
+	memcpy(&stack->buf[stack->len], &ref.ptr, sizeof(ref.ptr));
+	stack->len += sizeof(ref.ptr);
+	--self->live;
+}
+
+/**
+ * INTERNAL: Find the smallest class whose blocks hold a payload.
+ * @param len The length of the payload, no more than `ARENA_CHUNK`.
+ * @return The index of the class.
+ */
+static size_t arena_class(size_t len) {
+	if (len <= (size_t)1 << ARENA_MIN_SHIFT) {
+		return 0;
+	}
+	return (size_t)(64 - __builtin_clzll((unsigned long long)(len - 1))) - ARENA_MIN_SHIFT;
+}
+
+/**
+ * INTERNAL: Carve a new chunk into blocks of one class.
+ * @param self The Arena on which to act.
+ * @param cls The class, whose free list is empty.
+ * @return true on success, or false if allocation failed.
+ */
+static bool arena_refill(Arena* const self, size_t cls) {
+	size_t size = (size_t)1 << (ARENA_MIN_SHIFT + cls);
+	size_t count = ARENA_CHUNK / size;
+	/* Room for every block of the class, so that releases never allocate. */
+	if (!vec_reserve(&self->free[cls], (self->blocks[cls] + count) * sizeof(unsigned char*))
+		|| !vec_reserve(&self->chunks, sizeof(unsigned char*))) {
+		return false;
+	}
+	unsigned char* chunk = INSTRUMENT_MALLOC("arena", ARENA_CHUNK);
+	if (chunk == NULL) {
+		return false;
+	}
+	vec_push_slice(&self->chunks, slice_new((unsigned char*)&chunk, sizeof(chunk)));
+	/* Pushed last first, so that blocks are handed out in address order. */
+	for (size_t idx = count; idx > 0; --idx) {
+		unsigned char* block = &chunk[(idx - 1) * size];
+		vec_push_slice(&self->free[cls], slice_new((unsigned char*)&block, sizeof(block)));
+	}
+	self->blocks[cls] += count;
+	return true;
+}
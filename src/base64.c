@@ -0,0 +1,619 @@
+#include <stdint.h>
+#include <string.h>
+
+#include <wyzyrdry.h>
+
+#ifdef WYZYRDRY_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * The character that pads standard text to a multiple of four characters.
+ */
+#define BASE64_PAD '='
+
+/**
+ * Marks a character outside the alphabet in the decoding tables.
+ */
+#define BASE64_INVALID 0xFF
+
+static const char base64_chars[2][65] = {
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/",
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_",
+};
+
+/**
+ * Decoding tables, from character to six-bit value, built on first use.
+ */
+static unsigned char base64_values[2][256];
+static int base64_values_ready = 0;
+
+#ifdef WYZYRDRY_X86
+
+/**
+ * What the SIMD kernels need to know about an alphabet.
+ *
+ * Encoding sorts each six-bit value into a range (`A-Z`, `a-z`, `0-9`, or one
+ * of the two symbols) and adds that range's offset from `shift`.
+ *
+ * Decoding classifies each character by its high and low nibbles: the
+ * character is valid only if `lo[low] & hi[high]` is zero. The value is then
+ * the character plus `roll[high]`. The one symbol that shares its high nibble
+ * with another range is moved to a spare `roll` entry by adding `delta`.
+ */
+typedef struct Base64Simd {
+	signed char shift[16];
+	unsigned char lo[16];
+	unsigned char hi[16];
+	signed char roll[16];
+	unsigned char symbol;
+	signed char delta;
+} Base64Simd;
+
+static const Base64Simd base64_simd[2] = {
+	{
+		.shift = {
+			'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+			'/' - 63, 'A', 0, 0,
+		},
+		.lo = {
+			0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+			0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+		},
+		.hi = {
+			0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+			0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+		},
+		.roll = {
+			0, 63 - '/', 62 - '+', 52 - '0', -'A', -'A', 26 - 'a', 26 - 'a',
+			0, 0, 0, 0, 0, 0, 0, 0,
+		},
+		.symbol = '/',
+		.delta = -1,
+	},
+	{
+		.shift = {
+			'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '-' - 62,
+			'_' - 63, 'A', 0, 0,
+		},
+		/* `_` is the only valid character past `Z` in the 0x5_ row, so rows
+		 * 0x5_ and 0x7_ need separate classes. */
+		.lo = {
+			0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+			0x11, 0x11, 0x13, 0x3B, 0x3B, 0x3A, 0x3B, 0x33,
+		},
+		.hi = {
+			0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x20,
+			0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+		},
+		.roll = {
+			63 - '_', 0, 62 - '-', 52 - '0', -'A', -'A', 26 - 'a', 26 - 'a',
+			0, 0, 0, 0, 0, 0, 0, 0,
+		},
+		.symbol = '_',
+		.delta = -5,
+	},
+};
+
+#endif
+
+static size_t base64_encode_raw(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	Base64Alphabet alphabet
+);
+static size_t base64_encode_scalar(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	Base64Alphabet alphabet
+);
+static size_t base64_decode_blocks(
+	unsigned char* dst,
+	size_t room,
+	const unsigned char* src,
+	size_t len,
+	Base64Alphabet alphabet
+);
+static const unsigned char* base64_table(Base64Alphabet alphabet);
+static void base64_init_tables(void);
+#ifdef WYZYRDRY_X86
+static size_t base64_encode_ssse3(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	const Base64Simd* simd
+);
+static size_t base64_encode_avx2(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	const Base64Simd* simd
+);
+static size_t base64_decode_ssse3(
+	unsigned char* dst,
+	size_t room,
+	const unsigned char* src,
+	size_t len,
+	const Base64Simd* simd
+);
+static size_t base64_decode_avx2(
+	unsigned char* dst,
+	size_t room,
+	const unsigned char* src,
+	size_t len,
+	const Base64Simd* simd
+);
+#endif
+
+/**
+ * Compute the length of the base64 text for some number of bytes.
+ * @param len The number of bytes to encode.
+ * @param alphabet The alphabet, which decides whether the text is padded.
+ * @return The number of characters `base64_encode()` produces.
+ */
+size_t base64_encoded_len(size_t len, Base64Alphabet alphabet) {
+	if (alphabet == BASE64_STANDARD) {
+		return (len + 2) / 3 * 4;
+	}
+	return len / 3 * 4 + (len % 3 != 0 ? len % 3 + 1 : 0);
+}
+
+/**
+ * Append the base64 encoding of a Slice to a Vec.
+ *
+ * If the Vec cannot grow to hold the text, it is left unchanged.
+ * @param dst The Vec to receive the text.
+ * @param src The bytes to encode.
+ * @param alphabet The alphabet to encode with.
+ */
+void base64_encode(Vec* const dst, const Slice src, Base64Alphabet alphabet) {
+	if (!vec_reserve(dst, base64_encoded_len(src.len, alphabet))) {
+		return;
+	}
+	dst->len += base64_encode_raw(&dst->buf[dst->len], src.ptr, src.len, alphabet);
+}
+
+/**
+ * Write the base64 encoding of a Slice into a pre-existing buffer.
+ * @param dst The buffer to receive `base64_encoded_len()` characters.
+ * @param src The bytes to encode.
+ * @param alphabet The alphabet to encode with.
+ * @return The number of characters written, or zero if `dst` is too small.
+ */
+size_t base64_encode_into(
+	const Slice dst,
+	const Slice src,
+	Base64Alphabet alphabet
+) {
+	if (dst.len < base64_encoded_len(src.len, alphabet)) {
+		return 0;
+	}
+	return base64_encode_raw(dst.ptr, src.ptr, src.len, alphabet);
+}
+
+/**
+ * Decode base64 text, appending the bytes to a Vec.
+ *
+ * On failure, the Vec's length is unchanged.
+ * @param dst The Vec to receive the bytes.
+ * @param src The text to decode. Padding is optional in either alphabet.
+ * @param alphabet The alphabet to decode with.
+ * @return Ok with the number of bytes appended, or Err with the index of the
+ * first character that could not be decoded.
+ */
+Base64Result base64_decode(
+	Vec* const dst,
+	const Slice src,
+	Base64Alphabet alphabet
+) {
+	if (!vec_reserve(dst, (src.len + 3) / 4 * 3)) {
+		return SET_VARIANT(Base64Result, Err, 0);
+	}
+	Slice spare = slice_new(&dst->buf[dst->len], dst->cap - dst->len);
+	Base64Result ret = base64_decode_into(spare, src, alphabet);
+	if (GET_VARIANT_TYPE(ret) == ENUM_VAR(Base64Result, Ok)) {
+		dst->len += GET_VARIANT_BODY(ret, Ok);
+	}
+	return ret;
+}
+
+/**
+ * Decode base64 text into a pre-existing buffer.
+ *
+ * Padding is accepted only where it completes a final group of four
+ * characters; anywhere else, `=` is a bad character.
+ * @param dst The buffer to receive the bytes.
+ * @param src The text to decode. Padding is optional in either alphabet.
+ * @param alphabet The alphabet to decode with.
+ * @return Ok with the number of bytes written, or Err with the index of the
+ * first character that could not be decoded. If `dst` is too small, this is the
+ * first character of the group whose bytes did not fit.
+ */
+Base64Result base64_decode_into(
+	const Slice dst,
+	const Slice src,
+	Base64Alphabet alphabet
+) {
+	size_t len = src.len;
+	if (len % 4 == 0 && len > 0 && src.ptr[len - 1] == BASE64_PAD) {
+		--len;
+		if (src.ptr[len - 1] == BASE64_PAD) {
+			--len;
+		}
+	}
+	const unsigned char* values = base64_table(alphabet);
+	/* The kernels stop short of any block with a bad character in it. */
+	size_t idx = base64_decode_blocks(dst.ptr, dst.len, src.ptr, len, alphabet);
+	size_t out = idx / 4 * 3;
+	/* Whole groups test validity once, as only BASE64_INVALID sets the top bit. */
+	for (; idx + 4 <= len && out + 3 <= dst.len; idx += 4) {
+		unsigned char a = values[src.ptr[idx]];
+		unsigned char b = values[src.ptr[idx + 1]];
+		unsigned char c = values[src.ptr[idx + 2]];
+		unsigned char d = values[src.ptr[idx + 3]];
+		if (((a | b | c | d) & 0x80) != 0) {
+			break;
+		}
+		dst.ptr[out++] = (unsigned char)(a << 2 | b >> 4);
+		dst.ptr[out++] = (unsigned char)(b << 4 | c >> 2);
+		dst.ptr[out++] = (unsigned char)(c << 6 | d);
+	}
+	for (; idx < len; idx += 4) {
+		size_t group = len - idx < 4 ? len - idx : 4;
+		uint32_t bits = 0;
+		for (size_t pos = 0; pos < group; ++pos) {
+			unsigned char val = values[src.ptr[idx + pos]];
+			if (val == BASE64_INVALID) {
+				return SET_VARIANT(Base64Result, Err, idx + pos);
+			}
+			bits |= (uint32_t)val << (18 - 6 * pos);
+		}
+		if (group == 1) {
+			return SET_VARIANT(Base64Result, Err, idx);
+		}
+		/* Bits below the last whole byte must be zero, or the text is not the
+		 * encoding of any input. */
+		if (group < 4 && (bits & (0xFFFFFFu >> (8 * (group - 1)))) != 0) {
+			return SET_VARIANT(Base64Result, Err, idx + group - 1);
+		}
+		if (out + group - 1 > dst.len) {
+			return SET_VARIANT(Base64Result, Err, idx);
+		}
+		for (size_t pos = 0; pos < group - 1; ++pos) {
+			dst.ptr[out++] = (unsigned char)(bits >> (16 - 8 * pos));
+		}
+	}
+	return SET_VARIANT(Base64Result, Ok, out);
+}
+
+/**
+ * INTERNAL: Encode bytes as base64, using the fastest available kernel for
+ * whole blocks and the portable encoder for the rest.
+ * @param dst A buffer of at least `base64_encoded_len(len)` bytes.
+ * @param src A buffer of `len` bytes.
+ * @param len The number of bytes to encode.
+ * @param alphabet The alphabet to encode with.
+ * @return The number of characters written.
+ */
+static size_t base64_encode_raw(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	Base64Alphabet alphabet
+) {
+	size_t done = 0;
+#ifdef WYZYRDRY_X86
+	if (len >= 28 && cpu_has(CPU_AVX2)) {
+		done = base64_encode_avx2(dst, src, len, &base64_simd[alphabet]);
+	}
+	if (len - done >= 16 && cpu_has(CPU_SSSE3)) {
+		done += base64_encode_ssse3(&dst[done / 3 * 4], &src[done], len - done, &base64_simd[alphabet]);
+	}
+#endif
+	size_t out = done / 3 * 4;
+	return out + base64_encode_scalar(&dst[out], &src[done], len - done, alphabet);
+}
+
+/**
+ * INTERNAL: Portable base64 encoder, which also writes the final partial group
+ * and any padding.
+ * @return The number of characters written.
+ */
+static size_t base64_encode_scalar(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	Base64Alphabet alphabet
+) {
+	const char* chars = base64_chars[alphabet];
+	size_t out = 0;
+	size_t idx = 0;
+	for (; idx + 3 <= len; idx += 3) {
+		uint32_t bits = (uint32_t)src[idx] << 16
+			| (uint32_t)src[idx + 1] << 8
+			| (uint32_t)src[idx + 2];
+		dst[out++] = (unsigned char)chars[bits >> 18];
+		dst[out++] = (unsigned char)chars[(bits >> 12) & 0x3F];
+		dst[out++] = (unsigned char)chars[(bits >> 6) & 0x3F];
+		dst[out++] = (unsigned char)chars[bits & 0x3F];
+	}
+	size_t rest = len - idx;
+	if (rest == 0) {
+		return out;
+	}
+	uint32_t bits = (uint32_t)src[idx] << 16;
+	if (rest == 2) {
+		bits |= (uint32_t)src[idx + 1] << 8;
+	}
+	dst[out++] = (unsigned char)chars[bits >> 18];
+	dst[out++] = (unsigned char)chars[(bits >> 12) & 0x3F];
+	if (rest == 2) {
+		dst[out++] = (unsigned char)chars[(bits >> 6) & 0x3F];
+	}
+	if (alphabet == BASE64_STANDARD) {
+		for (size_t pad = rest; pad < 3; ++pad) {
+			dst[out++] = BASE64_PAD;
+		}
+	}
+	return out;
+}
+
+/**
+ * INTERNAL: Decode as many whole blocks of text as the fastest available
+ * kernel can, stopping before any block that holds a bad character.
+ * @param dst The buffer to receive the bytes.
+ * @param room The length of `dst`.
+ * @param src The text, without padding.
+ * @param len The length of `src`.
+ * @param alphabet The alphabet to decode with.
+ * @return The number of characters decoded, a multiple of four. Each group of
+ * four produced three bytes.
+ */
+static size_t base64_decode_blocks(
+	unsigned char* dst,
+	size_t room,
+	const unsigned char* src,
+	size_t len,
+	Base64Alphabet alphabet
+) {
+	size_t done = 0;
+#ifdef WYZYRDRY_X86
+	if (len >= 32 && cpu_has(CPU_AVX2)) {
+		done = base64_decode_avx2(dst, room, src, len, &base64_simd[alphabet]);
+	}
+	if (len - done >= 16 && cpu_has(CPU_SSSE3)) {
+		size_t out = done / 4 * 3;
+		done += base64_decode_ssse3(&dst[out], room - out, &src[done], len - done, &base64_simd[alphabet]);
+	}
+#else
+	(void)dst;
+	(void)room;
+	(void)src;
+	(void)len;
+	(void)alphabet;
+#endif
+	return done;
+}
+
+/**
+ * INTERNAL: Get the decoding table for an alphabet, building the tables if
+ * this is the first use.
+ */
+static const unsigned char* base64_table(Base64Alphabet alphabet) {
+#ifdef __GNUC__
+	if (!__atomic_load_n(&base64_values_ready, __ATOMIC_ACQUIRE)) {
+#else
+	if (!base64_values_ready) {
+#endif
+		base64_init_tables();
+	}
+	return base64_values[alphabet];
+}
+
+/**
+ * INTERNAL: Build the decoding tables from the alphabets.
+ */
+static void base64_init_tables(void) {
+	for (size_t alpha = 0; alpha < 2; ++alpha) {
+		memset(base64_values[alpha], BASE64_INVALID, 256);
+		for (size_t val = 0; val < 64; ++val) {
+			base64_values[alpha][(unsigned char)base64_chars[alpha][val]] = (unsigned char)val;
+		}
+	}
+#ifdef __GNUC__
+	__atomic_store_n(&base64_values_ready, 1, __ATOMIC_RELEASE);
+#else
+	base64_values_ready = 1;
+#endif
+}
+
+#ifdef WYZYRDRY_X86
+
+/**
+ * INTERNAL: SSSE3 base64 encoder, 12 bytes to 16 characters per step.
+ *
+ * The bytes of each group of three are shuffled into a 32-bit lane so that
+ * multiplies can shift all four six-bit fields into bytes of their own at
+ * once. Each field is then sorted into its range by a saturating subtract and
+ * a compare, and the range picks its offset to the character with `pshufb`.
+ * @return The number of bytes encoded, a multiple of 12.
+ */
+WYZYRDRY_TARGET("ssse3")
+static size_t base64_encode_ssse3(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	const Base64Simd* simd
+) {
+	const __m128i spread = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+	const __m128i shift = _mm_loadu_si128((const __m128i*)simd->shift);
+	size_t idx = 0;
+	size_t out = 0;
+	/* Each load reads 16 bytes, of which the first 12 are encoded. */
+	for (; idx + 16 <= len; idx += 12, out += 16) {
+		__m128i in = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&src[idx]), spread);
+		__m128i ac = _mm_mulhi_epu16(
+			_mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00)),
+			_mm_set1_epi32(0x04000040)
+		);
+		__m128i bd = _mm_mullo_epi16(
+			_mm_and_si128(in, _mm_set1_epi32(0x003F03F0)),
+			_mm_set1_epi32(0x01000010)
+		);
+		__m128i vals = _mm_or_si128(ac, bd);
+		__m128i range = _mm_subs_epu8(vals, _mm_set1_epi8(51));
+		__m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), vals);
+		range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+		__m128i chars = _mm_add_epi8(vals, _mm_shuffle_epi8(shift, range));
+		_mm_storeu_si128((__m128i*)&dst[out], chars);
+	}
+	return idx;
+}
+
+/**
+ * INTERNAL: AVX2 base64 encoder, 24 bytes to 32 characters per step. Each
+ * 128-bit lane does the work of one step of the SSSE3 encoder.
+ * @return The number of bytes encoded, a multiple of 24.
+ */
+WYZYRDRY_TARGET("avx2")
+static size_t base64_encode_avx2(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	const Base64Simd* simd
+) {
+	const __m256i spread = _mm256_setr_epi8(
+		1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+		1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10
+	);
+	const __m256i shift = _mm256_broadcastsi128_si256(
+		_mm_loadu_si128((const __m128i*)simd->shift)
+	);
+	size_t idx = 0;
+	size_t out = 0;
+	/* The upper lane's load starts 12 bytes in and reads 16. */
+	for (; idx + 28 <= len; idx += 24, out += 32) {
+		__m256i in = _mm256_inserti128_si256(
+			_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)&src[idx])),
+			_mm_loadu_si128((const __m128i*)&src[idx + 12]),
+			1
+		);
+		in = _mm256_shuffle_epi8(in, spread);
+		__m256i ac = _mm256_mulhi_epu16(
+			_mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00)),
+			_mm256_set1_epi32(0x04000040)
+		);
+		__m256i bd = _mm256_mullo_epi16(
+			_mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0)),
+			_mm256_set1_epi32(0x01000010)
+		);
+		__m256i vals = _mm256_or_si256(ac, bd);
+		__m256i range = _mm256_subs_epu8(vals, _mm256_set1_epi8(51));
+		__m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), vals);
+		range = _mm256_or_si256(range, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+		__m256i chars = _mm256_add_epi8(vals, _mm256_shuffle_epi8(shift, range));
+		_mm256_storeu_si256((__m256i*)&dst[out], chars);
+	}
+	return idx;
+}
+
+/**
+ * INTERNAL: SSSE3 base64 decoder, 16 characters to 12 bytes per step.
+ *
+ * Each character is checked against the alphabet by two nibble lookups, and
+ * translated to its value by adding an offset looked up by its high nibble.
+ * Multiply-adds then pack four six-bit values into three bytes.
+ * @return The number of characters decoded, a multiple of 16.
+ */
+WYZYRDRY_TARGET("ssse3")
+static size_t base64_decode_ssse3(
+	unsigned char* dst,
+	size_t room,
+	const unsigned char* src,
+	size_t len,
+	const Base64Simd* simd
+) {
+	const __m128i lut_lo = _mm_loadu_si128((const __m128i*)simd->lo);
+	const __m128i lut_hi = _mm_loadu_si128((const __m128i*)simd->hi);
+	const __m128i lut_roll = _mm_loadu_si128((const __m128i*)simd->roll);
+	const __m128i symbol = _mm_set1_epi8((char)simd->symbol);
+	const __m128i delta = _mm_set1_epi8(simd->delta);
+	const __m128i nibble = _mm_set1_epi8(0x0F);
+	const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+	size_t idx = 0;
+	size_t out = 0;
+	/* Each store writes 16 bytes, of which the first 12 are kept. */
+	for (; idx + 16 <= len && out + 16 <= room; idx += 16, out += 12) {
+		__m128i in = _mm_loadu_si128((const __m128i*)&src[idx]);
+		__m128i hi = _mm_and_si128(_mm_srli_epi32(in, 4), nibble);
+		__m128i lo = _mm_and_si128(in, nibble);
+		__m128i bad = _mm_and_si128(
+			_mm_shuffle_epi8(lut_lo, lo),
+			_mm_shuffle_epi8(lut_hi, hi)
+		);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(bad, _mm_setzero_si128())) != 0xFFFF) {
+			break;
+		}
+		__m128i row = _mm_add_epi8(hi, _mm_and_si128(_mm_cmpeq_epi8(in, symbol), delta));
+		__m128i vals = _mm_add_epi8(in, _mm_shuffle_epi8(lut_roll, row));
+		__m128i pairs = _mm_maddubs_epi16(vals, _mm_set1_epi32(0x01400140));
+		__m128i words = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+		_mm_storeu_si128((__m128i*)&dst[out], _mm_shuffle_epi8(words, pack));
+	}
+	return idx;
+}
+
+/**
+ * INTERNAL: AVX2 base64 decoder, 32 characters to 24 bytes per step. Each
+ * 128-bit lane does the work of one step of the SSSE3 decoder, and a permute
+ * closes the gap between the lanes' bytes.
+ * @return The number of characters decoded, a multiple of 32.
+ */
+WYZYRDRY_TARGET("avx2")
+static size_t base64_decode_avx2(
+	unsigned char* dst,
+	size_t room,
+	const unsigned char* src,
+	size_t len,
+	const Base64Simd* simd
+) {
+	const __m256i lut_lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)simd->lo));
+	const __m256i lut_hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)simd->hi));
+	const __m256i lut_roll = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)simd->roll));
+	const __m256i symbol = _mm256_set1_epi8((char)simd->symbol);
+	const __m256i delta = _mm256_set1_epi8(simd->delta);
+	const __m256i nibble = _mm256_set1_epi8(0x0F);
+	const __m256i pack = _mm256_setr_epi8(
+		2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+		2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+	);
+	const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+	size_t idx = 0;
+	size_t out = 0;
+	/* Each store writes 32 bytes, of which the first 24 are kept. */
+	for (; idx + 32 <= len && out + 32 <= room; idx += 32, out += 24) {
+		__m256i in = _mm256_loadu_si256((const __m256i*)&src[idx]);
+		__m256i hi = _mm256_and_si256(_mm256_srli_epi32(in, 4), nibble);
+		__m256i lo = _mm256_and_si256(in, nibble);
+		__m256i bad = _mm256_and_si256(
+			_mm256_shuffle_epi8(lut_lo, lo),
+			_mm256_shuffle_epi8(lut_hi, hi)
+		);
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(bad, _mm256_setzero_si256())) != -1) {
+			break;
+		}
+		__m256i row = _mm256_add_epi8(hi, _mm256_and_si256(_mm256_cmpeq_epi8(in, symbol), delta));
+		__m256i vals = _mm256_add_epi8(in, _mm256_shuffle_epi8(lut_roll, row));
+		__m256i pairs = _mm256_maddubs_epi16(vals, _mm256_set1_epi32(0x01400140));
+		__m256i words = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+		__m256i bytes = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(words, pack), lanes);
+		_mm256_storeu_si256((__m256i*)&dst[out], bytes);
+	}
+	return idx;
+}
+
+#endif
@@ -0,0 +1,306 @@
+#include <string.h>
+
+#include <wyzyrdry.h>
+
+static BroadcastReader* broadcast_readers(const Broadcast* const self);
+static BroadcastReader* broadcast_reader(const Broadcast* const self, size_t id);
+static RingBufCursor broadcast_cursor(
+	const Broadcast* const self,
+	const BroadcastReader* const reader
+);
+static size_t broadcast_record_size(
+	const Broadcast* const self,
+	const RingBufCursor* const from,
+	const RingBufCursor* const to
+);
+static void broadcast_drop_head(Broadcast* const self);
+static void broadcast_reclaim(Broadcast* const self);
+
+/**
+ * Initialize a Broadcast over a ring, with no readers.
+ * @param ring The ring, which stays owned by the caller. It should be empty;
+ * messages already in it are seen by no reader.
+ * @param policy What a write does when the ring is full.
+ * @return A Broadcast structure. Nothing is allocated until a reader is added.
+ */
+Broadcast broadcast_init(RingBuf* const ring, BroadcastPolicy policy) {
+	Broadcast ret = {
+		.ring = ring,
+		.policy = policy,
+		.readers = { .buf = NULL, .len = 0, .cap = 0 },
+		.active = 0,
+		.base = 0,
+		.base_at = 0,
+	};
+	return ret;
+}
+
+/**
+ * Deallocate a Broadcast. The ring is left as it is.
+ * @param self The Broadcast on which to act.
+ */
+void broadcast_free(Broadcast* const self) {
+	vec_free(&self->readers);
+	*self = broadcast_init(self->ring, self->policy);
+}
+
+/**
+ * Add a reader, which sees every message written from now on.
+ * @param self The Broadcast on which to act.
+ * @return The reader's id, which numbers the readers from zero in the order
+ * they were added, or `BROADCAST_NONE` if allocation failed.
+ */
+size_t broadcast_add(Broadcast* const self) {
+	size_t id = self->readers.len / sizeof(BroadcastReader);
+	/* The next message to be written is one past the end of the ring. */
+	BroadcastReader reader = {
+		.seq = self->base + self->ring->count,
+		.at = self->base_at + ringbuf_space_used(self->ring),
+		.missed = 0,
+		.active = true,
+	};
+	vec_push_slice(&self->readers, slice_new((unsigned char*)&reader, sizeof(reader)));
+	if (self->readers.len / sizeof(BroadcastReader) == id) {
+		return BROADCAST_NONE;
+	}
+	++self->active;
+	return id;
+}
+
+/**
+ * Remove a reader. Messages that only it had yet to see are popped.
+ * @param self The Broadcast on which to act.
+ * @param id The reader's id, which is not reused.
+ */
+void broadcast_remove(Broadcast* const self, size_t id) {
+	BroadcastReader* reader = broadcast_reader(self, id);
+	if (reader == NULL) {
+		return;
+	}
+	reader->active = false;
+	--self->active;
+	broadcast_reclaim(self);
+}
+
+/**
+ * Write a `Slice`'s contents into the ring, once, for every reader.
+ * @param self The Broadcast on which to act.
+ * @param in The `Slice` to be written.
+ * @return The amount of data pushed into the ring, or zero if it did not fit.
+ */
+StrLen broadcast_write_slice(Broadcast* const self, const Slice in) {
+	return broadcast_write_gather(self, &in, 1);
+}
+
+/**
+ * Write a message given as several `Slice`s into the ring, once, for every
+ * reader.
+ *
+ * If the ring is full, then under `BROADCAST_WAIT` the message is refused, and
+ * under `BROADCAST_DROP` the oldest messages are popped until it fits. A
+ * message with no reader is popped as soon as it is written.
+ * @param self The Broadcast on which to act.
+ * @param parts The pieces of the message, in order.
+ * @param n The number of pieces.
+ * @return The amount of data pushed into the ring, or zero if it did not fit.
+ */
+StrLen broadcast_write_gather(
+	Broadcast* const self,
+	const Slice* const parts,
+	size_t n
+) {
+	size_t total = 0;
+	for (size_t idx = 0; idx < n; ++idx) {
+		total += parts[idx].len;
+	}
+	if (total > (StrLen)~(StrLen)0) {
+		return ringbuf_write_gather(self->ring, parts, n);
+	}
+	if (self->policy == BROADCAST_DROP) {
+		while (self->ring->count > 0 && !ringbuf_fits(self->ring, (StrLen)total)) {
+			broadcast_drop_head(self);
+		}
+	}
+	if (!ringbuf_fits(self->ring, (StrLen)total)) {
+		return 0;
+	}
+	StrLen ret = ringbuf_write_gather(self->ring, parts, n);
+	if (self->active == 0) {
+		broadcast_reclaim(self);
+	}
+	return ret;
+}
+
+/**
+ * Count the messages a reader has yet to see.
+ * @param self The Broadcast to inspect.
+ * @param id The reader's id.
+ * @return The number of messages between the reader and the producer.
+ */
+size_t broadcast_pending(const Broadcast* const self, size_t id) {
+	BroadcastReader* reader = broadcast_reader(self, id);
+	if (reader == NULL) {
+		return 0;
+	}
+	return self->base + self->ring->count - reader->seq;
+}
+
+/**
+ * Count the messages a reader missed because it fell behind a
+ * `BROADCAST_DROP` producer.
+ * @param self The Broadcast to inspect.
+ * @param id The reader's id.
+ * @return The number of messages it was moved past.
+ */
+size_t broadcast_missed(const Broadcast* const self, size_t id) {
+	BroadcastReader* reader = broadcast_reader(self, id);
+	return reader != NULL ? reader->missed : 0;
+}
+
+/**
+ * Describes the payload of a reader's next message, in place, without moving
+ * the reader.
+ *
+ * The Slices are as from `ringbuf_peek_slices()`, and remain valid until the
+ * reader pops the message or the ring is written.
+ * @param self The Broadcast to inspect.
+ * @param id The reader's id.
+ * @param parts Receives the one or two Slices over the payload. Both are empty
+ * if the reader has seen every message.
+ * @return true if the reader has a message.
+ */
+bool broadcast_peek(const Broadcast* const self, size_t id, Slice parts[2]) {
+	BroadcastReader* reader = broadcast_reader(self, id);
+	if (reader == NULL) {
+		parts[0] = slice_new(NULL, 0);
+		parts[1] = slice_new(NULL, 0);
+		return false;
+	}
+	RingBufCursor cursor = broadcast_cursor(self, reader);
+	return ringbuf_next(self->ring, &cursor, parts);
+}
+
+/**
+ * Move a reader past its next message. Once the slowest reader has passed a
+ * message, it is popped from the ring.
+ * @param self The Broadcast on which to act.
+ * @param id The reader's id.
+ */
+void broadcast_pop(Broadcast* const self, size_t id) {
+	BroadcastReader* reader = broadcast_reader(self, id);
+	if (reader == NULL) {
+		return;
+	}
+	RingBufCursor from = broadcast_cursor(self, reader);
+	RingBufCursor to = from;
+	Slice parts[2];
+	if (!ringbuf_next(self->ring, &to, parts)) {
+		return;
+	}
+	bool slowest = reader->seq == self->base;
+	reader->at += broadcast_record_size(self, &from, &to);
+	++reader->seq;
+	/* Only a reader at the head can be the one holding it there. */
+	if (slowest) {
+		broadcast_reclaim(self);
+	}
+}
+
+/**
+ * INTERNAL: View the readers as an array.
+ */
+static BroadcastReader* broadcast_readers(const Broadcast* const self) {
+	return (BroadcastReader*)self->readers.buf;
+}
+
+/**
+ * INTERNAL: Find an active reader by id.
+ * @return The reader, or NULL if the id is not that of an active reader.
+ */
+static BroadcastReader* broadcast_reader(const Broadcast* const self, size_t id) {
+	if (id >= self->readers.len / sizeof(BroadcastReader)) {
+		return NULL;
+	}
+	BroadcastReader* reader = &broadcast_readers(self)[id];
+	return reader->active ? reader : NULL;
+}
+
+/**
+ * INTERNAL: Build a ring cursor at a reader's next message, from its distance
+ * in bytes and messages past the head of the ring.
+ */
+static RingBufCursor broadcast_cursor(
+	const Broadcast* const self,
+	const BroadcastReader* const reader
+) {
+	const RingBuf* ring = self->ring;
+	RingBufCursor ret = {
+		.seen = reader->seq - self->base,
+		.pos = ring->head,
+	};
+	size_t off = reader->at - self->base_at;
+	if (off > 0) {
+		/* The reader is within the ring, so one wrap at most. */
+		ret.pos = off < ring->store.len - ring->head
+			? ring->head + off
+			: off - (ring->store.len - ring->head);
+	}
+	return ret;
+}
+
+/**
+ * INTERNAL: Measure the record between two places in the ring, including its
+ * length prefix and any stamp.
+ * @param self The Broadcast to inspect.
+ * @param from A cursor at the record.
+ * @param to The cursor after `ringbuf_next()` has passed the record.
+ * @return The size of the record.
+ */
+static size_t broadcast_record_size(
+	const Broadcast* const self,
+	const RingBufCursor* const from,
+	const RingBufCursor* const to
+) {
+	size_t cap = self->ring->store.len;
+	/* A record never has zero size, so equal places are a full lap. */
+	return to->pos > from->pos ? to->pos - from->pos : to->pos + cap - from->pos;
+}
+
+/**
+ * INTERNAL: Pop the message at the head of the ring, moving past it any reader
+ * that has not seen it.
+ * @param self The Broadcast on which to act.
+ */
+static void broadcast_drop_head(Broadcast* const self) {
+	size_t used = ringbuf_space_used(self->ring);
+	ringbuf_pop(self->ring);
+	size_t size = used - ringbuf_space_used(self->ring);
+	BroadcastReader* readers = broadcast_readers(self);
+	for (size_t idx = 0; idx < self->readers.len / sizeof(BroadcastReader); ++idx) {
+		if (readers[idx].active && readers[idx].seq == self->base) {
+			++readers[idx].seq;
+			readers[idx].at += size;
+			++readers[idx].missed;
+		}
+	}
+	++self->base;
+	self->base_at += size;
+}
+
+/**
+ * INTERNAL: Pop the messages that every reader has passed.
+ * @param self The Broadcast on which to act.
+ */
+static void broadcast_reclaim(Broadcast* const self) {
+	size_t slowest = self->base + self->ring->count;
+	BroadcastReader* readers = broadcast_readers(self);
+	for (size_t idx = 0; idx < self->readers.len / sizeof(BroadcastReader); ++idx) {
+		if (readers[idx].active && readers[idx].seq < slowest) {
+			slowest = readers[idx].seq;
+		}
+	}
+	/* No reader is at the head, so none is moved past a message it lacks. */
+	while (self->base < slowest) {
+		broadcast_drop_head(self);
+	}
+}
@@ -0,0 +1,95 @@
+#include <wyzyrdry.h>
+
+/**
+ * The features in use by the library. Zero means "not yet detected"; SSE2 is
+ * part of the x86-64 baseline, and every other architecture sets a sentinel
+ * bit, so a detected set is never zero.
+ */
+static unsigned int cpu_cache = 0;
+
+/**
+ * The mask applied to the detected features by `cpu_restrict()`.
+ */
+static unsigned int cpu_mask = ~0u;
+
+/**
+ * Sentinel bit marking the feature cache as populated.
+ */
+#define CPU_DETECTED (1u << 31)
+
+/**
+ * INTERNAL: Query the processor for its supported extensions.
+ * @return A bitmask of `CpuFeature` values, plus the `CPU_DETECTED` sentinel.
+ */
+static unsigned int cpu_detect(void) {
+	unsigned int ret = CPU_DETECTED;
+#ifdef WYZYRDRY_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2")) {
+		ret |= CPU_SSE2;
+	}
+	if (__builtin_cpu_supports("ssse3")) {
+		ret |= CPU_SSSE3;
+	}
+	if (__builtin_cpu_supports("sse4.2")) {
+		ret |= CPU_SSE42;
+	}
+	if (__builtin_cpu_supports("pclmul")) {
+		ret |= CPU_PCLMUL;
+	}
+	if (__builtin_cpu_supports("avx2")) {
+		ret |= CPU_AVX2;
+	}
+	if (__builtin_cpu_supports("avx512bw")) {
+		ret |= CPU_AVX512BW;
+	}
+	if (__builtin_cpu_supports("bmi2")) {
+		ret |= CPU_BMI2;
+	}
+	if (__builtin_cpu_supports("avx512vbmi")) {
+		ret |= CPU_AVX512VBMI;
+	}
+#endif
+	return ret;
+}
+
+/**
+ * Get the set of extensions the library will use on this processor.
+ *
+ * Detection runs once, on first use. Concurrent first calls race benignly, as
+ * every thread computes and stores the same value.
+ * @return A bitmask of `CpuFeature` values.
+ */
+unsigned int cpu_features(void) {
+	unsigned int feats = cpu_cache;
+	if (feats == 0) {
+		feats = cpu_detect();
+		cpu_cache = feats;
+	}
+	return feats & cpu_mask & ~CPU_DETECTED;
+}
+
+/**
+ * Check whether all of the given extensions may be used.
+ * @param features A bitmask of `CpuFeature` values.
+ * @return true if every requested extension is available.
+ */
+bool cpu_has(unsigned int features) {
+	return (cpu_features() & features) == features;
+}
+
+/**
+ * Limit the extensions the library will use, regardless of what the processor
+ * supports. This lets tests and benchmarks exercise every kernel on a single
+ * machine. Passing `~0u` lifts the restriction.
+ *
+ * This is not synchronized with other threads, and should be set before any
+ * concurrent use of the library.
+ * @param mask A bitmask of `CpuFeature` values that may be used.
+ * @return The previous mask, so that it can be restored.
+ */
+unsigned int cpu_restrict(unsigned int mask) {
+	unsigned int old = cpu_mask;
+	cpu_mask = mask;
+	return old;
+}
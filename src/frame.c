@@ -0,0 +1,225 @@
+#include <string.h>
+
+#include <wyzyrdry.h>
+
+/**
+ * The longest payload a length prefix can describe.
+ */
+#define FRAME_WIRE_MAX ((size_t)(StrLen)~(StrLen)0)
+
+static void frame_decoder_release(FrameDecoder* const self);
+static void frame_decoder_advance(FrameDecoder* const self, size_t len);
+
+/**
+ * Append a frame to a Vec: the payload's length in network byte order, then
+ * the payload.
+ * @param dst The Vec to append to.
+ * @param payload The bytes to frame.
+ * @return true on success, or false if the payload is too long for a `StrLen`
+ * or the Vec could not grow, in which case the Vec is unchanged.
+ */
+bool frame_encode(Vec* const dst, const Slice payload) {
+	if (payload.len > FRAME_WIRE_MAX || !vec_reserve(dst, sizeof(StrLen) + payload.len)) {
+		return false;
+	}
+	dst->len += frame_encode_into(slice_new(&dst->buf[dst->len], dst->cap - dst->len), payload);
+	return true;
+}
+
+/**
+ * Write a frame into a buffer: the payload's length in network byte order,
+ * then the payload.
+ * @param dst The buffer to write into.
+ * @param payload The bytes to frame.
+ * @return The number of bytes written, or 0 if `dst` is too small or the
+ * payload is too long for a `StrLen`.
+ */
+size_t frame_encode_into(const Slice dst, const Slice payload) {
+	if (payload.len > FRAME_WIRE_MAX || dst.len < sizeof(StrLen) + payload.len) {
+		return 0;
+	}
+	str_len_to_wire(dst.ptr, (StrLen)payload.len);
+	if (payload.len > 0) {
+		INSTRUMENT_COPY("frame", &dst.ptr[sizeof(StrLen)], payload.ptr, payload.len);
+	}
+	return sizeof(StrLen) + payload.len;
+}
+
+/**
+ * Initialize a FrameDecoder.
+ * @param max_len The longest payload to accept. It is capped at
+ * `FRAME_MAX_LEN`. This much memory is allocated once, for frames that span
+ * pieces of input.
+ * @return A FrameDecoder with no input. If malloc failed, its `partial.buf`
+ * will be NULL, and it must not be used.
+ */
+FrameDecoder frame_decoder_init(size_t max_len) {
+	if (max_len > FRAME_MAX_LEN) {
+		max_len = FRAME_MAX_LEN;
+	}
+	FrameDecoder ret = {
+		.max_len = max_len,
+		.input = slice_new(NULL, 0),
+		.prefix_len = 0,
+		.frame_len = 0,
+		.in_frame = false,
+		.partial = vec_init(max_len > 0 ? max_len : 1, 1),
+		.yielded_partial = false,
+		.held = slice_new(NULL, 0),
+		.holding = false,
+		.failed = false,
+	};
+	return ret;
+}
+
+/**
+ * Deallocate a FrameDecoder's buffer.
+ * @param self The FrameDecoder on which to act.
+ */
+void frame_decoder_free(FrameDecoder* const self) {
+	vec_free(&self->partial);
+	frame_decoder_reset(self);
+}
+
+/**
+ * Discard all input and any frame in progress, and clear a TooLarge failure,
+ * so that the decoder can be used for a new stream.
+ * @param self The FrameDecoder on which to act.
+ */
+void frame_decoder_reset(FrameDecoder* const self) {
+	self->input = slice_new(NULL, 0);
+	self->prefix_len = 0;
+	self->frame_len = 0;
+	self->in_frame = false;
+	self->partial.len = 0;
+	self->yielded_partial = false;
+	self->held = slice_new(NULL, 0);
+	self->holding = false;
+	self->failed = false;
+}
+
+/**
+ * Give the decoder the next piece of the stream.
+ *
+ * This must only be called once decoding has returned More for the previous
+ * piece. The piece is not copied, and must remain valid until then.
+ * @param self The FrameDecoder on which to act.
+ * @param input The next bytes of the stream.
+ */
+void frame_decoder_feed(FrameDecoder* const self, const Slice input) {
+	self->input = input;
+}
+
+/**
+ * Decode the next frame from the input fed so far.
+ *
+ * A frame that lies entirely within the current piece of input is returned as a
+ * Slice into that piece; one that began in an earlier piece is returned from
+ * the decoder's own buffer. Either way, the Slice is valid until the next call
+ * to any FrameDecoder function.
+ * @param self The FrameDecoder on which to act.
+ * @return Frame with the next payload, More once the input is used up, or
+ * TooLarge if the stream is corrupt.
+ */
+FrameResult frame_decoder_next(FrameDecoder* const self) {
+	frame_decoder_release(self);
+	if (self->failed) {
+		return SET_VARIANT(FrameResult, TooLarge, self->frame_len);
+	}
+	/* Between frames, a frame wholly within the input needs no copying. */
+	if (self->prefix_len == 0 && self->input.len >= sizeof(StrLen)) {
+		size_t len = str_len_from_wire(self->input.ptr);
+		if (len <= self->max_len && self->input.len - sizeof(StrLen) >= len) {
+			Slice frame = slice_new(&self->input.ptr[sizeof(StrLen)], len);
+			frame_decoder_advance(self, sizeof(StrLen) + len);
+			return SET_VARIANT(FrameResult, Frame, frame);
+		}
+	}
+	/* Otherwise gather the prefix, and then the payload, a piece at a time. */
+	if (!self->in_frame) {
+		while (self->prefix_len < sizeof(StrLen)) {
+			if (self->input.len == 0) {
+				return SET_VARIANT(FrameResult, More, sizeof(StrLen) - self->prefix_len);
+			}
+			self->prefix[self->prefix_len++] = self->input.ptr[0];
+			frame_decoder_advance(self, 1);
+		}
+		self->frame_len = str_len_from_wire(self->prefix);
+		if (self->frame_len > self->max_len) {
+			self->failed = true;
+			return SET_VARIANT(FrameResult, TooLarge, self->frame_len);
+		}
+		self->in_frame = true;
+		self->partial.len = 0;
+	}
+	size_t need = self->frame_len - self->partial.len;
+	size_t take = need < self->input.len ? need : self->input.len;
+	if (take > 0) {
+		INSTRUMENT_COPY("frame", &self->partial.buf[self->partial.len], self->input.ptr, take);
+		self->partial.len += take;
+		frame_decoder_advance(self, take);
+	}
+	if (self->partial.len < self->frame_len) {
+		return SET_VARIANT(FrameResult, More, self->frame_len - self->partial.len);
+	}
+	self->in_frame = false;
+	self->prefix_len = 0;
+	self->yielded_partial = true;
+	return SET_VARIANT(FrameResult, Frame, vec_as_slice(&self->partial));
+}
+
+/**
+ * Decode every complete frame from the input fed so far into a RingBuf, as one
+ * `Str` message each, in a single pass.
+ *
+ * Messages in the RingBuf use its native-endian length prefix. The RingBuf must
+ * be able to hold a message of `max_len` bytes, or a frame that long will never
+ * fit.
+ * @param self The FrameDecoder on which to act.
+ * @param ring The RingBuf to fill.
+ * @return More once the input is used up, Full if the RingBuf ran out of room,
+ * or TooLarge if the stream is corrupt. After Full, make room in the RingBuf
+ * and call this again; the frame that did not fit is kept until then.
+ */
+FrameResult frame_decoder_into_ringbuf(
+	FrameDecoder* const self,
+	RingBuf* const ring
+) {
+	for (;;) {
+		Slice frame = self->held;
+		if (!self->holding) {
+			FrameResult res = frame_decoder_next(self);
+			if (GET_VARIANT_TYPE(res) != ENUM_VAR(FrameResult, Frame)) {
+				return res;
+			}
+			frame = GET_VARIANT_BODY(res, Frame);
+		}
+		if (!ringbuf_fits(ring, (StrLen)frame.len)
+			|| ringbuf_write_slice(ring, frame) == 0) {
+			self->held = frame;
+			self->holding = true;
+			return SET_VARIANT(FrameResult, Full, frame.len);
+		}
+		self->holding = false;
+	}
+}
+
+/**
+ * INTERNAL: Discard a gathered frame once it has been returned to the caller.
+ * @param self The FrameDecoder on which to act.
+ */
+static void frame_decoder_release(FrameDecoder* const self) {
+	if (self->yielded_partial) {
+		self->partial.len = 0;
+		self->yielded_partial = false;
+	}
+}
+
+/**
+ * INTERNAL: Consume bytes from the front of the input.
+ * @param self The FrameDecoder on which to act.
+ * @param len The number of bytes consumed.
+ */
+static void frame_decoder_advance(FrameDecoder* const self, size_t len) {
+	self->input = slice_new(&self->input.ptr[len], self->input.len - len);
+}
@@ -0,0 +1,496 @@
+#include <string.h>
+
+#include <wyzyrdry.h>
+
+#ifdef WYZYRDRY_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * The CRC-32C polynomial, bit-reflected.
+ */
+#define CRC32C_POLY 0x82F63B78u
+
+/**
+ * The number of bytes each of the three parallel streams covers in one pass
+ * of the folding kernel. Long passes amortize the cost of folding; short passes
+ * cover what remains of large inputs.
+ */
+#define CRC32C_LONG 8192
+#define CRC32C_SHORT 256
+
+static const uint64_t XXH_PRIME1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t XXH_PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t XXH_PRIME3 = 0x165667B19E3779F9ULL;
+static const uint64_t XXH_PRIME4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t XXH_PRIME5 = 0x27D4EB2F165667C5ULL;
+
+/**
+ * Slicing-by-8 lookup tables, built on first use.
+ */
+static uint32_t crc32c_table[8][256];
+static int crc32c_table_ready = 0;
+
+static uint32_t crc32c_raw(uint32_t state, const unsigned char* ptr, size_t len);
+static uint32_t crc32c_table_raw(
+	uint32_t state,
+	const unsigned char* ptr,
+	size_t len
+);
+static uint32_t crc32c_multmodp(uint32_t a, uint32_t b);
+static uint32_t crc32c_xpow(uint64_t n);
+#if defined(WYZYRDRY_X86) && defined(__x86_64__)
+static uint32_t crc32c_sse42_raw(
+	uint32_t state,
+	const unsigned char* ptr,
+	size_t len
+);
+static uint32_t crc32c_pclmul_raw(
+	uint32_t state,
+	const unsigned char* ptr,
+	size_t len
+);
+#endif
+static const unsigned char* xxh64_stripes(
+	uint64_t acc[4],
+	const unsigned char* ptr,
+	size_t len
+);
+static uint64_t xxh64_finish(
+	const uint64_t acc[4],
+	uint64_t seed,
+	uint64_t total,
+	const unsigned char* tail,
+	size_t tail_len
+);
+
+/**
+ * Compute or continue a CRC-32C checksum.
+ *
+ * To checksum data that arrives in pieces, start with a CRC of 0 and pass each
+ * result back in with the next piece.
+ * @param crc The CRC of the data preceding `data`, or 0 to start a new one.
+ * @param data The bytes to checksum.
+ * @return The CRC of everything up to and including `data`.
+ */
+uint32_t hash_crc32c(uint32_t crc, const Slice data) {
+	return ~crc32c_raw(~crc, data.ptr, data.len);
+}
+
+/**
+ * Combine the CRCs of two adjacent pieces of data into the CRC of both, without
+ * revisiting the data. This allows pieces to be checksummed independently, and
+ * in parallel.
+ * @param first The CRC of the first piece.
+ * @param second The CRC of the second piece, computed starting from 0.
+ * @param second_len The length of the second piece, in bytes.
+ * @return The CRC of the first piece followed by the second.
+ */
+uint32_t hash_crc32c_combine(uint32_t first, uint32_t second, size_t second_len) {
+	return crc32c_multmodp(crc32c_xpow(8 * (uint64_t)second_len), first) ^ second;
+}
+
+/**
+ * Compute the XXH64 hash of a Slice.
+ * @param data The bytes to hash.
+ * @param seed Selects an independent hash function.
+ * @return The 64-bit hash.
+ */
+uint64_t hash_xxh64(const Slice data, uint64_t seed) {
+	uint64_t acc[4] = {
+		seed + XXH_PRIME1 + XXH_PRIME2,
+		seed + XXH_PRIME2,
+		seed,
+		seed - XXH_PRIME1,
+	};
+	const unsigned char* tail = xxh64_stripes(acc, data.ptr, data.len);
+	size_t tail_len = data.len - (size_t)(tail - data.ptr);
+	return xxh64_finish(acc, seed, data.len, tail, tail_len);
+}
+
+/**
+ * Start an incremental XXH64 computation.
+ * @param seed Selects an independent hash function.
+ * @return A `Hasher` that has consumed no data.
+ */
+Hasher hasher_init(uint64_t seed) {
+	Hasher ret = {
+		.acc = {
+			seed + XXH_PRIME1 + XXH_PRIME2,
+			seed + XXH_PRIME2,
+			seed,
+			seed - XXH_PRIME1,
+		},
+		.seed = seed,
+		.total = 0,
+		.buf_len = 0,
+	};
+	return ret;
+}
+
+/**
+ * Add data to an incremental XXH64 computation.
+ * @param self The `Hasher` on which to act.
+ * @param data The bytes to add after those already consumed.
+ */
+void hasher_update(Hasher* const self, const Slice data) {
+	const unsigned char* ptr = data.ptr;
+	size_t len = data.len;
+	self->total += len;
+	/* Complete a buffered partial stripe first. */
+	if (self->buf_len > 0) {
+		size_t take = sizeof(self->buf) - self->buf_len;
+		if (take > len) {
+			take = len;
+		}
+		memcpy(&self->buf[self->buf_len], ptr, take);
+		self->buf_len += (unsigned int)take;
+		ptr += take;
+		len -= take;
+		if (self->buf_len < sizeof(self->buf)) {
+			return;
+		}
+		xxh64_stripes(self->acc, self->buf, sizeof(self->buf));
+		self->buf_len = 0;
+	}
+	const unsigned char* tail = xxh64_stripes(self->acc, ptr, len);
+	self->buf_len = (unsigned int)(len - (size_t)(tail - ptr));
+	memcpy(self->buf, tail, self->buf_len);
+}
+
+/**
+ * Produce the hash of all data consumed by an incremental XXH64 computation.
+ * The `Hasher` is not modified, and may continue to receive data.
+ * @param self The `Hasher` to read.
+ * @return The hash of everything passed to `hasher_update()`, equal to
+ * `hash_xxh64()` of the same bytes in one Slice.
+ */
+uint64_t hasher_finish(const Hasher* const self) {
+	return xxh64_finish(self->acc, self->seed, self->total, self->buf, self->buf_len);
+}
+
+/**
+ * INTERNAL: Read eight bytes as a little-endian integer.
+ */
+static inline uint64_t hash_read64(const unsigned char* ptr) {
+	return (uint64_t)ptr[0]
+		| (uint64_t)ptr[1] << 8
+		| (uint64_t)ptr[2] << 16
+		| (uint64_t)ptr[3] << 24
+		| (uint64_t)ptr[4] << 32
+		| (uint64_t)ptr[5] << 40
+		| (uint64_t)ptr[6] << 48
+		| (uint64_t)ptr[7] << 56;
+}
+
+/**
+ * INTERNAL: Read four bytes as a little-endian integer.
+ */
+static inline uint32_t hash_read32(const unsigned char* ptr) {
+	return (uint32_t)ptr[0]
+		| (uint32_t)ptr[1] << 8
+		| (uint32_t)ptr[2] << 16
+		| (uint32_t)ptr[3] << 24;
+}
+
+static inline uint64_t hash_rotl64(uint64_t x, int r) {
+	return (x << r) | (x >> (64 - r));
+}
+
+/**
+ * INTERNAL: Mix one word into an XXH64 lane.
+ */
+static inline uint64_t xxh64_round(uint64_t acc, uint64_t input) {
+	acc += input * XXH_PRIME2;
+	acc = hash_rotl64(acc, 31);
+	return acc * XXH_PRIME1;
+}
+
+static inline uint64_t xxh64_merge(uint64_t hash, uint64_t lane) {
+	hash ^= xxh64_round(0, lane);
+	return hash * XXH_PRIME1 + XXH_PRIME4;
+}
+
+/**
+ * INTERNAL: Consume all whole 32-byte stripes of a buffer into the lanes.
+ * @return A pointer to the first byte that did not fill a stripe.
+ */
+static const unsigned char* xxh64_stripes(
+	uint64_t acc[4],
+	const unsigned char* ptr,
+	size_t len
+) {
+	const unsigned char* end = ptr + len;
+	while (end - ptr >= 32) {
+		acc[0] = xxh64_round(acc[0], hash_read64(ptr));
+		acc[1] = xxh64_round(acc[1], hash_read64(ptr + 8));
+		acc[2] = xxh64_round(acc[2], hash_read64(ptr + 16));
+		acc[3] = xxh64_round(acc[3], hash_read64(ptr + 24));
+		ptr += 32;
+	}
+	return ptr;
+}
+
+/**
+ * INTERNAL: Merge the lanes, mix in the bytes that did not fill a stripe, and
+ * avalanche the result.
+ */
+static uint64_t xxh64_finish(
+	const uint64_t acc[4],
+	uint64_t seed,
+	uint64_t total,
+	const unsigned char* tail,
+	size_t tail_len
+) {
+	uint64_t hash;
+	if (total >= 32) {
+		hash = hash_rotl64(acc[0], 1) + hash_rotl64(acc[1], 7)
+			+ hash_rotl64(acc[2], 12) + hash_rotl64(acc[3], 18);
+		for (int lane = 0; lane < 4; ++lane) {
+			hash = xxh64_merge(hash, acc[lane]);
+		}
+	}
+	else {
+		hash = seed + XXH_PRIME5;
+	}
+	hash += total;
+	for (; tail_len >= 8; tail += 8, tail_len -= 8) {
+		hash ^= xxh64_round(0, hash_read64(tail));
+		hash = hash_rotl64(hash, 27) * XXH_PRIME1 + XXH_PRIME4;
+	}
+	if (tail_len >= 4) {
+		hash ^= (uint64_t)hash_read32(tail) * XXH_PRIME1;
+		hash = hash_rotl64(hash, 23) * XXH_PRIME2 + XXH_PRIME3;
+		tail += 4;
+		tail_len -= 4;
+	}
+	for (; tail_len > 0; ++tail, --tail_len) {
+		hash ^= *tail * XXH_PRIME5;
+		hash = hash_rotl64(hash, 11) * XXH_PRIME1;
+	}
+	hash ^= hash >> 33;
+	hash *= XXH_PRIME2;
+	hash ^= hash >> 29;
+	hash *= XXH_PRIME3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+/**
+ * INTERNAL: Advance a CRC-32C register over a buffer, with the fastest
+ * available kernel. The register is the CRC without its initial and final
+ * inversion.
+ */
+static uint32_t crc32c_raw(uint32_t state, const unsigned char* ptr, size_t len) {
+#if defined(WYZYRDRY_X86) && defined(__x86_64__)
+	if (cpu_has(CPU_SSE42 | CPU_PCLMUL)) {
+		return crc32c_pclmul_raw(state, ptr, len);
+	}
+	if (cpu_has(CPU_SSE42)) {
+		return crc32c_sse42_raw(state, ptr, len);
+	}
+#endif
+	return crc32c_table_raw(state, ptr, len);
+}
+
+/**
+ * INTERNAL: Build the slicing-by-8 tables. Each `table[k][n]` is the CRC
+ * register contribution of byte `n` followed by `k` zero bytes.
+ */
+static void crc32c_init_table(void) {
+	for (uint32_t n = 0; n < 256; ++n) {
+		uint32_t crc = n;
+		for (int bit = 0; bit < 8; ++bit) {
+			crc = crc & 1 ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+		}
+		crc32c_table[0][n] = crc;
+	}
+	for (uint32_t n = 0; n < 256; ++n) {
+		for (int k = 1; k < 8; ++k) {
+			uint32_t prev = crc32c_table[k - 1][n];
+			crc32c_table[k][n] = (prev >> 8) ^ crc32c_table[0][prev & 0xFF];
+		}
+	}
+#ifdef __GNUC__
+	__atomic_store_n(&crc32c_table_ready, 1, __ATOMIC_RELEASE);
+#else
+	crc32c_table_ready = 1;
+#endif
+}
+
+/**
+ * INTERNAL: Portable CRC-32C, consuming eight bytes per step through eight
+ * lookup tables.
+ */
+static uint32_t crc32c_table_raw(
+	uint32_t state,
+	const unsigned char* ptr,
+	size_t len
+) {
+#ifdef __GNUC__
+	if (!__atomic_load_n(&crc32c_table_ready, __ATOMIC_ACQUIRE)) {
+#else
+	if (!crc32c_table_ready) {
+#endif
+		crc32c_init_table();
+	}
+	for (; len >= 8; ptr += 8, len -= 8) {
+		uint32_t lo = state ^ hash_read32(ptr);
+		uint32_t hi = hash_read32(ptr + 4);
+		state = crc32c_table[7][lo & 0xFF]
+			^ crc32c_table[6][(lo >> 8) & 0xFF]
+			^ crc32c_table[5][(lo >> 16) & 0xFF]
+			^ crc32c_table[4][lo >> 24]
+			^ crc32c_table[3][hi & 0xFF]
+			^ crc32c_table[2][(hi >> 8) & 0xFF]
+			^ crc32c_table[1][(hi >> 16) & 0xFF]
+			^ crc32c_table[0][hi >> 24];
+	}
+	for (; len > 0; ++ptr, --len) {
+		state = (state >> 8) ^ crc32c_table[0][(state ^ *ptr) & 0xFF];
+	}
+	return state;
+}
+
+/**
+ * INTERNAL: Multiply two polynomials modulo the CRC-32C polynomial, in the
+ * bit-reflected representation.
+ */
+static uint32_t crc32c_multmodp(uint32_t a, uint32_t b) {
+	uint32_t m = 1u << 31;
+	uint32_t p = 0;
+	for (;;) {
+		if (a & m) {
+			p ^= b;
+			if ((a & (m - 1)) == 0) {
+				break;
+			}
+		}
+		m >>= 1;
+		b = b & 1 ? (b >> 1) ^ CRC32C_POLY : b >> 1;
+	}
+	return p;
+}
+
+/**
+ * INTERNAL: Compute x^n modulo the CRC-32C polynomial, bit-reflected, by
+ * repeated squaring. Multiplying a CRC register by x^(8k) advances it past k
+ * zero bytes.
+ */
+static uint32_t crc32c_xpow(uint64_t n) {
+	uint32_t ret = 1u << 31;
+	uint32_t square = 1u << 30;
+	while (n != 0) {
+		if (n & 1) {
+			ret = crc32c_multmodp(square, ret);
+		}
+		square = crc32c_multmodp(square, square);
+		n >>= 1;
+	}
+	return ret;
+}
+
+#if defined(WYZYRDRY_X86) && defined(__x86_64__)
+
+/**
+ * INTERNAL: CRC-32C with the SSE4.2 `crc32` instruction, eight bytes at a time.
+ */
+WYZYRDRY_TARGET("sse4.2")
+static uint32_t crc32c_sse42_raw(
+	uint32_t state,
+	const unsigned char* ptr,
+	size_t len
+) {
+	uint64_t crc = state;
+	for (; len >= 8; ptr += 8, len -= 8) {
+		uint64_t word;
+		memcpy(&word, ptr, 8);
+		crc = _mm_crc32_u64(crc, word);
+	}
+	for (; len > 0; ++ptr, --len) {
+		crc = _mm_crc32_u8((uint32_t)crc, *ptr);
+	}
+	return (uint32_t)crc;
+}
+
+/**
+ * INTERNAL: Run the `crc32` instruction over three adjacent blocks at once, and
+ * fold the results into one register.
+ *
+ * `crc32` has a latency of three cycles but a throughput of one, so three
+ * independent chains keep it busy. The first two chains are then shifted past
+ * the blocks that follow them: a carry-less multiply by x^(8n - 33) and a
+ * `crc32` reduction of the product together multiply by x^(8n).
+ * @param state The register before the first block.
+ * @param ptr The start of the first block.
+ * @param block The length of each block. It must be a multiple of eight.
+ * @param shift2 x^(8 * 2 * block - 33), to shift past two blocks.
+ * @param shift1 x^(8 * block - 33), to shift past one block.
+ * @return The register after the third block.
+ */
+WYZYRDRY_TARGET("sse4.2,pclmul")
+static inline uint32_t crc32c_fold3(
+	uint32_t state,
+	const unsigned char* ptr,
+	size_t block,
+	uint32_t shift2,
+	uint32_t shift1
+) {
+	uint64_t a = state;
+	uint64_t b = 0;
+	uint64_t c = 0;
+	for (size_t idx = 0; idx < block; idx += 8) {
+		uint64_t wa;
+		uint64_t wb;
+		uint64_t wc;
+		memcpy(&wa, &ptr[idx], 8);
+		memcpy(&wb, &ptr[block + idx], 8);
+		memcpy(&wc, &ptr[2 * block + idx], 8);
+		a = _mm_crc32_u64(a, wa);
+		b = _mm_crc32_u64(b, wb);
+		c = _mm_crc32_u64(c, wc);
+	}
+	__m128i pa = _mm_clmulepi64_si128(
+		_mm_cvtsi32_si128((int)a),
+		_mm_cvtsi32_si128((int)shift2),
+		0
+	);
+	__m128i pb = _mm_clmulepi64_si128(
+		_mm_cvtsi32_si128((int)b),
+		_mm_cvtsi32_si128((int)shift1),
+		0
+	);
+	uint64_t folded = (uint64_t)_mm_cvtsi128_si64(_mm_xor_si128(pa, pb));
+	return (uint32_t)_mm_crc32_u64(0, folded) ^ (uint32_t)c;
+}
+
+/**
+ * INTERNAL: CRC-32C over three parallel streams, folded with PCLMUL. Inputs too
+ * short to split finish on a single stream.
+ */
+WYZYRDRY_TARGET("sse4.2,pclmul")
+static uint32_t crc32c_pclmul_raw(
+	uint32_t state,
+	const unsigned char* ptr,
+	size_t len
+) {
+	/* Computed once; racing threads compute and store the same values. */
+	static uint32_t shifts[4];
+	static int shifts_ready = 0;
+	if (len >= 3 * CRC32C_SHORT && !__atomic_load_n(&shifts_ready, __ATOMIC_ACQUIRE)) {
+		shifts[0] = crc32c_xpow(8 * 2 * CRC32C_LONG - 33);
+		shifts[1] = crc32c_xpow(8 * CRC32C_LONG - 33);
+		shifts[2] = crc32c_xpow(8 * 2 * CRC32C_SHORT - 33);
+		shifts[3] = crc32c_xpow(8 * CRC32C_SHORT - 33);
+		__atomic_store_n(&shifts_ready, 1, __ATOMIC_RELEASE);
+	}
+	for (; len >= 3 * CRC32C_LONG; ptr += 3 * CRC32C_LONG, len -= 3 * CRC32C_LONG) {
+		state = crc32c_fold3(state, ptr, CRC32C_LONG, shifts[0], shifts[1]);
+	}
+	for (; len >= 3 * CRC32C_SHORT; ptr += 3 * CRC32C_SHORT, len -= 3 * CRC32C_SHORT) {
+		state = crc32c_fold3(state, ptr, CRC32C_SHORT, shifts[2], shifts[3]);
+	}
+	return crc32c_sse42_raw(state, ptr, len);
+}
+
+#endif
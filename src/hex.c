@@ -0,0 +1,342 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <wyzyrdry.h>
+
+#ifdef WYZYRDRY_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * The longest line a dump can produce: a sixteen-digit offset, a separator,
+ * eight groups of four digits and a space, a space, sixteen characters, and a
+ * newline.
+ */
+#define HEX_LINE_MAX 80
+
+/**
+ * The number of dump lines that are formatted before being written out.
+ */
+#define HEX_DUMP_BATCH 64
+
+static const char hex_digits[16] = "0123456789ABCDEF";
+
+static void hex_encode_raw(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len
+);
+static void hex_encode_scalar(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len
+);
+#ifdef WYZYRDRY_X86
+static void hex_encode_ssse3(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len
+);
+static void hex_encode_avx2(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len
+);
+#endif
+static size_t hex_dump_line(
+	unsigned char* line,
+	const unsigned char* src,
+	size_t len,
+	size_t offset,
+	int digits
+);
+static int hex_offset_digits(size_t end);
+
+/**
+ * Append the hexadecimal encoding of a Slice to a Vec.
+ *
+ * If the Vec cannot grow to hold the text, it is left unchanged.
+ * @param dst The Vec to receive two characters per source byte.
+ * @param src The bytes to encode.
+ */
+void hex_encode(Vec* const dst, const Slice src) {
+	if (!vec_reserve(dst, 2 * src.len)) {
+		return;
+	}
+	hex_encode_raw(&dst->buf[dst->len], src.ptr, src.len);
+	dst->len += 2 * src.len;
+}
+
+/**
+ * Write the hexadecimal encoding of a Slice into a pre-existing buffer.
+ * @param dst The buffer to receive two characters per source byte.
+ * @param src The bytes to encode.
+ * @return The number of characters written, or zero if `dst` is too small.
+ */
+size_t hex_encode_into(const Slice dst, const Slice src) {
+	if (dst.len < 2 * src.len) {
+		return 0;
+	}
+	hex_encode_raw(dst.ptr, src.ptr, src.len);
+	return 2 * src.len;
+}
+
+/**
+ * Decode hexadecimal text, appending the bytes to a Vec.
+ *
+ * On failure, the Vec's length is unchanged.
+ * @param dst The Vec to receive one byte per two source characters.
+ * @param src The text to decode.
+ * @return Ok with the number of bytes appended, or Err with the index of the
+ * first character that could not be decoded.
+ */
+HexResult hex_decode(Vec* const dst, const Slice src) {
+	if (!vec_reserve(dst, src.len / 2)) {
+		return SET_VARIANT(HexResult, Err, 0);
+	}
+	Slice spare = slice_new(&dst->buf[dst->len], dst->cap - dst->len);
+	HexResult ret = hex_decode_into(spare, src);
+	if (GET_VARIANT_TYPE(ret) == ENUM_VAR(HexResult, Ok)) {
+		dst->len += GET_VARIANT_BODY(ret, Ok);
+	}
+	return ret;
+}
+
+/**
+ * Decode hexadecimal text into a pre-existing buffer.
+ * @param dst The buffer to receive one byte per two source characters.
+ * @param src The text to decode.
+ * @return Ok with the number of bytes written, or Err with the index of the
+ * first character that could not be decoded. If `dst` is too small, this is the
+ * first character whose byte did not fit.
+ */
+HexResult hex_decode_into(const Slice dst, const Slice src) {
+	size_t pairs = src.len / 2;
+	for (size_t idx = 0; idx < pairs; ++idx) {
+		if (idx == dst.len) {
+			return SET_VARIANT(HexResult, Err, 2 * idx);
+		}
+		unsigned char hi = src.ptr[2 * idx];
+		unsigned char lo = src.ptr[2 * idx + 1];
+		/* Fold letters to lowercase; digits are unaffected by bit 5. */
+		unsigned int vh = (unsigned int)hi - '0';
+		unsigned int vl = (unsigned int)lo - '0';
+		if (vh > 9) {
+			vh = (unsigned int)(hi | 0x20) - 'a';
+			if (vh > 5) {
+				return SET_VARIANT(HexResult, Err, 2 * idx);
+			}
+			vh += 10;
+		}
+		if (vl > 9) {
+			vl = (unsigned int)(lo | 0x20) - 'a';
+			if (vl > 5) {
+				return SET_VARIANT(HexResult, Err, 2 * idx + 1);
+			}
+			vl += 10;
+		}
+		dst.ptr[idx] = (unsigned char)(vh << 4 | vl);
+	}
+	if (src.len % 2 != 0) {
+		return SET_VARIANT(HexResult, Err, src.len - 1);
+	}
+	return SET_VARIANT(HexResult, Ok, pairs);
+}
+
+/**
+ * Write a Slice to a stream as an `xxd`-style dump.
+ *
+ * Each line holds the offset of its first byte, sixteen bytes in hexadecimal,
+ * and the same bytes as ASCII with unprintable bytes shown as `.`. Lines are
+ * formatted into a local buffer and written out in batches, so the stream sees
+ * one `fwrite()` per batch of whole lines.
+ * @param out The stream to write.
+ * @param src The bytes to dump.
+ * @param offset The offset to label the first byte with.
+ */
+void hex_dump(FILE* const out, const Slice src, size_t offset) {
+	unsigned char buf[HEX_DUMP_BATCH * HEX_LINE_MAX];
+	size_t used = 0;
+	int digits = hex_offset_digits(offset + src.len);
+	for (size_t idx = 0; idx < src.len; idx += HEX_DUMP_WIDTH) {
+		if (used + HEX_LINE_MAX > sizeof(buf)) {
+			fwrite(buf, 1, used, out);
+			used = 0;
+		}
+		size_t len = src.len - idx < HEX_DUMP_WIDTH ? src.len - idx : HEX_DUMP_WIDTH;
+		used += hex_dump_line(&buf[used], &src.ptr[idx], len, offset + idx, digits);
+	}
+	if (used > 0) {
+		fwrite(buf, 1, used, out);
+	}
+}
+
+/**
+ * Append an `xxd`-style dump of a Slice to a Vec, in the format produced by
+ * `hex_dump()`.
+ *
+ * If the Vec cannot grow to hold the text, it is left unchanged.
+ * @param dst The Vec to receive the dump text.
+ * @param src The bytes to dump.
+ * @param offset The offset to label the first byte with.
+ */
+void hex_dump_vec(Vec* const dst, const Slice src, size_t offset) {
+	size_t lines = (src.len + HEX_DUMP_WIDTH - 1) / HEX_DUMP_WIDTH;
+	if (!vec_reserve(dst, lines * HEX_LINE_MAX)) {
+		return;
+	}
+	int digits = hex_offset_digits(offset + src.len);
+	for (size_t idx = 0; idx < src.len; idx += HEX_DUMP_WIDTH) {
+		size_t len = src.len - idx < HEX_DUMP_WIDTH ? src.len - idx : HEX_DUMP_WIDTH;
+		dst->len += hex_dump_line(&dst->buf[dst->len], &src.ptr[idx], len, offset + idx, digits);
+	}
+}
+
+/**
+ * INTERNAL: Format one line of a dump.
+ * @param line The buffer to receive the line. It must hold `HEX_LINE_MAX`
+ * bytes.
+ * @param src The bytes to show on this line.
+ * @param len The number of bytes to show, at most `HEX_DUMP_WIDTH`.
+ * @param offset The offset label of the line.
+ * @param digits The number of hexadecimal digits in the offset label.
+ * @return The length of the line, including its newline.
+ */
+static size_t hex_dump_line(
+	unsigned char* line,
+	const unsigned char* src,
+	size_t len,
+	size_t offset,
+	int digits
+) {
+	unsigned char hex[2 * HEX_DUMP_WIDTH];
+	size_t pos = 0;
+	for (int shift = 4 * (digits - 1); shift >= 0; shift -= 4) {
+		line[pos++] = hex_digits[(offset >> shift) & 0xF];
+	}
+	line[pos++] = ':';
+	line[pos++] = ' ';
+	hex_encode_raw(hex, src, len);
+	/* Pad a short final line so that its ASCII column lines up. */
+	memset(&hex[2 * len], ' ', 2 * (HEX_DUMP_WIDTH - len));
+	for (size_t idx = 0; idx < 2 * HEX_DUMP_WIDTH; idx += 4) {
+		memcpy(&line[pos], &hex[idx], 4);
+		pos += 4;
+		line[pos++] = ' ';
+	}
+	line[pos++] = ' ';
+	for (size_t idx = 0; idx < len; ++idx) {
+		unsigned char c = src[idx];
+		line[pos++] = c >= ' ' && c <= '~' ? c : '.';
+	}
+	line[pos++] = '\n';
+	return pos;
+}
+
+/**
+ * INTERNAL: Choose the width of the offset labels for a dump, so that every
+ * label in it has the same width.
+ * @param end The offset one past the final byte of the dump.
+ * @return Eight digits, or sixteen if an offset will not fit in eight.
+ */
+static int hex_offset_digits(size_t end) {
+	return (unsigned long long)end > 0xFFFFFFFFULL ? 16 : 8;
+}
+
+/**
+ * INTERNAL: Encode bytes as hexadecimal, using the fastest available kernel.
+ * @param dst A buffer of at least `2 * len` bytes.
+ * @param src A buffer of `len` bytes.
+ * @param len The number of bytes to encode.
+ */
+static void hex_encode_raw(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len
+) {
+#ifdef WYZYRDRY_X86
+	if (len >= 16) {
+		if (cpu_has(CPU_AVX2)) {
+			hex_encode_avx2(dst, src, len);
+			return;
+		}
+		if (cpu_has(CPU_SSSE3)) {
+			hex_encode_ssse3(dst, src, len);
+			return;
+		}
+	}
+#endif
+	hex_encode_scalar(dst, src, len);
+}
+
+/**
+ * INTERNAL: Portable hexadecimal encoder.
+ */
+static void hex_encode_scalar(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len
+) {
+	for (size_t idx = 0; idx < len; ++idx) {
+		dst[2 * idx] = hex_digits[src[idx] >> 4];
+		dst[2 * idx + 1] = hex_digits[src[idx] & 0xF];
+	}
+}
+
+#ifdef WYZYRDRY_X86
+
+/**
+ * INTERNAL: SSSE3 hexadecimal encoder. Each nibble indexes the digit table
+ * with `pshufb`, and the high and low nibbles are interleaved into digit pairs.
+ */
+WYZYRDRY_TARGET("ssse3")
+static void hex_encode_ssse3(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len
+) {
+	const __m128i lut = _mm_loadu_si128((const __m128i*)hex_digits);
+	const __m128i low = _mm_set1_epi8(0x0F);
+	size_t idx = 0;
+	for (; idx + 16 <= len; idx += 16) {
+		__m128i in = _mm_loadu_si128((const __m128i*)&src[idx]);
+		__m128i hi = _mm_and_si128(_mm_srli_epi16(in, 4), low);
+		__m128i lo = _mm_and_si128(in, low);
+		__m128i first = _mm_shuffle_epi8(lut, _mm_unpacklo_epi8(hi, lo));
+		__m128i second = _mm_shuffle_epi8(lut, _mm_unpackhi_epi8(hi, lo));
+		_mm_storeu_si128((__m128i*)&dst[2 * idx], first);
+		_mm_storeu_si128((__m128i*)&dst[2 * idx + 16], second);
+	}
+	hex_encode_scalar(&dst[2 * idx], &src[idx], len - idx);
+}
+
+/**
+ * INTERNAL: AVX2 hexadecimal encoder. Each source byte is widened to sixteen
+ * bits, which places its high nibble in the first output byte and its low
+ * nibble in the second without needing a cross-lane interleave.
+ */
+WYZYRDRY_TARGET("avx2")
+static void hex_encode_avx2(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len
+) {
+	const __m256i lut = _mm256_broadcastsi128_si256(
+		_mm_loadu_si128((const __m128i*)hex_digits)
+	);
+	const __m256i low = _mm256_set1_epi8(0x0F);
+	size_t idx = 0;
+	for (; idx + 16 <= len; idx += 16) {
+		__m128i in = _mm_loadu_si128((const __m128i*)&src[idx]);
+		__m256i wide = _mm256_cvtepu8_epi16(in);
+		__m256i nibs = _mm256_or_si256(
+			_mm256_srli_epi16(wide, 4),
+			_mm256_slli_epi16(wide, 8)
+		);
+		nibs = _mm256_and_si256(nibs, low);
+		_mm256_storeu_si256((__m256i*)&dst[2 * idx], _mm256_shuffle_epi8(lut, nibs));
+	}
+	hex_encode_scalar(&dst[2 * idx], &src[idx], len - idx);
+}
+
+#endif
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <wyzyrdry.h>
+
+/**
+ * The number of buckets that split each power of two.
+ */
+#define HIST_HALF (1 << (HIST_SUB_BITS - 1))
+
+static size_t hist_index(uint64_t value);
+static uint64_t hist_highest(size_t idx);
+
+/**
+ * Empty a histogram.
+ * @param self The `Hist` to be initialized.
+ */
+void hist_init(Hist* const self) {
+	memset(self, 0, sizeof(*self));
+	self->min = UINT64_MAX;
+}
+
+/**
+ * Count one value.
+ * @param self The `Hist` on which to act.
+ * @param value The value to be counted.
+ */
+void hist_record(Hist* const self, uint64_t value) {
+	++self->counts[hist_index(value)];
+	++self->total;
+	self->sum += value;
+	if (value < self->min) {
+		self->min = value;
+	}
+	if (value > self->max) {
+		self->max = value;
+	}
+}
+
+/**
+ * Add the counts of one histogram into another, as if every value recorded in
+ * `other` had also been recorded in `self`.
+ * @param self The `Hist` that receives the counts.
+ * @param other The `Hist` whose counts are added. It is not changed.
+ */
+void hist_merge(Hist* const self, const Hist* const other) {
+	for (size_t idx = 0; idx < HIST_BUCKETS; ++idx) {
+		self->counts[idx] += other->counts[idx];
+	}
+	self->total += other->total;
+	self->sum += other->sum;
+	if (other->min < self->min) {
+		self->min = other->min;
+	}
+	if (other->max > self->max) {
+		self->max = other->max;
+	}
+}
+
+/**
+ * Find the value below which some percentage of the recorded values fall.
+ *
+ * The answer is the largest value that shares a bucket with the value at that
+ * rank, so it never understates it, and is no more than the largest value
+ * recorded.
+ * @param self The `Hist` to inspect.
+ * @param pct The percentage, from 0 to 100.
+ * @return The value at that percentile, or zero if the histogram is empty.
+ */
+uint64_t hist_percentile(const Hist* const self, double pct) {
+	if (self->total == 0) {
+		return 0;
+	}
+	if (pct <= 0.0) {
+		return self->min;
+	}
+	if (pct >= 100.0) {
+		return self->max;
+	}
+	/* The rank of the value sought, counting from one. */
+	double want = pct / 100.0 * (double)self->total;
+	uint64_t rank = (uint64_t)want;
+	if ((double)rank < want || rank == 0) {
+		++rank;
+	}
+	uint64_t seen = 0;
+	for (size_t idx = 0; idx < HIST_BUCKETS; ++idx) {
+		seen += self->counts[idx];
+		if (seen >= rank) {
+			uint64_t ret = hist_highest(idx);
+			return ret < self->max ? ret : self->max;
+		}
+	}
+	return self->max;
+}
+
+/**
+ * Calculate the mean of the recorded values.
+ * @param self The `Hist` to inspect.
+ * @return The mean, or zero if the histogram is empty.
+ */
+double hist_mean(const Hist* const self) {
+	if (self->total == 0) {
+		return 0.0;
+	}
+	return (double)self->sum / (double)self->total;
+}
+
+/**
+ * Display a summary of the histogram for debugging purposes.
+ * @param self
+ */
+void hist_debug_print(const Hist* const self) {
+	printf(
+		"Hist { total: %llu, min: %llu, mean: %.1f, p50: %llu, p99: %llu, p99.9: %llu, max: %llu }\n",
+		(unsigned long long)self->total,
+		(unsigned long long)(self->total > 0 ? self->min : 0),
+		hist_mean(self),
+		(unsigned long long)hist_percentile(self, 50.0),
+		(unsigned long long)hist_percentile(self, 99.0),
+		(unsigned long long)hist_percentile(self, 99.9),
+		(unsigned long long)self->max
+	);
+}
+
+/**
+ * INTERNAL: Find the bucket that counts a value.
+ *
+ * Small values are their own index. Otherwise the value is shifted right until
+ * only its top `HIST_SUB_BITS` bits remain, which lie in `[HIST_HALF,
+ * 2 * HIST_HALF)`, and the shift selects the power of two.
+ * @param value The value to be counted.
+ * @return The index of its bucket.
+ */
+static size_t hist_index(uint64_t value) {
+	if (value < 2 * HIST_HALF) {
+		return (size_t)value;
+	}
+	unsigned int shift = (unsigned int)(63 - __builtin_clzll(value)) - (HIST_SUB_BITS - 1);
+	return (size_t)shift * HIST_HALF + (size_t)(value >> shift);
+}
+
+/**
+ * INTERNAL: Find the largest value counted by a bucket.
+ * @param idx The index of the bucket.
+ * @return The largest value that `hist_index()` maps to it.
+ */
+static uint64_t hist_highest(size_t idx) {
+	if (idx < 2 * HIST_HALF) {
+		return (uint64_t)idx;
+	}
+	unsigned int shift = (unsigned int)(idx / HIST_HALF) - 1;
+	uint64_t sub = (uint64_t)(idx - (size_t)shift * HIST_HALF);
+	return ((sub + 1) << shift) - 1;
+}
@@ -0,0 +1,217 @@
+#include <pthread.h>
+#include <string.h>
+
+#include <wyzyrdry.h>
+
+#ifdef WYZYRDRY_INSTRUMENT
+
+/**
+ * Every call site that has been used, by id.
+ */
+static const InstrumentSite* instrument_sites[INSTRUMENT_SITES_MAX];
+static int instrument_sites_len = 0;
+static pthread_mutex_t instrument_sites_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * The calling thread's counters, by site id. The last entry is shared by the
+ * sites that did not get an id of their own.
+ */
+static __thread InstrumentCounts instrument_counts[INSTRUMENT_SITES_MAX + 1];
+
+static InstrumentTrace instrument_trace = NULL;
+static void* instrument_trace_ctx = NULL;
+
+static InstrumentCounts* instrument_site_counts(InstrumentSite* const site);
+static void instrument_emit(
+	InstrumentEvent event,
+	const InstrumentSite* site,
+	const void* ptr,
+	size_t len
+);
+static void instrument_add(InstrumentCounts* const sum, const InstrumentCounts* const add);
+
+/**
+ * Copy the calling thread's counters.
+ * @param out Receives the counters of every site this thread has used, and
+ * their total.
+ */
+void instrument_snapshot(InstrumentSnapshot* const out) {
+	memset(&out->total, 0, sizeof(out->total));
+	out->sites_len = 0;
+	int len = __atomic_load_n(&instrument_sites_len, __ATOMIC_ACQUIRE);
+	for (int idx = 0; idx <= INSTRUMENT_SITES_MAX; ++idx) {
+		if (idx >= len && idx < INSTRUMENT_SITES_MAX) {
+			continue;
+		}
+		const InstrumentCounts* counts = &instrument_counts[idx];
+		if (counts->allocs + counts->reallocs + counts->frees + counts->copies == 0) {
+			continue;
+		}
+		out->sites[out->sites_len].site = idx < INSTRUMENT_SITES_MAX ? instrument_sites[idx] : NULL;
+		out->sites[out->sites_len].counts = *counts;
+		++out->sites_len;
+		instrument_add(&out->total, counts);
+	}
+}
+
+/**
+ * Sum the counters of one module's sites.
+ * @param snap A snapshot from `instrument_snapshot()`.
+ * @param module The name of the module, such as "vec".
+ * @return The module's counters.
+ */
+InstrumentCounts instrument_module(
+	const InstrumentSnapshot* const snap,
+	const char* module
+) {
+	InstrumentCounts ret;
+	memset(&ret, 0, sizeof(ret));
+	for (size_t idx = 0; idx < snap->sites_len; ++idx) {
+		const InstrumentSite* site = snap->sites[idx].site;
+		if (site != NULL && strcmp(site->module, module) == 0) {
+			instrument_add(&ret, &snap->sites[idx].counts);
+		}
+	}
+	return ret;
+}
+
+/**
+ * Zero the calling thread's counters.
+ */
+void instrument_reset(void) {
+	memset(instrument_counts, 0, sizeof(instrument_counts));
+}
+
+/**
+ * Install a function to be told of every instrumented event, or remove it.
+ *
+ * The callback is shared by all threads, and should be installed before other
+ * threads use the library. It must not call instrumented functions itself.
+ * @param trace The function, or NULL to stop tracing.
+ * @param ctx Passed to every call of `trace`.
+ */
+void instrument_set_trace(InstrumentTrace trace, void* ctx) {
+	__atomic_store_n(&instrument_trace_ctx, ctx, __ATOMIC_RELAXED);
+	__atomic_store_n(&instrument_trace, trace, __ATOMIC_RELEASE);
+}
+
+/**
+ * Counted `malloc()`. Use `INSTRUMENT_MALLOC()`, which supplies the site.
+ */
+void* instrument_malloc(InstrumentSite* const site, size_t size) {
+	void* ret = malloc(size);
+	InstrumentCounts* counts = instrument_site_counts(site);
+	++counts->allocs;
+	counts->bytes_allocated += size;
+	instrument_emit(INSTRUMENT_ALLOC, site, ret, size);
+	return ret;
+}
+
+/**
+ * Counted `realloc()`. Use `INSTRUMENT_REALLOC()`, which supplies the site.
+ */
+void* instrument_realloc(InstrumentSite* const site, void* ptr, size_t size) {
+	void* ret = realloc(ptr, size);
+	InstrumentCounts* counts = instrument_site_counts(site);
+	++counts->reallocs;
+	counts->bytes_allocated += size;
+	instrument_emit(INSTRUMENT_REALLOC, site, ret, size);
+	return ret;
+}
+
+/**
+ * Counted `free()`. Use `INSTRUMENT_FREE()`, which supplies the site.
+ */
+void instrument_free(InstrumentSite* const site, void* ptr) {
+	free(ptr);
+	++instrument_site_counts(site)->frees;
+	instrument_emit(INSTRUMENT_FREE, site, ptr, 0);
+}
+
+/**
+ * Counted `memcpy()`. Use `INSTRUMENT_COPY()`, which supplies the site.
+ */
+void* instrument_copy(
+	InstrumentSite* const site,
+	void* dst,
+	const void* src,
+	size_t len
+) {
+	memcpy(dst, src, len);
+	InstrumentCounts* counts = instrument_site_counts(site);
+	++counts->copies;
+	counts->bytes_copied += len;
+	instrument_emit(INSTRUMENT_COPY, site, dst, len);
+	return dst;
+}
+
+/**
+ * Counted `memmove()`. Use `INSTRUMENT_MOVE()`, which supplies the site.
+ */
+void* instrument_move(
+	InstrumentSite* const site,
+	void* dst,
+	const void* src,
+	size_t len
+) {
+	memmove(dst, src, len);
+	InstrumentCounts* counts = instrument_site_counts(site);
+	++counts->copies;
+	counts->bytes_copied += len;
+	instrument_emit(INSTRUMENT_COPY, site, dst, len);
+	return dst;
+}
+
+/**
+ * INTERNAL: Find the calling thread's counters for a site, giving the site an
+ * id the first time any thread uses it.
+ * @param site The call site.
+ * @return The counters.
+ */
+static InstrumentCounts* instrument_site_counts(InstrumentSite* const site) {
+	int id = __atomic_load_n(&site->id, __ATOMIC_ACQUIRE);
+	if (id < 0) {
+		pthread_mutex_lock(&instrument_sites_lock);
+		id = site->id;
+		if (id < 0) {
+			id = INSTRUMENT_SITES_MAX;
+			if (instrument_sites_len < INSTRUMENT_SITES_MAX) {
+				id = instrument_sites_len;
+				instrument_sites[id] = site;
+				__atomic_store_n(&instrument_sites_len, id + 1, __ATOMIC_RELEASE);
+			}
+			__atomic_store_n(&site->id, id, __ATOMIC_RELEASE);
+		}
+		pthread_mutex_unlock(&instrument_sites_lock);
+	}
+	return &instrument_counts[id];
+}
+
+/**
+ * INTERNAL: Pass an event to the trace callback, if one is installed.
+ */
+static void instrument_emit(
+	InstrumentEvent event,
+	const InstrumentSite* site,
+	const void* ptr,
+	size_t len
+) {
+	InstrumentTrace trace = __atomic_load_n(&instrument_trace, __ATOMIC_ACQUIRE);
+	if (trace != NULL) {
+		trace(event, site, ptr, len, __atomic_load_n(&instrument_trace_ctx, __ATOMIC_RELAXED));
+	}
+}
+
+/**
+ * INTERNAL: Add one set of counters to another.
+ */
+static void instrument_add(InstrumentCounts* const sum, const InstrumentCounts* const add) {
+	sum->allocs += add->allocs;
+	sum->reallocs += add->reallocs;
+	sum->frees += add->frees;
+	sum->bytes_allocated += add->bytes_allocated;
+	sum->copies += add->copies;
+	sum->bytes_copied += add->bytes_copied;
+}
+
+#endif
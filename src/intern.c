@@ -0,0 +1,144 @@
+#include <stdlib.h>
+
+#include <wyzyrdry.h>
+
+static InternShard* interner_shard(Interner* const self, uint64_t hash);
+
+/**
+ * Initialize an Interner with no values.
+ * @param self The Interner to initialize.
+ * @return true on success, or false if a lock could not be created, in which
+ * case the Interner must not be used.
+ */
+bool interner_init(Interner* const self) {
+	for (size_t idx = 0; idx < INTERN_SHARDS; ++idx) {
+		if (pthread_rwlock_init(&self->shards[idx].lock, NULL) != 0) {
+			while (idx-- > 0) {
+				pthread_rwlock_destroy(&self->shards[idx].lock);
+			}
+			return false;
+		}
+		self->shards[idx].map = map_init(0, MAP_BORROW_KEYS);
+	}
+	return true;
+}
+
+/**
+ * Deallocate an Interner and every `Str` it handed out.
+ *
+ * No other thread may be using the Interner, and every interned `Str*` becomes
+ * invalid.
+ * @param self The Interner on which to act.
+ */
+void interner_free(Interner* const self) {
+	for (size_t idx = 0; idx < INTERN_SHARDS; ++idx) {
+		InternShard* shard = &self->shards[idx];
+		size_t cursor = 0;
+		MapEntry entry;
+		while (map_next(&shard->map, &cursor, &entry)) {
+			str_free(entry.value);
+		}
+		map_free(&shard->map);
+		pthread_rwlock_destroy(&shard->lock);
+	}
+}
+
+/**
+ * Get the canonical `Str` holding some bytes, creating it if this is the first
+ * time they have been interned.
+ *
+ * Interning bytes that are already present allocates nothing. This may be
+ * called from any number of threads at once.
+ * @param self The Interner on which to act.
+ * @param value The bytes to intern.
+ * @return The canonical `Str` for these bytes, or NULL if they are longer than
+ * `STR_MAX_LEN` or allocation failed.
+ */
+Str* interner_intern(Interner* const self, const Slice value) {
+	if (value.len > STR_MAX_LEN) {
+		return NULL;
+	}
+	uint64_t hash = map_hash(value);
+	InternShard* shard = interner_shard(self, hash);
+
+	pthread_rwlock_rdlock(&shard->lock);
+	void** found = map_get_hashed(&shard->map, value, hash);
+	Str* ret = found == NULL ? NULL : *found;
+	pthread_rwlock_unlock(&shard->lock);
+	if (ret != NULL) {
+		return ret;
+	}
+
+	/*
+	 * Build the Str before taking the exclusive lock, so that other threads
+	 * are not held up by the allocation. If another thread interns the same
+	 * bytes in the meantime, its Str wins and this one is discarded.
+	 */
+	Str* fresh = str_from_slice(value);
+	if (fresh == NULL) {
+		return NULL;
+	}
+	bool inserted = false;
+	pthread_rwlock_wrlock(&shard->lock);
+	void** slot = map_entry_hashed(&shard->map, str_as_slice(fresh), hash, &inserted);
+	if (slot != NULL && inserted) {
+		*slot = fresh;
+	}
+	ret = slot == NULL ? NULL : *slot;
+	pthread_rwlock_unlock(&shard->lock);
+	if (ret != fresh) {
+		str_free(fresh);
+	}
+	return ret;
+}
+
+/**
+ * Get the canonical `Str` holding some bytes, if they have been interned.
+ *
+ * This never allocates, and may be called from any number of threads at once.
+ * @param self The Interner on which to act.
+ * @param value The bytes to look up.
+ * @return The canonical `Str` for these bytes, or NULL if they have not been
+ * interned.
+ */
+Str* interner_find(Interner* const self, const Slice value) {
+	uint64_t hash = map_hash(value);
+	InternShard* shard = interner_shard(self, hash);
+	pthread_rwlock_rdlock(&shard->lock);
+	void** found = map_get_hashed(&shard->map, value, hash);
+	Str* ret = found == NULL ? NULL : *found;
+	pthread_rwlock_unlock(&shard->lock);
+	return ret;
+}
+
+/**
+ * Count the distinct values interned.
+ *
+ * While other threads are interning, the count is only a snapshot.
+ * @param self The Interner on which to act.
+ * @return The number of canonical `Str`s.
+ */
+size_t interner_len(Interner* const self) {
+	size_t ret = 0;
+	for (size_t idx = 0; idx < INTERN_SHARDS; ++idx) {
+		InternShard* shard = &self->shards[idx];
+		pthread_rwlock_rdlock(&shard->lock);
+		ret += shard->map.len;
+		pthread_rwlock_unlock(&shard->lock);
+	}
+	return ret;
+}
+
+/**
+ * INTERNAL: Choose the shard for a hash.
+ *
+ * The shard is taken from the top bits of the hash, which a shard's own Map
+ * does not use to place entries, so that each Map still sees well-spread
+ * hashes.
+ * @param self The Interner on which to act.
+ * @param hash The result of `map_hash()` on the value.
+ * @return The shard that holds the value, if it is interned.
+ */
+static InternShard* interner_shard(Interner* const self, uint64_t hash) {
+	return &self->shards[(hash >> 56) & (INTERN_SHARDS - 1)];
+}
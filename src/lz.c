@@ -0,0 +1,430 @@
+#include <string.h>
+
+#include <wyzyrdry.h>
+
+/**
+ * The shortest match that is worth a token.
+ */
+#define LZ_MIN_MATCH 4
+
+/**
+ * The format requires the last bytes of a block to be literals, so that the
+ * decoder can copy them without looking for a match.
+ */
+#define LZ_LAST_LITERALS 5
+
+/**
+ * No match may begin within this many bytes of the end of the input.
+ */
+#define LZ_MATCH_LIMIT 12
+
+/**
+ * The greatest distance back that a match can refer to.
+ */
+#define LZ_MAX_OFFSET 65535
+
+/**
+ * The hash table of recent positions has at most `1 << LZ_HASH_BITS` entries.
+ * Short inputs use fewer, so that clearing the table does not dominate.
+ */
+#define LZ_HASH_BITS 12
+
+/**
+ * After `1 << LZ_SKIP_TRIGGER` positions without a match, the search steps
+ * over more bytes at a time, so that incompressible input is passed quickly.
+ */
+#define LZ_SKIP_TRIGGER 6
+
+static uint32_t lz_read32(const unsigned char* src);
+static unsigned lz_hash_bits(size_t len);
+static size_t lz_match_len(
+	const unsigned char* cur,
+	const unsigned char* prev,
+	const unsigned char* end
+);
+static unsigned char* lz_emit(
+	unsigned char* op,
+	const unsigned char* oend,
+	const unsigned char* lit,
+	size_t lit_len,
+	size_t offset,
+	size_t match_len
+);
+static unsigned char* lz_put_length(unsigned char* op, size_t len);
+static void lz_copy8(unsigned char* to, const unsigned char* from, size_t len);
+static bool lz_get_length(const Slice src, size_t* const idx, size_t* const len);
+
+/**
+ * Compute the largest block that compressing some bytes can produce, which is
+ * slightly larger than the input when it does not compress at all.
+ * @param len The number of bytes to be compressed.
+ * @return The size of a buffer that is always large enough.
+ */
+size_t lz_bound(size_t len) {
+	return len + len / 255 + 16;
+}
+
+/**
+ * Append the compressed form of a Slice to a Vec.
+ * @param dst The Vec to receive the block.
+ * @param src The bytes to compress.
+ * @return true on success, or false if the Vec could not grow, in which case it
+ * is unchanged.
+ */
+bool lz_compress(Vec* const dst, const Slice src) {
+	if (!vec_reserve(dst, lz_bound(src.len))) {
+		return false;
+	}
+	dst->len += lz_compress_into(slice_new(&dst->buf[dst->len], dst->cap - dst->len), src);
+	return true;
+}
+
+/**
+ * Compress a Slice into a pre-existing buffer.
+ * @param dst The buffer to receive the block. A buffer of `lz_bound(src.len)`
+ * bytes is always large enough.
+ * @param src The bytes to compress.
+ * @return The number of bytes written, or zero if `dst` is too small. A block
+ * is never empty, so zero is not a valid length.
+ */
+size_t lz_compress_into(const Slice dst, const Slice src) {
+	unsigned char* op = dst.ptr;
+	const unsigned char* oend = dst.ptr + dst.len;
+	const unsigned char* base = src.ptr;
+	size_t anchor = 0;
+	if (src.len > LZ_MATCH_LIMIT) {
+		uint32_t table[1 << LZ_HASH_BITS];
+		unsigned bits = lz_hash_bits(src.len);
+		memset(table, 0, sizeof(table[0]) << bits);
+		const unsigned char* match_end = &base[src.len - LZ_LAST_LITERALS];
+		size_t limit = src.len - LZ_MATCH_LIMIT;
+		size_t misses = 1 << LZ_SKIP_TRIGGER;
+		size_t pos = 1;
+		table[(lz_read32(base) * 2654435761u) >> (32 - bits)] = 0;
+		while (pos < limit) {
+			uint32_t seq = lz_read32(&base[pos]);
+			uint32_t slot = (seq * 2654435761u) >> (32 - bits);
+			size_t cand = table[slot];
+			table[slot] = (uint32_t)pos;
+			if (cand >= pos || pos - cand > LZ_MAX_OFFSET || lz_read32(&base[cand]) != seq) {
+				pos += misses++ >> LZ_SKIP_TRIGGER;
+				continue;
+			}
+			/* Take back any literals that the match also covers. */
+			while (pos > anchor && cand > 0 && base[pos - 1] == base[cand - 1]) {
+				--pos;
+				--cand;
+			}
+			size_t len = LZ_MIN_MATCH + lz_match_len(
+				&base[pos + LZ_MIN_MATCH],
+				&base[cand + LZ_MIN_MATCH],
+				match_end
+			);
+			op = lz_emit(op, oend, &base[anchor], pos - anchor, pos - cand, len);
+			if (op == NULL) {
+				return 0;
+			}
+			pos += len;
+			anchor = pos;
+			misses = 1 << LZ_SKIP_TRIGGER;
+			/* Remember a position inside the match, for the next search. */
+			if (pos < limit) {
+				table[(lz_read32(&base[pos - 2]) * 2654435761u) >> (32 - bits)] = (uint32_t)(pos - 2);
+			}
+		}
+	}
+	op = lz_emit(op, oend, &base[anchor], src.len - anchor, 0, 0);
+	if (op == NULL) {
+		return 0;
+	}
+	return (size_t)(op - dst.ptr);
+}
+
+/**
+ * Append the decompressed contents of a block to a Vec.
+ *
+ * If the block is corrupt, the Vec's length is unchanged, though its capacity
+ * may have grown.
+ * @param dst The Vec to receive the bytes.
+ * @param src The block to decompress.
+ * @param len The decompressed length of the block, as stored beside it. The
+ * block is rejected if it describes more than this.
+ * @return Ok with the number of bytes appended, or Err.
+ */
+LzResult lz_decompress(Vec* const dst, const Slice src, size_t len) {
+	if (!vec_reserve(dst, len)) {
+		return SET_VARIANT(LzResult, Err, 0);
+	}
+	LzResult res = lz_decompress_into(slice_new(&dst->buf[dst->len], len), src);
+	if (GET_VARIANT_TYPE(res) == ENUM_VAR(LzResult, Ok)) {
+		dst->len += GET_VARIANT_BODY(res, Ok);
+	}
+	return res;
+}
+
+/**
+ * Decompress a block into a pre-existing buffer.
+ * @param dst The buffer to receive the bytes.
+ * @param src The block to decompress.
+ * @return Ok with the number of bytes written, or Err if the block is corrupt
+ * or does not fit in `dst`. After Err, `dst` holds unspecified bytes.
+ */
+LzResult lz_decompress_into(const Slice dst, const Slice src) {
+	size_t ip = 0;
+	size_t op = 0;
+	while (ip < src.len) {
+		unsigned token = src.ptr[ip++];
+		size_t lit = token >> 4;
+		/*
+		 * Most tokens hold a few literals and a short match. With room to
+		 * spare in both buffers, each is copied in fixed-size moves that may
+		 * run past its end, to be overwritten by what follows.
+		 */
+		if (lit < 15 && src.len - ip >= 16 + 2 && dst.len - op >= 16 + 24) {
+			memcpy(&dst.ptr[op], &src.ptr[ip], 16);
+		}
+		else {
+			if (lit == 15 && !lz_get_length(src, &ip, &lit)) {
+				return SET_VARIANT(LzResult, Err, ip);
+			}
+			if (lit > src.len - ip || lit > dst.len - op) {
+				return SET_VARIANT(LzResult, Err, ip);
+			}
+			if (src.len - ip - lit >= 8 && dst.len - op - lit >= 8) {
+				lz_copy8(&dst.ptr[op], &src.ptr[ip], lit);
+			}
+			else {
+				memcpy(&dst.ptr[op], &src.ptr[ip], lit);
+			}
+		}
+		ip += lit;
+		op += lit;
+		/* Only the last token may end without a match. */
+		if (ip == src.len) {
+			return SET_VARIANT(LzResult, Ok, op);
+		}
+		if (src.len - ip < 2) {
+			return SET_VARIANT(LzResult, Err, ip);
+		}
+		size_t offset = (size_t)src.ptr[ip] | (size_t)src.ptr[ip + 1] << 8;
+		if (offset == 0 || offset > op) {
+			return SET_VARIANT(LzResult, Err, ip);
+		}
+		ip += 2;
+		size_t len = token & 15;
+		const unsigned char* from = &dst.ptr[op - offset];
+		unsigned char* to = &dst.ptr[op];
+		if (len < 15 && offset >= 8 && dst.len - op >= 24) {
+			memcpy(to, from, 8);
+			memcpy(&to[8], &from[8], 8);
+			memcpy(&to[16], &from[16], 2);
+			op += len + LZ_MIN_MATCH;
+			continue;
+		}
+		if (len == 15 && !lz_get_length(src, &ip, &len)) {
+			return SET_VARIANT(LzResult, Err, ip);
+		}
+		len += LZ_MIN_MATCH;
+		if (len > dst.len - op) {
+			return SET_VARIANT(LzResult, Err, ip);
+		}
+		if (offset >= 8 && dst.len - op - len >= 8) {
+			lz_copy8(to, from, len);
+			op += len;
+			continue;
+		}
+		/*
+		 * A match may overlap its own output, repeating the last `offset`
+		 * bytes. Copying whole periods at a time keeps every memcpy free of
+		 * overlap, and doubles the span that can be copied at each step.
+		 */
+		size_t done = 0;
+		while (done < len) {
+			size_t chunk = offset + done;
+			if (chunk > len - done) {
+				chunk = len - done;
+			}
+			memcpy(&to[done], from, chunk);
+			done += chunk;
+		}
+		op += len;
+	}
+	/* An empty block, or one that ends after a match, is truncated. */
+	return SET_VARIANT(LzResult, Err, ip);
+}
+
+/**
+ * INTERNAL: Load four bytes, which need not be aligned.
+ * @param src The first byte.
+ * @return The bytes in native order.
+ */
+static uint32_t lz_read32(const unsigned char* src) {
+	uint32_t ret;
+	memcpy(&ret, src, sizeof(ret));
+	return ret;
+}
+
+/**
+ * INTERNAL: Choose the size of the hash table for an input.
+ * @param len The length of the input.
+ * @return The number of hash bits, between 8 and `LZ_HASH_BITS`.
+ */
+static unsigned lz_hash_bits(size_t len) {
+	unsigned bits = 8;
+	while (bits < LZ_HASH_BITS && ((size_t)1 << bits) < len) {
+		++bits;
+	}
+	return bits;
+}
+
+/**
+ * INTERNAL: Count how far two positions in the input continue to agree.
+ * @param cur The later position.
+ * @param prev The earlier position.
+ * @param end Where the count must stop, at or after `cur`.
+ * @return The number of equal bytes.
+ */
+static size_t lz_match_len(
+	const unsigned char* cur,
+	const unsigned char* prev,
+	const unsigned char* end
+) {
+	const unsigned char* start = cur;
+	while (end - cur >= 8) {
+		uint64_t a, b;
+		memcpy(&a, cur, sizeof(a));
+		memcpy(&b, prev, sizeof(b));
+		uint64_t diff = a ^ b;
+		if (diff != 0) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+			return (size_t)(cur - start) + (size_t)__builtin_ctzll(diff) / 8;
+#else
+			return (size_t)(cur - start) + (size_t)__builtin_clzll(diff) / 8;
+#endif
+		}
+		cur += 8;
+		prev += 8;
+	}
+	while (cur < end && *cur == *prev) {
+		++cur;
+		++prev;
+	}
+	return (size_t)(cur - start);
+}
+
+/**
+ * INTERNAL: Write one token: a run of literals, then a match if there is one.
+ * @param op Where to write.
+ * @param oend The end of the output buffer.
+ * @param lit The literal bytes.
+ * @param lit_len The number of literal bytes.
+ * @param offset How far back the match begins.
+ * @param match_len The length of the match, or zero for the final token.
+ * @return The position after the token, or NULL if it does not fit.
+ */
+static unsigned char* lz_emit(
+	unsigned char* op,
+	const unsigned char* oend,
+	const unsigned char* lit,
+	size_t lit_len,
+	size_t offset,
+	size_t match_len
+) {
+	size_t need = 1 + lit_len;
+	if (lit_len >= 15) {
+		need += (lit_len - 15) / 255 + 1;
+	}
+	if (match_len > 0) {
+		need += 2;
+		if (match_len - LZ_MIN_MATCH >= 15) {
+			need += (match_len - LZ_MIN_MATCH - 15) / 255 + 1;
+		}
+	}
+	if ((size_t)(oend - op) < need) {
+		return NULL;
+	}
+	unsigned char* token = op++;
+	if (lit_len >= 15) {
+		*token = 15 << 4;
+		op = lz_put_length(op, lit_len - 15);
+	}
+	else {
+		*token = (unsigned char)(lit_len << 4);
+	}
+	/*
+	 * Literals before a match are followed by at least `LZ_MATCH_LIMIT` bytes of
+	 * input, so they can be copied in whole words when the output has room.
+	 */
+	if (match_len > 0 && (size_t)(oend - op) >= lit_len + 8) {
+		lz_copy8(op, lit, lit_len);
+	}
+	else if (lit_len > 0) {
+		memcpy(op, lit, lit_len);
+	}
+	op += lit_len;
+	if (match_len > 0) {
+		*op++ = (unsigned char)(offset & 0xFF);
+		*op++ = (unsigned char)(offset >> 8);
+		size_t extra = match_len - LZ_MIN_MATCH;
+		if (extra >= 15) {
+			*token |= 15;
+			op = lz_put_length(op, extra - 15);
+		}
+		else {
+			*token |= (unsigned char)extra;
+		}
+	}
+	return op;
+}
+
+/**
+ * INTERNAL: Write the bytes that extend a length past its token's nibble.
+ * @param op Where to write.
+ * @param len The length beyond 15.
+ * @return The position after the length.
+ */
+static unsigned char* lz_put_length(unsigned char* op, size_t len) {
+	while (len >= 255) {
+		*op++ = 255;
+		len -= 255;
+	}
+	*op++ = (unsigned char)len;
+	return op;
+}
+
+/**
+ * INTERNAL: Copy in eight-byte words, writing up to seven bytes past the end.
+ *
+ * The caller must ensure that both buffers have that much room, and that the
+ * source is at least eight bytes behind the destination if they overlap.
+ * @param to The destination.
+ * @param from The source.
+ * @param len The number of bytes that must be copied.
+ */
+static void lz_copy8(unsigned char* to, const unsigned char* from, size_t len) {
+	unsigned char* end = to + len;
+	while (to < end) {
+		memcpy(to, from, 8);
+		to += 8;
+		from += 8;
+	}
+}
+
+/**
+ * INTERNAL: Read the bytes that extend a length past its token's nibble.
+ * @param src The block.
+ * @param idx The index of the first length byte, advanced past the last.
+ * @param len The length so far, to which the bytes are added.
+ * @return false if the block ends first, or the length overflows.
+ */
+static bool lz_get_length(const Slice src, size_t* const idx, size_t* const len) {
+	unsigned char byte;
+	do {
+		if (*idx >= src.len || *len > SIZE_MAX - 255) {
+			return false;
+		}
+		byte = src.ptr[(*idx)++];
+		*len += byte;
+	} while (byte == 255);
+	return true;
+}
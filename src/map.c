@@ -0,0 +1,608 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <wyzyrdry.h>
+
+#if defined(WYZYRDRY_X86) && defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Control byte of a slot that has never held an entry. Probes stop here.
+ */
+#define MAP_EMPTY 0x80
+/**
+ * Control byte of a slot whose entry was erased. Probes continue past it.
+ */
+#define MAP_DELETED 0xFE
+/**
+ * The size of each block of the key arena. Longer keys get a block of their own.
+ */
+#define MAP_ARENA_BLOCK 65536
+/**
+ * The seed for key hashes.
+ */
+#define MAP_SEED 0x5EEDF00DCAFEBEEFULL
+
+static size_t map_max_load(size_t cap);
+static size_t map_capacity_for(size_t count);
+static unsigned int map_match(const unsigned char* group, unsigned char h2);
+static unsigned int map_match_empty(const unsigned char* group);
+static unsigned int map_match_free(const unsigned char* group);
+static void map_set_ctrl(Map* const self, size_t idx, unsigned char ctrl);
+static MapEntry* map_find(const Map* const self, const Slice key, uint64_t hash);
+static size_t map_find_free(const Map* const self, uint64_t hash);
+static bool map_rehash(Map* const self, size_t cap);
+static bool map_arena_store(Map* const self, Slice* const key);
+static void map_arena_free(Map* const self);
+
+/**
+ * Initialize a Map structure.
+ * @param capacity The number of entries the Map can hold before it first grows.
+ * Zero defers allocation until the first insertion.
+ * @param mode Whether the Map copies its keys or borrows them.
+ * @return A Map structure. If malloc failed, ctrl will be NULL and the Map will
+ * have no capacity.
+ */
+Map map_init(size_t capacity, MapKeys mode) {
+	Map ret = {
+		.ctrl = NULL,
+		.slots = NULL,
+		.cap = 0,
+		.len = 0,
+		.growth_left = 0,
+		.mode = mode,
+		.blocks = { .buf = NULL, .len = 0, .cap = 0 },
+		.arena_top = NULL,
+		.arena_room = 0,
+		.arena_dead = 0,
+	};
+	if (capacity > 0) {
+		map_rehash(&ret, map_capacity_for(capacity));
+	}
+	return ret;
+}
+
+/**
+ * Deallocate a Map structure, along with any keys it copied.
+ *
+ * Values are not freed; that is the caller's responsibility.
+ * @param self The Map on which to act.
+ */
+void map_free(Map* const self) {
+	map_arena_free(self);
+	INSTRUMENT_FREE("map", self->ctrl);
+	INSTRUMENT_FREE("map", self->slots);
+	self->ctrl = NULL;
+	self->slots = NULL;
+	self->cap = 0;
+	self->len = 0;
+	self->growth_left = 0;
+}
+
+/**
+ * Remove every entry from the Map, keeping its capacity.
+ * @param self The Map on which to act.
+ */
+void map_clear(Map* const self) {
+	map_arena_free(self);
+	if (self->cap > 0) {
+		memset(self->ctrl, MAP_EMPTY, self->cap + MAP_GROUP);
+	}
+	self->len = 0;
+	self->growth_left = map_max_load(self->cap);
+}
+
+/**
+ * Ensure that the Map can receive some number of new entries without
+ * rebuilding its table.
+ * @param self The Map on which to act.
+ * @param additional The number of entries past the current length to make room
+ * for.
+ * @return true if the Map has room for `additional` more entries. If allocation
+ * fails, the Map is left unchanged.
+ */
+bool map_reserve(Map* const self, size_t additional) {
+	if (self->growth_left >= additional) {
+		return true;
+	}
+	return map_rehash(self, map_capacity_for(self->len + additional));
+}
+
+/**
+ * Hash a key the way every Map does.
+ *
+ * The low seven bits go into the control byte, and the rest choose where the
+ * probe starts.
+ * @param key The bytes of the key.
+ * @return The hash of the key.
+ */
+uint64_t map_hash(const Slice key) {
+	return hash_xxh64(key, MAP_SEED);
+}
+
+/**
+ * Look up the value stored under a key.
+ * @param self The Map on which to act.
+ * @param key The bytes of the key.
+ * @return A pointer to the value, through which it may be replaced, or NULL if
+ * the key is not present. The pointer is invalidated by the next insertion or
+ * erasure.
+ */
+void** map_get(const Map* const self, const Slice key) {
+	return map_get_hashed(self, key, map_hash(key));
+}
+
+/**
+ * Look up the value stored under a key whose hash the caller already has.
+ *
+ * This lets a caller that also uses the hash for its own purposes, such as
+ * choosing among several Maps, hash each key only once.
+ * @param self The Map on which to act.
+ * @param key The bytes of the key.
+ * @param hash The result of `map_hash(key)`.
+ * @return A pointer to the value, or NULL if the key is not present.
+ */
+void** map_get_hashed(const Map* const self, const Slice key, uint64_t hash) {
+	MapEntry* entry = map_find(self, key, hash);
+	if (entry == NULL) {
+		return NULL;
+	}
+	return &entry->value;
+}
+
+/**
+ * Look up the value stored under a key, inserting the key with a NULL value if
+ * it is not present.
+ *
+ * This hashes and probes for the key once, where a `map_get()` followed by a
+ * `map_insert()` would do both twice.
+ * @param self The Map on which to act.
+ * @param key The bytes of the key. If the Map borrows keys, this memory must
+ * outlive the entry.
+ * @param inserted If not NULL, set to whether the key was newly inserted.
+ * @return A pointer to the value, through which it may be set, or NULL if the
+ * key was absent and could not be inserted because allocation failed. The
+ * pointer is invalidated by the next insertion or erasure.
+ */
+void** map_entry(Map* const self, const Slice key, bool* const inserted) {
+	return map_entry_hashed(self, key, map_hash(key), inserted);
+}
+
+/**
+ * Look up the value stored under a key whose hash the caller already has,
+ * inserting the key with a NULL value if it is not present.
+ * @param self The Map on which to act.
+ * @param key The bytes of the key. If the Map borrows keys, this memory must
+ * outlive the entry.
+ * @param hash The result of `map_hash(key)`.
+ * @param inserted If not NULL, set to whether the key was newly inserted, which
+ * is false if allocation failed.
+ * @return A pointer to the value, or NULL if allocation failed.
+ */
+void** map_entry_hashed(
+	Map* const self,
+	const Slice key,
+	uint64_t hash,
+	bool* const inserted
+) {
+	MapEntry* entry = map_find(self, key, hash);
+	/* Only a filled slot counts as an insertion, not a failed attempt. */
+	if (inserted != NULL) {
+		*inserted = false;
+	}
+	if (entry != NULL) {
+		return &entry->value;
+	}
+	if (self->growth_left == 0) {
+		/* Rebuild at the same size if erased slots are what fill the table. */
+		size_t cap = self->cap;
+		if (cap == 0) {
+			cap = MAP_GROUP;
+		}
+		else if (self->len > map_max_load(cap) / 2) {
+			cap *= 2;
+		}
+		if (!map_rehash(self, cap)) {
+			return NULL;
+		}
+	}
+	size_t idx = map_find_free(self, hash);
+	Slice stored = key;
+	if (!map_arena_store(self, &stored)) {
+		return NULL;
+	}
+	if (self->ctrl[idx] == MAP_EMPTY) {
+		--self->growth_left;
+	}
+	map_set_ctrl(self, idx, (unsigned char)(hash & 0x7F));
+	self->slots[idx].key = stored;
+	self->slots[idx].value = NULL;
+	++self->len;
+	if (inserted != NULL) {
+		*inserted = true;
+	}
+	return &self->slots[idx].value;
+}
+
+/**
+ * Store a value under a key, replacing any value already there.
+ * @param self The Map on which to act.
+ * @param key The bytes of the key. If the Map borrows keys, this memory must
+ * outlive the entry.
+ * @param value The value to store.
+ * @return true if the value was stored, or false if allocation failed.
+ */
+bool map_insert(Map* const self, const Slice key, void* value) {
+	void** slot = map_entry(self, key, NULL);
+	if (slot == NULL) {
+		return false;
+	}
+	*slot = value;
+	return true;
+}
+
+/**
+ * Remove a key and its value from the Map.
+ * @param self The Map on which to act.
+ * @param key The bytes of the key.
+ * @return true if the key was present.
+ */
+bool map_erase(Map* const self, const Slice key) {
+	MapEntry* entry = map_find(self, key, map_hash(key));
+	if (entry == NULL) {
+		return false;
+	}
+	size_t mask = self->cap - 1;
+	size_t idx = (size_t)(entry - self->slots);
+	/*
+	 * If no window of MAP_GROUP slots covering this one is completely full,
+	 * no probe ever passed over it, and it can become empty again.
+	 */
+	unsigned int before = map_match_empty(&self->ctrl[(idx - MAP_GROUP) & mask]);
+	unsigned int after = map_match_empty(&self->ctrl[idx]);
+	bool reusable = before != 0 && after != 0
+		&& (unsigned int)__builtin_ctz(after) + (unsigned int)(__builtin_clz(before) - 16) < MAP_GROUP;
+	if (reusable) {
+		map_set_ctrl(self, idx, MAP_EMPTY);
+		++self->growth_left;
+	}
+	else {
+		map_set_ctrl(self, idx, MAP_DELETED);
+	}
+	if (self->mode == MAP_COPY_KEYS) {
+		self->arena_dead += entry->key.len;
+	}
+	--self->len;
+	return true;
+}
+
+/**
+ * Step through the entries of the Map, in no particular order.
+ *
+ * The Map must not be modified during iteration, except to replace values.
+ * @param self The Map on which to act.
+ * @param cursor The iteration state. Set this to 0 before the first call.
+ * @param out Receives the next entry.
+ * @return true if an entry was produced, or false once every entry has been
+ * visited.
+ */
+bool map_next(const Map* const self, size_t* const cursor, MapEntry* const out) {
+	while (*cursor < self->cap) {
+		size_t idx = *cursor;
+		unsigned int full = ~map_match_free(&self->ctrl[idx]) & 0xFFFF;
+		if (full == 0) {
+			*cursor += MAP_GROUP;
+			continue;
+		}
+		idx += (size_t)__builtin_ctz(full);
+		if (idx >= self->cap) {
+			/* Past the end, among the copied control bytes. */
+			*cursor = self->cap;
+			break;
+		}
+		*cursor = idx + 1;
+		*out = self->slots[idx];
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Print out the Map for debugging purposes.
+ * @param self The Map on which to act.
+ */
+void map_debug_print(const Map* const self) {
+	printf(
+		"Map { cap: %zu, len: %zu, growth_left: %zu, mode: %s }\n",
+		self->cap,
+		self->len,
+		self->growth_left,
+		self->mode == MAP_COPY_KEYS ? "copy" : "borrow"
+	);
+	size_t cursor = 0;
+	MapEntry entry;
+	while (map_next(self, &cursor, &entry)) {
+		printf("Entry { value: %p }\n", entry.value);
+		hex_print(entry.key);
+	}
+}
+
+/**
+ * INTERNAL: The number of entries a table may hold, which keeps a probe short
+ * by leaving an eighth of the slots empty.
+ * @param cap The number of slots.
+ * @return The maximum number of full and erased slots.
+ */
+static size_t map_max_load(size_t cap) {
+	return cap - cap / 8;
+}
+
+/**
+ * INTERNAL: The number of slots needed to hold some number of entries.
+ * @param count The number of entries.
+ * @return A power of two, at least `MAP_GROUP`.
+ */
+static size_t map_capacity_for(size_t count) {
+	size_t cap = MAP_GROUP;
+	while (map_max_load(cap) < count) {
+		cap *= 2;
+	}
+	return cap;
+}
+
+#if defined(WYZYRDRY_X86) && defined(__SSE2__)
+/*
+ * SSE2 is part of the baseline wherever the compiler assumes it, so these are
+ * used directly rather than selected at runtime; a `cpu_has()` check on every
+ * probe would cost as much as the match itself.
+ */
+
+/**
+ * INTERNAL: Find the control bytes in a group that hold some hash bits.
+ * @param group The first of `MAP_GROUP` control bytes.
+ * @param h2 The seven hash bits to look for.
+ * @return A bitmask with bit `i` set if `group[i] == h2`.
+ */
+static unsigned int map_match(const unsigned char* group, unsigned char h2) {
+	__m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+	return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)h2)));
+}
+
+/**
+ * INTERNAL: Find the empty slots in a group.
+ * @param group The first of `MAP_GROUP` control bytes.
+ * @return A bitmask with bit `i` set if slot `i` has never been full.
+ */
+static unsigned int map_match_empty(const unsigned char* group) {
+	__m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+	return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)MAP_EMPTY)));
+}
+
+/**
+ * INTERNAL: Find the slots in a group that are empty or erased.
+ * @param group The first of `MAP_GROUP` control bytes.
+ * @return A bitmask with bit `i` set if slot `i` holds no entry.
+ */
+static unsigned int map_match_free(const unsigned char* group) {
+	return (unsigned int)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+}
+#else
+/**
+ * INTERNAL: Read eight control bytes as a little-endian word, so that byte `i`
+ * of the group is byte `i` of the word.
+ */
+static uint64_t map_load_word(const unsigned char* ptr) {
+	uint64_t ret = 0;
+	for (int idx = 7; idx >= 0; --idx) {
+		ret = (ret << 8) | ptr[idx];
+	}
+	return ret;
+}
+
+/**
+ * INTERNAL: Gather the top bit of each byte of a word into an 8-bit mask.
+ */
+static unsigned int map_word_mask(uint64_t word) {
+	return (unsigned int)((((word & 0x8080808080808080ULL) >> 7) * 0x0102040810204080ULL) >> 56);
+}
+
+/**
+ * INTERNAL: Mark the zero bytes of a word with their top bit, exactly.
+ */
+static uint64_t map_word_zeros(uint64_t word) {
+	uint64_t low = 0x7F7F7F7F7F7F7F7FULL;
+	return ~(((word & low) + low) | word | low);
+}
+
+static unsigned int map_match(const unsigned char* group, unsigned char h2) {
+	uint64_t pattern = 0x0101010101010101ULL * h2;
+	unsigned int lo = map_word_mask(map_word_zeros(map_load_word(group) ^ pattern));
+	unsigned int hi = map_word_mask(map_word_zeros(map_load_word(&group[8]) ^ pattern));
+	return lo | hi << 8;
+}
+
+static unsigned int map_match_empty(const unsigned char* group) {
+	uint64_t pattern = 0x0101010101010101ULL * MAP_EMPTY;
+	unsigned int lo = map_word_mask(map_word_zeros(map_load_word(group) ^ pattern));
+	unsigned int hi = map_word_mask(map_word_zeros(map_load_word(&group[8]) ^ pattern));
+	return lo | hi << 8;
+}
+
+static unsigned int map_match_free(const unsigned char* group) {
+	return map_word_mask(map_load_word(group)) | map_word_mask(map_load_word(&group[8])) << 8;
+}
+#endif
+
+/**
+ * INTERNAL: Set the control byte of a slot, and its copy past the end of the
+ * table if it is one of the first `MAP_GROUP` slots.
+ * @param self The Map on which to act.
+ * @param idx The slot.
+ * @param ctrl The new control byte.
+ */
+static void map_set_ctrl(Map* const self, size_t idx, unsigned char ctrl) {
+	size_t mask = self->cap - 1;
+	self->ctrl[idx] = ctrl;
+	self->ctrl[((idx - MAP_GROUP) & mask) + MAP_GROUP] = ctrl;
+}
+
+/**
+ * INTERNAL: Find the entry for a key.
+ *
+ * Probing visits groups at triangular offsets from the start, which reaches
+ * every group of a power-of-two table, and stops at the first group with an
+ * empty slot.
+ * @param self The Map on which to act.
+ * @param key The bytes of the key.
+ * @param hash The hash of the key.
+ * @return The entry, or NULL if the key is not present.
+ */
+static MapEntry* map_find(const Map* const self, const Slice key, uint64_t hash) {
+	if (self->len == 0) {
+		return NULL;
+	}
+	size_t mask = self->cap - 1;
+	size_t pos = (size_t)(hash >> 7) & mask;
+	unsigned char h2 = (unsigned char)(hash & 0x7F);
+	for (size_t stride = MAP_GROUP;; stride += MAP_GROUP) {
+		const unsigned char* group = &self->ctrl[pos];
+		for (unsigned int bits = map_match(group, h2); bits != 0; bits &= bits - 1) {
+			MapEntry* entry = &self->slots[(pos + (size_t)__builtin_ctz(bits)) & mask];
+			if (entry->key.len == key.len
+				&& (key.len == 0 || memcmp(entry->key.ptr, key.ptr, key.len) == 0)) {
+				return entry;
+			}
+		}
+		if (map_match_empty(group) != 0) {
+			return NULL;
+		}
+		pos = (pos + stride) & mask;
+	}
+}
+
+/**
+ * INTERNAL: Find the first empty or erased slot on a key's probe sequence.
+ *
+ * The table must have at least one empty slot.
+ * @param self The Map on which to act.
+ * @param hash The hash of the key.
+ * @return The index of the slot.
+ */
+static size_t map_find_free(const Map* const self, uint64_t hash) {
+	size_t mask = self->cap - 1;
+	size_t pos = (size_t)(hash >> 7) & mask;
+	for (size_t stride = MAP_GROUP;; stride += MAP_GROUP) {
+		unsigned int bits = map_match_free(&self->ctrl[pos]);
+		if (bits != 0) {
+			return (pos + (size_t)__builtin_ctz(bits)) & mask;
+		}
+		pos = (pos + stride) & mask;
+	}
+}
+
+/**
+ * INTERNAL: Move every entry into a new table, discarding erased slots. If the
+ * Map copies keys and some have been erased, the keys are also moved into a new
+ * arena, reclaiming the space of the erased ones.
+ * @param self The Map on which to act.
+ * @param cap The number of slots in the new table. It must be a power of two,
+ * at least `MAP_GROUP`, and large enough to hold every entry.
+ * @return true on success. If allocation fails, the Map is left unchanged.
+ */
+static bool map_rehash(Map* const self, size_t cap) {
+	Map next = *self;
+	next.ctrl = INSTRUMENT_MALLOC("map", cap + MAP_GROUP);
+	next.slots = INSTRUMENT_MALLOC("map", cap * sizeof(MapEntry));
+	if (next.ctrl == NULL || next.slots == NULL) {
+		INSTRUMENT_FREE("map", next.ctrl);
+		INSTRUMENT_FREE("map", next.slots);
+		return false;
+	}
+	memset(next.ctrl, MAP_EMPTY, cap + MAP_GROUP);
+	next.cap = cap;
+	bool compact = self->mode == MAP_COPY_KEYS && self->arena_dead > 0;
+	if (compact) {
+		next.blocks = (Vec){ .buf = NULL, .len = 0, .cap = 0 };
+		next.arena_top = NULL;
+		next.arena_room = 0;
+		next.arena_dead = 0;
+	}
+	for (size_t idx = 0; idx < self->cap; ++idx) {
+		if (self->ctrl[idx] & 0x80) {
+			continue;
+		}
+		MapEntry entry = self->slots[idx];
+		if (compact && !map_arena_store(&next, &entry.key)) {
+			map_arena_free(&next);
+			INSTRUMENT_FREE("map", next.ctrl);
+			INSTRUMENT_FREE("map", next.slots);
+			return false;
+		}
+		uint64_t hash = map_hash(entry.key);
+		size_t at = map_find_free(&next, hash);
+		map_set_ctrl(&next, at, (unsigned char)(hash & 0x7F));
+		next.slots[at] = entry;
+	}
+	next.growth_left = map_max_load(cap) - self->len;
+	if (compact) {
+		map_arena_free(self);
+	}
+	INSTRUMENT_FREE("map", self->ctrl);
+	INSTRUMENT_FREE("map", self->slots);
+	*self = next;
+	return true;
+}
+
+/**
+ * INTERNAL: Copy a key into the arena, if the Map copies keys.
+ * @param self The Map on which to act.
+ * @param key The key, which is updated to point at the copy.
+ * @return true on success, or false if allocation failed.
+ */
+static bool map_arena_store(Map* const self, Slice* const key) {
+	if (self->mode != MAP_COPY_KEYS || key->len == 0) {
+		return true;
+	}
+	unsigned char* dst = self->arena_top;
+	if (key->len > self->arena_room) {
+		size_t size = key->len > MAP_ARENA_BLOCK ? key->len : MAP_ARENA_BLOCK;
+		if (!vec_reserve(&self->blocks, sizeof(unsigned char*))) {
+			return false;
+		}
+		dst = INSTRUMENT_MALLOC("map", size);
+		if (dst == NULL) {
+			return false;
+		}
+		vec_push_slice(&self->blocks, slice_new((unsigned char*)&dst, sizeof(dst)));
+		if (size == key->len) {
+			/* An oversized key leaves the current block open. */
+			INSTRUMENT_COPY("map", dst, key->ptr, key->len);
+			key->ptr = dst;
+			return true;
+		}
+		self->arena_room = size;
+	}
+	INSTRUMENT_COPY("map", dst, key->ptr, key->len);
+	key->ptr = dst;
+	self->arena_top = dst + key->len;
+	self->arena_room -= key->len;
+	return true;
+}
+
+/**
+ * INTERNAL: Free every block of the key arena.
+ * @param self The Map on which to act.
+ */
+static void map_arena_free(Map* const self) {
+	unsigned char** blocks = (unsigned char**)self->blocks.buf;
+	size_t count = self->blocks.len / sizeof(unsigned char*);
+	for (size_t idx = 0; idx < count; ++idx) {
+		INSTRUMENT_FREE("map", blocks[idx]);
+	}
+	vec_free(&self->blocks);
+	self->arena_top = NULL;
+	self->arena_room = 0;
+	self->arena_dead = 0;
+}
@@ -0,0 +1,311 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <linux/mempolicy.h>
+
+#include <wyzyrdry.h>
+
+/**
+ * The most processors, and the most nodes, that placement can name.
+ */
+#define PAGES_MASK_BITS 1024
+
+/**
+ * A set of processors or of nodes, in the form the kernel takes.
+ */
+typedef struct PagesMask {
+	unsigned long bits[PAGES_MASK_BITS / (8 * sizeof(unsigned long))];
+} PagesMask;
+
+/**
+ * The work of a thread that places a store by touching it first.
+ */
+typedef struct PagesToucher {
+	Slice pages;
+	size_t step;
+	PagesMask cpus;
+	/**
+	 * Whether the thread was pinned to the node, and so touched the store.
+	 */
+	bool pinned;
+} PagesToucher;
+
+static size_t pages_size(void);
+static unsigned char* pages_map(size_t len, unsigned int flags, unsigned int* const got);
+static bool pages_bind(const Slice pages, int node);
+static bool pages_node_cpus(int node, PagesMask* const out);
+static void pages_mask_set(PagesMask* const self, size_t bit);
+static bool pages_touch_on(const Slice pages, size_t step, int node);
+static void* pages_toucher(void* arg);
+static void pages_touch(const Slice pages, size_t step);
+
+/**
+ * Allocate a store of whole pages from the kernel.
+ *
+ * Each request falls back as described for the module, and the store is usable
+ * whatever it got. Its memory starts zeroed.
+ * @param len The least size of the store, which is rounded up as by
+ * `pages_round()`.
+ * @param flags `PAGES_HUGE` and `PAGES_PREFAULT`, as wanted. Other bits are
+ * ignored, so the flags reported for one store may be passed for the next.
+ * @param node The NUMA node on which to place the store, or `PAGES_ANY_NODE`.
+ * @param got If not NULL, receives the `PagesFlag`s describing the store, or
+ * zero if allocation failed.
+ * @return A Slice over the whole store, to be released with `pages_free()`, or
+ * an empty Slice with a NULL pointer if allocation failed.
+ */
+Slice pages_alloc(size_t len, unsigned int flags, int node, unsigned int* const got) {
+	unsigned int have = 0;
+	size_t size = pages_round(len, flags);
+	unsigned char* ptr = size > 0 ? pages_map(size, flags, &have) : NULL;
+	if (ptr == NULL) {
+		if (got != NULL) {
+			*got = 0;
+		}
+		return slice_new(NULL, 0);
+	}
+	Slice ret = slice_new(ptr, size);
+	have |= PAGES_MAPPED;
+	/* A transparent huge page that the kernel could not supply is left as
+	 * ordinary pages, so only explicit huge pages are touched once each. */
+	size_t step = (have & PAGES_HUGETLB) != 0 ? PAGES_HUGE_SIZE : pages_size();
+	if (node != PAGES_ANY_NODE) {
+		if (pages_bind(ret, node)) {
+			have |= PAGES_NODE;
+		}
+		else if (pages_touch_on(ret, step, node)) {
+			have |= PAGES_NODE | PAGES_PREFAULT;
+		}
+	}
+	if ((flags & PAGES_PREFAULT) != 0 && (have & PAGES_PREFAULT) == 0) {
+		pages_touch(ret, step);
+		have |= PAGES_PREFAULT;
+	}
+	if (got != NULL) {
+		*got = have;
+	}
+	return ret;
+}
+
+/**
+ * Release a store from `pages_alloc()`.
+ * @param pages The Slice that `pages_alloc()` returned. An empty Slice with a
+ * NULL pointer is ignored.
+ */
+void pages_free(const Slice pages) {
+	if (pages.ptr != NULL) {
+		munmap(pages.ptr, pages.len);
+	}
+}
+
+/**
+ * Find the size of the store that `pages_alloc()` makes for a request.
+ * @param len The size requested.
+ * @param flags The flags requested.
+ * @return `len` rounded up to a whole number of huge pages if `PAGES_HUGE` is
+ * set, or else of ordinary pages, and to at least one page; or zero if that
+ * does not fit in a `size_t`.
+ */
+size_t pages_round(size_t len, unsigned int flags) {
+	size_t size = (flags & PAGES_HUGE) != 0 ? PAGES_HUGE_SIZE : pages_size();
+	if (len == 0) {
+		return size;
+	}
+	if (len > SIZE_MAX - (size - 1)) {
+		return 0;
+	}
+	return (len + size - 1) / size * size;
+}
+
+/**
+ * INTERNAL: Get the size of an ordinary page.
+ */
+static size_t pages_size(void) {
+	long size = sysconf(_SC_PAGESIZE);
+	return size > 0 ? (size_t)size : 4096;
+}
+
+/**
+ * INTERNAL: Map a store, with huge pages if asked and available.
+ * @param len The size of the store, a whole number of pages of the kind asked
+ * for.
+ * @param flags The flags requested.
+ * @param got Receives `PAGES_HUGE` and `PAGES_HUGETLB`, as obtained.
+ * @return The start of the store, or NULL if mapping failed.
+ */
+static unsigned char* pages_map(size_t len, unsigned int flags, unsigned int* const got) {
+	int prot = PROT_READ | PROT_WRITE;
+	int anon = MAP_PRIVATE | MAP_ANONYMOUS;
+	void* ptr;
+	if ((flags & PAGES_HUGE) == 0) {
+		ptr = mmap(NULL, len, prot, anon, -1, 0);
+		return ptr != MAP_FAILED ? ptr : NULL;
+	}
+#ifdef MAP_HUGETLB
+	/* This fails unless the system has reserved enough huge pages. */
+	ptr = mmap(NULL, len, prot, anon | MAP_HUGETLB, -1, 0);
+	if (ptr != MAP_FAILED) {
+		*got |= PAGES_HUGE | PAGES_HUGETLB;
+		return ptr;
+	}
+#endif
+	/* Transparent huge pages back only aligned huge pages, so map one more
+	 * than needed and trim it to an aligned store. */
+	if (len > SIZE_MAX - PAGES_HUGE_SIZE) {
+		return NULL;
+	}
+	ptr = mmap(NULL, len + PAGES_HUGE_SIZE, prot, anon, -1, 0);
+	if (ptr == MAP_FAILED) {
+		return NULL;
+	}
+	unsigned char* raw = ptr;
+	size_t lead = (PAGES_HUGE_SIZE - (uintptr_t)raw % PAGES_HUGE_SIZE) % PAGES_HUGE_SIZE;
+	if (lead > 0) {
+		munmap(raw, lead);
+	}
+	munmap(&raw[lead + len], PAGES_HUGE_SIZE - lead);
+#ifdef MADV_HUGEPAGE
+	if (madvise(&raw[lead], len, MADV_HUGEPAGE) == 0) {
+		*got |= PAGES_HUGE;
+	}
+#endif
+	return &raw[lead];
+}
+
+/**
+ * INTERNAL: Give a store's pages a preference for a node, before any is
+ * touched.
+ * @return true if the kernel took the policy.
+ */
+static bool pages_bind(const Slice pages, int node) {
+#ifdef SYS_mbind
+	if (node < 0 || node >= PAGES_MASK_BITS) {
+		return false;
+	}
+	PagesMask nodes;
+	memset(&nodes, 0, sizeof(nodes));
+	pages_mask_set(&nodes, (size_t)node);
+	/* The kernel reads one bit fewer than it is told the mask holds. Preferring
+	 * the node, rather than binding to it, lets a full node spill over instead
+	 * of failing a page fault. */
+	return syscall(
+		SYS_mbind,
+		pages.ptr,
+		pages.len,
+		MPOL_PREFERRED,
+		nodes.bits,
+		(unsigned long)PAGES_MASK_BITS + 1,
+		0
+	) == 0;
+#else
+	(void)pages;
+	(void)node;
+	return false;
+#endif
+}
+
+/**
+ * INTERNAL: Read the processors of a node from sysfs, where they are listed as
+ * ranges such as "0-7,16-23".
+ * @return true if the node has at least one processor that a mask can name.
+ */
+static bool pages_node_cpus(int node, PagesMask* const out) {
+	memset(out, 0, sizeof(*out));
+	if (node < 0) {
+		return false;
+	}
+	char path[64];
+	snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+	FILE* file = fopen(path, "r");
+	if (file == NULL) {
+		return false;
+	}
+	char list[4096];
+	size_t len = fread(list, 1, sizeof(list) - 1, file);
+	fclose(file);
+	list[len] = '\0';
+	bool any = false;
+	char* cur = list;
+	while (*cur >= '0' && *cur <= '9') {
+		char* end;
+		unsigned long lo = strtoul(cur, &end, 10);
+		unsigned long hi = lo;
+		if (*end == '-') {
+			hi = strtoul(end + 1, &end, 10);
+		}
+		for (unsigned long cpu = lo; cpu <= hi && cpu < PAGES_MASK_BITS; ++cpu) {
+			pages_mask_set(out, cpu);
+			any = true;
+		}
+		cur = *end == ',' ? end + 1 : end;
+	}
+	return any;
+}
+
+/**
+ * INTERNAL: Add a member to a set of processors or nodes.
+ */
+static void pages_mask_set(PagesMask* const self, size_t bit) {
+	size_t word = 8 * sizeof(unsigned long);
+	self->bits[bit / word] |= 1UL << (bit % word);
+}
+
+/**
+ * INTERNAL: Place a store on a node by touching every page from a thread
+ * pinned to that node's processors.
+ * @return true if the pages were touched from the node.
+ */
+static bool pages_touch_on(const Slice pages, size_t step, int node) {
+	PagesToucher toucher = {
+		.pages = pages,
+		.step = step,
+		.pinned = false,
+	};
+	if (!pages_node_cpus(node, &toucher.cpus)) {
+		return false;
+	}
+	pthread_t thread;
+	if (pthread_create(&thread, NULL, pages_toucher, &toucher) != 0) {
+		return false;
+	}
+	pthread_join(thread, NULL);
+	return toucher.pinned;
+}
+
+/**
+ * INTERNAL: The body of the thread started by `pages_touch_on()`.
+ */
+static void* pages_toucher(void* arg) {
+	PagesToucher* toucher = arg;
+#ifdef SYS_sched_setaffinity
+	/* A pid of zero names the calling thread. */
+	toucher->pinned = syscall(
+		SYS_sched_setaffinity,
+		0,
+		sizeof(toucher->cpus.bits),
+		toucher->cpus.bits
+	) == 0;
+#endif
+	if (toucher->pinned) {
+		pages_touch(toucher->pages, toucher->step);
+	}
+	return NULL;
+}
+
+/**
+ * INTERNAL: Write to one byte of every page, so that the kernel allocates them
+ * all now.
+ * @param pages The store.
+ * @param step The size of its pages.
+ */
+static void pages_touch(const Slice pages, size_t step) {
+	volatile unsigned char* ptr = pages.ptr;
+	for (size_t idx = 0; idx < pages.len; idx += step) {
+		ptr[idx] = 0;
+	}
+}
@@ -0,0 +1,476 @@
+#include <sched.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <wyzyrdry.h>
+
+/**
+ * Context for the `Slice` operations that work on a source and a destination.
+ */
+typedef struct PoolPair {
+	Slice dst;
+	Slice src;
+	unsigned char byte;
+	/**
+	 * The running result of a find or count, updated atomically.
+	 */
+	size_t result;
+	/**
+	 * The CRC of each piece, and the length of all but the last, for checksums.
+	 */
+	uint32_t* crcs;
+	size_t grain;
+} PoolPair;
+
+static void* pool_worker(void* arg);
+static void pool_work(Pool* const self, size_t me);
+static bool pool_take(PoolDeque* const deque, size_t* const idx);
+static bool pool_steal(Pool* const self, size_t me, size_t* const idx);
+static uint64_t pool_pack(size_t lo, size_t hi);
+static void pool_run_copy(size_t start, size_t end, void* ctx);
+static void pool_run_fill(size_t start, size_t end, void* ctx);
+static void pool_run_find(size_t start, size_t end, void* ctx);
+static void pool_run_count(size_t start, size_t end, void* ctx);
+static void pool_run_crc32c(size_t start, size_t end, void* ctx);
+static void pool_run_hex(size_t start, size_t end, void* ctx);
+
+/**
+ * Start a pool of threads.
+ * @param self The Pool to initialize.
+ * @param threads The number of threads to work on each job, counting the one
+ * that calls `pool_for()`, or zero for one per online processor.
+ * @param grain The smallest chunk of work to hand to a thread, or zero for
+ * `POOL_GRAIN_DEFAULT`.
+ * @return true on success, or false if memory, a thread or a lock could not be
+ * had, in which case the Pool must not be used.
+ */
+bool pool_init(Pool* const self, size_t threads, size_t grain) {
+	memset(self, 0, sizeof(*self));
+	if (threads == 0) {
+		long online = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = online > 0 ? (size_t)online : 1;
+	}
+	self->threads = threads;
+	self->grain = grain > 0 ? grain : POOL_GRAIN_DEFAULT;
+	if (threads > SIZE_MAX / sizeof(PoolDeque)) {
+		return false;
+	}
+	self->deques = INSTRUMENT_MALLOC("pool", threads * sizeof(PoolDeque));
+	self->handles = INSTRUMENT_MALLOC("pool", threads * sizeof(pthread_t));
+	if (self->deques == NULL || self->handles == NULL) {
+		INSTRUMENT_FREE("pool", self->deques);
+		INSTRUMENT_FREE("pool", self->handles);
+		return false;
+	}
+	memset(self->deques, 0, threads * sizeof(PoolDeque));
+	memset(self->handles, 0, threads * sizeof(pthread_t));
+	/* Each lock is made only if the one before it was, so that a failure
+	 * destroys exactly those that exist. */
+	bool run_lock = pthread_mutex_init(&self->run_lock, NULL) == 0;
+	bool lock = run_lock && pthread_mutex_init(&self->lock, NULL) == 0;
+	bool wake = lock && pthread_cond_init(&self->wake, NULL) == 0;
+	bool done = wake && pthread_cond_init(&self->done, NULL) == 0;
+	if (!done) {
+		if (wake) {
+			pthread_cond_destroy(&self->wake);
+		}
+		if (lock) {
+			pthread_mutex_destroy(&self->lock);
+		}
+		if (run_lock) {
+			pthread_mutex_destroy(&self->run_lock);
+		}
+		INSTRUMENT_FREE("pool", self->deques);
+		INSTRUMENT_FREE("pool", self->handles);
+		return false;
+	}
+	/* The caller is the first thread, so only the rest are started. */
+	for (size_t idx = 1; idx < threads; ++idx) {
+		if (pthread_create(&self->handles[idx], NULL, pool_worker, self) != 0) {
+			self->threads = idx;
+			pool_free(self);
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Stop the pool's threads and release its memory.
+ *
+ * No job may be running.
+ * @param self The Pool on which to act.
+ */
+void pool_free(Pool* const self) {
+	pthread_mutex_lock(&self->lock);
+	self->stop = true;
+	pthread_cond_broadcast(&self->wake);
+	pthread_mutex_unlock(&self->lock);
+	for (size_t idx = 1; idx < self->threads; ++idx) {
+		pthread_join(self->handles[idx], NULL);
+	}
+	pthread_cond_destroy(&self->done);
+	pthread_cond_destroy(&self->wake);
+	pthread_mutex_destroy(&self->lock);
+	pthread_mutex_destroy(&self->run_lock);
+	INSTRUMENT_FREE("pool", self->handles);
+	INSTRUMENT_FREE("pool", self->deques);
+	self->handles = NULL;
+	self->deques = NULL;
+	self->threads = 0;
+}
+
+/**
+ * Call a function over every index in a range, in chunks, on all of the pool's
+ * threads, and wait for it to finish.
+ *
+ * Chunks may run in any order and at the same time, so `fn` must only touch
+ * state belonging to its own indices, or update shared state atomically. A
+ * range no longer than the grain is run as one call on the calling thread. `fn`
+ * must not call `pool_for()` on the same pool.
+ * @param self The Pool on which to run.
+ * @param start The first index.
+ * @param end One past the last index.
+ * @param grain The smallest number of indices in a chunk, or zero for the
+ * pool's grain.
+ * @param fn Called with each chunk's range of indices.
+ * @param ctx Passed to every call of `fn`.
+ */
+void pool_for(
+	Pool* const self,
+	size_t start,
+	size_t end,
+	size_t grain,
+	PoolFn fn,
+	void* ctx
+) {
+	if (end <= start) {
+		return;
+	}
+	if (grain == 0) {
+		grain = self->grain;
+	}
+	size_t len = end - start;
+	if (self->threads <= 1 || len <= grain) {
+		fn(start, end, ctx);
+		return;
+	}
+	/* Chunk indices must fit in half of a packed deque. */
+	size_t chunk = grain;
+	if (len / chunk >= UINT32_MAX) {
+		chunk = len / (UINT32_MAX - 1) + 1;
+	}
+	size_t chunks = (len + chunk - 1) / chunk;
+
+	pthread_mutex_lock(&self->run_lock);
+	pthread_mutex_lock(&self->lock);
+	self->fn = fn;
+	self->ctx = ctx;
+	self->start = start;
+	self->end = end;
+	self->chunk = chunk;
+	self->remaining = chunks;
+	/* Deal each thread an equal, contiguous run of chunks. */
+	for (size_t idx = 0; idx < self->threads; ++idx) {
+		size_t lo = chunks * idx / self->threads;
+		size_t hi = chunks * (idx + 1) / self->threads;
+		__atomic_store_n(&self->deques[idx].range, pool_pack(lo, hi), __ATOMIC_RELAXED);
+	}
+	self->active = self->threads - 1;
+	++self->generation;
+	pthread_cond_broadcast(&self->wake);
+	pthread_mutex_unlock(&self->lock);
+
+	pool_work(self, 0);
+
+	pthread_mutex_lock(&self->lock);
+	while (self->active > 0) {
+		pthread_cond_wait(&self->done, &self->lock);
+	}
+	pthread_mutex_unlock(&self->lock);
+	pthread_mutex_unlock(&self->run_lock);
+}
+
+/**
+ * Copy bytes between non-overlapping Slices on the pool.
+ * @param self The Pool on which to run.
+ * @param dst The Slice to receive the bytes.
+ * @param src The bytes to copy.
+ * @return The number of bytes copied, which is the shorter of the two lengths.
+ */
+size_t pool_copy(Pool* const self, const Slice dst, const Slice src) {
+	size_t len = dst.len < src.len ? dst.len : src.len;
+	PoolPair pair = { .dst = dst, .src = src };
+	pool_for(self, 0, len, 0, pool_run_copy, &pair);
+	return len;
+}
+
+/**
+ * Set every byte of a Slice on the pool.
+ * @param self The Pool on which to run.
+ * @param dst The Slice to fill.
+ * @param byte The value to store.
+ */
+void pool_fill(Pool* const self, const Slice dst, unsigned char byte) {
+	PoolPair pair = { .dst = dst, .byte = byte };
+	pool_for(self, 0, dst.len, 0, pool_run_fill, &pair);
+}
+
+/**
+ * Find the first occurrence of a byte on the pool.
+ *
+ * Chunks past an occurrence that has already been found are skipped.
+ * @param self The Pool on which to run.
+ * @param src The Slice to search.
+ * @param byte The byte to find.
+ * @return The index of the first occurrence, or `src.len` if there is none.
+ */
+size_t pool_find_byte(Pool* const self, const Slice src, unsigned char byte) {
+	PoolPair pair = { .src = src, .byte = byte, .result = src.len };
+	pool_for(self, 0, src.len, 0, pool_run_find, &pair);
+	return pair.result;
+}
+
+/**
+ * Count the occurrences of a byte on the pool.
+ * @param self The Pool on which to run.
+ * @param src The Slice to search.
+ * @param byte The byte to count.
+ * @return The number of occurrences.
+ */
+size_t pool_count_byte(Pool* const self, const Slice src, unsigned char byte) {
+	PoolPair pair = { .src = src, .byte = byte, .result = 0 };
+	pool_for(self, 0, src.len, 0, pool_run_count, &pair);
+	return pair.result;
+}
+
+/**
+ * Compute or continue a CRC-32C checksum on the pool, with the same result as
+ * `hash_crc32c()`.
+ *
+ * The data is cut into grain-sized pieces that are checksummed independently
+ * and then joined with `hash_crc32c_combine()`.
+ * @param self The Pool on which to run.
+ * @param crc The CRC of the data preceding `data`, or 0 to start a new one.
+ * @param data The bytes to checksum.
+ * @return The CRC of everything up to and including `data`.
+ */
+uint32_t pool_crc32c(Pool* const self, uint32_t crc, const Slice data) {
+	size_t grain = self->grain;
+	if (self->threads <= 1 || data.len <= grain) {
+		return hash_crc32c(crc, data);
+	}
+	size_t pieces = (data.len + grain - 1) / grain;
+	PoolPair pair = {
+		.src = data,
+		.crcs = INSTRUMENT_MALLOC("pool", pieces * sizeof(uint32_t)),
+		.grain = grain,
+	};
+	/* Without room for the pieces' CRCs, checksum on this thread alone. */
+	if (pair.crcs == NULL) {
+		return hash_crc32c(crc, data);
+	}
+	pool_for(self, 0, pieces, 1, pool_run_crc32c, &pair);
+	for (size_t idx = 0; idx < pieces; ++idx) {
+		size_t len = idx + 1 < pieces ? grain : data.len - idx * grain;
+		crc = hash_crc32c_combine(crc, pair.crcs[idx], len);
+	}
+	INSTRUMENT_FREE("pool", pair.crcs);
+	return crc;
+}
+
+/**
+ * Write the hexadecimal encoding of a Slice into a pre-existing buffer, on the
+ * pool.
+ * @param self The Pool on which to run.
+ * @param dst The buffer to receive two characters per source byte.
+ * @param src The bytes to encode.
+ * @return The number of characters written, or zero if `dst` is too small.
+ */
+size_t pool_hex_encode_into(Pool* const self, const Slice dst, const Slice src) {
+	if (dst.len < 2 * src.len) {
+		return 0;
+	}
+	PoolPair pair = { .dst = dst, .src = src };
+	pool_for(self, 0, src.len, 0, pool_run_hex, &pair);
+	return 2 * src.len;
+}
+
+/**
+ * INTERNAL: The body of each thread other than the caller. It sleeps until a
+ * job is posted, works on it, and reports when it runs out of chunks.
+ * @param arg The Pool.
+ * @return NULL.
+ */
+static void* pool_worker(void* arg) {
+	Pool* self = arg;
+	uint64_t seen = 0;
+	pthread_mutex_lock(&self->lock);
+	/* This thread's place in the deques is the order in which it started. */
+	size_t me = ++self->started;
+	for (;;) {
+		while (self->generation == seen && !self->stop) {
+			pthread_cond_wait(&self->wake, &self->lock);
+		}
+		if (self->stop) {
+			break;
+		}
+		seen = self->generation;
+		pthread_mutex_unlock(&self->lock);
+		pool_work(self, me);
+		pthread_mutex_lock(&self->lock);
+		if (--self->active == 0) {
+			pthread_cond_signal(&self->done);
+		}
+	}
+	pthread_mutex_unlock(&self->lock);
+	return NULL;
+}
+
+/**
+ * INTERNAL: Run chunks of the current job, first from this thread's deque and
+ * then from others', until every chunk is finished.
+ * @param self The Pool.
+ * @param me The index of this thread's deque.
+ */
+static void pool_work(Pool* const self, size_t me) {
+	for (;;) {
+		size_t idx;
+		if (pool_take(&self->deques[me], &idx) || pool_steal(self, me, &idx)) {
+			size_t start = self->start + idx * self->chunk;
+			size_t rest = self->end - start;
+			self->fn(start, start + (rest < self->chunk ? rest : self->chunk), self->ctx);
+			__atomic_sub_fetch(&self->remaining, 1, __ATOMIC_ACQ_REL);
+			continue;
+		}
+		/* Nothing left to take, but chunks may still be running elsewhere. */
+		if (__atomic_load_n(&self->remaining, __ATOMIC_ACQUIRE) == 0) {
+			return;
+		}
+		sched_yield();
+	}
+}
+
+/**
+ * INTERNAL: Take the first chunk from a deque.
+ * @param deque The deque, normally the calling thread's own.
+ * @param idx Receives the index of the chunk.
+ * @return true if a chunk was taken, or false if the deque is empty.
+ */
+static bool pool_take(PoolDeque* const deque, size_t* const idx) {
+	uint64_t range = __atomic_load_n(&deque->range, __ATOMIC_ACQUIRE);
+	for (;;) {
+		size_t lo = (size_t)(uint32_t)range;
+		size_t hi = (size_t)(range >> 32);
+		if (lo >= hi) {
+			return false;
+		}
+		if (__atomic_compare_exchange_n(
+			&deque->range, &range, pool_pack(lo + 1, hi),
+			false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE
+		)) {
+			*idx = lo;
+			return true;
+		}
+	}
+}
+
+/**
+ * INTERNAL: Steal the back half of another thread's chunks into this thread's
+ * empty deque, and take the first of them.
+ * @param self The Pool.
+ * @param me The index of the calling thread's deque.
+ * @param idx Receives the index of the chunk taken.
+ * @return true if a chunk was stolen, or false if every deque is empty.
+ */
+static bool pool_steal(Pool* const self, size_t me, size_t* const idx) {
+	for (size_t step = 1; step < self->threads; ++step) {
+		PoolDeque* victim = &self->deques[(me + step) % self->threads];
+		uint64_t range = __atomic_load_n(&victim->range, __ATOMIC_ACQUIRE);
+		for (;;) {
+			size_t lo = (size_t)(uint32_t)range;
+			size_t hi = (size_t)(range >> 32);
+			if (lo >= hi) {
+				break;
+			}
+			size_t mid = hi - (hi - lo + 1) / 2;
+			if (__atomic_compare_exchange_n(
+				&victim->range, &range, pool_pack(lo, mid),
+				false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE
+			)) {
+				/* No other thread steals from an empty deque, so a store will do. */
+				__atomic_store_n(&self->deques[me].range, pool_pack(mid + 1, hi), __ATOMIC_RELEASE);
+				*idx = mid;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * INTERNAL: Pack the bounds of a run of chunks into a deque's word.
+ */
+static uint64_t pool_pack(size_t lo, size_t hi) {
+	return (uint64_t)hi << 32 | (uint64_t)(uint32_t)lo;
+}
+
+/**
+ * INTERNAL: The chunks of the `Slice` operations.
+ */
+static void pool_run_copy(size_t start, size_t end, void* ctx) {
+	PoolPair* pair = ctx;
+	memcpy(&pair->dst.ptr[start], &pair->src.ptr[start], end - start);
+}
+
+static void pool_run_fill(size_t start, size_t end, void* ctx) {
+	PoolPair* pair = ctx;
+	memset(&pair->dst.ptr[start], pair->byte, end - start);
+}
+
+static void pool_run_find(size_t start, size_t end, void* ctx) {
+	PoolPair* pair = ctx;
+	size_t best = __atomic_load_n(&pair->result, __ATOMIC_RELAXED);
+	if (start >= best) {
+		return;
+	}
+	size_t at = slice_find_byte(slice_new(&pair->src.ptr[start], end - start), pair->byte);
+	if (at == end - start) {
+		return;
+	}
+	at += start;
+	while (at < best && !__atomic_compare_exchange_n(
+		&pair->result, &best, at,
+		false, __ATOMIC_RELAXED, __ATOMIC_RELAXED
+	)) {
+	}
+}
+
+static void pool_run_count(size_t start, size_t end, void* ctx) {
+	PoolPair* pair = ctx;
+	size_t count = slice_count_byte(slice_new(&pair->src.ptr[start], end - start), pair->byte);
+	__atomic_add_fetch(&pair->result, count, __ATOMIC_RELAXED);
+}
+
+/**
+ * INTERNAL: Checksum a run of whole pieces.
+ */
+static void pool_run_crc32c(size_t start, size_t end, void* ctx) {
+	PoolPair* pair = ctx;
+	size_t grain = pair->grain;
+	for (size_t idx = start; idx < end; ++idx) {
+		size_t at = idx * grain;
+		size_t rest = pair->src.len - at;
+		Slice piece = slice_new(&pair->src.ptr[at], rest < grain ? rest : grain);
+		pair->crcs[idx] = hash_crc32c(0, piece);
+	}
+}
+
+static void pool_run_hex(size_t start, size_t end, void* ctx) {
+	PoolPair* pair = ctx;
+	hex_encode_into(
+		slice_new(&pair->dst.ptr[2 * start], 2 * (end - start)),
+		slice_new(&pair->src.ptr[start], end - start)
+	);
+}
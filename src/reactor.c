@@ -0,0 +1,385 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <wyzyrdry.h>
+
+static ReactorLink* reactor_links(const Reactor* const self);
+static bool reactor_watch(Reactor* const self, size_t idx, int op);
+static size_t reactor_pump_read(ReactorLink* const link);
+static size_t reactor_pump_write(ReactorLink* const link);
+static ssize_t reactor_send(
+	const ReactorLink* const link,
+	const struct iovec* iov,
+	size_t count
+);
+
+/**
+ * Initialize a Reactor with no links.
+ * @param self The Reactor to initialize.
+ * @return true on success, or false if the `epoll` instance could not be
+ * created, in which case the Reactor must not be used.
+ */
+bool reactor_init(Reactor* const self) {
+	self->epfd = epoll_create1(EPOLL_CLOEXEC);
+	self->links = (Vec){ .buf = NULL, .len = 0, .cap = 0 };
+	return self->epfd >= 0;
+}
+
+/**
+ * Deallocate a Reactor and its links.
+ *
+ * The linked descriptors are not closed, and the RingBufs are left as they are.
+ * @param self The Reactor on which to act.
+ */
+void reactor_free(Reactor* const self) {
+	ReactorLink* links = reactor_links(self);
+	for (size_t idx = 0; idx < self->links.len / sizeof(ReactorLink); ++idx) {
+		if (links[idx].in != NULL) {
+			frame_decoder_free(&links[idx].decoder);
+			INSTRUMENT_FREE("reactor", links[idx].input);
+		}
+	}
+	vec_free(&self->links);
+	close(self->epfd);
+	self->epfd = -1;
+}
+
+/**
+ * Link a descriptor to a RingBuf, and start watching it.
+ *
+ * The descriptor is made non-blocking. It may be given one RingBuf to read into
+ * and one to write from, by two calls.
+ *
+ * A RingBuf that is read into must be able to hold the longest frame that will
+ * arrive; longer frames close the link. Its latency, compression, and Arena
+ * settings should be made before it is linked. A RingBuf that is written from
+ * must not use compression or an Arena, as its messages are sent as they are
+ * stored.
+ * @param self The Reactor on which to act.
+ * @param fd The descriptor, which stays owned by the caller.
+ * @param ring The RingBuf to fill or drain.
+ * @param dir Whether to read frames from `fd` into `ring`, or to write the
+ * messages in `ring` to `fd`.
+ * @return true on success, or false if the descriptor already has a RingBuf in
+ * that direction, `ring` has message headers and is to be written from, or a
+ * system call or allocation failed.
+ */
+bool reactor_add(Reactor* const self, int fd, RingBuf* const ring, ReactorDir dir) {
+	ReactorLink* link = reactor_link(self, fd);
+	if (link != NULL && (dir == REACTOR_READ ? link->in : link->out) != NULL) {
+		return false;
+	}
+	if (dir == REACTOR_WRITE && (ring->compress || ring->arena != NULL)) {
+		return false;
+	}
+	int flags = fcntl(fd, F_GETFL);
+	if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+		return false;
+	}
+	unsigned char* input = NULL;
+	FrameDecoder decoder;
+	if (dir == REACTOR_READ) {
+		/* Frames must fit in the empty RingBuf, after its own overhead. */
+		size_t room = ringbuf_space_max(ring);
+		size_t extra = ringbuf_stored_size(ring, 0);
+		if (room <= extra) {
+			return false;
+		}
+		size_t max_len = room - extra;
+		if (ringbuf_stored_size(ring, (StrLen)FRAME_MAX_LEN) <= room) {
+			/* Long frames are passed by reference, so any length fits. */
+			max_len = FRAME_MAX_LEN;
+		}
+		input = INSTRUMENT_MALLOC("reactor", REACTOR_READ_SIZE);
+		decoder = frame_decoder_init(max_len);
+		if (input == NULL || decoder.partial.buf == NULL) {
+			INSTRUMENT_FREE("reactor", input);
+			frame_decoder_free(&decoder);
+			return false;
+		}
+	}
+	bool fresh = link == NULL;
+	if (fresh) {
+		int type;
+		socklen_t type_len = sizeof(type);
+		ReactorLink blank = {
+			.fd = fd,
+			.in = NULL,
+			.out = NULL,
+			/* Anything that arrived before the link is found by trying. */
+			.readable = true,
+			.writable = true,
+			.in_closed = false,
+			.out_closed = false,
+			.socket = getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &type_len) == 0,
+			.input = NULL,
+			.sent = 0,
+		};
+		size_t before = self->links.len;
+		vec_push_slice(&self->links, slice_new((unsigned char*)&blank, sizeof(blank)));
+		if (self->links.len == before) {
+			if (dir == REACTOR_READ) {
+				INSTRUMENT_FREE("reactor", input);
+				frame_decoder_free(&decoder);
+			}
+			return false;
+		}
+		link = &reactor_links(self)[self->links.len / sizeof(ReactorLink) - 1];
+	}
+	if (dir == REACTOR_READ) {
+		link->in = ring;
+		link->input = input;
+		link->decoder = decoder;
+	}
+	else {
+		link->out = ring;
+	}
+	size_t idx = (size_t)(link - reactor_links(self));
+	if (!reactor_watch(self, idx, fresh ? EPOLL_CTL_ADD : EPOLL_CTL_MOD)) {
+		if (dir == REACTOR_READ) {
+			link->in = NULL;
+			link->input = NULL;
+			INSTRUMENT_FREE("reactor", input);
+			frame_decoder_free(&decoder);
+		}
+		else {
+			link->out = NULL;
+		}
+		if (fresh) {
+			self->links.len -= sizeof(ReactorLink);
+		}
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Find the link of a descriptor, to inspect its state.
+ * @param self The Reactor to search.
+ * @param fd The descriptor.
+ * @return The link, or NULL if `fd` has not been added. It is valid until the
+ * next call of `reactor_add()`.
+ */
+ReactorLink* reactor_link(const Reactor* const self, int fd) {
+	ReactorLink* links = reactor_links(self);
+	for (size_t idx = 0; idx < self->links.len / sizeof(ReactorLink); ++idx) {
+		if (links[idx].fd == fd) {
+			return &links[idx];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Wait for descriptors to become ready, then move as many messages as they and
+ * the RingBufs allow.
+ * @param self The Reactor on which to act.
+ * @param timeout_ms The longest time to wait, in milliseconds: 0 to check
+ * without waiting, or -1 to wait indefinitely.
+ * @return The number of messages moved, or -1 if `epoll_wait()` failed.
+ */
+int reactor_poll(Reactor* const self, int timeout_ms) {
+	struct epoll_event events[REACTOR_BATCH];
+	int got = epoll_wait(self->epfd, events, REACTOR_BATCH, timeout_ms);
+	if (got < 0 && errno != EINTR) {
+		return -1;
+	}
+	ReactorLink* links = reactor_links(self);
+	for (int idx = 0; idx < got; ++idx) {
+		ReactorLink* link = &links[events[idx].data.u64];
+		uint32_t flags = events[idx].events;
+		/* Errors and hangups are reported by the next read or write. */
+		if (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+			link->readable = true;
+		}
+		if (flags & (EPOLLOUT | EPOLLHUP | EPOLLERR)) {
+			link->writable = true;
+		}
+	}
+	return (int)reactor_pump(self);
+}
+
+/**
+ * Move as many messages as the descriptors and RingBufs allow, without waiting.
+ *
+ * Call this after taking messages from a full RingBuf, to resume reading
+ * into it, and after writing messages into a RingBuf, to send them.
+ * @param self The Reactor on which to act.
+ * @return The number of messages moved.
+ */
+size_t reactor_pump(Reactor* const self) {
+	ReactorLink* links = reactor_links(self);
+	size_t ret = 0;
+	for (size_t idx = 0; idx < self->links.len / sizeof(ReactorLink); ++idx) {
+		ReactorLink* link = &links[idx];
+		if (link->in != NULL && !link->in_closed) {
+			ret += reactor_pump_read(link);
+		}
+		if (link->out != NULL && !link->out_closed && link->writable) {
+			ret += reactor_pump_write(link);
+		}
+	}
+	return ret;
+}
+
+/**
+ * INTERNAL: View the links as an array.
+ */
+static ReactorLink* reactor_links(const Reactor* const self) {
+	return (ReactorLink*)self->links.buf;
+}
+
+/**
+ * INTERNAL: Register a link's descriptor with `epoll` for the directions it
+ * has RingBufs for.
+ * @param self The Reactor on which to act.
+ * @param idx The index of the link.
+ * @param op `EPOLL_CTL_ADD` or `EPOLL_CTL_MOD`.
+ * @return Whether `epoll_ctl()` succeeded.
+ */
+static bool reactor_watch(Reactor* const self, size_t idx, int op) {
+	ReactorLink* link = &reactor_links(self)[idx];
+	struct epoll_event event = {
+		.events = EPOLLET
+			| (link->in != NULL ? EPOLLIN | EPOLLRDHUP : 0)
+			| (link->out != NULL ? EPOLLOUT : 0),
+		.data.u64 = idx,
+	};
+	return epoll_ctl(self->epfd, op, link->fd, &event) == 0;
+}
+
+/**
+ * INTERNAL: Decode frames into a link's RingBuf, reading until the descriptor
+ * would block or the RingBuf is full.
+ *
+ * Frames already decoded are delivered first, so that a RingBuf that was full
+ * is refilled even if no new data has arrived.
+ * @param link The link on which to act.
+ * @return The number of messages added to the RingBuf.
+ */
+static size_t reactor_pump_read(ReactorLink* const link) {
+	RingBuf* ring = link->in;
+	size_t before = ring->count;
+	for (;;) {
+		FrameResult res = frame_decoder_into_ringbuf(&link->decoder, ring);
+		if (GET_VARIANT_TYPE(res) == ENUM_VAR(FrameResult, Full)) {
+			/* The descriptor stays readable, to resume once there is room. */
+			break;
+		}
+		if (GET_VARIANT_TYPE(res) == ENUM_VAR(FrameResult, TooLarge)) {
+			link->in_closed = true;
+			break;
+		}
+		if (!link->readable) {
+			break;
+		}
+		ssize_t got = read(link->fd, link->input, REACTOR_READ_SIZE);
+		if (got > 0) {
+			frame_decoder_feed(&link->decoder, slice_new(link->input, (size_t)got));
+			continue;
+		}
+		if (got < 0 && errno == EINTR) {
+			continue;
+		}
+		if (got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+			link->in_closed = true;
+		}
+		link->readable = false;
+		break;
+	}
+	return ring->count - before;
+}
+
+/**
+ * INTERNAL: Send the messages of a link's RingBuf as frames, until it is empty
+ * or the descriptor would block.
+ *
+ * Each `writev()` gathers up to `REACTOR_BATCH` messages from the store, with
+ * their prefixes converted to network byte order. Messages are popped once
+ * their whole frame has been written; `sent` remembers how much of the first
+ * remaining one already was.
+ * @param link The link on which to act.
+ * @return The number of messages sent and popped.
+ */
+static size_t reactor_pump_write(ReactorLink* const link) {
+	RingBuf* ring = link->out;
+	size_t ret = 0;
+	while (ring->count > 0) {
+		struct iovec iov[3 * REACTOR_BATCH];
+		unsigned char prefixes[REACTOR_BATCH][sizeof(StrLen)];
+		size_t count = 0;
+		size_t msgs = 0;
+		RingBufCursor cursor = { .seen = 0, .pos = 0 };
+		Slice parts[2];
+		while (msgs < REACTOR_BATCH && ringbuf_next(ring, &cursor, parts)) {
+			str_len_to_wire(prefixes[msgs], (StrLen)(parts[0].len + parts[1].len));
+			iov[count++] = (struct iovec){ .iov_base = prefixes[msgs], .iov_len = sizeof(StrLen) };
+			for (size_t pdx = 0; pdx < 2; ++pdx) {
+				if (parts[pdx].len > 0) {
+					iov[count++] = (struct iovec){
+						.iov_base = (void*)parts[pdx].ptr,
+						.iov_len = parts[pdx].len,
+					};
+				}
+			}
+			++msgs;
+		}
+		/* Skip what an earlier, partial write already sent. */
+		size_t first = 0;
+		size_t skip = link->sent;
+		while (skip > 0 && skip >= iov[first].iov_len) {
+			skip -= iov[first].iov_len;
+			++first;
+		}
+		iov[first].iov_base = (unsigned char*)iov[first].iov_base + skip;
+		iov[first].iov_len -= skip;
+		ssize_t put = reactor_send(link, &iov[first], count - first);
+		if (put < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				link->out_closed = true;
+			}
+			link->writable = false;
+			break;
+		}
+		size_t done = link->sent + (size_t)put;
+		while (ring->count > 0) {
+			size_t frame = str_size(ringbuf_peek_len(ring));
+			if (done < frame) {
+				break;
+			}
+			done -= frame;
+			ringbuf_pop(ring);
+			++ret;
+		}
+		link->sent = done;
+	}
+	return ret;
+}
+
+/**
+ * INTERNAL: Write gathered buffers to a link's descriptor. Sockets use
+ * `sendmsg()`, so that a closed peer is reported as an error rather than by
+ * `SIGPIPE`.
+ */
+static ssize_t reactor_send(
+	const ReactorLink* const link,
+	const struct iovec* iov,
+	size_t count
+) {
+	if (!link->socket) {
+		return writev(link->fd, iov, (int)count);
+	}
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = (struct iovec*)iov;
+	msg.msg_iovlen = count;
+	return sendmsg(link->fd, &msg, MSG_NOSIGNAL);
+}
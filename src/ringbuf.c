@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 
 #include <wyzyrdry.h>
 
@@ -43,12 +44,69 @@ ENUM(RbAct, char*, NoOp, StrLen, NoWrap, RbWrap, Wrap);
  */
 ENUM(RbOp, StrLen, Read, StrLen, Write);
 
+/**
+ * The first byte of each message in a compressing `RingBuf`, or one with an
+ * `Arena`.
+ *
+ * RB_PLAIN marks a message stored as it was written.
+ *
+ * RB_LZ marks a message stored as its length, then an `LZ` block.
+ *
+ * RB_REF marks a message stored as an `ArenaRef` to the block that holds it.
+ */
+enum RbCodec {
+	RB_PLAIN = 0,
+	RB_LZ = 1,
+	RB_REF = 2,
+};
+
+/**
+ * The length of the write time that follows the prefix of each message in a
+ * `RingBuf` that records latency.
+ */
+#define RB_STAMP sizeof(uint64_t)
+
 StrLen ringbuf_push_raw(
 	RingBuf* const self,
 	StrLen len,
 	const unsigned char* const src
 );
 RbAct ringbuf_check(const RingBuf* const self, RbOp op);
+static StrLen ringbuf_push(
+	RingBuf* const self,
+	StrLen len,
+	const unsigned char* const src
+);
+static StrLen ringbuf_push_parts(
+	RingBuf* const self,
+	const Slice* const parts,
+	size_t n,
+	StrLen len
+);
+static StrLen ringbuf_push_parts_raw(
+	RingBuf* const self,
+	const Slice head,
+	const Slice* const parts,
+	size_t n,
+	StrLen len
+);
+static void ringbuf_gather(unsigned char* dst, const Slice* const parts, size_t n);
+static StrLen ringbuf_read_record(RingBuf* const self, const Slice out);
+static unsigned char ringbuf_parts_byte(const Slice parts[2], size_t idx);
+static StrLen ringbuf_record_len(const RingBuf* const self);
+static StrLen ringbuf_record_slices(const RingBuf* const self, Slice parts[2]);
+static void ringbuf_parts_skip(Slice parts[2], size_t len);
+static void ringbuf_put(RingBuf* const self, const void* src, size_t len);
+static void ringbuf_record_latency(RingBuf* const self);
+static uint64_t ringbuf_now(void);
+static bool ringbuf_has_codec(const RingBuf* const self);
+static ArenaRef ringbuf_parts_ref(const Slice parts[2]);
+static StrLen ringbuf_push_ref(RingBuf* const self, const ArenaRef ref);
+static void ringbuf_drop(RingBuf* const self);
+static bool ringbuf_grow(RingBuf* const self, size_t need);
+static void ringbuf_settle(RingBuf* const self, size_t removed);
+static bool ringbuf_resize(RingBuf* const self, size_t cap);
+static void ringbuf_release(const RingBuf* const self, const Slice store);
 
 /**
  * Initialize a `RingBuf` over the given `Slice` of memory.
@@ -64,15 +122,44 @@ RingBuf ringbuf_init(const Slice store) {
 	return ret;
 }
 
+/**
+ * Initialize a `RingBuf` over a new store from `pages_alloc()`, for large
+ * queues that want huge pages, a NUMA node, or no page faults on their first
+ * messages.
+ * @param len The least size of the store.
+ * @param flags The `PagesFlag`s to ask for.
+ * @param node The NUMA node on which to place the store, or `PAGES_ANY_NODE`.
+ * @return The `RingBuf` control structure. If allocation failed, its store is
+ * empty with a NULL pointer.
+ */
+RingBuf ringbuf_init_pages(size_t len, unsigned int flags, int node) {
+	unsigned int got = 0;
+	RingBuf ret = {
+		.store = pages_alloc(len, flags, node, &got),
+	};
+	/* The store starts zeroed, and wiping it would fault in every page on this
+	 * thread, so it is not wiped. */
+	if (ret.store.ptr != NULL) {
+		ret.pages = got | (flags & (PAGES_HUGE | PAGES_PREFAULT));
+		ret.node = node;
+	}
+	return ret;
+}
+
 /**
  * Deallocate the memory behind a `RingBuf` and erase its control structure.
  * @param self A pointer to the `RingBuf` to be erased.
  */
 void ringbuf_free(RingBuf* const self) {
+	/* Blocks still referenced by messages go back to their Arena. */
+	while (self->arena != NULL && self->count > 0) {
+		ringbuf_pop(self);
+	}
 	ringbuf_wipe(self);
+	vec_free(&self->scratch);
 	Slice old = self->store;
 	self->store = slice_new(NULL, 0);
-	free(old.ptr);
+	ringbuf_release(self, old);
 }
 
 /**
@@ -87,37 +174,164 @@ void ringbuf_wipe(RingBuf* const self) {
 }
 
 /**
- * Calculates how many bytes of the store are not in active use.
- * @param self The `RingBuf` to inspect.
- * @return A count of available bytes.
+ * Turn compression of messages on or off.
+ *
+ * Messages of at least `min_len` bytes are compressed, and kept that way if it
+ * makes them smaller; shorter ones only gain a one-byte header. Compression
+ * suits messages that repeat themselves, such as text logs, and the setting can
+ * only change while the queue is empty, as it changes how messages are stored.
+ * @param self The `RingBuf` on which to act.
+ * @param enable Whether to compress.
+ * @param min_len The shortest message worth compressing.
+ * @return true if the setting changed, or false if the queue is not empty.
+ */
+bool ringbuf_set_compression(RingBuf* const self, bool enable, StrLen min_len) {
+	if (self->count > 0) {
+		return false;
+	}
+	self->compress = enable;
+	self->compress_min = min_len;
+	return true;
+}
+
+/**
+ * Start or stop recording how long each message waits in the queue.
+ *
+ * While a histogram is installed, every message is stamped with the
+ * `CLOCK_MONOTONIC` time when it is written, and the nanoseconds from then
+ * until it is read or popped are recorded in the histogram. The stamp takes
+ * eight bytes of the store per message and is not seen by readers. Like
+ * compression, this can only change while the queue is empty. The histogram
+ * belongs to the caller, and several queues may share one or keep their own to
+ * be merged with `hist_merge()`.
+ * @param self The `RingBuf` on which to act.
+ * @param hist The histogram to receive latencies, or NULL to stop stamping.
+ * @return true if the setting changed, or false if the queue is not empty.
  */
-size_t ringbuf_space_free(const RingBuf* const self) {
-	return self->store.len - ringbuf_space_used(self);
+bool ringbuf_set_latency(RingBuf* const self, Hist* const hist) {
+	if (self->count > 0) {
+		return false;
+	}
+	self->latency = hist;
+	return true;
+}
+
+/**
+ * Start or stop passing large messages by reference.
+ *
+ * With an Arena installed, a message longer than `inline_max` is kept in a
+ * block of the Arena, and the queue holds only a small descriptor of it. Like
+ * compression, every message then gains a one-byte header, which the peek
+ * functions see, and this can only change while the queue is empty. Writing a
+ * large message still copies it once, into its block; `ringbuf_write_ref()`
+ * and `ringbuf_read_ref()` pass a block without copying it at all.
+ * @param self The `RingBuf` on which to act.
+ * @param arena The Arena to hold large messages, or NULL to store every message
+ * in the queue. It must outlive the queue's use of it.
+ * @param inline_max The longest message kept in the queue itself.
+ * @return true if the setting changed, or false if the queue is not empty.
+ */
+bool ringbuf_set_arena(RingBuf* const self, Arena* const arena, StrLen inline_max) {
+	if (self->count > 0) {
+		return false;
+	}
+	self->arena = arena;
+	self->inline_max = inline_max;
+	return true;
 }
 
 /**
- * Calculates how many bytes of the store are in active use.
+ * Let the store grow when a message does not fit, and shrink when the queue
+ * stays lightly loaded.
+ *
+ * A write that does not fit moves the queued messages, in order, into a new
+ * store `factor` times the size of the old one, or as many times as it takes,
+ * up to `max` bytes. Once the queue has used no more than a `1 / (2 * factor)`
+ * share of its store while a store's worth of messages passed through it, the
+ * messages move into a store `factor` times smaller, but no smaller than the
+ * store is now. Each move copies the messages once, or twice if they wrap, and
+ * is paid for by the traffic since the last, so the cost per message stays
+ * constant. The store must have come from `malloc()`, or from
+ * `ringbuf_init_pages()`, as `ringbuf_free()` expects; a store of pages is
+ * replaced by another from `pages_alloc()`, with the same flags and node and
+ * rounded up to whole pages, and the old one is given back with `pages_free()`.
+ * Unlike the other settings, this can change at any time.
+ * @param self The `RingBuf` on which to act.
+ * @param factor The factor by which to grow, at least 2, or zero to fix the
+ * store at its present size.
+ * @param max The largest size of the store, in bytes.
+ * @return true if the setting changed, or false if `factor` is 1 or `max` is
+ * smaller than the store.
+ */
+bool ringbuf_set_growth(RingBuf* const self, unsigned factor, size_t max) {
+	if (factor == 1 || (factor > 1 && max < self->store.len)) {
+		return false;
+	}
+	self->grow = factor;
+	self->store_min = self->store.len;
+	self->store_max = factor > 1 ? max : self->store.len;
+	self->idle = 0;
+	return true;
+}
+
+/**
+ * Calculates how many bytes of the store a message would take.
+ *
+ * This is exact unless the message would be compressed, in which case it is
+ * the most the message can take.
  * @param self The `RingBuf` to inspect.
- * @return A count of unavailable bytes.
+ * @param len The length of the message.
+ * @return The number of bytes, including the length prefix and any header.
  */
-size_t ringbuf_space_used(const RingBuf* const self) {
-	if (self->count == 0) {
-		return 0;
+size_t ringbuf_stored_size(const RingBuf* const self, StrLen len) {
+	size_t body = len;
+	if (self->arena != NULL && len > self->inline_max) {
+		body = 1 + sizeof(ArenaRef);
 	}
-	if (self->head < self->tail) {
-		return self->tail - self->head;
+	else if (ringbuf_has_codec(self)) {
+		body = 1 + (size_t)len;
 	}
-	else {
-		return self->store.len - self->head + self->tail;
+	if (self->latency != NULL) {
+		body += RB_STAMP;
 	}
+	return sizeof(StrLen) + body;
 }
 
 /**
- * Retrieves the length of the first Str in the queue, if any.
+ * Checks whether a message would fit in the queue, counting the room a growing
+ * queue can make.
+ *
+ * Like `ringbuf_stored_size()`, this assumes a message to be compressed takes
+ * the most room it can. A growing queue can still fail to allocate its store.
+ * @param self The `RingBuf` to inspect.
+ * @param len The length of the message.
+ * @return true if a write of the message can succeed.
+ */
+bool ringbuf_fits(const RingBuf* const self, StrLen len) {
+	return ringbuf_space_used(self) + ringbuf_stored_size(self, len) <= ringbuf_space_max(self);
+}
+
+/**
+ * Retrieves the length of the first Str in the queue, if any, not counting a
+ * latency stamp.
  * @param self The `RingBuf` on which to act.
  * @return The length of the first `Str` in the queue, or zero if empty.
  */
 StrLen ringbuf_peek_len(const RingBuf* const self) {
+	StrLen len = ringbuf_record_len(self);
+	if (self->latency != NULL && len >= RB_STAMP) {
+		return len - RB_STAMP;
+	}
+	return len;
+}
+
+/**
+ * INTERNAL: Retrieves the length of the first Str in the queue as stored,
+ * including any latency stamp.
+ * @param self The `RingBuf` on which to act.
+ * @return The length of the first `Str` in the queue, or zero if empty.
+ */
+static StrLen ringbuf_record_len(const RingBuf* const self) {
 	if (self->count == 0) {
 		return 0;
 	}
@@ -139,9 +353,9 @@ StrLen ringbuf_peek_len(const RingBuf* const self) {
 				/* Prep to receive a StrLen */
 				unsigned char tmp[sizeof(StrLen)];
 				/* Move `front` bytes from self->head into tmp */
-				memmove(tmp, &self->store.ptr[self->head], w.front);
+				INSTRUMENT_MOVE("ringbuf", tmp, &self->store.ptr[self->head], w.front);
 				/* Move `back` bytes from self[0] into tmp[front] */
-				memmove(&tmp[w.front], self->store.ptr, w.back);
+				INSTRUMENT_MOVE("ringbuf", &tmp[w.front], self->store.ptr, w.back);
 				/* tmp is now the bytes of a StrLen; cast, deref, and return. */
 				return *(StrLen*)tmp;
 			}
@@ -151,6 +365,182 @@ StrLen ringbuf_peek_len(const RingBuf* const self) {
 	}
 }
 
+/**
+ * Retrieves the number of bytes that `ringbuf_read()` will deliver for the
+ * first message, which differs from its stored length when compression is on.
+ * @param self The `RingBuf` on which to act.
+ * @return The length of the first message as written, or zero if empty.
+ */
+StrLen ringbuf_peek_read_len(const RingBuf* const self) {
+	if (!ringbuf_has_codec(self)) {
+		return ringbuf_peek_len(self);
+	}
+	Slice parts[2];
+	StrLen stored = ringbuf_peek_slices(self, parts);
+	if (stored == 0) {
+		return 0;
+	}
+	if (ringbuf_parts_byte(parts, 0) == RB_REF) {
+		return stored < 1 + sizeof(ArenaRef) ? 0 : (StrLen)ringbuf_parts_ref(parts).len;
+	}
+	if (ringbuf_parts_byte(parts, 0) != RB_LZ) {
+		return stored - 1;
+	}
+	if (stored < 1 + sizeof(StrLen)) {
+		return 0;
+	}
+	unsigned char tmp[sizeof(StrLen)];
+	for (size_t idx = 0; idx < sizeof(StrLen); ++idx) {
+		tmp[idx] = ringbuf_parts_byte(parts, 1 + idx);
+	}
+	StrLen ret;
+	memcpy(&ret, tmp, sizeof(StrLen));
+	return ret;
+}
+
+/**
+ * Describes the payload of the first Str in the queue, without copying it.
+ *
+ * A payload that wraps around the end of the store is described by two
+ * Slices, in order; otherwise the second Slice is empty. The Slices remain
+ * valid until the message is read or popped, or a growing queue is written.
+ * @param self The `RingBuf` to inspect.
+ * @param parts Receives the one or two Slices over the payload. Both are empty
+ * if the queue is.
+ * @return The length of the first `Str` in the queue, or zero if empty.
+ */
+StrLen ringbuf_peek_slices(const RingBuf* const self, Slice parts[2]) {
+	StrLen msglen = ringbuf_record_slices(self, parts);
+	if (self->latency != NULL && msglen >= RB_STAMP) {
+		ringbuf_parts_skip(parts, RB_STAMP);
+		return msglen - RB_STAMP;
+	}
+	return msglen;
+}
+
+/**
+ * Describes the payload of the next message in a walk over the queue, without
+ * copying it or removing it.
+ *
+ * The Slices are as from `ringbuf_peek_slices()`, and remain valid until the
+ * message is read or popped, or a growing queue is written. The walk sees the
+ * messages queued when it started, so the queue must not be read from or popped
+ * during it.
+ * @param self The `RingBuf` to inspect.
+ * @param cursor The place in the walk, which is advanced past the message.
+ * @param parts Receives the one or two Slices over the payload.
+ * @return true if there was another message, or false at the end of the queue.
+ */
+bool ringbuf_next(
+	const RingBuf* const self,
+	RingBufCursor* const cursor,
+	Slice parts[2]
+) {
+	parts[0] = slice_new(NULL, 0);
+	parts[1] = slice_new(NULL, 0);
+	if (cursor->seen >= self->count) {
+		return false;
+	}
+	if (cursor->seen == 0) {
+		cursor->pos = self->head;
+	}
+	/*
+	 * Each message is its prefix and body laid end to end around the store.
+	 * Positions stay below `cap`, so wrapping one is a subtraction, not a
+	 * division.
+	 */
+	size_t cap = self->store.len;
+	unsigned char tmp[sizeof(StrLen)];
+	size_t at = cursor->pos;
+	for (size_t idx = 0; idx < sizeof(StrLen); ++idx) {
+		tmp[idx] = self->store.ptr[at];
+		at = at + 1 < cap ? at + 1 : 0;
+	}
+	StrLen len;
+	memcpy(&len, tmp, sizeof(StrLen));
+	size_t front = cap - at;
+	if (len <= front) {
+		parts[0] = slice_new(&self->store.ptr[at], len);
+	}
+	else {
+		parts[0] = slice_new(&self->store.ptr[at], front);
+		parts[1] = slice_new(self->store.ptr, len - front);
+	}
+	cursor->pos = len < front ? at + len : len - front;
+	++cursor->seen;
+	if (self->latency != NULL && len >= RB_STAMP) {
+		ringbuf_parts_skip(parts, RB_STAMP);
+	}
+	return true;
+}
+
+/**
+ * INTERNAL: Describes the whole of the first Str in the queue, including any
+ * latency stamp, in the manner of `ringbuf_peek_slices()`.
+ * @param self The `RingBuf` to inspect.
+ * @param parts Receives the one or two Slices over the Str's contents.
+ * @return The length of the first `Str` in the queue, or zero if empty.
+ */
+static StrLen ringbuf_record_slices(const RingBuf* const self, Slice parts[2]) {
+	parts[0] = slice_new(NULL, 0);
+	parts[1] = slice_new(NULL, 0);
+	StrLen msglen = ringbuf_record_len(self);
+	if (msglen == 0) {
+		return 0;
+	}
+	RbAct rba = ringbuf_check(self, SET_VARIANT(RbOp, Read, msglen));
+	switch (GET_VARIANT_TYPE(rba)) {
+		case ENUM_VAR(RbAct, NoWrap): {
+			parts[0] = slice_new(&self->store.ptr[self->head + sizeof(StrLen)], msglen);
+			break;
+		}
+		case ENUM_VAR(RbAct, Wrap): {
+			RbWrap w = GET_VARIANT_BODY(rba, Wrap);
+			/* A wrap in the prefix leaves the data contiguous at the front */
+			if (w.front <= sizeof(StrLen)) {
+				parts[0] = slice_new(&self->store.ptr[sizeof(StrLen) - w.front], msglen);
+			}
+			else {
+				parts[0] = slice_new(
+					&self->store.ptr[self->head + sizeof(StrLen)],
+					w.front - sizeof(StrLen)
+				);
+				parts[1] = slice_new(self->store.ptr, w.back);
+			}
+			break;
+		}
+		default:
+			return 0;
+	}
+	return msglen;
+}
+
+/**
+ * Computes the CRC-32C checksum of the first message in the queue, in place.
+ * @param self The `RingBuf` to inspect.
+ * @return The checksum of the first message's payload, or zero if empty.
+ */
+uint32_t ringbuf_peek_checksum(const RingBuf* const self) {
+	Slice parts[2];
+	ringbuf_peek_slices(self, parts);
+	return hash_crc32c(hash_crc32c(0, parts[0]), parts[1]);
+}
+
+/**
+ * Computes the XXH64 hash of the first message in the queue, in place.
+ * @param self The `RingBuf` to inspect.
+ * @param seed Selects an independent hash function.
+ * @return The hash of the first message's payload.
+ */
+uint64_t ringbuf_peek_hash(const RingBuf* const self, uint64_t seed) {
+	Slice parts[2];
+	ringbuf_peek_slices(self, parts);
+	Hasher h = hasher_init(seed);
+	hasher_update(&h, parts[0]);
+	hasher_update(&h, parts[1]);
+	return hasher_finish(&h);
+}
+
 /**
  * Pushes a `Str*` into the RingBuf, if possible.
  * @param self The `RingBuf` into which the `Str*` is pushed.
@@ -158,7 +548,7 @@ StrLen ringbuf_peek_len(const RingBuf* const self) {
  * @return The total number of bytes added to the queue.
  */
 StrLen ringbuf_write_str(RingBuf* const self, const Str* const in) {
-	return ringbuf_push_raw(self, (StrLen)in->len, in->data);
+	return ringbuf_push(self, (StrLen)in->len, in->data);
 }
 
 /**
@@ -168,7 +558,7 @@ StrLen ringbuf_write_str(RingBuf* const self, const Str* const in) {
  * @return The amount of data pushed into the queue.
  */
 StrLen ringbuf_write_vec(RingBuf* const self, const Vec* const in) {
-	return ringbuf_push_raw(self, (StrLen)in->len, in->buf);
+	return ringbuf_push(self, (StrLen)in->len, in->buf);
 }
 
 /**
@@ -178,7 +568,47 @@ StrLen ringbuf_write_vec(RingBuf* const self, const Vec* const in) {
  * @return The amount of data pushed into the queue.
  */
 StrLen ringbuf_write_slice(RingBuf* const self, const Slice in) {
-	return ringbuf_push_raw(self, (StrLen)in.len, in.ptr);
+	return ringbuf_push(self, (StrLen)in.len, in.ptr);
+}
+
+/**
+ * Pushes a message given as several `Slice`s, such as a header, a body, and a
+ * trailer held in separate buffers, into the queue as one message.
+ *
+ * The pieces are copied straight into the queue's store, wrapping around its
+ * end wherever that falls, so they need not be joined into one buffer first.
+ * @param self The queue to receive the message.
+ * @param parts The pieces of the message, in order.
+ * @param n The number of pieces.
+ * @return The amount of data pushed into the queue, or zero if the pieces
+ * together are too long for one message.
+ */
+StrLen ringbuf_write_gather(RingBuf* const self, const Slice* const parts, size_t n) {
+	size_t total = 0;
+	for (size_t idx = 0; idx < n; ++idx) {
+		total += parts[idx].len;
+		if (total > (StrLen)~(StrLen)0) {
+			fprintf(stderr, "Message too large!\n");
+			return 0;
+		}
+	}
+	return ringbuf_push_parts(self, parts, n, (StrLen)total);
+}
+
+/**
+ * Pushes a message held in an `Arena` block into the queue, without copying
+ * it.
+ * @param self A queue with an Arena, set by `ringbuf_set_arena()`.
+ * @param ref A block from that Arena, holding the message. On success the
+ * queue owns it; on failure the caller still does.
+ * @return The amount of data pushed into the queue, which is the size of the
+ * descriptor, or zero if the queue has no Arena or no room.
+ */
+StrLen ringbuf_write_ref(RingBuf* const self, const ArenaRef ref) {
+	if (self->arena == NULL || ref.ptr == NULL) {
+		return 0;
+	}
+	return ringbuf_push_ref(self, ref);
 }
 
 /**
@@ -187,12 +617,19 @@ StrLen ringbuf_write_slice(RingBuf* const self, const Slice in) {
  * If the `Slice` destination parameter cannot hold the first message, then the
  * transaction aborts without mutating the queue. If the destination can hold
  * the first message, then the body of the first `Str` is moved into the
- * `Slice`, and the number of message bytes moved is returned.
+ * `Slice`, and the number of message bytes moved is returned. A compressed
+ * message is decompressed into the `Slice`, which must be able to hold it as it
+ * was written; see `ringbuf_peek_read_len()`. An empty message is never read,
+ * and stays at the front of the queue until `ringbuf_pop()` removes it.
  * @param self The `RingBuf` from which to attempt a pop.
  * @param out The `Slice` into which the message (if any) will be delivered.
- * @return The number of bytes moved.
+ * @return The number of bytes moved, or zero if nothing was read, in which
+ * case the queue is unchanged.
  */
 StrLen ringbuf_read(RingBuf* const self, const Slice out) {
+	if (ringbuf_has_codec(self) || self->latency != NULL) {
+		return ringbuf_read_record(self, out);
+	}
 	StrLen msglen = ringbuf_peek_len(self);
 	/* Abort if there is no message, or the message is too large to fit. */
 	if (msglen == 0 || msglen > out.len) {
@@ -200,10 +637,11 @@ StrLen ringbuf_read(RingBuf* const self, const Slice out) {
 	}
 	/* Check what behavior is required to extract the message */
 	RbAct rba = ringbuf_check(self, SET_VARIANT(RbOp, Read, msglen));
+	size_t removed = str_size(msglen);
 	switch (GET_VARIANT_TYPE(rba)) {
 		case ENUM_VAR(RbAct, NoWrap): {
 			Str* msg = (Str*)&self->store.ptr[self->head];
-			memmove(out.ptr, &msg->data, msglen);
+			INSTRUMENT_MOVE("ringbuf", out.ptr, &msg->data, msglen);
 			self->head += GET_VARIANT_BODY(rba, NoWrap);
 			break;
 		}
@@ -213,7 +651,7 @@ StrLen ringbuf_read(RingBuf* const self, const Slice out) {
 			if (w.front <= sizeof(StrLen)) {
 				/* set the head at the start of the data (near index 0) */
 				self->head = sizeof(StrLen) - w.front;
-				memmove(out.ptr, &self->store.ptr[self->head], msglen);
+				INSTRUMENT_MOVE("ringbuf", out.ptr, &self->store.ptr[self->head], msglen);
 				self->head += msglen;
 			}
 			/* Otherwise, it occurred in the data */
@@ -221,8 +659,8 @@ StrLen ringbuf_read(RingBuf* const self, const Slice out) {
 				/* adjust the front and head to skip the prefix */
 				w.front -= sizeof(StrLen);
 				self->head += sizeof(StrLen);
-				memmove(out.ptr, &self->store.ptr[self->head], w.front);
-				memmove(&out.ptr[w.front], self->store.ptr, w.back);
+				INSTRUMENT_MOVE("ringbuf", out.ptr, &self->store.ptr[self->head], w.front);
+				INSTRUMENT_MOVE("ringbuf", &out.ptr[w.front], self->store.ptr, w.back);
 				self->head = w.back;
 			}
 			break;
@@ -236,21 +674,86 @@ StrLen ringbuf_read(RingBuf* const self, const Slice out) {
 		self->head = 0;
 		self->tail = 0;
 	}
+	if (self->grow != 0) {
+		ringbuf_settle(self, removed);
+	}
 	return msglen;
 }
 
+/**
+ * Moves the first message out of the queue as an `Arena` block, whose
+ * ownership passes to the caller.
+ *
+ * A message that was passed by reference is handed over without copying. One
+ * that was kept in the queue is copied into a new block, so that every message
+ * can be consumed in the same way.
+ * @param self A queue with an Arena, set by `ringbuf_set_arena()`.
+ * @param out Receives the block, which the caller must give back to the Arena
+ * with `arena_release()`.
+ * @return true if a message was taken, or false if the queue has no Arena, is
+ * empty, or a block could not be allocated, in which case the queue is
+ * unchanged.
+ */
+bool ringbuf_read_ref(RingBuf* const self, ArenaRef* const out) {
+	Slice parts[2];
+	if (self->arena == NULL || ringbuf_peek_slices(self, parts) == 0) {
+		return false;
+	}
+	if (ringbuf_parts_byte(parts, 0) == RB_REF) {
+		*out = ringbuf_parts_ref(parts);
+		ringbuf_drop(self);
+		return true;
+	}
+	StrLen len = ringbuf_peek_read_len(self);
+	ArenaRef ref = arena_alloc(self->arena, len);
+	if (ref.ptr == NULL) {
+		return false;
+	}
+	/* An empty message is not read, only popped. */
+	if (len == 0) {
+		ringbuf_pop(self);
+	}
+	else if (ringbuf_read(self, arena_as_slice(ref)) != len) {
+		arena_release(self->arena, ref);
+		return false;
+	}
+	*out = ref;
+	return true;
+}
+
 /**
  * Unconditionally destroys the first message in the queue.
  *
  * This sets the head cursor to target the cell immediately after the first
- * message ends. If the queue is empty, this function aborts without acting.
+ * message ends. If the queue is empty, this function aborts without acting. A
+ * message kept in an `Arena` block has its block released.
  * @param self
  */
 void ringbuf_pop(RingBuf* const self) {
-	StrLen msglen = ringbuf_peek_len(self);
-	if (msglen == 0) {
+	if (self->count > 0 && self->arena != NULL) {
+		Slice parts[2];
+		if (ringbuf_peek_slices(self, parts) >= 1 + sizeof(ArenaRef)
+			&& ringbuf_parts_byte(parts, 0) == RB_REF) {
+			arena_release(self->arena, ringbuf_parts_ref(parts));
+		}
+	}
+	ringbuf_drop(self);
+}
+
+/**
+ * INTERNAL: Remove the first message from the queue, leaving any block it
+ * refers to with the caller.
+ * @param self The `RingBuf` on which to act.
+ */
+static void ringbuf_drop(RingBuf* const self) {
+	/* An empty message still occupies its prefix, so test the count. */
+	if (self->count == 0) {
 		return;
 	}
+	if (self->latency != NULL) {
+		ringbuf_record_latency(self);
+	}
+	StrLen msglen = ringbuf_record_len(self);
 	RbAct rba = ringbuf_check(self, SET_VARIANT(RbOp, Read, msglen));
 	switch (GET_VARIANT_TYPE(rba)) {
 		/* The first stored message does not wrap; bump head */
@@ -277,6 +780,9 @@ void ringbuf_pop(RingBuf* const self) {
 		self->head = 0;
 		self->tail = 0;
 	}
+	if (self->grow != 0) {
+		ringbuf_settle(self, str_size(msglen));
+	}
 }
 
 /**
@@ -293,8 +799,8 @@ void ringbuf_debug_print(const RingBuf* const self) {
 		(size_t)self->count
 	);
 	if (self->store.ptr != NULL) {
-		printf("Contents: ");
-		hex_print(slice_new(self->store.ptr, 32));
+		printf("Contents:\n");
+		hex_print(self->store);
 	}
 }
 
@@ -313,72 +819,83 @@ void ringbuf_debug_print(const RingBuf* const self) {
  * @param len The amount of data to be pushed.
  * @param src The source of data to be pushed.
  * @return The amount of data actually pushed into the queue, including the
- * length prefix.
+ * length prefix and any latency stamp.
  */
 StrLen ringbuf_push_raw(
 	RingBuf* const self,
 	StrLen len,
 	const unsigned char* const src
+) {
+	Slice part = slice_new((unsigned char*)src, len);
+	return ringbuf_push_parts_raw(self, slice_new(NULL, 0), &part, 1, len);
+}
+
+/**
+ * INTERNAL: Push a record made of a header and several pieces of data, copying
+ * each straight into the store. This is `ringbuf_push_raw()` for data that is
+ * not in one piece.
+ * @param self The `RingBuf` into which the record is pushed.
+ * @param head Bytes stored ahead of the pieces, such as a codec byte. May be
+ * empty.
+ * @param parts The pieces, in order.
+ * @param n The number of pieces.
+ * @param len The total length of the pieces.
+ * @return The amount of data actually pushed into the queue, including the
+ * length prefix and any latency stamp.
+ */
+static StrLen ringbuf_push_parts_raw(
+	RingBuf* const self,
+	const Slice head,
+	const Slice* const parts,
+	size_t n,
+	StrLen len
 ) {
 	/* If the queue is empty, set both cursors to the start of the store */
 	if (self->count == 0) {
 		self->head = 0;
 		self->tail = 0;
 	}
-	/* Get the total size of the data to be pushed into the queue's store */
-	StrLen strlen = str_size(len);
+	/* A recording queue puts the write time between the prefix and the data */
+	StrLen stamp = self->latency != NULL ? RB_STAMP : 0;
+	if (head.len + len > (StrLen)~(StrLen)0 - sizeof(StrLen) - stamp) {
+		fprintf(stderr, "Message too large!\n");
+		return 0;
+	}
+	StrLen total = (StrLen)(head.len + len + stamp);
 	/* Check if the queue can receive that much data */
-	RbAct rba = ringbuf_check(self, SET_VARIANT(RbOp, Write, len));
-	switch (GET_VARIANT_TYPE(rba)) {
-		/* It can't */
-		case ENUM_VAR(RbAct, NoOp): {
-			fprintf(stderr, "%s\n", GET_VARIANT_BODY(rba, NoOp));
-			return 0;
+	RbAct rba = ringbuf_check(self, SET_VARIANT(RbOp, Write, total));
+	/* The pieces may lie in the old store, so it is freed after the copy. */
+	Slice old = slice_new(NULL, 0);
+	if (RbAct_is_NoOp(rba) && self->grow != 0) {
+		old = self->store;
+		if (ringbuf_grow(self, str_size(total))) {
+			rba = ringbuf_check(self, SET_VARIANT(RbOp, Write, total));
 		}
-		/* It can, easily */
-		case ENUM_VAR(RbAct, NoWrap): {
-			/* Write the length prefix into the current tail */
-			*(StrLen*)&self->store.ptr[self->tail] = len;
-			self->tail += sizeof(StrLen);
-			/* Write the data into the updated tail */
-			memmove(&self->store.ptr[self->tail], src, len);
-			self->tail += len;
-			break;
+		else {
+			old = slice_new(NULL, 0);
 		}
-		/* It can, less easily */
-		case ENUM_VAR(RbAct, Wrap): {
-			RbWrap w = GET_VARIANT_BODY(rba, Wrap);
-			/* Check if the wrap occurs in the middle of the length header */
-			if (w.front <= sizeof(StrLen)) {
-				/* Pretend the length is a byte buffer, and push it */
-				unsigned char* tmp = (void*)&len;
-				memmove(&self->store.ptr[self->tail], tmp, w.front);
-				unsigned char tback = sizeof(StrLen) - w.front;
-				memmove(self->store.ptr, &tmp[w.front], tback);
-				self->tail = tback;
-				/* Push the data */
-				memmove(&self->store.ptr[self->tail], src, len);
-				self->tail += len;
-				break;
-			}
-			else {
-				/* Push the length */
-				*(StrLen*)&self->store.ptr[self->tail] = len;
-				self->tail += sizeof(StrLen);
-				/* Update the wrap state to account for the pushed length */
-				w.front -= sizeof(StrLen);
-				/* Push the data */
-				memmove(&self->store.ptr[self->tail], src, w.front);
-				memmove(self->store.ptr, &src[w.front], w.back);
-				self->tail = w.back;
-				break;
-			}
+	}
+	if (RbAct_is_NoOp(rba)) {
+		fprintf(stderr, "%s\n", GET_VARIANT_BODY(rba, NoOp));
+		return 0;
+	}
+	/* Each piece may wrap around the end of the store independently */
+	ringbuf_put(self, &total, sizeof(StrLen));
+	if (stamp > 0) {
+		uint64_t now = ringbuf_now();
+		ringbuf_put(self, &now, sizeof(now));
+	}
+	if (head.len > 0) {
+		ringbuf_put(self, head.ptr, head.len);
+	}
+	for (size_t idx = 0; idx < n; ++idx) {
+		if (parts[idx].len > 0) {
+			ringbuf_put(self, parts[idx].ptr, parts[idx].len);
 		}
-		default:
-			return 0;
 	}
+	ringbuf_release(self, old);
 	self->count++;
-	return strlen;
+	return str_size(total);
 }
 
 /**
@@ -412,7 +929,7 @@ RbAct ringbuf_check(const RingBuf* const self, RbOp op) {
 				return SET_VARIANT(RbAct, NoOp, "The queue is empty");
 			}
 			/* Get the number of bytes between head and end-of-store */
-			StrLen back = (StrLen)(self->store.len - self->head);
+			size_t back = self->store.len - self->head;
 			/* If there are at least as many store bytes as transfer, NoWrap. */
 			if (back >= strlen) {
 				return SET_VARIANT(RbAct, NoWrap, strlen);
@@ -422,8 +939,8 @@ RbAct ringbuf_check(const RingBuf* const self, RbOp op) {
 			 * and start-of-store to end-of-data in the back of the data.
 			 */
 			return SET_VARIANT(RbAct, Wrap, ((RbWrap){
-				.front = back,
-				.back = strlen - back,
+				.front = (StrLen)back,
+				.back = (StrLen)(strlen - back),
 			}));
 		}
 		case ENUM_VAR(RbOp, Write): {
@@ -435,16 +952,408 @@ RbAct ringbuf_check(const RingBuf* const self, RbOp op) {
 				return SET_VARIANT(RbAct, NoOp, "Message too large!");
 			}
 			/* Same logic as above, but for tail instead of head */
-			StrLen back = (StrLen)(self->store.len - self->tail);
+			size_t back = self->store.len - self->tail;
 			if (back >= strlen) {
 				return SET_VARIANT(RbAct, NoWrap, strlen);
 			}
 			return SET_VARIANT(RbAct, Wrap, ((RbWrap){
-				.front = back,
-				.back = strlen - back,
+				.front = (StrLen)back,
+				.back = (StrLen)(strlen - back),
 			}));
 		}
 	}
 	/* Unreachable. */
 	return SET_VARIANT(RbAct, NoOp, "CONTROL FLOW ERROR!");
 }
+
+/**
+ * INTERNAL: Push a message, with a compression header if the queue uses them.
+ *
+ * A compressed block is assembled in the scratch `Vec` and then pushed as one
+ * `Str`. Either way, a message which does not fit leaves the queue untouched.
+ * @param self The `RingBuf` into which the data is being pushed.
+ * @param len The length of the message.
+ * @param src The message.
+ * @return The number of bytes added to the queue, including the length prefix,
+ * or zero if the message did not fit.
+ */
+static StrLen ringbuf_push(
+	RingBuf* const self,
+	StrLen len,
+	const unsigned char* const src
+) {
+	Slice part = slice_new((unsigned char*)src, len);
+	return ringbuf_push_parts(self, &part, 1, len);
+}
+
+/**
+ * INTERNAL: Push a message given as several pieces, in the form the queue's
+ * settings call for.
+ *
+ * Only the compressor needs the message in one piece; every other form copies
+ * the pieces straight into the store or into the message's `Arena` block.
+ * @param self The `RingBuf` into which the message is pushed.
+ * @param parts The pieces of the message, in order.
+ * @param n The number of pieces.
+ * @param len The total length of the pieces.
+ * @return The number of bytes added to the queue, or zero on failure.
+ */
+static StrLen ringbuf_push_parts(
+	RingBuf* const self,
+	const Slice* const parts,
+	size_t n,
+	StrLen len
+) {
+	if (!ringbuf_has_codec(self)) {
+		return ringbuf_push_parts_raw(self, slice_new(NULL, 0), parts, n, len);
+	}
+	if (self->arena != NULL && len > self->inline_max) {
+		ArenaRef ref = arena_alloc(self->arena, len);
+		if (ref.ptr == NULL) {
+			return 0;
+		}
+		ringbuf_gather(ref.ptr, parts, n);
+		StrLen ret = ringbuf_push_ref(self, ref);
+		if (ret == 0) {
+			arena_release(self->arena, ref);
+		}
+		return ret;
+	}
+	Vec* buf = &self->scratch;
+	size_t header = 1 + sizeof(StrLen);
+	size_t bound = header + lz_bound(len);
+	/* Pieces are gathered after the block, so the compressor sees one run. */
+	size_t gather = n > 1 ? (size_t)len : 0;
+	if (self->compress && len > 0 && len >= self->compress_min && vec_reserve(buf, bound + gather)) {
+		const unsigned char* src = parts[0].ptr;
+		if (gather > 0) {
+			ringbuf_gather(&buf->buf[bound], parts, n);
+			src = &buf->buf[bound];
+		}
+		size_t packed = lz_compress_into(
+			slice_new(&buf->buf[header], bound - header),
+			slice_new((unsigned char*)src, len)
+		);
+		/* Keep the block only if it beats storing the message as written. */
+		if (packed > 0 && header + packed < 1 + (size_t)len) {
+			buf->buf[0] = RB_LZ;
+			memcpy(&buf->buf[1], &len, sizeof(StrLen));
+			return ringbuf_push_raw(self, (StrLen)(header + packed), buf->buf);
+		}
+	}
+	static const unsigned char plain = RB_PLAIN;
+	return ringbuf_push_parts_raw(self, slice_new((unsigned char*)&plain, 1), parts, n, len);
+}
+
+/**
+ * INTERNAL: Move the first message out of a queue with headers or stamps,
+ * decompressing it or copying it out of its block if needed.
+ * @param self The `RingBuf` from which to read.
+ * @param out The `Slice` into which the message will be delivered.
+ * @return The number of bytes delivered, or zero if the queue is empty, the
+ * message does not fit, or it is corrupt. The queue is unchanged on failure.
+ */
+static StrLen ringbuf_read_record(RingBuf* const self, const Slice out) {
+	Slice parts[2];
+	StrLen stored = ringbuf_peek_slices(self, parts);
+	if (stored == 0) {
+		return 0;
+	}
+	StrLen len = ringbuf_peek_read_len(self);
+	/* An empty message is left queued, as on a queue with no header. */
+	if (len == 0 || len > out.len) {
+		return 0;
+	}
+	if (ringbuf_has_codec(self) && ringbuf_parts_byte(parts, 0) == RB_REF) {
+		ArenaRef ref = ringbuf_parts_ref(parts);
+		INSTRUMENT_COPY("ringbuf", out.ptr, ref.ptr, len);
+	}
+	else if (!ringbuf_has_codec(self) || ringbuf_parts_byte(parts, 0) == RB_PLAIN) {
+		/* Copy around the header byte, which is always in the first part. */
+		size_t skip = ringbuf_has_codec(self) ? 1 : 0;
+		if (parts[0].len > skip) {
+			INSTRUMENT_COPY("ringbuf", out.ptr, &parts[0].ptr[skip], parts[0].len - skip);
+		}
+		if (parts[1].len > 0) {
+			INSTRUMENT_COPY("ringbuf", &out.ptr[parts[0].len - skip], parts[1].ptr, parts[1].len);
+		}
+	}
+	else {
+		size_t header = 1 + sizeof(StrLen);
+		if (stored < header) {
+			return 0;
+		}
+		Slice rec = parts[0];
+		/* A block that wraps is made contiguous before decoding. */
+		if (parts[1].len > 0) {
+			self->scratch.len = 0;
+			if (!vec_reserve(&self->scratch, stored)) {
+				return 0;
+			}
+			vec_push_slice(&self->scratch, parts[0]);
+			vec_push_slice(&self->scratch, parts[1]);
+			rec = vec_as_slice(&self->scratch);
+		}
+		LzResult res = lz_decompress_into(
+			slice_new(out.ptr, len),
+			slice_new(&rec.ptr[header], rec.len - header)
+		);
+		if (GET_VARIANT_TYPE(res) != ENUM_VAR(LzResult, Ok) || GET_VARIANT_BODY(res, Ok) != len) {
+			return 0;
+		}
+	}
+	ringbuf_pop(self);
+	return len;
+}
+
+/**
+ * INTERNAL: Get a byte of a message described by `ringbuf_peek_slices()`.
+ * @param parts The one or two Slices over the message.
+ * @param idx The index of the byte within the message.
+ * @return The byte.
+ */
+static unsigned char ringbuf_parts_byte(const Slice parts[2], size_t idx) {
+	if (idx < parts[0].len) {
+		return parts[0].ptr[idx];
+	}
+	return parts[1].ptr[idx - parts[0].len];
+}
+
+/**
+ * INTERNAL: Drop bytes from the start of a message described by
+ * `ringbuf_peek_slices()`, keeping the first Slice non-empty while any bytes
+ * remain.
+ * @param parts The one or two Slices over the message.
+ * @param len The number of bytes to drop, no more than the message holds.
+ */
+static void ringbuf_parts_skip(Slice parts[2], size_t len) {
+	if (len < parts[0].len) {
+		parts[0] = slice_new(&parts[0].ptr[len], parts[0].len - len);
+		return;
+	}
+	len -= parts[0].len;
+	parts[0] = parts[1].len > len
+		? slice_new(&parts[1].ptr[len], parts[1].len - len)
+		: slice_new(NULL, 0);
+	parts[1] = slice_new(NULL, 0);
+}
+
+/**
+ * INTERNAL: Copy bytes in at the tail cursor, wrapping around the end of the
+ * store if they do not fit before it. The caller must have checked that the
+ * store has room.
+ * @param self The `RingBuf` into which the bytes are written.
+ * @param src The bytes.
+ * @param len The number of bytes.
+ */
+static void ringbuf_put(RingBuf* const self, const void* src, size_t len) {
+	const unsigned char* bytes = src;
+	size_t room = self->store.len - self->tail;
+	if (len <= room) {
+		INSTRUMENT_MOVE("ringbuf", &self->store.ptr[self->tail], bytes, len);
+		self->tail += len;
+	}
+	else {
+		INSTRUMENT_MOVE("ringbuf", &self->store.ptr[self->tail], bytes, room);
+		INSTRUMENT_MOVE("ringbuf", self->store.ptr, &bytes[room], len - room);
+		self->tail = len - room;
+	}
+}
+
+/**
+ * INTERNAL: Copy several pieces of data, one after another, into a buffer.
+ * @param dst The buffer, which must hold the total length of the pieces.
+ * @param parts The pieces, in order.
+ * @param n The number of pieces.
+ */
+static void ringbuf_gather(unsigned char* dst, const Slice* const parts, size_t n) {
+	for (size_t idx = 0; idx < n; ++idx) {
+		if (parts[idx].len > 0) {
+			INSTRUMENT_COPY("ringbuf", dst, parts[idx].ptr, parts[idx].len);
+			dst += parts[idx].len;
+		}
+	}
+}
+
+/**
+ * INTERNAL: Record how long the first message has been in the queue.
+ * @param self A `RingBuf` with a latency histogram and at least one message.
+ */
+static void ringbuf_record_latency(RingBuf* const self) {
+	Slice parts[2];
+	if (ringbuf_record_slices(self, parts) < RB_STAMP) {
+		return;
+	}
+	unsigned char tmp[RB_STAMP];
+	for (size_t idx = 0; idx < RB_STAMP; ++idx) {
+		tmp[idx] = ringbuf_parts_byte(parts, idx);
+	}
+	uint64_t then;
+	memcpy(&then, tmp, sizeof(then));
+	uint64_t now = ringbuf_now();
+	hist_record(self->latency, now > then ? now - then : 0);
+}
+
+/**
+ * INTERNAL: Read the clock used for latency stamps.
+ * @return The `CLOCK_MONOTONIC` time, in nanoseconds.
+ */
+static uint64_t ringbuf_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * INTERNAL: Whether each message begins with a byte that says how it is
+ * stored, as in a compressing queue or one with an `Arena`.
+ */
+static bool ringbuf_has_codec(const RingBuf* const self) {
+	return self->compress || self->arena != NULL;
+}
+
+/**
+ * INTERNAL: Get the descriptor from a message stored by reference, described
+ * by `ringbuf_peek_slices()`.
+ * @param parts The one or two Slices over the message, which begins with
+ * `RB_REF`.
+ * @return The block that holds the message.
+ */
+static ArenaRef ringbuf_parts_ref(const Slice parts[2]) {
+	unsigned char tmp[sizeof(ArenaRef)];
+	for (size_t idx = 0; idx < sizeof(ArenaRef); ++idx) {
+		tmp[idx] = ringbuf_parts_byte(parts, 1 + idx);
+	}
+	ArenaRef ret;
+	memcpy(&ret, tmp, sizeof(ArenaRef));
+	return ret;
+}
+
+/**
+ * INTERNAL: Push a descriptor of an `Arena` block as a message.
+ * @param self The `RingBuf` into which the descriptor is pushed.
+ * @param ref The block, which the queue owns if this succeeds.
+ * @return The number of bytes added to the queue, or zero if it had no room.
+ */
+static StrLen ringbuf_push_ref(RingBuf* const self, const ArenaRef ref) {
+	unsigned char rec[1 + sizeof(ArenaRef)];
+	rec[0] = RB_REF;
+	memcpy(&rec[1], &ref, sizeof(ArenaRef));
+	/* Checked here so that a full queue fails quietly. A growing queue makes
+	 * room in the push, so only its largest store counts. */
+	size_t need = str_size(sizeof(rec)) + (self->latency != NULL ? RB_STAMP : 0);
+	if (ringbuf_space_used(self) + need > ringbuf_space_max(self)) {
+		return 0;
+	}
+	return ringbuf_push_raw(self, (StrLen)sizeof(rec), rec);
+}
+
+/**
+ * INTERNAL: Move the queue into a store large enough for another record. The
+ * old store is left for the caller to free.
+ * @param self A growing `RingBuf`.
+ * @param need The stored size of the record.
+ * @return true if the queue now has room for the record.
+ */
+static bool ringbuf_grow(RingBuf* const self, size_t need) {
+	size_t want = ringbuf_space_used(self) + need;
+	if (want > self->store_max) {
+		return false;
+	}
+	size_t cap = self->store.len > 0 ? self->store.len : need;
+	while (cap < want) {
+		cap = cap > self->store_max / self->grow ? self->store_max : cap * self->grow;
+	}
+	return ringbuf_resize(self, cap);
+}
+
+/**
+ * INTERNAL: Account for a record removed from a growing queue, and shrink the
+ * store once the queue has stayed lightly loaded for long enough.
+ * @param self A growing `RingBuf`.
+ * @param removed The stored size of the record.
+ */
+static void ringbuf_settle(RingBuf* const self, size_t removed) {
+	size_t cap = self->store.len;
+	if (cap <= self->store_min) {
+		return;
+	}
+	/* A queue shrunk from this load is at most half full afterward, so it
+	 * does not grow straight back. */
+	if (ringbuf_space_used(self) > cap / (2 * (size_t)self->grow)) {
+		self->idle = 0;
+		return;
+	}
+	self->idle += removed;
+	if (self->idle < cap) {
+		return;
+	}
+	size_t smaller = cap / self->grow;
+	if (smaller < self->store_min) {
+		smaller = self->store_min;
+	}
+	/* A store of pages may round back up to the size it already has. */
+	if (self->pages != 0 && pages_round(smaller, self->pages) >= cap) {
+		self->idle = 0;
+		return;
+	}
+	Slice old = self->store;
+	if (ringbuf_resize(self, smaller)) {
+		ringbuf_release(self, old);
+	}
+}
+
+/**
+ * INTERNAL: Move the queued records into a new store, oldest first from its
+ * start, in one copy or two if they wrap. The old store is not freed.
+ * @param self The `RingBuf` on which to act.
+ * @param cap The size of the new store, which must exceed the bytes in use.
+ * @return true if the records moved, or false if allocation failed, in which
+ * case the queue is unchanged.
+ */
+static bool ringbuf_resize(RingBuf* const self, size_t cap) {
+	unsigned char* buf;
+	if (self->pages != 0) {
+		/* The new store is rounded up to whole pages, and all of it is used. */
+		Slice pages = pages_alloc(cap, self->pages, self->node, NULL);
+		buf = pages.ptr;
+		cap = pages.len;
+	}
+	else {
+		buf = INSTRUMENT_MALLOC("ringbuf", cap);
+	}
+	if (buf == NULL) {
+		return false;
+	}
+	size_t used = ringbuf_space_used(self);
+	size_t first = self->store.len - self->head;
+	if (first > used) {
+		first = used;
+	}
+	if (first > 0) {
+		INSTRUMENT_COPY("ringbuf", buf, &self->store.ptr[self->head], first);
+	}
+	if (used > first) {
+		INSTRUMENT_COPY("ringbuf", &buf[first], self->store.ptr, used - first);
+	}
+	self->store = slice_new(buf, cap);
+	self->head = 0;
+	self->tail = used;
+	self->idle = 0;
+	return true;
+}
+
+/**
+ * INTERNAL: Release a store that the queue has left, back to where it came
+ * from.
+ * @param self The `RingBuf` that used the store.
+ * @param store The store, which may be empty with a NULL pointer.
+ */
+static void ringbuf_release(const RingBuf* const self, const Slice store) {
+	if (self->pages != 0) {
+		pages_free(store);
+	}
+	else {
+		INSTRUMENT_FREE("ringbuf", store.ptr);
+	}
+}
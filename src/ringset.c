@@ -0,0 +1,189 @@
+#include <string.h>
+
+#include <wyzyrdry.h>
+
+static RingSetMember* ringset_members(const RingSet* const self);
+static size_t ringset_find(const RingSet* const self, size_t from);
+static void ringset_clear(RingSet* const self, size_t id);
+
+/**
+ * Initialize a RingSet with no rings.
+ * @param mode Whether to serve rings by priority or by fair shares.
+ * @return A RingSet structure. Nothing is allocated until a ring is added.
+ */
+RingSet ringset_init(RingSetMode mode) {
+	RingSet ret = {
+		.mode = mode,
+		.members = { .buf = NULL, .len = 0, .cap = 0 },
+		.summary = 0,
+		.current = RINGSET_NONE,
+		.last = RINGSET_NONE,
+	};
+	memset(ret.ready, 0, sizeof(ret.ready));
+	return ret;
+}
+
+/**
+ * Deallocate a RingSet. The rings themselves are left as they are.
+ * @param self The RingSet on which to act.
+ */
+void ringset_free(RingSet* const self) {
+	vec_free(&self->members);
+	*self = ringset_init(self->mode);
+}
+
+/**
+ * Add a ring to the set.
+ * @param self The RingSet on which to act.
+ * @param ring The ring, which stays owned by the caller.
+ * @param quantum The bytes the ring may send in each turn, in fair mode. Rings
+ * with twice the quantum receive twice the share. Zero is taken as one; a
+ * quantum at least as large as the ring's typical message serves it in fewer,
+ * longer turns. Ignored in priority mode.
+ * @return The ring's id, which numbers the rings from zero in the order they
+ * were added, or `RINGSET_NONE` if the set is full or allocation failed.
+ */
+size_t ringset_add(RingSet* const self, RingBuf* const ring, size_t quantum) {
+	size_t id = self->members.len / sizeof(RingSetMember);
+	if (id >= RINGSET_MAX) {
+		return RINGSET_NONE;
+	}
+	RingSetMember member = {
+		.ring = ring,
+		.quantum = quantum > 0 ? quantum : 1,
+		.deficit = 0,
+	};
+	vec_push_slice(&self->members, slice_new((unsigned char*)&member, sizeof(member)));
+	if (self->members.len / sizeof(RingSetMember) == id) {
+		return RINGSET_NONE;
+	}
+	if (ring->count > 0) {
+		ringset_mark(self, id);
+	}
+	return id;
+}
+
+/**
+ * Note that a ring may have messages. Call this after writing to a ring other
+ * than through `ringset_write_slice()`, or its messages may not be seen.
+ * @param self The RingSet on which to act.
+ * @param id The ring's id.
+ */
+void ringset_mark(RingSet* const self, size_t id) {
+	self->ready[id / 64] |= (uint64_t)1 << (id % 64);
+	self->summary |= (uint64_t)1 << (id / 64);
+}
+
+/**
+ * Push a `Slice`'s contents into one of the rings, and mark it ready.
+ * @param self The RingSet on which to act.
+ * @param id The ring's id.
+ * @param in The `Slice` to be pushed.
+ * @return The amount of data pushed into the ring, as from
+ * `ringbuf_write_slice()`.
+ */
+StrLen ringset_write_slice(RingSet* const self, size_t id, const Slice in) {
+	StrLen ret = ringbuf_write_slice(ringset_members(self)[id].ring, in);
+	if (ret > 0) {
+		ringset_mark(self, id);
+	}
+	return ret;
+}
+
+/**
+ * Choose the ring to take the next message from.
+ *
+ * The caller must then take exactly one message from that ring, by
+ * `ringbuf_read()`, `ringbuf_pop()`, or any other means, before calling this
+ * again; in fair mode, that message has already been charged to the ring.
+ * @param self The RingSet on which to act.
+ * @return The id of a ring that holds a message, or `RINGSET_NONE` if every
+ * ring is empty.
+ */
+size_t ringset_next(RingSet* const self) {
+	RingSetMember* members = ringset_members(self);
+	for (;;) {
+		size_t id = self->current;
+		if (id == RINGSET_NONE) {
+			if (self->mode == RINGSET_PRIORITY) {
+				id = ringset_find(self, 0);
+			}
+			else {
+				/*
+				 * Turns go round in order of id, from the last turn's ring.
+				 * Before the first turn, `last + 1` wraps to zero.
+				 */
+				id = ringset_find(self, self->last + 1);
+				if (id == RINGSET_NONE) {
+					id = ringset_find(self, 0);
+				}
+			}
+			if (id == RINGSET_NONE) {
+				return RINGSET_NONE;
+			}
+			if (self->mode == RINGSET_FAIR) {
+				members[id].deficit += members[id].quantum;
+				self->current = id;
+			}
+		}
+		RingSetMember* member = &members[id];
+		if (member->ring->count == 0) {
+			/* An idle ring keeps no allowance, so it cannot save up a burst. */
+			ringset_clear(self, id);
+			member->deficit = 0;
+			self->last = id;
+			self->current = RINGSET_NONE;
+			continue;
+		}
+		if (self->mode == RINGSET_PRIORITY) {
+			return id;
+		}
+		size_t len = ringbuf_peek_len(member->ring);
+		if (len <= member->deficit) {
+			member->deficit -= len;
+			return id;
+		}
+		self->last = id;
+		self->current = RINGSET_NONE;
+	}
+}
+
+/**
+ * INTERNAL: View the members as an array.
+ */
+static RingSetMember* ringset_members(const RingSet* const self) {
+	return (RingSetMember*)self->members.buf;
+}
+
+/**
+ * INTERNAL: Find the first ready ring at or after an id.
+ * @param self The RingSet to search.
+ * @param from The lowest id to consider. It may be `RINGSET_MAX` or more.
+ * @return The id of the ring, or `RINGSET_NONE` if there is none.
+ */
+static size_t ringset_find(const RingSet* const self, size_t from) {
+	if (from >= RINGSET_MAX) {
+		return RINGSET_NONE;
+	}
+	size_t word = from / 64;
+	uint64_t bits = self->ready[word] & (~(uint64_t)0 << (from % 64));
+	if (bits != 0) {
+		return word * 64 + (size_t)__builtin_ctzll(bits);
+	}
+	uint64_t words = word + 1 < 64 ? self->summary & (~(uint64_t)0 << (word + 1)) : 0;
+	if (words == 0) {
+		return RINGSET_NONE;
+	}
+	word = (size_t)__builtin_ctzll(words);
+	return word * 64 + (size_t)__builtin_ctzll(self->ready[word]);
+}
+
+/**
+ * INTERNAL: Note that a ring is empty.
+ */
+static void ringset_clear(RingSet* const self, size_t id) {
+	self->ready[id / 64] &= ~((uint64_t)1 << (id % 64));
+	if (self->ready[id / 64] == 0) {
+		self->summary &= ~((uint64_t)1 << (id / 64));
+	}
+}
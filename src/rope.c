@@ -0,0 +1,335 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <wyzyrdry.h>
+
+/**
+ * The capacity of the first chunk when none is given.
+ */
+#define ROPE_CHUNK_MIN 4096
+
+static RopeChunk* rope_chunks(const Rope* const self);
+static RopeChunk* rope_add_chunk(Rope* const self, size_t cap);
+static size_t rope_find_chunk(const Rope* const self, size_t offset);
+
+/**
+ * Initialize a Rope structure. No memory is allocated until bytes are pushed.
+ * @param first_chunk The capacity of the first chunk. Later chunks double in
+ * size up to `ROPE_CHUNK_MAX`. Zero selects a small default.
+ * @return An empty Rope.
+ */
+Rope rope_init(size_t first_chunk) {
+	Rope ret = {
+		.chunks = { .buf = NULL, .len = 0, .cap = 0 },
+		.len = 0,
+		.next_cap = first_chunk > 0 ? first_chunk : ROPE_CHUNK_MIN,
+	};
+	return ret;
+}
+
+/**
+ * Deallocate every chunk of a Rope, leaving it empty.
+ * @param self The Rope on which to act.
+ */
+void rope_free(Rope* const self) {
+	RopeChunk* chunks = rope_chunks(self);
+	size_t count = rope_chunk_count(self);
+	for (size_t idx = 0; idx < count; ++idx) {
+		INSTRUMENT_FREE("rope", chunks[idx].ptr);
+	}
+	vec_free(&self->chunks);
+	self->len = 0;
+}
+
+/**
+ * Append a byte to the Rope.
+ * @param self The Rope on which to act.
+ * @param byte The byte to append.
+ * @return true on success, or false if a new chunk could not be allocated.
+ */
+bool rope_push_byte(Rope* const self, unsigned char byte) {
+	size_t count = rope_chunk_count(self);
+	if (count > 0) {
+		RopeChunk* last = &rope_chunks(self)[count - 1];
+		if (last->len < last->cap) {
+			last->ptr[last->len++] = byte;
+			++self->len;
+			return true;
+		}
+	}
+	return rope_push_slice(self, slice_new(&byte, 1));
+}
+
+/**
+ * Append a Slice to the Rope.
+ *
+ * The bytes fill the last chunk, and any that do not fit go into one new chunk,
+ * which is made large enough to hold them all. Either every byte is appended
+ * or, if allocation fails, none are.
+ * @param self The Rope on which to act.
+ * @param slice The bytes to append.
+ * @return true on success, or false if a new chunk could not be allocated.
+ */
+bool rope_push_slice(Rope* const self, const Slice slice) {
+	if (slice.len == 0) {
+		return true;
+	}
+	size_t count = rope_chunk_count(self);
+	size_t room = 0;
+	if (count > 0) {
+		RopeChunk* last = &rope_chunks(self)[count - 1];
+		room = last->cap - last->len;
+	}
+	if (slice.len <= room) {
+		RopeChunk* last = &rope_chunks(self)[count - 1];
+		INSTRUMENT_COPY("rope", &last->ptr[last->len], slice.ptr, slice.len);
+		last->len += slice.len;
+		self->len += slice.len;
+		return true;
+	}
+	size_t rest = slice.len - room;
+	RopeChunk* next = rope_add_chunk(self, self->next_cap > rest ? self->next_cap : rest);
+	if (next == NULL) {
+		return false;
+	}
+	if (room > 0) {
+		/* The index may have moved, so find the old last chunk again. */
+		RopeChunk* last = next - 1;
+		INSTRUMENT_COPY("rope", &last->ptr[last->len], slice.ptr, room);
+		last->len += room;
+	}
+	INSTRUMENT_COPY("rope", next->ptr, &slice.ptr[room], rest);
+	next->len = rest;
+	self->len += slice.len;
+	return true;
+}
+
+/**
+ * Count the chunks of the Rope.
+ * @param self The Rope on which to act.
+ * @return The number of chunks, each of which `rope_next()` yields as a Slice.
+ */
+size_t rope_chunk_count(const Rope* const self) {
+	return self->chunks.len / sizeof(RopeChunk);
+}
+
+/**
+ * Step through the contents of the Rope as a sequence of Slices, in order.
+ * @param self The Rope on which to act.
+ * @param cursor The iteration state. Set this to 0 before the first call.
+ * @param out Receives the next chunk's contents.
+ * @return true if a Slice was produced, or false at the end of the Rope.
+ */
+bool rope_next(const Rope* const self, size_t* const cursor, Slice* const out) {
+	if (*cursor >= rope_chunk_count(self)) {
+		return false;
+	}
+	RopeChunk* chunk = &rope_chunks(self)[(*cursor)++];
+	*out = slice_new(chunk->ptr, chunk->len);
+	return true;
+}
+
+/**
+ * Get the contiguous run of bytes that starts at an offset, which extends to
+ * the end of the chunk holding that offset.
+ *
+ * This finds the chunk by binary search, in O(log n) of the number of chunks.
+ * @param self The Rope on which to act.
+ * @param offset The offset of the first byte.
+ * @return A Slice of the bytes from `offset` to the end of its chunk, or an
+ * empty Slice if `offset` is past the end of the Rope.
+ */
+Slice rope_slice_at(const Rope* const self, size_t offset) {
+	if (offset >= self->len) {
+		return slice_new(NULL, 0);
+	}
+	RopeChunk* chunk = &rope_chunks(self)[rope_find_chunk(self, offset)];
+	size_t at = offset - chunk->start;
+	return slice_new(&chunk->ptr[at], chunk->len - at);
+}
+
+/**
+ * Copy bytes out of the Rope, across chunk boundaries.
+ * @param self The Rope on which to act.
+ * @param offset The offset of the first byte to copy.
+ * @param out The buffer to fill.
+ * @return The number of bytes copied, which is less than `out.len` if the
+ * Rope ends first.
+ */
+size_t rope_read(const Rope* const self, size_t offset, const Slice out) {
+	size_t done = 0;
+	while (done < out.len) {
+		Slice run = rope_slice_at(self, offset + done);
+		if (run.len == 0) {
+			break;
+		}
+		size_t take = run.len < out.len - done ? run.len : out.len - done;
+		INSTRUMENT_COPY("rope", &out.ptr[done], run.ptr, take);
+		done += take;
+	}
+	return done;
+}
+
+/**
+ * Describe the contents of the Rope from an offset onwards as an array of
+ * `iovec`s, for `writev()` and similar calls.
+ *
+ * After a partial write, call this again with the offset advanced by the
+ * number of bytes written.
+ * @param self The Rope on which to act.
+ * @param offset The offset of the first byte to describe.
+ * @param out The array to fill.
+ * @param max The number of entries `out` can hold, such as `IOV_MAX`.
+ * @return The number of entries filled.
+ */
+size_t rope_iovec(
+	const Rope* const self,
+	size_t offset,
+	struct iovec* const out,
+	size_t max
+) {
+	if (offset >= self->len || max == 0) {
+		return 0;
+	}
+	RopeChunk* chunks = rope_chunks(self);
+	size_t count = rope_chunk_count(self);
+	size_t idx = rope_find_chunk(self, offset);
+	size_t at = offset - chunks[idx].start;
+	size_t ret = 0;
+	for (; idx < count && ret < max; ++idx, ++ret) {
+		out[ret].iov_base = &chunks[idx].ptr[at];
+		out[ret].iov_len = chunks[idx].len - at;
+		at = 0;
+	}
+	return ret;
+}
+
+/**
+ * Move the contents of the Rope into a single Vec, leaving the Rope empty.
+ *
+ * The first chunk is grown in place where the allocator allows it, and every
+ * other chunk is freed as soon as it has been copied, so the peak memory use is
+ * little more than the Rope's length.
+ * @param self The Rope on which to act.
+ * @return A Vec holding the Rope's contents. If allocation fails, its buf is
+ * NULL and the Rope is left unchanged.
+ */
+Vec rope_flatten(Rope* const self) {
+	Vec ret = {
+		.buf = NULL,
+		.len = 0,
+		.cap = 0,
+	};
+	size_t count = rope_chunk_count(self);
+	if (count == 0) {
+		return ret;
+	}
+	RopeChunk* chunks = rope_chunks(self);
+	unsigned char* buf = INSTRUMENT_REALLOC("rope", chunks[0].ptr, self->len);
+	if (buf == NULL) {
+		return ret;
+	}
+	size_t len = chunks[0].len;
+	for (size_t idx = 1; idx < count; ++idx) {
+		INSTRUMENT_COPY("rope", &buf[len], chunks[idx].ptr, chunks[idx].len);
+		len += chunks[idx].len;
+		INSTRUMENT_FREE("rope", chunks[idx].ptr);
+	}
+	ret.buf = buf;
+	ret.len = len;
+	ret.cap = len;
+	vec_free(&self->chunks);
+	self->len = 0;
+	return ret;
+}
+
+/**
+ * Print out the Rope for debugging purposes.
+ * @param self The Rope on which to act.
+ */
+void rope_debug_print(const Rope* const self) {
+	printf(
+		"Rope { len: %zu, chunks: %zu, next_cap: %zu }\n",
+		self->len,
+		rope_chunk_count(self),
+		self->next_cap
+	);
+	RopeChunk* chunks = rope_chunks(self);
+	for (size_t idx = 0; idx < rope_chunk_count(self); ++idx) {
+		printf(
+			"RopeChunk { start: %zu, len: %zu, cap: %zu }\n",
+			chunks[idx].start,
+			chunks[idx].len,
+			chunks[idx].cap
+		);
+		hex_print(slice_new(chunks[idx].ptr, chunks[idx].len));
+	}
+}
+
+/**
+ * INTERNAL: View the chunk index as an array.
+ * @param self The Rope on which to act.
+ * @return The first chunk descriptor.
+ */
+static RopeChunk* rope_chunks(const Rope* const self) {
+	return (RopeChunk*)self->chunks.buf;
+}
+
+/**
+ * INTERNAL: Allocate an empty chunk and add it to the end of the Rope. It
+ * starts where the current last chunk's capacity ends, so that chunk must be
+ * filled before the new one is used.
+ * @param self The Rope on which to act.
+ * @param cap The capacity of the new chunk.
+ * @return The new chunk, or NULL if allocation failed, in which case the Rope
+ * is unchanged.
+ */
+static RopeChunk* rope_add_chunk(Rope* const self, size_t cap) {
+	if (!vec_reserve(&self->chunks, sizeof(RopeChunk))) {
+		return NULL;
+	}
+	RopeChunk chunk = {
+		.ptr = INSTRUMENT_MALLOC("rope", cap),
+		.len = 0,
+		.cap = cap,
+		.start = 0,
+	};
+	if (chunk.ptr == NULL) {
+		return NULL;
+	}
+	size_t count = rope_chunk_count(self);
+	if (count > 0) {
+		RopeChunk* last = &rope_chunks(self)[count - 1];
+		chunk.start = last->start + last->cap;
+	}
+	memcpy(&self->chunks.buf[self->chunks.len], &chunk, sizeof(chunk));
+	self->chunks.len += sizeof(chunk);
+	if (self->next_cap < ROPE_CHUNK_MAX) {
+		self->next_cap = 2 * self->next_cap < ROPE_CHUNK_MAX ? 2 * self->next_cap : ROPE_CHUNK_MAX;
+	}
+	return &rope_chunks(self)[count];
+}
+
+/**
+ * INTERNAL: Find the chunk holding an offset, by binary search over the chunks'
+ * starting offsets.
+ * @param self The Rope on which to act.
+ * @param offset An offset less than the Rope's length.
+ * @return The index of the chunk.
+ */
+static size_t rope_find_chunk(const Rope* const self, size_t offset) {
+	RopeChunk* chunks = rope_chunks(self);
+	size_t lo = 0;
+	size_t hi = rope_chunk_count(self);
+	while (hi - lo > 1) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (chunks[mid].start <= offset) {
+			lo = mid;
+		}
+		else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
@@ -1,52 +1,337 @@
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <wyzyrdry.h>
 
+#ifdef WYZYRDRY_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * The largest byte set that `slice_find_any()` searches with SIMD comparisons.
+ * Each member costs one comparison per vector, so past this point the table
+ * lookup is faster.
+ */
+#define SLICE_SET_SIMD_MAX 16
+
+static size_t slice_mismatch(
+	const unsigned char* a,
+	const unsigned char* b,
+	size_t len
+);
+static size_t slice_find_byte_scalar(const Slice self, unsigned char byte);
+static size_t slice_find_any_scalar(const Slice self, const Slice set);
+static size_t slice_find_subslice_scalar(const Slice self, const Slice needle);
+static size_t slice_count_byte_scalar(const Slice self, unsigned char byte);
+static size_t slice_mismatch_scalar(
+	const unsigned char* a,
+	const unsigned char* b,
+	size_t len
+);
+#ifdef WYZYRDRY_X86
+static size_t slice_find_byte_sse2(const Slice self, unsigned char byte);
+static size_t slice_find_any_sse2(const Slice self, const Slice set);
+static size_t slice_find_subslice_sse2(const Slice self, const Slice needle);
+static size_t slice_count_byte_sse2(const Slice self, unsigned char byte);
+static size_t slice_mismatch_sse2(
+	const unsigned char* a,
+	const unsigned char* b,
+	size_t len
+);
+static size_t slice_find_byte_avx2(const Slice self, unsigned char byte);
+static size_t slice_find_any_avx2(const Slice self, const Slice set);
+static size_t slice_find_subslice_avx2(const Slice self, const Slice needle);
+static size_t slice_count_byte_avx2(const Slice self, unsigned char byte);
+static size_t slice_mismatch_avx2(
+	const unsigned char* a,
+	const unsigned char* b,
+	size_t len
+);
+static size_t slice_find_byte_avx512(const Slice self, unsigned char byte);
+static size_t slice_count_byte_avx512(const Slice self, unsigned char byte);
+static size_t slice_mismatch_avx512(
+	const unsigned char* a,
+	const unsigned char* b,
+	size_t len
+);
+#endif
+
+static void slice_shift_range(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	unsigned char first,
+	unsigned char delta
+);
+static void slice_map_scalar(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	const unsigned char table[256]
+);
+#ifdef WYZYRDRY_X86
+static size_t slice_shift_range_sse2(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	unsigned char first,
+	unsigned char delta
+);
+static size_t slice_shift_range_avx2(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	unsigned char first,
+	unsigned char delta
+);
+static void slice_shift_range_avx512(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	unsigned char first,
+	unsigned char delta
+);
+static void slice_map_avx2(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	const unsigned char table[256]
+);
+static void slice_map_avx512vbmi(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	const unsigned char table[256]
+);
+#endif
+
+/**
+ * Invoke a function on each byte in the slice.
+ * @param self The Slice over which to loop.
+ * @param callback The function to be invoked with each byte in the Slice.
+ */
+void slice_for_each(const Slice self, void (*callback)(unsigned char c)) {
+	for (size_t idx = 0; idx < self.len; ++idx) {
+		callback(self.ptr[idx]);
+	}
+}
+
 /**
- * Make a new Slice out of a pointer and length.
+ * Translate each byte of a Slice through a table into another Slice.
  *
- * This presumes that the pointer is not null, and that the memory described by
- * the pointer and length is all valid.
- * @param ptr A pointer to valid memory.
- * @param len The length of memory captured by the slice.
- * @return A new Slice describing the memory.
- */
-const Slice slice_new(unsigned char* const ptr, size_t len) {
-	Slice ret = {
-		.ptr = ptr,
-		.len = len,
-	};
-	return ret;
+ * `dst` may be the same buffer as `src` to translate in place, but must not
+ * otherwise overlap it.
+ * @param dst The buffer to receive the translated bytes.
+ * @param src The bytes to translate.
+ * @param table The replacement for each byte value.
+ * @return The number of bytes written, or zero if `dst` is shorter than `src`.
+ */
+size_t slice_map_into(
+	const Slice dst,
+	const Slice src,
+	const unsigned char table[256]
+) {
+	if (dst.len < src.len) {
+		return 0;
+	}
+#ifdef WYZYRDRY_X86
+	if (src.len >= 64 && cpu_has(CPU_AVX512BW | CPU_AVX512VBMI)) {
+		slice_map_avx512vbmi(dst.ptr, src.ptr, src.len, table);
+		return src.len;
+	}
+	if (src.len >= 32 && cpu_has(CPU_AVX2)) {
+		slice_map_avx2(dst.ptr, src.ptr, src.len, table);
+		return src.len;
+	}
+#endif
+	slice_map_scalar(dst.ptr, src.ptr, src.len, table);
+	return src.len;
 }
 
 /**
- * Accessor to the Slice's pointer.
- * @param self The Slice on which to act.
- * @return The Slice's pointer field.
+ * Copy a Slice into another with ASCII uppercase letters made lowercase. Other
+ * bytes are copied unchanged.
+ *
+ * `dst` may be the same buffer as `src`, but must not otherwise overlap it.
+ * @param dst The buffer to receive the folded bytes.
+ * @param src The bytes to fold.
+ * @return The number of bytes written, or zero if `dst` is shorter than `src`.
  */
-unsigned char* slice_ptr(const Slice self) {
-	return self.ptr;
+size_t slice_to_ascii_lower(const Slice dst, const Slice src) {
+	if (dst.len < src.len) {
+		return 0;
+	}
+	slice_shift_range(dst.ptr, src.ptr, src.len, 'A', 'a' - 'A');
+	return src.len;
 }
 
 /**
- * Accessor to the slice's length.
- * @param self The Slice on which to act.
- * @return The Slice's length field.
+ * Copy a Slice into another with ASCII lowercase letters made uppercase. Other
+ * bytes are copied unchanged.
+ *
+ * `dst` may be the same buffer as `src`, but must not otherwise overlap it.
+ * @param dst The buffer to receive the folded bytes.
+ * @param src The bytes to fold.
+ * @return The number of bytes written, or zero if `dst` is shorter than `src`.
  */
-size_t slice_len(const Slice self) {
-	return self.len;
+size_t slice_to_ascii_upper(const Slice dst, const Slice src) {
+	if (dst.len < src.len) {
+		return 0;
+	}
+	slice_shift_range(dst.ptr, src.ptr, src.len, 'a', (unsigned char)('A' - 'a'));
+	return src.len;
 }
 
 /**
- * Invoke a function on each byte in the slice.
- * @param self The Slice over which to loop.
- * @param callback The function to be invoked with each byte in the Slice.
+ * Find the first occurrence of a byte in the Slice.
+ * @param self The Slice to search.
+ * @param byte The byte to find.
+ * @return The index of the first matching byte, or `self.len` if absent.
  */
-void slice_for_each(const Slice self, void (*callback)(unsigned char c)) {
-	for (size_t idx = 0; idx < self.len; ++idx) {
-		callback(self.ptr[idx]);
+size_t slice_find_byte(const Slice self, unsigned char byte) {
+#ifdef WYZYRDRY_X86
+	if (self.len >= 16) {
+		if (cpu_has(CPU_AVX512BW)) {
+			return slice_find_byte_avx512(self, byte);
+		}
+		if (cpu_has(CPU_AVX2)) {
+			return slice_find_byte_avx2(self, byte);
+		}
+		if (cpu_has(CPU_SSE2)) {
+			return slice_find_byte_sse2(self, byte);
+		}
 	}
+#endif
+	return slice_find_byte_scalar(self, byte);
+}
+
+/**
+ * Find the first byte in the Slice that is a member of a set of bytes.
+ *
+ * Sets of up to sixteen bytes are searched with SIMD comparisons; larger sets
+ * fall back to a table lookup per byte.
+ * @param self The Slice to search.
+ * @param set A Slice holding the bytes to find. Order and duplicates do not
+ * matter.
+ * @return The index of the first byte in `self` that appears in `set`, or
+ * `self.len` if none do.
+ */
+size_t slice_find_any(const Slice self, const Slice set) {
+	if (set.len == 0) {
+		return self.len;
+	}
+	if (set.len == 1) {
+		return slice_find_byte(self, set.ptr[0]);
+	}
+#ifdef WYZYRDRY_X86
+	if (self.len >= 16 && set.len <= SLICE_SET_SIMD_MAX) {
+		if (cpu_has(CPU_AVX2)) {
+			return slice_find_any_avx2(self, set);
+		}
+		if (cpu_has(CPU_SSE2)) {
+			return slice_find_any_sse2(self, set);
+		}
+	}
+#endif
+	return slice_find_any_scalar(self, set);
+}
+
+/**
+ * Find the first occurrence of one Slice's contents inside another.
+ *
+ * Candidate positions are found by matching the first and last bytes of the
+ * needle in parallel, and only candidates are compared in full.
+ * @param self The Slice to search.
+ * @param needle The sequence of bytes to find.
+ * @return The index at which `needle` begins in `self`, or `self.len` if it
+ * does not occur. An empty needle is found at index 0.
+ */
+size_t slice_find_subslice(const Slice self, const Slice needle) {
+	if (needle.len == 0) {
+		return 0;
+	}
+	if (needle.len > self.len) {
+		return self.len;
+	}
+	if (needle.len == 1) {
+		return slice_find_byte(self, needle.ptr[0]);
+	}
+#ifdef WYZYRDRY_X86
+	if (cpu_has(CPU_AVX2)) {
+		return slice_find_subslice_avx2(self, needle);
+	}
+	if (cpu_has(CPU_SSE2)) {
+		return slice_find_subslice_sse2(self, needle);
+	}
+#endif
+	return slice_find_subslice_scalar(self, needle);
+}
+
+/**
+ * Count the occurrences of a byte in the Slice.
+ * @param self The Slice to search.
+ * @param byte The byte to count.
+ * @return The number of bytes in `self` equal to `byte`.
+ */
+size_t slice_count_byte(const Slice self, unsigned char byte) {
+#ifdef WYZYRDRY_X86
+	if (self.len >= 16) {
+		if (cpu_has(CPU_AVX512BW)) {
+			return slice_count_byte_avx512(self, byte);
+		}
+		if (cpu_has(CPU_AVX2)) {
+			return slice_count_byte_avx2(self, byte);
+		}
+		if (cpu_has(CPU_SSE2)) {
+			return slice_count_byte_sse2(self, byte);
+		}
+	}
+#endif
+	return slice_count_byte_scalar(self, byte);
+}
+
+/**
+ * Check whether two Slices describe equal contents.
+ * @param self A Slice.
+ * @param other Another Slice.
+ * @return true if both Slices have the same length and bytes.
+ */
+bool slice_eq(const Slice self, const Slice other) {
+	if (self.len != other.len) {
+		return false;
+	}
+	if (self.ptr == other.ptr) {
+		return true;
+	}
+	return slice_mismatch(self.ptr, other.ptr, self.len) == self.len;
+}
+
+/**
+ * Compare two Slices lexicographically, as unsigned bytes. A Slice that is a
+ * prefix of the other sorts first.
+ * @param self A Slice.
+ * @param other Another Slice.
+ * @return -1, 0, or 1 as `self` sorts before, equal to, or after `other`.
+ */
+int slice_cmp(const Slice self, const Slice other) {
+	size_t len = self.len < other.len ? self.len : other.len;
+	size_t idx = slice_mismatch(self.ptr, other.ptr, len);
+	if (idx < len) {
+		return self.ptr[idx] < other.ptr[idx] ? -1 : 1;
+	}
+	return (self.len > other.len) - (self.len < other.len);
+}
+
+/**
+ * Check whether a Slice holds valid UTF-8. See `utf8_validate()` to find
+ * where invalid text goes wrong.
+ * @param self The Slice to check.
+ * @return true if every byte is part of a valid UTF-8 sequence.
+ */
+bool slice_validate_utf8(const Slice self) {
+	return utf8_validate(self) == self.len;
 }
 
 /**
@@ -54,6 +339,662 @@ void slice_for_each(const Slice self, void (*callback)(unsigned char c)) {
  * @param self The Slice on which to act.
  */
 void slice_debug_print(const Slice self) {
-	printf("Slice { ptr: %p, len: %zu }\nPtr: ", self.ptr, self.len);
+	printf("Slice { ptr: %p, len: %zu }\n", self.ptr, self.len);
 	hex_print(self);
 }
+
+/**
+ * INTERNAL: Find the first index at which two buffers differ.
+ * @param a A buffer of at least `len` bytes.
+ * @param b A buffer of at least `len` bytes.
+ * @param len The number of bytes to compare.
+ * @return The index of the first differing byte, or `len` if they are equal.
+ */
+static size_t slice_mismatch(
+	const unsigned char* a,
+	const unsigned char* b,
+	size_t len
+) {
+#ifdef WYZYRDRY_X86
+	if (len >= 16) {
+		if (cpu_has(CPU_AVX512BW)) {
+			return slice_mismatch_avx512(a, b, len);
+		}
+		if (cpu_has(CPU_AVX2)) {
+			return slice_mismatch_avx2(a, b, len);
+		}
+		if (cpu_has(CPU_SSE2)) {
+			return slice_mismatch_sse2(a, b, len);
+		}
+	}
+#endif
+	return slice_mismatch_scalar(a, b, len);
+}
+
+/*
+ * Portable kernels. These are the reference behavior for every SIMD kernel, and
+ * also finish the sub-vector tails that the SIMD kernels leave behind.
+ */
+
+/**
+ * INTERNAL: Scalar `slice_find_byte`. This tests a machine word at a time for
+ * a zero byte after XORing with the needle, and only inspects individual bytes
+ * in a word that contains a match.
+ */
+static size_t slice_find_byte_scalar(const Slice self, unsigned char byte) {
+	const uint64_t ones = 0x0101010101010101ULL;
+	const uint64_t highs = 0x8080808080808080ULL;
+	const uint64_t pattern = ones * byte;
+	size_t idx = 0;
+	for (; idx + 8 <= self.len; idx += 8) {
+		uint64_t word;
+		memcpy(&word, &self.ptr[idx], 8);
+		word ^= pattern;
+		if (((word - ones) & ~word & highs) != 0) {
+			break;
+		}
+	}
+	for (; idx < self.len; ++idx) {
+		if (self.ptr[idx] == byte) {
+			return idx;
+		}
+	}
+	return self.len;
+}
+
+/**
+ * INTERNAL: Scalar `slice_find_any`, using a 256-bit membership table.
+ */
+static size_t slice_find_any_scalar(const Slice self, const Slice set) {
+	uint32_t table[8] = { 0 };
+	for (size_t idx = 0; idx < set.len; ++idx) {
+		table[set.ptr[idx] >> 5] |= 1u << (set.ptr[idx] & 31);
+	}
+	for (size_t idx = 0; idx < self.len; ++idx) {
+		unsigned char c = self.ptr[idx];
+		if (table[c >> 5] & (1u << (c & 31))) {
+			return idx;
+		}
+	}
+	return self.len;
+}
+
+/**
+ * INTERNAL: Scalar `slice_find_subslice`. Skips to each occurrence of the
+ * needle's first byte, then compares the rest.
+ */
+static size_t slice_find_subslice_scalar(const Slice self, const Slice needle) {
+	if (needle.len > self.len) {
+		return self.len;
+	}
+	size_t last = self.len - needle.len;
+	size_t idx = 0;
+	while (idx <= last) {
+		Slice rest = slice_new(&self.ptr[idx], last - idx + 1);
+		idx += slice_find_byte_scalar(rest, needle.ptr[0]);
+		if (idx > last) {
+			break;
+		}
+		if (memcmp(&self.ptr[idx + 1], &needle.ptr[1], needle.len - 1) == 0) {
+			return idx;
+		}
+		++idx;
+	}
+	return self.len;
+}
+
+/**
+ * INTERNAL: Scalar `slice_count_byte`.
+ */
+static size_t slice_count_byte_scalar(const Slice self, unsigned char byte) {
+	size_t ret = 0;
+	for (size_t idx = 0; idx < self.len; ++idx) {
+		ret += self.ptr[idx] == byte;
+	}
+	return ret;
+}
+
+/**
+ * INTERNAL: Scalar `slice_mismatch`, comparing a machine word at a time.
+ */
+static size_t slice_mismatch_scalar(
+	const unsigned char* a,
+	const unsigned char* b,
+	size_t len
+) {
+	size_t idx = 0;
+	for (; idx + 8 <= len; idx += 8) {
+		uint64_t wa;
+		uint64_t wb;
+		memcpy(&wa, &a[idx], 8);
+		memcpy(&wb, &b[idx], 8);
+		if (wa != wb) {
+			break;
+		}
+	}
+	for (; idx < len; ++idx) {
+		if (a[idx] != b[idx]) {
+			return idx;
+		}
+	}
+	return len;
+}
+
+#ifdef WYZYRDRY_X86
+
+/*
+ * SSE2 kernels, working sixteen bytes at a time.
+ */
+
+WYZYRDRY_TARGET("sse2")
+static size_t slice_find_byte_sse2(const Slice self, unsigned char byte) {
+	const __m128i needle = _mm_set1_epi8((char)byte);
+	size_t idx = 0;
+	for (; idx + 16 <= self.len; idx += 16) {
+		__m128i blk = _mm_loadu_si128((const __m128i*)&self.ptr[idx]);
+		unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(blk, needle));
+		if (mask != 0) {
+			return idx + __builtin_ctz(mask);
+		}
+	}
+	Slice rest = slice_new(&self.ptr[idx], self.len - idx);
+	return idx + slice_find_byte_scalar(rest, byte);
+}
+
+WYZYRDRY_TARGET("sse2")
+static size_t slice_find_any_sse2(const Slice self, const Slice set) {
+	__m128i needles[SLICE_SET_SIMD_MAX];
+	for (size_t idx = 0; idx < set.len; ++idx) {
+		needles[idx] = _mm_set1_epi8((char)set.ptr[idx]);
+	}
+	size_t idx = 0;
+	for (; idx + 16 <= self.len; idx += 16) {
+		__m128i blk = _mm_loadu_si128((const __m128i*)&self.ptr[idx]);
+		__m128i hits = _mm_cmpeq_epi8(blk, needles[0]);
+		for (size_t jdx = 1; jdx < set.len; ++jdx) {
+			hits = _mm_or_si128(hits, _mm_cmpeq_epi8(blk, needles[jdx]));
+		}
+		unsigned int mask = _mm_movemask_epi8(hits);
+		if (mask != 0) {
+			return idx + __builtin_ctz(mask);
+		}
+	}
+	Slice rest = slice_new(&self.ptr[idx], self.len - idx);
+	return idx + slice_find_any_scalar(rest, set);
+}
+
+WYZYRDRY_TARGET("sse2")
+static size_t slice_find_subslice_sse2(const Slice self, const Slice needle) {
+	const __m128i first = _mm_set1_epi8((char)needle.ptr[0]);
+	const __m128i last = _mm_set1_epi8((char)needle.ptr[needle.len - 1]);
+	const size_t tail = needle.len - 1;
+	size_t idx = 0;
+	for (; idx + tail + 16 <= self.len; idx += 16) {
+		__m128i bf = _mm_loadu_si128((const __m128i*)&self.ptr[idx]);
+		__m128i bl = _mm_loadu_si128((const __m128i*)&self.ptr[idx + tail]);
+		__m128i hits = _mm_and_si128(
+			_mm_cmpeq_epi8(bf, first),
+			_mm_cmpeq_epi8(bl, last)
+		);
+		unsigned int mask = _mm_movemask_epi8(hits);
+		while (mask != 0) {
+			size_t at = idx + __builtin_ctz(mask);
+			if (memcmp(&self.ptr[at + 1], &needle.ptr[1], needle.len - 2) == 0) {
+				return at;
+			}
+			mask &= mask - 1;
+		}
+	}
+	Slice rest = slice_new(&self.ptr[idx], self.len - idx);
+	return idx + slice_find_subslice_scalar(rest, needle);
+}
+
+WYZYRDRY_TARGET("sse2")
+static size_t slice_count_byte_sse2(const Slice self, unsigned char byte) {
+	const __m128i needle = _mm_set1_epi8((char)byte);
+	const __m128i zero = _mm_setzero_si128();
+	size_t ret = 0;
+	size_t idx = 0;
+	while (idx + 16 <= self.len) {
+		/* Each lane counts matches as a byte, so flush before it overflows. */
+		__m128i acc = zero;
+		for (int run = 0; run < 255 && idx + 16 <= self.len; ++run, idx += 16) {
+			__m128i blk = _mm_loadu_si128((const __m128i*)&self.ptr[idx]);
+			acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(blk, needle));
+		}
+		uint64_t lanes[2];
+		_mm_storeu_si128((__m128i*)lanes, _mm_sad_epu8(acc, zero));
+		ret += lanes[0] + lanes[1];
+	}
+	Slice rest = slice_new(&self.ptr[idx], self.len - idx);
+	return ret + slice_count_byte_scalar(rest, byte);
+}
+
+WYZYRDRY_TARGET("sse2")
+static size_t slice_mismatch_sse2(
+	const unsigned char* a,
+	const unsigned char* b,
+	size_t len
+) {
+	size_t idx = 0;
+	for (; idx + 16 <= len; idx += 16) {
+		__m128i va = _mm_loadu_si128((const __m128i*)&a[idx]);
+		__m128i vb = _mm_loadu_si128((const __m128i*)&b[idx]);
+		unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb));
+		if (mask != 0xFFFF) {
+			return idx + __builtin_ctz(~mask);
+		}
+	}
+	return idx + slice_mismatch_scalar(&a[idx], &b[idx], len - idx);
+}
+
+/*
+ * AVX2 kernels, working thirty-two bytes at a time. Tails shorter than a full
+ * vector are handed to the SSE2 kernels.
+ */
+
+WYZYRDRY_TARGET("avx2")
+static size_t slice_find_byte_avx2(const Slice self, unsigned char byte) {
+	const __m256i needle = _mm256_set1_epi8((char)byte);
+	size_t idx = 0;
+	/* Test two vectors per iteration, and only locate the hit once found. */
+	for (; idx + 64 <= self.len; idx += 64) {
+		__m256i b0 = _mm256_loadu_si256((const __m256i*)&self.ptr[idx]);
+		__m256i b1 = _mm256_loadu_si256((const __m256i*)&self.ptr[idx + 32]);
+		__m256i h0 = _mm256_cmpeq_epi8(b0, needle);
+		__m256i h1 = _mm256_cmpeq_epi8(b1, needle);
+		if (_mm256_movemask_epi8(_mm256_or_si256(h0, h1)) != 0) {
+			uint64_t mask = (uint32_t)_mm256_movemask_epi8(h0)
+				| (uint64_t)(uint32_t)_mm256_movemask_epi8(h1) << 32;
+			return idx + __builtin_ctzll(mask);
+		}
+	}
+	for (; idx + 32 <= self.len; idx += 32) {
+		__m256i blk = _mm256_loadu_si256((const __m256i*)&self.ptr[idx]);
+		unsigned int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(blk, needle));
+		if (mask != 0) {
+			return idx + __builtin_ctz(mask);
+		}
+	}
+	Slice rest = slice_new(&self.ptr[idx], self.len - idx);
+	return idx + slice_find_byte_sse2(rest, byte);
+}
+
+WYZYRDRY_TARGET("avx2")
+static size_t slice_find_any_avx2(const Slice self, const Slice set) {
+	__m256i needles[SLICE_SET_SIMD_MAX];
+	for (size_t idx = 0; idx < set.len; ++idx) {
+		needles[idx] = _mm256_set1_epi8((char)set.ptr[idx]);
+	}
+	size_t idx = 0;
+	for (; idx + 32 <= self.len; idx += 32) {
+		__m256i blk = _mm256_loadu_si256((const __m256i*)&self.ptr[idx]);
+		__m256i hits = _mm256_cmpeq_epi8(blk, needles[0]);
+		for (size_t jdx = 1; jdx < set.len; ++jdx) {
+			hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(blk, needles[jdx]));
+		}
+		unsigned int mask = _mm256_movemask_epi8(hits);
+		if (mask != 0) {
+			return idx + __builtin_ctz(mask);
+		}
+	}
+	Slice rest = slice_new(&self.ptr[idx], self.len - idx);
+	return idx + slice_find_any_sse2(rest, set);
+}
+
+WYZYRDRY_TARGET("avx2")
+static size_t slice_find_subslice_avx2(const Slice self, const Slice needle) {
+	const __m256i first = _mm256_set1_epi8((char)needle.ptr[0]);
+	const __m256i last = _mm256_set1_epi8((char)needle.ptr[needle.len - 1]);
+	const size_t tail = needle.len - 1;
+	size_t idx = 0;
+	for (; idx + tail + 32 <= self.len; idx += 32) {
+		__m256i bf = _mm256_loadu_si256((const __m256i*)&self.ptr[idx]);
+		__m256i bl = _mm256_loadu_si256((const __m256i*)&self.ptr[idx + tail]);
+		__m256i hits = _mm256_and_si256(
+			_mm256_cmpeq_epi8(bf, first),
+			_mm256_cmpeq_epi8(bl, last)
+		);
+		unsigned int mask = _mm256_movemask_epi8(hits);
+		while (mask != 0) {
+			size_t at = idx + __builtin_ctz(mask);
+			if (memcmp(&self.ptr[at + 1], &needle.ptr[1], needle.len - 2) == 0) {
+				return at;
+			}
+			mask &= mask - 1;
+		}
+	}
+	Slice rest = slice_new(&self.ptr[idx], self.len - idx);
+	return idx + slice_find_subslice_sse2(rest, needle);
+}
+
+WYZYRDRY_TARGET("avx2")
+static size_t slice_count_byte_avx2(const Slice self, unsigned char byte) {
+	const __m256i needle = _mm256_set1_epi8((char)byte);
+	const __m256i zero = _mm256_setzero_si256();
+	size_t ret = 0;
+	size_t idx = 0;
+	while (idx + 32 <= self.len) {
+		__m256i acc = zero;
+		for (int run = 0; run < 255 && idx + 32 <= self.len; ++run, idx += 32) {
+			__m256i blk = _mm256_loadu_si256((const __m256i*)&self.ptr[idx]);
+			acc = _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(blk, needle));
+		}
+		uint64_t lanes[4];
+		_mm256_storeu_si256((__m256i*)lanes, _mm256_sad_epu8(acc, zero));
+		ret += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	}
+	Slice rest = slice_new(&self.ptr[idx], self.len - idx);
+	return ret + slice_count_byte_sse2(rest, byte);
+}
+
+WYZYRDRY_TARGET("avx2")
+static size_t slice_mismatch_avx2(
+	const unsigned char* a,
+	const unsigned char* b,
+	size_t len
+) {
+	size_t idx = 0;
+	for (; idx + 32 <= len; idx += 32) {
+		__m256i va = _mm256_loadu_si256((const __m256i*)&a[idx]);
+		__m256i vb = _mm256_loadu_si256((const __m256i*)&b[idx]);
+		unsigned int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb));
+		if (mask != 0xFFFFFFFFu) {
+			return idx + __builtin_ctz(~mask);
+		}
+	}
+	return idx + slice_mismatch_sse2(&a[idx], &b[idx], len - idx);
+}
+
+/*
+ * AVX-512BW kernels, working sixty-four bytes at a time. Masked loads let these
+ * finish their own tails without reading past the end of the Slice.
+ */
+
+/**
+ * INTERNAL: Build a load mask covering the low `len` lanes of a 512-bit vector.
+ */
+static inline uint64_t slice_tail_mask(size_t len) {
+	return len >= 64 ? ~0ULL : (1ULL << len) - 1;
+}
+
+WYZYRDRY_TARGET("avx512f,avx512bw")
+static size_t slice_find_byte_avx512(const Slice self, unsigned char byte) {
+	const __m512i needle = _mm512_set1_epi8((char)byte);
+	size_t idx = 0;
+	for (; idx + 64 <= self.len; idx += 64) {
+		__m512i blk = _mm512_loadu_si512((const void*)&self.ptr[idx]);
+		uint64_t mask = _mm512_cmpeq_epi8_mask(blk, needle);
+		if (mask != 0) {
+			return idx + __builtin_ctzll(mask);
+		}
+	}
+	if (idx < self.len) {
+		__mmask64 live = slice_tail_mask(self.len - idx);
+		__m512i blk = _mm512_maskz_loadu_epi8(live, &self.ptr[idx]);
+		uint64_t mask = _mm512_mask_cmpeq_epi8_mask(live, blk, needle);
+		if (mask != 0) {
+			return idx + __builtin_ctzll(mask);
+		}
+	}
+	return self.len;
+}
+
+WYZYRDRY_TARGET("avx512f,avx512bw,popcnt")
+static size_t slice_count_byte_avx512(const Slice self, unsigned char byte) {
+	const __m512i needle = _mm512_set1_epi8((char)byte);
+	size_t ret = 0;
+	size_t idx = 0;
+	for (; idx + 64 <= self.len; idx += 64) {
+		__m512i blk = _mm512_loadu_si512((const void*)&self.ptr[idx]);
+		ret += __builtin_popcountll(_mm512_cmpeq_epi8_mask(blk, needle));
+	}
+	if (idx < self.len) {
+		__mmask64 live = slice_tail_mask(self.len - idx);
+		__m512i blk = _mm512_maskz_loadu_epi8(live, &self.ptr[idx]);
+		ret += __builtin_popcountll(_mm512_mask_cmpeq_epi8_mask(live, blk, needle));
+	}
+	return ret;
+}
+
+WYZYRDRY_TARGET("avx512f,avx512bw")
+static size_t slice_mismatch_avx512(
+	const unsigned char* a,
+	const unsigned char* b,
+	size_t len
+) {
+	size_t idx = 0;
+	for (; idx + 64 <= len; idx += 64) {
+		__m512i va = _mm512_loadu_si512((const void*)&a[idx]);
+		__m512i vb = _mm512_loadu_si512((const void*)&b[idx]);
+		uint64_t mask = _mm512_cmpneq_epi8_mask(va, vb);
+		if (mask != 0) {
+			return idx + __builtin_ctzll(mask);
+		}
+	}
+	if (idx < len) {
+		__mmask64 live = slice_tail_mask(len - idx);
+		__m512i va = _mm512_maskz_loadu_epi8(live, &a[idx]);
+		__m512i vb = _mm512_maskz_loadu_epi8(live, &b[idx]);
+		uint64_t mask = _mm512_mask_cmpneq_epi8_mask(live, va, vb);
+		if (mask != 0) {
+			return idx + __builtin_ctzll(mask);
+		}
+	}
+	return len;
+}
+
+#endif
+
+/*
+ * Transform kernels. These all read a full block before writing it, so they
+ * are safe to run in place.
+ */
+
+/**
+ * INTERNAL: Add `delta` to every byte in the 26-letter range that starts at
+ * `first`, and copy every other byte unchanged. This is ASCII case folding in
+ * either direction.
+ */
+static void slice_shift_range(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	unsigned char first,
+	unsigned char delta
+) {
+	size_t idx = 0;
+#ifdef WYZYRDRY_X86
+	if (len >= 16) {
+		if (cpu_has(CPU_AVX512BW)) {
+			slice_shift_range_avx512(dst, src, len, first, delta);
+			return;
+		}
+		if (cpu_has(CPU_AVX2)) {
+			idx = slice_shift_range_avx2(dst, src, len, first, delta);
+		}
+		else if (cpu_has(CPU_SSE2)) {
+			idx = slice_shift_range_sse2(dst, src, len, first, delta);
+		}
+	}
+#endif
+	for (; idx < len; ++idx) {
+		unsigned char c = src[idx];
+		dst[idx] = (unsigned char)(c - first) < 26 ? (unsigned char)(c + delta) : c;
+	}
+}
+
+/**
+ * INTERNAL: Portable table translation.
+ */
+static void slice_map_scalar(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	const unsigned char table[256]
+) {
+	for (size_t idx = 0; idx < len; ++idx) {
+		dst[idx] = table[src[idx]];
+	}
+}
+
+#ifdef WYZYRDRY_X86
+
+/**
+ * INTERNAL: SSE2 range shift. A byte is in range when subtracting the start of
+ * the range leaves it unchanged by an unsigned minimum against the range size.
+ * @return The number of bytes processed; the caller finishes the tail.
+ */
+WYZYRDRY_TARGET("sse2")
+static size_t slice_shift_range_sse2(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	unsigned char first,
+	unsigned char delta
+) {
+	const __m128i base = _mm_set1_epi8((char)first);
+	const __m128i span = _mm_set1_epi8(25);
+	const __m128i shift = _mm_set1_epi8((char)delta);
+	size_t idx = 0;
+	for (; idx + 16 <= len; idx += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)&src[idx]);
+		__m128i off = _mm_sub_epi8(v, base);
+		__m128i hit = _mm_cmpeq_epi8(_mm_min_epu8(off, span), off);
+		v = _mm_add_epi8(v, _mm_and_si128(hit, shift));
+		_mm_storeu_si128((__m128i*)&dst[idx], v);
+	}
+	return idx;
+}
+
+/**
+ * INTERNAL: AVX2 range shift, as the SSE2 version.
+ * @return The number of bytes processed; the caller finishes the tail.
+ */
+WYZYRDRY_TARGET("avx2")
+static size_t slice_shift_range_avx2(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	unsigned char first,
+	unsigned char delta
+) {
+	const __m256i base = _mm256_set1_epi8((char)first);
+	const __m256i span = _mm256_set1_epi8(25);
+	const __m256i shift = _mm256_set1_epi8((char)delta);
+	size_t idx = 0;
+	for (; idx + 32 <= len; idx += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i*)&src[idx]);
+		__m256i off = _mm256_sub_epi8(v, base);
+		__m256i hit = _mm256_cmpeq_epi8(_mm256_min_epu8(off, span), off);
+		v = _mm256_add_epi8(v, _mm256_and_si256(hit, shift));
+		_mm256_storeu_si256((__m256i*)&dst[idx], v);
+	}
+	return idx + slice_shift_range_sse2(&dst[idx], &src[idx], len - idx, first, delta);
+}
+
+/**
+ * INTERNAL: AVX-512BW range shift, with masked loads and stores for the tail.
+ */
+WYZYRDRY_TARGET("avx512f,avx512bw")
+static void slice_shift_range_avx512(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	unsigned char first,
+	unsigned char delta
+) {
+	const __m512i base = _mm512_set1_epi8((char)first);
+	const __m512i span = _mm512_set1_epi8(25);
+	const __m512i shift = _mm512_set1_epi8((char)delta);
+	size_t idx = 0;
+	for (; idx + 64 <= len; idx += 64) {
+		__m512i v = _mm512_loadu_si512((const void*)&src[idx]);
+		__mmask64 hit = _mm512_cmple_epu8_mask(_mm512_sub_epi8(v, base), span);
+		v = _mm512_mask_add_epi8(v, hit, v, shift);
+		_mm512_storeu_si512((void*)&dst[idx], v);
+	}
+	if (idx < len) {
+		__mmask64 live = slice_tail_mask(len - idx);
+		__m512i v = _mm512_maskz_loadu_epi8(live, &src[idx]);
+		__mmask64 hit = _mm512_cmple_epu8_mask(_mm512_sub_epi8(v, base), span);
+		v = _mm512_mask_add_epi8(v, hit, v, shift);
+		_mm512_mask_storeu_epi8(&dst[idx], live, v);
+	}
+}
+
+/**
+ * INTERNAL: AVX2 table translation.
+ *
+ * `pshufb` can only index sixteen entries, so the table is split into sixteen
+ * rows by high nibble. Every row is looked up by the low nibble, and a tree of
+ * blends picks the right row using high-nibble bits 4 to 7 in turn. `blendv`
+ * selects on the top bit of each byte, so each selector bit is shifted there.
+ */
+WYZYRDRY_TARGET("avx2")
+static void slice_map_avx2(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	const unsigned char table[256]
+) {
+	__m256i rows[16];
+	for (int row = 0; row < 16; ++row) {
+		rows[row] = _mm256_broadcastsi128_si256(
+			_mm_loadu_si128((const __m128i*)&table[16 * row])
+		);
+	}
+	const __m256i low = _mm256_set1_epi8(0x0F);
+	size_t idx = 0;
+	for (; idx + 32 <= len; idx += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i*)&src[idx]);
+		__m256i lo = _mm256_and_si256(v, low);
+		__m256i bit4 = _mm256_slli_epi16(v, 3);
+		__m256i bit5 = _mm256_slli_epi16(v, 2);
+		__m256i bit6 = _mm256_slli_epi16(v, 1);
+		__m256i pick[8];
+		for (int pair = 0; pair < 8; ++pair) {
+			pick[pair] = _mm256_blendv_epi8(
+				_mm256_shuffle_epi8(rows[2 * pair], lo),
+				_mm256_shuffle_epi8(rows[2 * pair + 1], lo),
+				bit4
+			);
+		}
+		for (int quad = 0; quad < 4; ++quad) {
+			pick[quad] = _mm256_blendv_epi8(pick[2 * quad], pick[2 * quad + 1], bit5);
+		}
+		pick[0] = _mm256_blendv_epi8(pick[0], pick[1], bit6);
+		pick[1] = _mm256_blendv_epi8(pick[2], pick[3], bit6);
+		__m256i out = _mm256_blendv_epi8(pick[0], pick[1], v);
+		_mm256_storeu_si256((__m256i*)&dst[idx], out);
+	}
+	slice_map_scalar(&dst[idx], &src[idx], len - idx, table);
+}
+
+/**
+ * INTERNAL: AVX-512 VBMI table translation. `vpermi2b` looks up 128 entries
+ * from a pair of registers using the low seven bits of each byte, so two of
+ * them cover the table and the top bit picks between their results.
+ */
+WYZYRDRY_TARGET("avx512f,avx512bw,avx512vbmi")
+static void slice_map_avx512vbmi(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len,
+	const unsigned char table[256]
+) {
+	const __m512i t0 = _mm512_loadu_si512((const void*)&table[0]);
+	const __m512i t1 = _mm512_loadu_si512((const void*)&table[64]);
+	const __m512i t2 = _mm512_loadu_si512((const void*)&table[128]);
+	const __m512i t3 = _mm512_loadu_si512((const void*)&table[192]);
+	for (size_t idx = 0; idx < len; idx += 64) {
+		__mmask64 live = slice_tail_mask(len - idx);
+		__m512i v = _mm512_maskz_loadu_epi8(live, &src[idx]);
+		__m512i lower = _mm512_permutex2var_epi8(t0, v, t1);
+		__m512i upper = _mm512_permutex2var_epi8(t2, v, t3);
+		__m512i out = _mm512_mask_blend_epi8(_mm512_movepi8_mask(v), lower, upper);
+		_mm512_mask_storeu_epi8(&dst[idx], live, out);
+	}
+}
+
+#endif
@@ -0,0 +1,197 @@
+#include <string.h>
+
+#include <wyzyrdry.h>
+
+static size_t splitter_scan(const Splitter* const self, const Slice input);
+static void splitter_stash(Splitter* const self, const Slice bytes);
+static void splitter_release(Splitter* const self);
+
+/**
+ * Initialize a Splitter.
+ * @param delims The bytes that end a record, such as "\n" or "\0". At most
+ * `SPLIT_DELIMS_MAX` are used; they are copied, and a single delimiter is
+ * found with the faster single-byte search.
+ * @return A Splitter with no input.
+ */
+Splitter splitter_init(const Slice delims) {
+	Splitter ret = {
+		.delims_len = delims.len < SPLIT_DELIMS_MAX ? delims.len : SPLIT_DELIMS_MAX,
+		.input = slice_new(NULL, 0),
+		.queued = slice_new(NULL, 0),
+		.partial = { .buf = NULL, .len = 0, .cap = 0 },
+		.yielded_partial = false,
+		.ring_held = false,
+		.last_delim = 0,
+	};
+	if (ret.delims_len > 0) {
+		INSTRUMENT_COPY("split", ret.delims, delims.ptr, ret.delims_len);
+	}
+	return ret;
+}
+
+/**
+ * Deallocate the buffer a Splitter uses for records that span pieces of input.
+ * @param self The Splitter on which to act.
+ */
+void splitter_free(Splitter* const self) {
+	vec_free(&self->partial);
+	self->input = slice_new(NULL, 0);
+	self->queued = slice_new(NULL, 0);
+	self->yielded_partial = false;
+}
+
+/**
+ * Give the Splitter the next piece of input.
+ *
+ * This must only be called once `splitter_next()` has returned false for the
+ * previous piece. The piece is not copied, and must remain valid until then.
+ * @param self The Splitter on which to act.
+ * @param input The next bytes of the stream.
+ */
+void splitter_feed(Splitter* const self, const Slice input) {
+	splitter_release(self);
+	self->input = input;
+	self->queued = slice_new(NULL, 0);
+}
+
+/**
+ * Get the next complete record from the input fed so far.
+ *
+ * A record that lies entirely within the current piece of input is returned as
+ * a Slice into that piece. One that began in an earlier piece is returned from
+ * the Splitter's own buffer. Either way the delimiter is not included, and the
+ * Slice is valid until the next call to any Splitter function.
+ *
+ * When the current piece holds no more delimiters, its remaining bytes are kept
+ * as the start of the next record, and this returns false.
+ * @param self The Splitter on which to act.
+ * @param record Receives the record.
+ * @return true if a record was produced, or false if more input is needed.
+ */
+bool splitter_next(Splitter* const self, Slice* const record) {
+	splitter_release(self);
+	for (;;) {
+		if (self->input.len == 0) {
+			if (self->queued.len == 0) {
+				return false;
+			}
+			self->input = self->queued;
+			self->queued = slice_new(NULL, 0);
+		}
+		size_t idx = splitter_scan(self, self->input);
+		if (idx == self->input.len) {
+			splitter_stash(self, self->input);
+			self->input = slice_new(NULL, 0);
+			continue;
+		}
+		Slice head = slice_new(self->input.ptr, idx);
+		self->last_delim = self->input.ptr[idx];
+		self->input = slice_new(&self->input.ptr[idx + 1], self->input.len - idx - 1);
+		if (self->partial.len > 0) {
+			splitter_stash(self, head);
+			*record = vec_as_slice(&self->partial);
+			self->yielded_partial = true;
+		}
+		else {
+			*record = head;
+		}
+		return true;
+	}
+}
+
+/**
+ * Get the next complete record from the messages of a RingBuf.
+ *
+ * The messages are treated as consecutive pieces of one stream, and are read
+ * in place, including those that wrap around the end of the store. A message
+ * is popped once every record it completes has been returned, so the Splitter
+ * owns the head message while this is in use, and the caller must not read or
+ * pop it.
+ * @param self The Splitter on which to act.
+ * @param ring The RingBuf holding the stream.
+ * @param record Receives the record, valid until the next call to any Splitter
+ * function.
+ * @return true if a record was produced, or false if the RingBuf has no more
+ * messages. The bytes after the last delimiter are kept for later messages.
+ */
+bool splitter_next_ringbuf(
+	Splitter* const self,
+	RingBuf* const ring,
+	Slice* const record
+) {
+	for (;;) {
+		if (splitter_next(self, record)) {
+			return true;
+		}
+		if (self->ring_held) {
+			ringbuf_pop(ring);
+			self->ring_held = false;
+		}
+		if (ring->count == 0) {
+			return false;
+		}
+		Slice parts[2];
+		ringbuf_peek_slices(ring, parts);
+		self->input = parts[0];
+		self->queued = parts[1];
+		self->ring_held = true;
+	}
+}
+
+/**
+ * Get the final record of a stream that does not end with a delimiter.
+ *
+ * Call this once the stream has ended and `splitter_next()` has returned false.
+ * @param self The Splitter on which to act.
+ * @param record Receives the record, valid until the next call to any Splitter
+ * function.
+ * @return true if there were bytes after the last delimiter.
+ */
+bool splitter_finish(Splitter* const self, Slice* const record) {
+	splitter_release(self);
+	if (self->partial.len == 0) {
+		return false;
+	}
+	*record = vec_as_slice(&self->partial);
+	self->yielded_partial = true;
+	return true;
+}
+
+/**
+ * INTERNAL: Find the first delimiter in some input.
+ * @param self The Splitter on which to act.
+ * @param input The bytes to scan.
+ * @return The index of the first delimiter, or `input.len` if there is none.
+ */
+static size_t splitter_scan(const Splitter* const self, const Slice input) {
+	if (self->delims_len == 1) {
+		return slice_find_byte(input, self->delims[0]);
+	}
+	return slice_find_any(input, slice_new((unsigned char*)self->delims, self->delims_len));
+}
+
+/**
+ * INTERNAL: Append bytes to the record being carried across pieces of input.
+ *
+ * If allocation fails, the bytes are dropped and the record is truncated.
+ * @param self The Splitter on which to act.
+ * @param bytes The bytes to append.
+ */
+static void splitter_stash(Splitter* const self, const Slice bytes) {
+	if (bytes.len == 0 || !vec_reserve(&self->partial, bytes.len)) {
+		return;
+	}
+	INSTRUMENT_COPY("split", &self->partial.buf[self->partial.len], bytes.ptr, bytes.len);
+	self->partial.len += bytes.len;
+}
+
+/**
+ * INTERNAL: Discard a carried record once it has been returned to the caller.
+ * @param self The Splitter on which to act.
+ */
+static void splitter_release(Splitter* const self) {
+	if (self->yielded_partial) {
+		self->partial.len = 0;
+		self->yielded_partial = false;
+	}
+}
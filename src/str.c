@@ -14,7 +14,7 @@ Str* str_new(StrLen len);
 Str* str_from_vec(const Vec* const src) {
 	Str* ret = str_new((StrLen)src->len);
 	if (ret != NULL) {
-		memmove(&ret->data, src->buf, src->len);
+		INSTRUMENT_MOVE("str", &ret->data, src->buf, src->len);
 		ret->len = (StrLen)src->len;
 	}
 	return ret;
@@ -44,7 +44,7 @@ Str* str_from_vec_in_place(const Slice dst, const Vec* const src) {
 
 	Str* ret = (void*)dst.ptr;
 	ret->len = (StrLen)src->len;
-	memmove(&ret->data, src->buf, src->len);
+	INSTRUMENT_MOVE("str", &ret->data, src->buf, src->len);
 	return ret;
 }
 
@@ -56,12 +56,45 @@ Str* str_from_vec_in_place(const Slice dst, const Vec* const src) {
 Str* str_from_slice(const Slice src) {
 	Str* ret = str_new(src.len);
 	if (ret != NULL) {
-		memmove(&ret->data, src.ptr, src.len);
+		INSTRUMENT_MOVE("str", &ret->data, src.ptr, src.len);
 		ret->len = (StrLen)src.len;
 	}
 	return ret;
 }
 
+/**
+ * Copy several Slices, one after another, into a newly allocated Str buffer.
+ *
+ * The total length is found first, so the parts are copied once each, straight
+ * into the Str, with no intermediate buffer.
+ * @param parts The Slices whose contents will be written into the new Str, in
+ * order.
+ * @param n The number of Slices in `parts`.
+ * @return A pointer to the newly allocated Str buffer, or NULL if allocation
+ * failed or the parts together are longer than `STR_MAX_LEN`.
+ */
+Str* str_from_slices(const Slice* const parts, size_t n) {
+	size_t total = 0;
+	for (size_t idx = 0; idx < n; ++idx) {
+		total += parts[idx].len;
+		if (total > STR_MAX_LEN) {
+			return NULL;
+		}
+	}
+	Str* ret = str_new((StrLen)total);
+	if (ret != NULL) {
+		size_t at = 0;
+		for (size_t idx = 0; idx < n; ++idx) {
+			if (parts[idx].len > 0) {
+				INSTRUMENT_MOVE("str", &ret->data[at], parts[idx].ptr, parts[idx].len);
+				at += parts[idx].len;
+			}
+		}
+		ret->len = (StrLen)total;
+	}
+	return ret;
+}
+
 /**
  * Copy a slice of data into another pre-existing Slice.
  *
@@ -83,7 +116,7 @@ Str* str_from_slice_in_place(const Slice dst, const Slice src) {
 
 	Str* ret = (void*)dst.ptr;
 	ret->len = (StrLen)src.len;
-	memmove(&ret->data, src.ptr, src.len);
+	INSTRUMENT_MOVE("str", &ret->data, src.ptr, src.len);
 	return ret;
 }
 
@@ -94,19 +127,27 @@ Str* str_from_slice_in_place(const Slice dst, const Slice src) {
 void str_free(Str* self) {
 	memset(self->data, 0, self->len);
 	self->len = 0;
-	free(self);
+	INSTRUMENT_FREE("str", self);
 }
 
 /**
- * Get a Slice over a Str's data payload.
- * @param self The Str to be described as a Slice.
- * @return A Slice describing the Str.
+ * Compute the CRC-32C checksum of a Str's data payload, for verifying it after
+ * it crosses a process or machine boundary. The length prefix is not included,
+ * as its byte order may legitimately change in transit.
+ * @param self The Str to checksum.
+ * @return The CRC-32C of the payload.
  */
-const Slice str_as_slice(Str* const self) {
-	return (Slice){
-		.ptr = self->data,
-		.len = self->len,
-	};
+uint32_t str_checksum(const Str* const self) {
+	return hash_crc32c(0, str_as_slice((Str* const)self));
+}
+
+/**
+ * Check whether a Str's payload is valid UTF-8, before forwarding it as text.
+ * @param self The Str to check.
+ * @return true if the payload is valid UTF-8.
+ */
+bool str_validate_utf8(const Str* const self) {
+	return slice_validate_utf8(str_as_slice((Str* const)self));
 }
 
 /**
@@ -116,9 +157,9 @@ const Slice str_as_slice(Str* const self) {
  * @param self
  */
 void str_debug_print(const Str* const self) {
-	printf("Str { len: %zu, data ... }\nData: ", (size_t)self->len);
+	printf("Str { len: %zu, data ... }\nData:\n", (size_t)self->len);
 	hex_print(str_as_slice((Str* const)self));
-	printf("RawStr: ");
+	printf("RawStr:\n");
 	hex_print(slice_new((unsigned char*)self, str_size(self->len)));
 }
 
@@ -128,28 +169,5 @@ void str_debug_print(const Str* const self) {
  * @return A pointer to a new Str region.
  */
 Str* str_new(StrLen len) {
-	return malloc(str_size(len));
-}
-
-/**
- * INTERNAL USE: Get the size of a Str that wraps a certain amount of data.
- * @param len The amount of data to wrap with a Str.
- * @return The size of the Str that will wrap the given data.
- */
-StrLen str_size(StrLen len) {
-	return len + sizeof(StrLen);
-}
-
-/**
- * INTERNAL USE: Get the data capacity of a Str.
- * @param size The length of a data buffer.
- * @return The amount of data that buffer can hold formatted as a Str.
- */
-StrLen str_capacity(StrLen size) {
-	if (size > sizeof(StrLen)) {
-		return size - sizeof(StrLen);
-	}
-	else {
-		return 0;
-	}
+	return INSTRUMENT_MALLOC("str", str_size(len));
 }
@@ -0,0 +1,774 @@
+#include <stdint.h>
+#include <string.h>
+
+#include <wyzyrdry.h>
+
+#ifdef WYZYRDRY_X86
+#include <immintrin.h>
+#endif
+
+/*
+ * The ways a pair of adjacent bytes can be wrong, as seen by the lookup
+ * validator. Each table below maps a nibble of the pair to the set of errors
+ * that nibble is consistent with, so a pair is wrong exactly when all three of
+ * its lookups share a bit. TWO_CONTS is the exception: two continuation bytes
+ * are correct when the first one continues a three- or four-byte sequence.
+ */
+#define UTF8_TOO_SHORT (1 << 0)
+#define UTF8_TOO_LONG (1 << 1)
+#define UTF8_OVERLONG_3 (1 << 2)
+#define UTF8_TOO_LARGE (1 << 3)
+#define UTF8_SURROGATE (1 << 4)
+#define UTF8_OVERLONG_2 (1 << 5)
+#define UTF8_TOO_LARGE_1000 (1 << 6)
+#define UTF8_OVERLONG_4 (1 << 6)
+#define UTF8_TWO_CONTS (1 << 7)
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+/**
+ * Errors consistent with the high nibble of the first byte of a pair.
+ */
+static const unsigned char utf8_first_high[16] = {
+	/* 0_______: ASCII */
+	UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+	UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+	/* 10______: continuation */
+	UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+	/* 1100____, 1101____: two-byte lead */
+	UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+	UTF8_TOO_SHORT,
+	/* 1110____: three-byte lead */
+	UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+	/* 1111____: four-byte lead */
+	UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+};
+
+/**
+ * Errors consistent with the low nibble of the first byte of a pair.
+ */
+static const unsigned char utf8_first_low[16] = {
+	UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+	UTF8_CARRY | UTF8_OVERLONG_2,
+	UTF8_CARRY,
+	UTF8_CARRY,
+	UTF8_CARRY | UTF8_TOO_LARGE,
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+};
+
+/**
+ * Errors consistent with the high nibble of the second byte of a pair.
+ */
+static const unsigned char utf8_second_high[16] = {
+	/* 0_______: ASCII */
+	UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+	UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+	/* 1000____ */
+	UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3
+		| UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+	/* 1001____ */
+	UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3
+		| UTF8_TOO_LARGE,
+	/* 101_____ */
+	UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE
+		| UTF8_TOO_LARGE,
+	UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE
+		| UTF8_TOO_LARGE,
+	/* 11______: lead */
+	UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+};
+
+/**
+ * The largest byte at each of the last three positions of a 32-byte block
+ * that does not begin a sequence running past the block. The SSSE3 kernel
+ * uses the second half.
+ */
+static const unsigned char utf8_incomplete[32] = {
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1,
+};
+
+static size_t utf8_decode_one(
+	const unsigned char* src,
+	size_t len,
+	size_t idx,
+	uint32_t* cp
+);
+static size_t utf8_validate_scalar(
+	const unsigned char* src,
+	size_t len,
+	size_t idx
+);
+static size_t utf8_restart(const unsigned char* src, size_t idx);
+static bool utf8_is_ascii_scalar(const unsigned char* src, size_t len);
+static size_t utf8_count_scalar(const unsigned char* src, size_t len);
+static size_t utf8_widen_ascii(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len
+);
+static size_t utf16_narrow_ascii(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t units
+);
+#ifdef WYZYRDRY_X86
+static size_t utf8_validate_ssse3(const unsigned char* src, size_t len);
+static size_t utf8_validate_avx2(const unsigned char* src, size_t len);
+static bool utf8_is_ascii_sse2(const unsigned char* src, size_t len);
+static bool utf8_is_ascii_avx2(const unsigned char* src, size_t len);
+static size_t utf8_count_sse2(const unsigned char* src, size_t len);
+static size_t utf8_count_avx2(const unsigned char* src, size_t len);
+#endif
+
+/**
+ * Find the longest prefix of a Slice that is valid UTF-8.
+ * @param src The bytes to check.
+ * @return `src.len` if every byte is part of a valid sequence, or else the
+ * index of the first byte of the first sequence that is not.
+ */
+size_t utf8_validate(const Slice src) {
+#ifdef WYZYRDRY_X86
+	if (src.len >= 32 && cpu_has(CPU_AVX2)) {
+		return utf8_validate_avx2(src.ptr, src.len);
+	}
+	if (src.len >= 16 && cpu_has(CPU_SSSE3)) {
+		return utf8_validate_ssse3(src.ptr, src.len);
+	}
+#endif
+	return utf8_validate_scalar(src.ptr, src.len, 0);
+}
+
+/**
+ * Check whether a Slice holds only ASCII, which is valid UTF-8 with one code
+ * point per byte.
+ * @param src The bytes to check.
+ * @return true if no byte has its top bit set.
+ */
+bool utf8_is_ascii(const Slice src) {
+#ifdef WYZYRDRY_X86
+	if (src.len >= 32 && cpu_has(CPU_AVX2)) {
+		return utf8_is_ascii_avx2(src.ptr, src.len);
+	}
+	if (src.len >= 16 && cpu_has(CPU_SSE2)) {
+		return utf8_is_ascii_sse2(src.ptr, src.len);
+	}
+#endif
+	return utf8_is_ascii_scalar(src.ptr, src.len);
+}
+
+/**
+ * Count the code points in valid UTF-8.
+ *
+ * Every byte except a continuation byte starts a code point, so this counts
+ * those bytes, and does not validate. Invalid input yields a count with no
+ * particular meaning.
+ * @param src The text to count.
+ * @return The number of code points.
+ */
+size_t utf8_count(const Slice src) {
+#ifdef WYZYRDRY_X86
+	if (src.len >= 32 && cpu_has(CPU_AVX2)) {
+		return utf8_count_avx2(src.ptr, src.len);
+	}
+	if (src.len >= 16 && cpu_has(CPU_SSE2)) {
+		return utf8_count_sse2(src.ptr, src.len);
+	}
+#endif
+	return utf8_count_scalar(src.ptr, src.len);
+}
+
+/**
+ * Transcode UTF-8 to UTF-16, appending the code units to a Vec.
+ *
+ * On failure, the Vec's length is unchanged.
+ * @param dst The Vec to receive two bytes per code unit, in native order.
+ * @param src The UTF-8 text.
+ * @return Ok with the number of bytes appended, or Err with the index of the
+ * first sequence that is not valid UTF-8.
+ */
+Utf8Result utf8_to_utf16(Vec* const dst, const Slice src) {
+	/* One unit per byte is the most: four-byte sequences become two. */
+	if (!vec_reserve(dst, 2 * src.len)) {
+		return SET_VARIANT(Utf8Result, Err, 0);
+	}
+	unsigned char* out = &dst->buf[dst->len];
+	size_t pos = 0;
+	size_t idx = 0;
+	while (idx < src.len) {
+		size_t run = utf8_widen_ascii(&out[pos], &src.ptr[idx], src.len - idx);
+		idx += run;
+		pos += 2 * run;
+		if (idx == src.len) {
+			break;
+		}
+		uint32_t cp;
+		size_t len = utf8_decode_one(src.ptr, src.len, idx, &cp);
+		if (len == 0) {
+			return SET_VARIANT(Utf8Result, Err, idx);
+		}
+		uint16_t units[2];
+		size_t count = 1;
+		if (cp < 0x10000) {
+			units[0] = (uint16_t)cp;
+		}
+		else {
+			cp -= 0x10000;
+			units[0] = (uint16_t)(0xD800 | cp >> 10);
+			units[1] = (uint16_t)(0xDC00 | (cp & 0x3FF));
+			count = 2;
+		}
+		memcpy(&out[pos], units, 2 * count);
+		pos += 2 * count;
+		idx += len;
+	}
+	dst->len += pos;
+	return SET_VARIANT(Utf8Result, Ok, pos);
+}
+
+/**
+ * Transcode UTF-16 to UTF-8, appending the bytes to a Vec.
+ *
+ * On failure, the Vec's length is unchanged.
+ * @param dst The Vec to receive the UTF-8 text.
+ * @param src The UTF-16 text, two bytes per code unit, in native order.
+ * @return Ok with the number of bytes appended, or Err with the byte index of
+ * the first unpaired surrogate, or of the final byte if the length is odd.
+ */
+Utf8Result utf16_to_utf8(Vec* const dst, const Slice src) {
+	size_t units = src.len / 2;
+	/* Three bytes per unit is the most: surrogate pairs become four. */
+	if (!vec_reserve(dst, 3 * units)) {
+		return SET_VARIANT(Utf8Result, Err, 0);
+	}
+	unsigned char* out = &dst->buf[dst->len];
+	size_t pos = 0;
+	size_t idx = 0;
+	while (idx < units) {
+		size_t run = utf16_narrow_ascii(&out[pos], &src.ptr[2 * idx], units - idx);
+		idx += run;
+		pos += run;
+		if (idx == units) {
+			break;
+		}
+		uint16_t unit;
+		memcpy(&unit, &src.ptr[2 * idx], 2);
+		uint32_t cp = unit;
+		size_t used = 1;
+		if (unit >= 0xD800 && unit <= 0xDFFF) {
+			uint16_t next = 0;
+			if (idx + 1 < units) {
+				memcpy(&next, &src.ptr[2 * idx + 2], 2);
+			}
+			if (unit >= 0xDC00 || next < 0xDC00 || next > 0xDFFF) {
+				return SET_VARIANT(Utf8Result, Err, 2 * idx);
+			}
+			cp = 0x10000 + ((uint32_t)(unit - 0xD800) << 10 | (uint32_t)(next - 0xDC00));
+			used = 2;
+		}
+		if (cp < 0x800) {
+			out[pos++] = (unsigned char)(0xC0 | cp >> 6);
+		}
+		else if (cp < 0x10000) {
+			out[pos++] = (unsigned char)(0xE0 | cp >> 12);
+			out[pos++] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+		}
+		else {
+			out[pos++] = (unsigned char)(0xF0 | cp >> 18);
+			out[pos++] = (unsigned char)(0x80 | ((cp >> 12) & 0x3F));
+			out[pos++] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+		}
+		out[pos++] = (unsigned char)(0x80 | (cp & 0x3F));
+		idx += used;
+	}
+	if (src.len % 2 != 0) {
+		return SET_VARIANT(Utf8Result, Err, src.len - 1);
+	}
+	dst->len += pos;
+	return SET_VARIANT(Utf8Result, Ok, pos);
+}
+
+/**
+ * INTERNAL: Decode the multi-byte UTF-8 sequence that starts at an index.
+ * @param src The text.
+ * @param len The length of the text.
+ * @param idx The index of a byte that is not ASCII.
+ * @param cp Receives the code point.
+ * @return The length of the sequence, or zero if it is not valid.
+ */
+static size_t utf8_decode_one(
+	const unsigned char* src,
+	size_t len,
+	size_t idx,
+	uint32_t* cp
+) {
+	unsigned char lead = src[idx];
+	size_t need;
+	/* The range of the second byte rules out overlong forms, surrogates,
+	 * and code points past U+10FFFF. */
+	unsigned char lo = 0x80;
+	unsigned char hi = 0xBF;
+	if (lead >= 0xC2 && lead <= 0xDF) {
+		need = 1;
+	}
+	else if (lead >= 0xE0 && lead <= 0xEF) {
+		need = 2;
+		lo = lead == 0xE0 ? 0xA0 : 0x80;
+		hi = lead == 0xED ? 0x9F : 0xBF;
+	}
+	else if (lead >= 0xF0 && lead <= 0xF4) {
+		need = 3;
+		lo = lead == 0xF0 ? 0x90 : 0x80;
+		hi = lead == 0xF4 ? 0x8F : 0xBF;
+	}
+	else {
+		return 0;
+	}
+	if (len - idx <= need || src[idx + 1] < lo || src[idx + 1] > hi) {
+		return 0;
+	}
+	uint32_t val = lead & (0x7F >> (need + 1));
+	for (size_t pos = 1; pos <= need; ++pos) {
+		unsigned char c = src[idx + pos];
+		if ((c & 0xC0) != 0x80) {
+			return 0;
+		}
+		val = val << 6 | (c & 0x3F);
+	}
+	*cp = val;
+	return need + 1;
+}
+
+/**
+ * INTERNAL: Portable UTF-8 validator, skipping eight bytes of ASCII at a time.
+ * @param src The text.
+ * @param len The length of the text.
+ * @param idx The index to start at, which must begin a sequence.
+ * @return As `utf8_validate()`.
+ */
+static size_t utf8_validate_scalar(
+	const unsigned char* src,
+	size_t len,
+	size_t idx
+) {
+	while (idx < len) {
+		if (len - idx >= 8) {
+			uint64_t word;
+			memcpy(&word, &src[idx], 8);
+			if ((word & 0x8080808080808080ULL) == 0) {
+				idx += 8;
+				continue;
+			}
+		}
+		if (src[idx] < 0x80) {
+			++idx;
+			continue;
+		}
+		uint32_t cp;
+		size_t seq = utf8_decode_one(src, len, idx, &cp);
+		if (seq == 0) {
+			return idx;
+		}
+		idx += seq;
+	}
+	return len;
+}
+
+/**
+ * INTERNAL: Find where the portable validator must resume to locate an error
+ * that a kernel found in the block at an index. Everything before the block
+ * is valid except, perhaps, a sequence that starts in its last three bytes.
+ * @return The index of the lead byte of that sequence, or `idx`.
+ */
+static size_t utf8_restart(const unsigned char* src, size_t idx) {
+	for (size_t back = 1; back <= 3 && back <= idx; ++back) {
+		unsigned char c = src[idx - back];
+		if (c >= 0xC0) {
+			return idx - back;
+		}
+		if (c < 0x80) {
+			break;
+		}
+	}
+	return idx;
+}
+
+/**
+ * INTERNAL: Portable ASCII check, eight bytes at a time.
+ */
+static bool utf8_is_ascii_scalar(const unsigned char* src, size_t len) {
+	uint64_t acc = 0;
+	size_t idx = 0;
+	for (; idx + 8 <= len; idx += 8) {
+		uint64_t word;
+		memcpy(&word, &src[idx], 8);
+		acc |= word;
+	}
+	for (; idx < len; ++idx) {
+		acc |= src[idx];
+	}
+	return (acc & 0x8080808080808080ULL) == 0;
+}
+
+/**
+ * INTERNAL: Portable code point counter.
+ */
+static size_t utf8_count_scalar(const unsigned char* src, size_t len) {
+	size_t ret = 0;
+	for (size_t idx = 0; idx < len; ++idx) {
+		ret += (src[idx] & 0xC0) != 0x80;
+	}
+	return ret;
+}
+
+#if defined(WYZYRDRY_X86) && defined(__SSE2__)
+/*
+ * The transcoders alternate between ASCII runs and single sequences, so the
+ * runs use the baseline SSE2 directly rather than a `cpu_has()` check each.
+ */
+
+/**
+ * INTERNAL: Widen the run of ASCII at the start of some UTF-8 to UTF-16.
+ * @param dst Receives two bytes for each byte of the run.
+ * @param src The text.
+ * @param len The length of the text.
+ * @return The length of the run.
+ */
+static size_t utf8_widen_ascii(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len
+) {
+	const __m128i zero = _mm_setzero_si128();
+	size_t idx = 0;
+	for (; idx + 16 <= len; idx += 16) {
+		__m128i in = _mm_loadu_si128((const __m128i*)&src[idx]);
+		if (_mm_movemask_epi8(in) != 0) {
+			break;
+		}
+		_mm_storeu_si128((__m128i*)&dst[2 * idx], _mm_unpacklo_epi8(in, zero));
+		_mm_storeu_si128((__m128i*)&dst[2 * idx + 16], _mm_unpackhi_epi8(in, zero));
+	}
+	for (; idx < len && src[idx] < 0x80; ++idx) {
+		uint16_t unit = src[idx];
+		memcpy(&dst[2 * idx], &unit, 2);
+	}
+	return idx;
+}
+
+/**
+ * INTERNAL: Narrow the run of ASCII at the start of some UTF-16 to UTF-8.
+ * @param dst Receives one byte for each unit of the run.
+ * @param src The text, two bytes per unit.
+ * @param units The number of units in the text.
+ * @return The number of units in the run.
+ */
+static size_t utf16_narrow_ascii(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t units
+) {
+	const __m128i high = _mm_set1_epi16((short)0xFF80);
+	const __m128i zero = _mm_setzero_si128();
+	size_t idx = 0;
+	for (; idx + 16 <= units; idx += 16) {
+		__m128i a = _mm_loadu_si128((const __m128i*)&src[2 * idx]);
+		__m128i b = _mm_loadu_si128((const __m128i*)&src[2 * idx + 16]);
+		__m128i wide = _mm_and_si128(_mm_or_si128(a, b), high);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi16(wide, zero)) != 0xFFFF) {
+			break;
+		}
+		_mm_storeu_si128((__m128i*)&dst[idx], _mm_packus_epi16(a, b));
+	}
+	for (; idx < units; ++idx) {
+		uint16_t unit;
+		memcpy(&unit, &src[2 * idx], 2);
+		if (unit >= 0x80) {
+			break;
+		}
+		dst[idx] = (unsigned char)unit;
+	}
+	return idx;
+}
+
+#else
+
+static size_t utf8_widen_ascii(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t len
+) {
+	size_t idx = 0;
+	for (; idx < len && src[idx] < 0x80; ++idx) {
+		uint16_t unit = src[idx];
+		memcpy(&dst[2 * idx], &unit, 2);
+	}
+	return idx;
+}
+
+static size_t utf16_narrow_ascii(
+	unsigned char* dst,
+	const unsigned char* src,
+	size_t units
+) {
+	size_t idx = 0;
+	for (; idx < units; ++idx) {
+		uint16_t unit;
+		memcpy(&unit, &src[2 * idx], 2);
+		if (unit >= 0x80) {
+			break;
+		}
+		dst[idx] = (unsigned char)unit;
+	}
+	return idx;
+}
+
+#endif
+
+#ifdef WYZYRDRY_X86
+
+/**
+ * INTERNAL: Find the errors in a block of UTF-8, given the block before it.
+ * @return A vector that is zero unless some sequence ending in this block, or
+ * crossing into it, is not valid.
+ */
+WYZYRDRY_TARGET("ssse3")
+static inline __m128i utf8_check_ssse3(__m128i in, __m128i prev) {
+	const __m128i nibble = _mm_set1_epi8(0x0F);
+	__m128i prev1 = _mm_alignr_epi8(in, prev, 15);
+	__m128i special = _mm_and_si128(
+		_mm_and_si128(
+			_mm_shuffle_epi8(
+				_mm_loadu_si128((const __m128i*)utf8_first_high),
+				_mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)
+			),
+			_mm_shuffle_epi8(
+				_mm_loadu_si128((const __m128i*)utf8_first_low),
+				_mm_and_si128(prev1, nibble)
+			)
+		),
+		_mm_shuffle_epi8(
+			_mm_loadu_si128((const __m128i*)utf8_second_high),
+			_mm_and_si128(_mm_srli_epi16(in, 4), nibble)
+		)
+	);
+	/* Only bytes two after a three- or four-byte lead, or three after a
+	 * four-byte lead, reach 0x80 after these subtractions. */
+	__m128i third = _mm_subs_epu8(_mm_alignr_epi8(in, prev, 14), _mm_set1_epi8(0xE0 - 0x80));
+	__m128i fourth = _mm_subs_epu8(_mm_alignr_epi8(in, prev, 13), _mm_set1_epi8(0xF0 - 0x80));
+	__m128i must = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8((char)0x80));
+	return _mm_xor_si128(must, special);
+}
+
+/**
+ * INTERNAL: SSSE3 UTF-8 validator, 16 bytes per step. Blocks of ASCII only
+ * check that the block before did not end inside a sequence.
+ */
+WYZYRDRY_TARGET("ssse3")
+static size_t utf8_validate_ssse3(const unsigned char* src, size_t len) {
+	const __m128i max = _mm_loadu_si128((const __m128i*)&utf8_incomplete[16]);
+	const __m128i zero = _mm_setzero_si128();
+	__m128i prev = zero;
+	__m128i incomplete = zero;
+	size_t idx = 0;
+	for (; idx + 16 <= len; idx += 16) {
+		__m128i in = _mm_loadu_si128((const __m128i*)&src[idx]);
+		__m128i err = incomplete;
+		if (_mm_movemask_epi8(in) != 0) {
+			err = utf8_check_ssse3(in, prev);
+			incomplete = _mm_subs_epu8(in, max);
+		}
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(err, zero)) != 0xFFFF) {
+			return utf8_validate_scalar(src, len, utf8_restart(src, idx));
+		}
+		prev = in;
+	}
+	/* The zeros after the end cut short any sequence still open. */
+	unsigned char last[16] = { 0 };
+	memcpy(last, &src[idx], len - idx);
+	__m128i err = utf8_check_ssse3(_mm_loadu_si128((const __m128i*)last), prev);
+	if (_mm_movemask_epi8(_mm_cmpeq_epi8(err, zero)) != 0xFFFF) {
+		return utf8_validate_scalar(src, len, utf8_restart(src, idx));
+	}
+	return len;
+}
+
+/**
+ * INTERNAL: The AVX2 form of `utf8_check_ssse3()`. The bytes before each lane
+ * come from across the lane boundary, so they are gathered with a permute
+ * before the per-lane byte alignment.
+ */
+WYZYRDRY_TARGET("avx2")
+static inline __m256i utf8_check_avx2(__m256i in, __m256i prev) {
+	const __m256i nibble = _mm256_set1_epi8(0x0F);
+	__m256i carry = _mm256_permute2x128_si256(prev, in, 0x21);
+	__m256i prev1 = _mm256_alignr_epi8(in, carry, 15);
+	__m256i special = _mm256_and_si256(
+		_mm256_and_si256(
+			_mm256_shuffle_epi8(
+				_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)utf8_first_high)),
+				_mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)
+			),
+			_mm256_shuffle_epi8(
+				_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)utf8_first_low)),
+				_mm256_and_si256(prev1, nibble)
+			)
+		),
+		_mm256_shuffle_epi8(
+			_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)utf8_second_high)),
+			_mm256_and_si256(_mm256_srli_epi16(in, 4), nibble)
+		)
+	);
+	__m256i third = _mm256_subs_epu8(_mm256_alignr_epi8(in, carry, 14), _mm256_set1_epi8(0xE0 - 0x80));
+	__m256i fourth = _mm256_subs_epu8(_mm256_alignr_epi8(in, carry, 13), _mm256_set1_epi8(0xF0 - 0x80));
+	__m256i must = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8((char)0x80));
+	return _mm256_xor_si256(must, special);
+}
+
+/**
+ * INTERNAL: AVX2 UTF-8 validator, 32 bytes per step.
+ */
+WYZYRDRY_TARGET("avx2")
+static size_t utf8_validate_avx2(const unsigned char* src, size_t len) {
+	const __m256i max = _mm256_loadu_si256((const __m256i*)utf8_incomplete);
+	__m256i prev = _mm256_setzero_si256();
+	__m256i incomplete = _mm256_setzero_si256();
+	size_t idx = 0;
+	for (; idx + 32 <= len; idx += 32) {
+		__m256i in = _mm256_loadu_si256((const __m256i*)&src[idx]);
+		__m256i err = incomplete;
+		if (_mm256_movemask_epi8(in) != 0) {
+			err = utf8_check_avx2(in, prev);
+			incomplete = _mm256_subs_epu8(in, max);
+		}
+		if (!_mm256_testz_si256(err, err)) {
+			return utf8_validate_scalar(src, len, utf8_restart(src, idx));
+		}
+		prev = in;
+	}
+	unsigned char last[32] = { 0 };
+	memcpy(last, &src[idx], len - idx);
+	__m256i err = utf8_check_avx2(_mm256_loadu_si256((const __m256i*)last), prev);
+	if (!_mm256_testz_si256(err, err)) {
+		return utf8_validate_scalar(src, len, utf8_restart(src, idx));
+	}
+	return len;
+}
+
+/**
+ * INTERNAL: SSE2 ASCII check, ORing 64 bytes together between tests of the
+ * top bits.
+ */
+WYZYRDRY_TARGET("sse2")
+static bool utf8_is_ascii_sse2(const unsigned char* src, size_t len) {
+	size_t idx = 0;
+	for (; idx + 64 <= len; idx += 64) {
+		__m128i acc = _mm_or_si128(
+			_mm_or_si128(
+				_mm_loadu_si128((const __m128i*)&src[idx]),
+				_mm_loadu_si128((const __m128i*)&src[idx + 16])
+			),
+			_mm_or_si128(
+				_mm_loadu_si128((const __m128i*)&src[idx + 32]),
+				_mm_loadu_si128((const __m128i*)&src[idx + 48])
+			)
+		);
+		if (_mm_movemask_epi8(acc) != 0) {
+			return false;
+		}
+	}
+	for (; idx + 16 <= len; idx += 16) {
+		if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)&src[idx])) != 0) {
+			return false;
+		}
+	}
+	return utf8_is_ascii_scalar(&src[idx], len - idx);
+}
+
+/**
+ * INTERNAL: AVX2 ASCII check, ORing 128 bytes together between tests.
+ */
+WYZYRDRY_TARGET("avx2")
+static bool utf8_is_ascii_avx2(const unsigned char* src, size_t len) {
+	size_t idx = 0;
+	for (; idx + 128 <= len; idx += 128) {
+		__m256i acc = _mm256_or_si256(
+			_mm256_or_si256(
+				_mm256_loadu_si256((const __m256i*)&src[idx]),
+				_mm256_loadu_si256((const __m256i*)&src[idx + 32])
+			),
+			_mm256_or_si256(
+				_mm256_loadu_si256((const __m256i*)&src[idx + 64]),
+				_mm256_loadu_si256((const __m256i*)&src[idx + 96])
+			)
+		);
+		if (_mm256_movemask_epi8(acc) != 0) {
+			return false;
+		}
+	}
+	for (; idx + 32 <= len; idx += 32) {
+		if (_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)&src[idx])) != 0) {
+			return false;
+		}
+	}
+	return utf8_is_ascii_scalar(&src[idx], len - idx);
+}
+
+/**
+ * INTERNAL: SSE2 code point counter. A byte starts a code point unless, as a
+ * signed value, it is -65 (0xBF) or less.
+ */
+WYZYRDRY_TARGET("sse2")
+static size_t utf8_count_sse2(const unsigned char* src, size_t len) {
+	const __m128i cont = _mm_set1_epi8(-65);
+	const __m128i zero = _mm_setzero_si128();
+	size_t ret = 0;
+	size_t idx = 0;
+	while (idx + 16 <= len) {
+		/* Each lane counts as a byte, so flush before it overflows. */
+		__m128i acc = zero;
+		for (int run = 0; run < 255 && idx + 16 <= len; ++run, idx += 16) {
+			__m128i blk = _mm_loadu_si128((const __m128i*)&src[idx]);
+			acc = _mm_sub_epi8(acc, _mm_cmpgt_epi8(blk, cont));
+		}
+		uint64_t lanes[2];
+		_mm_storeu_si128((__m128i*)lanes, _mm_sad_epu8(acc, zero));
+		ret += lanes[0] + lanes[1];
+	}
+	return ret + utf8_count_scalar(&src[idx], len - idx);
+}
+
+/**
+ * INTERNAL: AVX2 code point counter.
+ */
+WYZYRDRY_TARGET("avx2")
+static size_t utf8_count_avx2(const unsigned char* src, size_t len) {
+	const __m256i cont = _mm256_set1_epi8(-65);
+	const __m256i zero = _mm256_setzero_si256();
+	size_t ret = 0;
+	size_t idx = 0;
+	while (idx + 32 <= len) {
+		__m256i acc = zero;
+		for (int run = 0; run < 255 && idx + 32 <= len; ++run, idx += 32) {
+			__m256i blk = _mm256_loadu_si256((const __m256i*)&src[idx]);
+			acc = _mm256_sub_epi8(acc, _mm256_cmpgt_epi8(blk, cont));
+		}
+		uint64_t lanes[4];
+		_mm256_storeu_si256((__m256i*)lanes, _mm256_sad_epu8(acc, zero));
+		ret += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	}
+	return ret + utf8_count_scalar(&src[idx], len - idx);
+}
+
+#endif
@@ -5,6 +5,7 @@
 #include <wyzyrdry.h>
 
 void vec_realloc(Vec* self);
+static bool vec_remap(Vec* const self, size_t cap);
 
 /**
  * Initialize a Vec structure.
@@ -19,7 +20,7 @@ Vec vec_init(size_t capacity, size_t item_size) {
 		.cap = 0,
 	};
 	size_t total = capacity * item_size;
-	void* buf = malloc(total);
+	void* buf = INSTRUMENT_MALLOC("vec", total);
 	if (buf == NULL) {
 		return ret;
 	}
@@ -29,14 +30,42 @@ Vec vec_init(size_t capacity, size_t item_size) {
 	return ret;
 }
 
+/**
+ * Initialize a Vec whose buffer comes from `pages_alloc()`, for large buffers
+ * that want huge pages, a NUMA node, or no page faults as they fill.
+ * @param capacity The least starting capacity, in bytes. The buffer is rounded
+ * up to whole pages, all of which count toward the capacity.
+ * @param flags The `PagesFlag`s to ask for.
+ * @param node The NUMA node on which to place the buffer, or `PAGES_ANY_NODE`.
+ * @return A Vec structure. If allocation failed, buf will be NULL, but the Vec
+ * still takes pages when it grows.
+ */
+Vec vec_init_pages(size_t capacity, unsigned int flags, int node) {
+	unsigned int got = 0;
+	Slice pages = pages_alloc(capacity, flags, node, &got);
+	Vec ret = {
+		.buf = pages.ptr,
+		.len = 0,
+		.cap = pages.len,
+		.pages = got | PAGES_MAPPED | (flags & (PAGES_HUGE | PAGES_PREFAULT)),
+		.node = node,
+	};
+	return ret;
+}
+
 /**
  * Deallocate a Vec structure.
  *
- * This frees the buffer and sets len and cap to 0.
+ * This frees the buffer and sets len and cap to 0. A Vec of pages stays one.
  * @param self The Vec on which to act.
  */
 void vec_free(Vec* const self) {
-	free(self->buf);
+	if (self->pages != 0) {
+		pages_free(slice_new(self->buf, self->cap));
+	}
+	else {
+		INSTRUMENT_FREE("vec", self->buf);
+	}
 	self->buf = NULL;
 	self->len = 0;
 	self->cap = 0;
@@ -70,27 +99,58 @@ void vec_push_byte(Vec* const self, unsigned char byte) {
  * @param slice The Slice to be appended into the Vec.
  */
 void vec_push_slice(Vec* const self, const Slice slice) {
-	for (size_t idx = 0; idx < slice.len; ++idx) {
-		vec_push_byte(self, slice.ptr[idx]);
+	if (slice.len == 0 || !vec_reserve(self, slice.len)) {
+		return;
 	}
+	INSTRUMENT_COPY("vec", &self->buf[self->len], slice.ptr, slice.len);
+	self->len += slice.len;
 }
 
 /**
- * Trims the Vec's capacity to exactly match its current length.
+ * Ensure that the Vec can receive some number of bytes without reallocating.
+ *
+ * The capacity at least doubles when it grows, so repeated reservations remain
+ * amortized constant time per byte. If reallocation fails, the Vec is left
+ * unchanged.
  * @param self The Vec on which to act.
+ * @param additional The number of bytes past the current length to make room
+ * for.
+ * @return true if the Vec has room for `additional` more bytes.
  */
-void vec_trim(Vec* const self) {
-	self->buf = realloc(self->buf, self->len);
-	self->cap = self->len;
+bool vec_reserve(Vec* const self, size_t additional) {
+	if (self->cap - self->len >= additional) {
+		return true;
+	}
+	size_t newcap = 2 * self->cap;
+	if (newcap < self->len + additional) {
+		newcap = self->len + additional;
+	}
+	if (self->pages != 0) {
+		return vec_remap(self, newcap);
+	}
+	unsigned char* buf = INSTRUMENT_REALLOC("vec", self->buf, newcap);
+	if (buf == NULL) {
+		return false;
+	}
+	self->buf = buf;
+	self->cap = newcap;
+	return true;
 }
 
 /**
- * Gets a reference to the interior contents of the Vec.
+ * Trims the Vec's capacity to exactly match its current length.
  * @param self The Vec on which to act.
- * @return A Slice (pointer and length) of the Vec's contents.
  */
-Slice vec_as_slice(const Vec* const self) {
-	return slice_new(self->buf, self->len);
+void vec_trim(Vec* const self) {
+	/* A Vec of pages keeps whole pages, so it moves only to shed some. */
+	if (self->pages != 0) {
+		if (pages_round(self->len, self->pages) < self->cap) {
+			vec_remap(self, self->len);
+		}
+		return;
+	}
+	self->buf = INSTRUMENT_REALLOC("vec", self->buf, self->len);
+	self->cap = self->len;
 }
 
 /**
@@ -98,14 +158,8 @@ Slice vec_as_slice(const Vec* const self) {
  * @param self The Vec on which to act.
  */
 void vec_debug_print(const Vec* const self) {
-	printf("Vec { buf: %p, len: %zu, cap: %zu }\nBuf: ", self->buf, self->len, self->cap);
-	for (size_t idx = 0; idx < self->len; ++idx) {
-		printf("%02X ", self->buf[idx]);
-	}
-	for (size_t idx = self->len; idx < self->cap; ++idx) {
-		printf("__ ");
-	}
-	printf("\n");
+	printf("Vec { buf: %p, len: %zu, cap: %zu }\n", self->buf, self->len, self->cap);
+	hex_print(vec_as_slice(self));
 }
 
 /**
@@ -116,6 +170,34 @@ void vec_debug_print(const Vec* const self) {
  */
 void vec_realloc(Vec* self) {
 	size_t newcap = 2 * self->cap;
-	self->buf = (unsigned char*)realloc(self->buf, newcap);
+	if (self->pages != 0) {
+		if (!vec_remap(self, newcap)) {
+			pages_free(slice_new(self->buf, self->cap));
+			self->buf = NULL;
+		}
+		return;
+	}
+	self->buf = (unsigned char*)INSTRUMENT_REALLOC("vec", self->buf, newcap);
 	self->cap = newcap;
 }
+
+/**
+ * INTERNAL: Move a Vec of pages into a new store from `pages_alloc()`.
+ * @param self The Vec on which to act.
+ * @param cap The least capacity of the new store, no less than the length.
+ * @return true if the Vec moved, or false if allocation failed, in which case
+ * the Vec is unchanged.
+ */
+static bool vec_remap(Vec* const self, size_t cap) {
+	Slice pages = pages_alloc(cap, self->pages, self->node, NULL);
+	if (pages.ptr == NULL) {
+		return false;
+	}
+	if (self->len > 0) {
+		INSTRUMENT_COPY("vec", pages.ptr, self->buf, self->len);
+	}
+	pages_free(slice_new(self->buf, self->cap));
+	self->buf = pages.ptr;
+	self->cap = pages.len;
+	return true;
+}
@@ -8,22 +8,10 @@
 #include <wyzyrdry.h>
 
 /**
- * Print out a Slice with its printable characters as ASCII and unprintable as
- * hexadecimal.
+ * Print out a Slice to stdout as an `xxd`-style dump, with offsets, hexadecimal,
+ * and printable characters as ASCII.
  * @param item The Slice to print out.
  */
 void hex_print(Slice item) {
-	for (size_t idx = 0; idx < item.len; ++idx) {
-		printf("%02X ", item.ptr[idx]);
-	}
-	for (size_t idx = 0; idx < item.len; ++idx) {
-		unsigned char c = item.ptr[idx];
-		if (c >= ' ') {
-			printf("%c", c);
-		}
-		else {
-			printf(".");
-		}
-	}
-	printf("\n");
+	hex_dump(stdout, item, 0);
 }
@@ -0,0 +1,47 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+void test_arena(void) {
+	Arena arena = arena_init();
+	ArenaRef small = arena_alloc(&arena, 10);
+	ArenaRef mid = arena_alloc(&arena, 1000);
+	ArenaRef big = arena_alloc(&arena, ARENA_CHUNK);
+	ArenaRef huge = arena_alloc(&arena, ARENA_CHUNK + 1);
+	printf("\nExpectation: Blocks come from the classes of 64, 1024, and 65536 bytes; too large fails.\n");
+	printf("Classes: %u, %u, %u, lengths: %u, %u, %u, too large: %d, live: %zu\n",
+		small.cls, mid.cls, big.cls,
+		small.len, mid.len, big.len,
+		huge.ptr == NULL,
+		arena.live
+	);
+
+	memset(small.ptr, 0x41, small.len);
+	Slice view = arena_as_slice(small);
+	unsigned char* first = small.ptr;
+	arena_release(&arena, small);
+	ArenaRef again = arena_alloc(&arena, 50);
+	printf("\nExpectation: A released block is the next one handed out in its class.\n");
+	printf("View: %zu bytes, reused: %d\n", view.len, again.ptr == first);
+
+	size_t chunks = arena.chunks.len / sizeof(unsigned char*);
+	ArenaRef refs[100];
+	for (size_t rep = 0; rep < 10; ++rep) {
+		for (size_t idx = 0; idx < 100; ++idx) {
+			refs[idx] = arena_alloc(&arena, 500);
+		}
+		for (size_t idx = 0; idx < 100; ++idx) {
+			arena_release(&arena, refs[idx]);
+		}
+	}
+	printf("\nExpectation: Cycling 100 blocks of 512 bytes ten times takes one more chunk, once.\n");
+	printf("New chunks: %zu, live: %zu\n",
+		arena.chunks.len / sizeof(unsigned char*) - chunks,
+		arena.live
+	);
+	arena_release(&arena, again);
+	arena_release(&arena, mid);
+	arena_release(&arena, big);
+	arena_free(&arena);
+}
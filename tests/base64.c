@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+void test_base64(void) {
+	const char* vectors[7] = { "", "f", "fo", "foo", "foob", "fooba", "foobar" };
+	printf("\nExpectation: The RFC 4648 vectors, padded: \"\" Zg== Zm8= Zm9v Zm9vYg== Zm9vYmE= Zm9vYmFy\n");
+	Vec text = vec_init(8, 1);
+	for (size_t idx = 0; idx < 7; ++idx) {
+		text.len = 0;
+		base64_encode(&text, slice_new((unsigned char*)vectors[idx], strlen(vectors[idx])), BASE64_STANDARD);
+		printf("\"%.*s\" ", (int)text.len, text.buf);
+	}
+	printf("\n");
+
+	unsigned char symbols[3] = { 0xFB, 0xEF, 0xFF };
+	printf("\nExpectation: Bytes FB EF FF encode as \"++//\" and \"--__\", and FB alone as \"+w==\" and \"-w\".\n");
+	Vec url = vec_init(8, 1);
+	text.len = 0;
+	base64_encode(&text, slice_new(symbols, 3), BASE64_STANDARD);
+	base64_encode(&url, slice_new(symbols, 3), BASE64_URL);
+	printf("\"%.*s\" \"%.*s\" ", (int)text.len, text.buf, (int)url.len, url.buf);
+	text.len = 0;
+	url.len = 0;
+	base64_encode(&text, slice_new(symbols, 1), BASE64_STANDARD);
+	base64_encode(&url, slice_new(symbols, 1), BASE64_URL);
+	printf("\"%.*s\" \"%.*s\"\n", (int)text.len, text.buf, (int)url.len, url.buf);
+
+	unsigned char bytes[1000];
+	for (size_t idx = 0; idx < sizeof(bytes); ++idx) {
+		bytes[idx] = (unsigned char)(idx * 167 + 13);
+	}
+	printf("\nExpectation: Every kernel encodes and decodes every length up to 1000 as the portable code does, in both alphabets.\n");
+	unsigned int old = cpu_restrict(0);
+	unsigned int levels[3] = { 0, CPU_SSE2 | CPU_SSSE3, CPU_SSE2 | CPU_SSSE3 | CPU_AVX2 };
+	Vec reference = vec_init(1400, 1);
+	Vec other = vec_init(1400, 1);
+	Vec back = vec_init(1000, 1);
+	for (size_t lvl = 0; lvl < 3; ++lvl) {
+		size_t same = 0;
+		for (size_t alpha = 0; alpha < 2; ++alpha) {
+			for (size_t len = 0; len <= sizeof(bytes); ++len) {
+				Slice src = slice_new(bytes, len);
+				reference.len = 0;
+				other.len = 0;
+				back.len = 0;
+				cpu_restrict(0);
+				base64_encode(&reference, src, (Base64Alphabet)alpha);
+				cpu_restrict(levels[lvl]);
+				base64_encode(&other, src, (Base64Alphabet)alpha);
+				Base64Result res = base64_decode(&back, vec_as_slice(&other), (Base64Alphabet)alpha);
+				same += slice_eq(vec_as_slice(&other), vec_as_slice(&reference))
+					&& other.len == base64_encoded_len(len, (Base64Alphabet)alpha)
+					&& GET_VARIANT_TYPE(res) == ENUM_VAR(Base64Result, Ok)
+					&& slice_eq(vec_as_slice(&back), src);
+			}
+		}
+		printf("Level %#x matches: %zu of 2002\n", levels[lvl], same);
+	}
+
+	text.len = 0;
+	base64_encode(&text, slice_new(bytes, 300), BASE64_STANDARD);
+	text.buf[217] = '-';
+	printf("\nExpectation: A bad character at index 217 of 400 is reported by every kernel, and the Vec stays empty.\n");
+	for (size_t lvl = 0; lvl < 3; ++lvl) {
+		cpu_restrict(levels[lvl]);
+		back.len = 0;
+		Base64Result res = base64_decode(&back, vec_as_slice(&text), BASE64_STANDARD);
+		printf("Level %#x: Err: %d, index: %zu, len: %zu\n",
+			levels[lvl],
+			GET_VARIANT_TYPE(res) == ENUM_VAR(Base64Result, Err),
+			GET_VARIANT_BODY(res, Err),
+			back.len
+		);
+	}
+
+	printf("\nExpectation: Every kernel accepts exactly the 64 characters of each alphabet.\n");
+	unsigned char probe[64];
+	for (size_t lvl = 0; lvl < 3; ++lvl) {
+		cpu_restrict(levels[lvl]);
+		size_t accepted[2] = { 0, 0 };
+		for (size_t alpha = 0; alpha < 2; ++alpha) {
+			for (size_t chr = 0; chr < 256; ++chr) {
+				memset(probe, 'A', sizeof(probe));
+				probe[37] = (unsigned char)chr;
+				back.len = 0;
+				Base64Result res = base64_decode(&back, slice_new(probe, sizeof(probe)), (Base64Alphabet)alpha);
+				accepted[alpha] += GET_VARIANT_TYPE(res) == ENUM_VAR(Base64Result, Ok);
+			}
+		}
+		printf("Level %#x accepts: %zu standard, %zu url\n", levels[lvl], accepted[0], accepted[1]);
+	}
+	cpu_restrict(old);
+
+	const char* cases[6] = { "Zg", "Zm8=", "Zh==", "Zg=", "Z===", "Zm9vY" };
+	printf("\nExpectation: Unpadded text decodes; \"Zh==\" has stray low bits at 1, \"Zg=\" pads short at 2, \"Z===\" fails at 1, and a lone final character at 4.\n");
+	for (size_t idx = 0; idx < 6; ++idx) {
+		back.len = 0;
+		Base64Result res = base64_decode(&back, slice_new((unsigned char*)cases[idx], strlen(cases[idx])), BASE64_STANDARD);
+		if (GET_VARIANT_TYPE(res) == ENUM_VAR(Base64Result, Ok)) {
+			printf("%s: Ok \"%.*s\"\n", cases[idx], (int)back.len, back.buf);
+		}
+		else {
+			printf("%s: Err %zu\n", cases[idx], GET_VARIANT_BODY(res, Err));
+		}
+	}
+
+	unsigned char small[4];
+	Base64Result res = base64_decode_into(slice_new(small, 4), slice_new((unsigned char*)"Zm9vYmFy", 8), BASE64_URL);
+	printf("\nExpectation: Six bytes do not fit in four; the group at index 4 is reported.\n");
+	printf("Err: %d, index: %zu\n",
+		GET_VARIANT_TYPE(res) == ENUM_VAR(Base64Result, Err),
+		GET_VARIANT_BODY(res, Err)
+	);
+
+	vec_free(&back);
+	vec_free(&other);
+	vec_free(&reference);
+	vec_free(&url);
+	vec_free(&text);
+}
@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+/**
+ * Check that a reader's next message is "message N", and move past it.
+ */
+static bool read_expected(Broadcast* bc, size_t id, size_t num) {
+	char text[32];
+	int len = snprintf(text, sizeof(text), "message %zu", num);
+	Slice parts[2];
+	if (!broadcast_peek(bc, id, parts) || parts[0].len + parts[1].len != (size_t)len) {
+		return false;
+	}
+	bool same = memcmp(parts[0].ptr, text, parts[0].len) == 0
+		&& (parts[1].len == 0 || memcmp(parts[1].ptr, &text[parts[0].len], parts[1].len) == 0);
+	broadcast_pop(bc, id);
+	return same;
+}
+
+static void write_numbered(Broadcast* bc, size_t num) {
+	char text[32];
+	int len = snprintf(text, sizeof(text), "message %zu", num);
+	broadcast_write_slice(bc, slice_new((unsigned char*)text, (size_t)len));
+}
+
+void test_broadcast(void) {
+	RingBuf ring = ringbuf_init(slice_new(malloc(256), 256));
+	Broadcast bc = broadcast_init(&ring, BROADCAST_WAIT);
+	size_t ids[3];
+	for (size_t idx = 0; idx < 3; ++idx) {
+		ids[idx] = broadcast_add(&bc);
+	}
+	for (size_t num = 0; num < 5; ++num) {
+		write_numbered(&bc, num);
+	}
+	Slice first[2];
+	Slice second[2];
+	broadcast_peek(&bc, ids[0], first);
+	broadcast_peek(&bc, ids[2], second);
+	printf("\nExpectation: Three readers see each of 5 messages at the same place in the one ring.\n");
+	printf("Ids: %zu %zu %zu, ring count: %zu, pending: %zu, same place: %d\n",
+		ids[0],
+		ids[1],
+		ids[2],
+		ring.count,
+		broadcast_pending(&bc, ids[1]),
+		first[0].ptr == second[0].ptr
+	);
+
+	size_t in_order = 0;
+	for (size_t num = 0; num < 5; ++num) {
+		in_order += read_expected(&bc, ids[0], num);
+	}
+	for (size_t num = 0; num < 2; ++num) {
+		in_order += read_expected(&bc, ids[1], num);
+	}
+	size_t held = ring.count;
+	for (size_t num = 0; num < 3; ++num) {
+		in_order += read_expected(&bc, ids[2], num);
+	}
+	printf("\nExpectation: Messages stay until the slowest reader passes them: 5 held, then 3.\n");
+	printf("In order: %zu of 10, held: %zu, then: %zu\n", in_order, held, ring.count);
+
+	broadcast_remove(&bc, ids[1]);
+	size_t late = broadcast_add(&bc);
+	write_numbered(&bc, 5);
+	held = ring.count;
+	size_t pending = broadcast_pending(&bc, late);
+	printf("\nExpectation: Removing the slowest reader frees one message; a new reader, 3, sees only the next.\n");
+	printf("Ring count: %zu, new reader: %zu, pending: %zu, first: %d\n",
+		held,
+		late,
+		pending,
+		read_expected(&bc, late, 5)
+	);
+	broadcast_free(&bc);
+	ringbuf_free(&ring);
+
+	/* 10-byte messages take 12 bytes each, so 64 bytes hold five. */
+	ring = ringbuf_init(slice_new(malloc(64), 64));
+	bc = broadcast_init(&ring, BROADCAST_WAIT);
+	size_t fast = broadcast_add(&bc);
+	size_t slow = broadcast_add(&bc);
+	size_t written = 0;
+	for (size_t num = 10; num < 20; ++num) {
+		char text[32];
+		int len = snprintf(text, sizeof(text), "message %zu", num);
+		written += broadcast_write_slice(&bc, slice_new((unsigned char*)text, (size_t)len)) > 0;
+		read_expected(&bc, fast, num);
+	}
+	printf("\nExpectation: A waiting producer is held back by the slow reader after 5 messages.\n");
+	printf("Written: %zu, slow pending: %zu, missed: %zu\n",
+		written,
+		broadcast_pending(&bc, slow),
+		broadcast_missed(&bc, slow)
+	);
+	broadcast_free(&bc);
+	ringbuf_wipe(&ring);
+
+	bc = broadcast_init(&ring, BROADCAST_DROP);
+	fast = broadcast_add(&bc);
+	slow = broadcast_add(&bc);
+	in_order = 0;
+	for (size_t num = 10; num < 20; ++num) {
+		write_numbered(&bc, num);
+		in_order += read_expected(&bc, fast, num);
+	}
+	pending = broadcast_pending(&bc, slow);
+	size_t missed = broadcast_missed(&bc, slow);
+	bool resumed = read_expected(&bc, slow, 15);
+	printf("\nExpectation: A dropping producer moves the slow reader past 5 messages; it resumes at message 15.\n");
+	printf("Fast in order: %zu of 10, slow pending: %zu, missed: %zu, resumed: %d\n",
+		in_order,
+		pending,
+		missed,
+		resumed
+	);
+	broadcast_free(&bc);
+	ringbuf_free(&ring);
+
+	/* A growing ring moves its messages, and readers keep their places. */
+	ring = ringbuf_init(slice_new(malloc(48), 48));
+	ringbuf_set_growth(&ring, 2, 4096);
+	bc = broadcast_init(&ring, BROADCAST_WAIT);
+	fast = broadcast_add(&bc);
+	slow = broadcast_add(&bc);
+	size_t next_fast = 0;
+	size_t next_slow = 0;
+	in_order = 0;
+	for (size_t num = 0; num < 300; ++num) {
+		write_numbered(&bc, num);
+		in_order += read_expected(&bc, fast, next_fast++);
+		/* The slow reader reads in bursts, letting the ring grow and shrink. */
+		if (num % 50 == 49) {
+			while (broadcast_pending(&bc, slow) > 0) {
+				in_order += read_expected(&bc, slow, next_slow++);
+			}
+		}
+	}
+	printf("\nExpectation: Through a ring that grows and wraps, both readers see all 300 messages in order.\n");
+	printf("In order: %zu of 600, ring count: %zu\n", in_order, ring.count);
+	broadcast_free(&bc);
+	ringbuf_free(&ring);
+}
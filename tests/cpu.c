@@ -0,0 +1,24 @@
+#include <stdio.h>
+#include <wyzyrdry.h>
+
+void test_cpu(void) {
+	printf("\nExpectation: The detected extensions of this processor.\n");
+	printf(
+		"SSE2: %d, SSSE3: %d, SSE4.2: %d, PCLMUL: %d, AVX2: %d, AVX-512BW: %d, BMI2: %d, AVX-512VBMI: %d\n",
+		cpu_has(CPU_SSE2),
+		cpu_has(CPU_SSSE3),
+		cpu_has(CPU_SSE42),
+		cpu_has(CPU_PCLMUL),
+		cpu_has(CPU_AVX2),
+		cpu_has(CPU_AVX512BW),
+		cpu_has(CPU_BMI2),
+		cpu_has(CPU_AVX512VBMI)
+	);
+
+	unsigned int old = cpu_restrict(CPU_SSE2);
+	printf("\nExpectation: Restricted to at most SSE2; AVX2 is unavailable.\n");
+	printf("Features: %#x, AVX2: %d\n", cpu_features(), cpu_has(CPU_AVX2));
+	cpu_restrict(old);
+	printf("\nExpectation: Restriction lifted.\n");
+	printf("Features: %#x\n", cpu_features());
+}
@@ -7,9 +7,41 @@ typedef struct EnumTestObj {
 } EnumTestObj;
 
 ENUM(EnumTest, char*, One, int, Two, EnumTestObj, Three);
+ENUM_PACKED(EnumTestPacked, char*, One, int, Two, EnumTestObj, Three);
+ENUM_WIDTH(EnumTestWide, uint16_t, int, One, int, Two);
+
+/* Twenty variants, past the old limit of thirteen. */
+ENUM(EnumTestMany,
+	int, V1, int, V2, int, V3, int, V4, int, V5,
+	int, V6, int, V7, int, V8, int, V9, int, V10,
+	int, V11, int, V12, int, V13, int, V14, int, V15,
+	int, V16, int, V17, int, V18, int, V19, int, V20
+);
 
 EnumTest var = SET_VARIANT(EnumTest, One, "Hello, world!");
 
 void test_enum() {
 	printf("%s\n", GET_VARIANT_BODY(var, One));
+
+	printf("\nExpectation: The packed layouts are the size of the union plus their tag.\n");
+	printf("ENUM: %zu, ENUM_PACKED: %zu, ENUM_WIDTH(uint16_t): %zu\n",
+		sizeof(EnumTest),
+		sizeof(EnumTestPacked),
+		sizeof(EnumTestWide)
+	);
+
+	EnumTestPacked packed = SET_VARIANT(EnumTestPacked, Three, ((EnumTestObj){ .a = 3, .b = 4 }));
+	EnumTestObj obj = EnumTestPacked_as_Three(packed);
+	printf("\nExpectation: The helpers read the tag and body of a packed value.\n");
+	printf("is One: %d, is Three: %d, tag is Three: %d, body: %d %d\n",
+		EnumTestPacked_is_One(packed),
+		EnumTestPacked_is_Three(packed),
+		EnumTestPacked_tag(packed) == EnumTestPacked_Three,
+		obj.a,
+		obj.b
+	);
+
+	EnumTestMany many = SET_VARIANT(EnumTestMany, V20, 20);
+	printf("\nExpectation: The twentieth variant has tag 19 and body 20.\n");
+	printf("tag: %d, body: %d\n", (int)GET_VARIANT_TYPE(many), EnumTestMany_as_V20(many));
 }
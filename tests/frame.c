@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+/**
+ * Decode a stream fed in pieces of one size, and fold every payload into one
+ * value so that different piece sizes can be compared.
+ */
+static uint64_t digest_frames(const Slice stream, size_t step, size_t* count) {
+	FrameDecoder d = frame_decoder_init(1024);
+	Hasher h = hasher_init(0);
+	*count = 0;
+	for (size_t idx = 0; idx < stream.len; idx += step) {
+		size_t len = stream.len - idx < step ? stream.len - idx : step;
+		frame_decoder_feed(&d, slice_new(&stream.ptr[idx], len));
+		FrameResult res = frame_decoder_next(&d);
+		while (GET_VARIANT_TYPE(res) == ENUM_VAR(FrameResult, Frame)) {
+			Slice frame = GET_VARIANT_BODY(res, Frame);
+			hasher_update(&h, frame);
+			hasher_update(&h, slice_new((unsigned char*)&frame.len, sizeof(frame.len)));
+			++*count;
+			res = frame_decoder_next(&d);
+		}
+	}
+	frame_decoder_free(&d);
+	return hasher_finish(&h);
+}
+
+void test_frame(void) {
+	unsigned char wire[2];
+	str_len_to_wire(wire, 0x0102);
+	printf("\nExpectation: A length of 0x0102 goes on the wire as 01 02, and reads back.\n");
+	printf("Wire: %02X %02X, back: %#x\n", wire[0], wire[1], str_len_from_wire(wire));
+
+	Vec stream = vec_init(64, 1);
+	frame_encode(&stream, slice_new((unsigned char*)"Saluton", 7));
+	frame_encode(&stream, slice_new(NULL, 0));
+	frame_encode(&stream, slice_new((unsigned char*)"mondo!", 6));
+	printf("\nExpectation: Three frames of 7, 0, and 6 bytes, each after a big-endian length.\n");
+	vec_debug_print(&stream);
+
+	FrameDecoder d = frame_decoder_init(1024);
+	frame_decoder_feed(&d, vec_as_slice(&stream));
+	printf("\nExpectation: One pass over the buffer yields all three in place, then wants 2 bytes.\n");
+	FrameResult res = frame_decoder_next(&d);
+	while (GET_VARIANT_TYPE(res) == ENUM_VAR(FrameResult, Frame)) {
+		Slice frame = GET_VARIANT_BODY(res, Frame);
+		int in_place = frame.ptr >= stream.buf && frame.ptr <= stream.buf + stream.len;
+		printf("\"%.*s\" (%s) ", (int)frame.len, frame.ptr, in_place ? "in place" : "copied");
+		res = frame_decoder_next(&d);
+	}
+	printf("\nMore: %zu\n", GET_VARIANT_BODY(res, More));
+
+	size_t count = 0;
+	Vec big = vec_init(64, 1);
+	unsigned char payload[300];
+	for (size_t idx = 0; idx < 200; ++idx) {
+		memset(payload, (int)idx, sizeof(payload));
+		frame_encode(&big, slice_new(payload, idx * 7 % 300));
+	}
+	uint64_t whole = digest_frames(vec_as_slice(&big), big.len, &count);
+	size_t agree = 0;
+	size_t steps[4] = { 1, 3, 257, 1500 };
+	for (size_t idx = 0; idx < 4; ++idx) {
+		size_t pieces = 0;
+		agree += digest_frames(vec_as_slice(&big), steps[idx], &pieces) == whole && pieces == count;
+	}
+	printf("\nExpectation: 200 frames, decoded identically from pieces of 1, 3, 257, and 1500 bytes.\n");
+	printf("Frames: %zu, agree: %zu of 4\n", count, agree);
+
+	FrameDecoder small = frame_decoder_init(100);
+	frame_decoder_feed(&small, vec_as_slice(&big));
+	size_t before = 0;
+	res = frame_decoder_next(&small);
+	while (GET_VARIANT_TYPE(res) == ENUM_VAR(FrameResult, Frame)) {
+		++before;
+		res = frame_decoder_next(&small);
+	}
+	printf("\nExpectation: A 100-byte limit passes 15 frames, then rejects one of 105 bytes, and keeps rejecting.\n");
+	printf("Frames: %zu, too large: %zu, still: %d\n",
+		before,
+		GET_VARIANT_BODY(res, TooLarge),
+		GET_VARIANT_TYPE(frame_decoder_next(&small)) == ENUM_VAR(FrameResult, TooLarge)
+	);
+	frame_decoder_free(&small);
+
+	size_t sz = 16;
+	RingBuf rb = ringbuf_init(slice_new(malloc(sz), sz));
+	frame_decoder_reset(&d);
+	frame_decoder_feed(&d, vec_as_slice(&stream));
+	res = frame_decoder_into_ringbuf(&d, &rb);
+	printf("\nExpectation: Two frames fit in a 16-byte RingBuf; the third, of 6 bytes, waits.\n");
+	printf("Messages: %zu, full: %d, waiting: %zu\n",
+		rb.count,
+		GET_VARIANT_TYPE(res) == ENUM_VAR(FrameResult, Full),
+		GET_VARIANT_BODY(res, Full)
+	);
+	ringbuf_pop(&rb);
+	res = frame_decoder_into_ringbuf(&d, &rb);
+	unsigned char out[16];
+	ringbuf_pop(&rb);
+	StrLen got = ringbuf_read(&rb, slice_new(out, sizeof(out)));
+	printf("\nExpectation: After a pop the waiting frame is delivered, and the input is used up.\n");
+	printf("More: %d, delivered: \"%.*s\"\n",
+		GET_VARIANT_TYPE(res) == ENUM_VAR(FrameResult, More),
+		(int)got,
+		out
+	);
+
+	Hist* hist = malloc(sizeof(Hist));
+	hist_init(hist);
+	ringbuf_set_latency(&rb, hist);
+	Vec stamped = vec_init(16, 1);
+	frame_encode(&stamped, slice_new((unsigned char*)"0123456789", 10));
+	frame_decoder_reset(&d);
+	frame_decoder_feed(&d, vec_as_slice(&stamped));
+	res = frame_decoder_into_ringbuf(&d, &rb);
+	printf("\nExpectation: A 10-byte frame and its stamp do not fit in the 16-byte RingBuf, and wait.\n");
+	printf("Messages: %zu, full: %d\n",
+		rb.count,
+		GET_VARIANT_TYPE(res) == ENUM_VAR(FrameResult, Full)
+	);
+	vec_free(&stamped);
+	free(hist);
+
+	ringbuf_free(&rb);
+	frame_decoder_free(&d);
+	vec_free(&big);
+	vec_free(&stream);
+}
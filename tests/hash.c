@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+/**
+ * Checksum a buffer at many lengths with the currently permitted kernels, and
+ * fold the results together so that kernels can be compared by one number.
+ */
+static uint32_t crc_of_lengths(const unsigned char* buf, size_t len) {
+	uint32_t ret = 0;
+	for (size_t idx = 0; idx <= len; idx += 1 + idx / 3) {
+		ret ^= hash_crc32c(0, slice_new((unsigned char*)&buf[idx % 7], idx - idx % 7)) + (uint32_t)idx;
+	}
+	return ret;
+}
+
+void test_hash(void) {
+	Slice check = slice_new((unsigned char*)"123456789", 9);
+	printf("\nExpectation: The CRC-32C check value is E3069283.\n");
+	printf("CRC-32C: %08X\n", hash_crc32c(0, check));
+
+	printf("\nExpectation: Checksumming in pieces gives the same value.\n");
+	uint32_t crc = hash_crc32c(0, slice_new(check.ptr, 4));
+	printf("CRC-32C: %08X\n", hash_crc32c(crc, slice_new(&check.ptr[4], 5)));
+
+	printf("\nExpectation: Combining separately computed pieces gives the same value.\n");
+	printf("CRC-32C: %08X\n", hash_crc32c_combine(
+		hash_crc32c(0, slice_new(check.ptr, 4)),
+		hash_crc32c(0, slice_new(&check.ptr[4], 5)),
+		5
+	));
+
+	printf("\nExpectation: XXH64 of \"\" is EF46DB3751D8E999, and of \"abc\" is 44BC2CF5AD770999.\n");
+	printf("XXH64: %016llX, %016llX\n",
+		(unsigned long long)hash_xxh64(slice_new(NULL, 0), 0),
+		(unsigned long long)hash_xxh64(slice_new((unsigned char*)"abc", 3), 0)
+	);
+
+	size_t len = 100000;
+	unsigned char* buf = malloc(len);
+	for (size_t idx = 0; idx < len; ++idx) {
+		buf[idx] = (unsigned char)(idx * 2654435761u >> 13);
+	}
+
+	printf("\nExpectation: Every CRC kernel agrees at every length.\n");
+	unsigned int old = cpu_restrict(0);
+	uint32_t reference = crc_of_lengths(buf, len);
+	cpu_restrict(CPU_SSE2 | CPU_SSE42);
+	printf("SSE4.2 matches: %d\n", crc_of_lengths(buf, len) == reference);
+	cpu_restrict(old);
+	printf("PCLMUL matches: %d\n", crc_of_lengths(buf, len) == reference);
+
+	printf("\nExpectation: Hashing in uneven pieces matches hashing all at once.\n");
+	Slice all = slice_new(buf, 1000);
+	Hasher h = hasher_init(42);
+	for (size_t idx = 0, step = 1; idx < all.len; idx += step, step = step * 3 % 71) {
+		size_t end = idx + step < all.len ? idx + step : all.len;
+		hasher_update(&h, slice_new(&buf[idx], end - idx));
+	}
+	printf("Matches: %d\n", hasher_finish(&h) == hash_xxh64(all, 42));
+
+	Str* str = str_from_slice(check);
+	printf("\nExpectation: The checksum of a Str covers only its payload, E3069283.\n");
+	printf("str_checksum: %08X\n", str_checksum(str));
+
+	size_t sz = 20;
+	RingBuf rb = ringbuf_init(slice_new(malloc(sz), sz));
+	ringbuf_write_slice(&rb, slice_new((unsigned char*)"xxxxx", 5));
+	ringbuf_write_slice(&rb, slice_new((unsigned char*)"yyyyy", 5));
+	ringbuf_pop(&rb);
+	ringbuf_write_str(&rb, str);
+	ringbuf_pop(&rb);
+	Slice parts[2];
+	StrLen msglen = ringbuf_peek_slices(&rb, parts);
+	printf("\nExpectation: A message that wraps is seen in two parts, and checksums to E3069283.\n");
+	printf("Length: %zu, parts: %zu + %zu, checksum: %08X, hash matches: %d\n",
+		(size_t)msglen,
+		parts[0].len,
+		parts[1].len,
+		ringbuf_peek_checksum(&rb),
+		ringbuf_peek_hash(&rb, 7) == hash_xxh64(check, 7)
+	);
+
+	ringbuf_free(&rb);
+	str_free(str);
+	free(buf);
+}
@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+void test_hex(void) {
+	Slice greet = slice_new((unsigned char*)"Saluton, mondo!\n", 16);
+
+	Vec text = vec_init(8, 1);
+	hex_encode(&text, greet);
+	printf("\nExpectation: The greeting as 32 uppercase hex digits.\n");
+	printf("%.*s\n", (int)text.len, text.buf);
+
+	Vec back = vec_init(8, 1);
+	HexResult res = hex_decode(&back, vec_as_slice(&text));
+	printf("\nExpectation: Decoding succeeds with 16 bytes, and round-trips.\n");
+	printf("Ok: %d, bytes: %zu, equal: %d\n",
+		GET_VARIANT_TYPE(res) == ENUM_VAR(HexResult, Ok),
+		GET_VARIANT_BODY(res, Ok),
+		slice_eq(vec_as_slice(&back), greet)
+	);
+
+	res = hex_decode(&back, slice_new((unsigned char*)"0aFfZ0", 6));
+	printf("\nExpectation: Decoding fails at the 'Z', index 4, and the Vec keeps 16 bytes.\n");
+	printf("Err: %d, index: %zu, len: %zu\n",
+		GET_VARIANT_TYPE(res) == ENUM_VAR(HexResult, Err),
+		GET_VARIANT_BODY(res, Err),
+		back.len
+	);
+
+	res = hex_decode(&back, slice_new((unsigned char*)"abc", 3));
+	printf("\nExpectation: An odd-length input fails at its last character, index 2.\n");
+	printf("Err: %d, index: %zu\n",
+		GET_VARIANT_TYPE(res) == ENUM_VAR(HexResult, Err),
+		GET_VARIANT_BODY(res, Err)
+	);
+
+	unsigned char bytes[256];
+	for (size_t idx = 0; idx < sizeof(bytes); ++idx) {
+		bytes[idx] = (unsigned char)idx;
+	}
+	printf("\nExpectation: Every encoder produces the same text for all byte values.\n");
+	Vec reference = vec_init(512, 1);
+	unsigned int old = cpu_restrict(0);
+	hex_encode(&reference, slice_new(bytes, sizeof(bytes)));
+	unsigned int levels[] = { CPU_SSE2 | CPU_SSSE3, CPU_SSE2 | CPU_SSSE3 | CPU_AVX2 };
+	for (size_t idx = 0; idx < 2; ++idx) {
+		Vec other = vec_init(512, 1);
+		cpu_restrict(levels[idx]);
+		hex_encode(&other, slice_new(bytes, sizeof(bytes)));
+		printf("Level %#x matches: %d\n", levels[idx], slice_eq(vec_as_slice(&other), vec_as_slice(&reference)));
+		vec_free(&other);
+	}
+	cpu_restrict(old);
+
+	printf("\nExpectation: A three-line dump, with a short last line aligned to the others.\n");
+	hex_dump(stdout, slice_new(&bytes[0x1C], 40), 0x1C);
+
+	Vec dump = vec_init(64, 1);
+	hex_dump_vec(&dump, greet, 0);
+	printf("\nExpectation: The same dump of the greeting, formatted into a Vec.\n");
+	fwrite(dump.buf, 1, dump.len, stdout);
+
+	vec_free(&dump);
+	vec_free(&reference);
+	vec_free(&back);
+	vec_free(&text);
+}
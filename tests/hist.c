@@ -0,0 +1,48 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <wyzyrdry.h>
+
+void test_hist(void) {
+	Hist* hist = malloc(sizeof(Hist));
+	hist_init(hist);
+	printf("\nExpectation: An empty histogram reports zeroes.\n");
+	hist_debug_print(hist);
+
+	for (uint64_t val = 1; val <= 100; ++val) {
+		hist_record(hist, val);
+	}
+	printf("\nExpectation: Values 1 to 100 are counted exactly: p50 50, p99 99, max 100, mean 50.5.\n");
+	hist_debug_print(hist);
+
+	Hist* other = malloc(sizeof(Hist));
+	hist_init(other);
+	for (uint64_t val = 0; val < 100; ++val) {
+		hist_record(other, 1000000 + val * 1000);
+	}
+	printf("\nExpectation: Values from 1,000,000 to 1,099,000 are reported within 1.6%%.\n");
+	uint64_t p50 = hist_percentile(other, 50.0);
+	uint64_t p90 = hist_percentile(other, 90.0);
+	printf("p50: %llu (exact 1049000), p90: %llu (exact 1089000), within: %d\n",
+		(unsigned long long)p50,
+		(unsigned long long)p90,
+		p50 >= 1049000 && p50 <= 1049000 * 1.016 && p90 >= 1089000 && p90 <= 1089000 * 1.016
+	);
+
+	hist_merge(hist, other);
+	printf("\nExpectation: The merged histogram holds 200 values; p50 is 100 and p51 is in the millions.\n");
+	printf("total: %llu, p50: %llu, p51: %llu, min: %llu, max: %llu\n",
+		(unsigned long long)hist->total,
+		(unsigned long long)hist_percentile(hist, 50.0),
+		(unsigned long long)hist_percentile(hist, 51.0),
+		(unsigned long long)hist->min,
+		(unsigned long long)hist->max
+	);
+
+	hist_init(other);
+	hist_record(other, UINT64_MAX);
+	printf("\nExpectation: The largest possible value is counted and reported.\n");
+	printf("p50: %llu\n", (unsigned long long)hist_percentile(other, 50.0));
+
+	free(other);
+	free(hist);
+}
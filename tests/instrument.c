@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+#ifdef WYZYRDRY_INSTRUMENT
+
+static void count_events(
+	InstrumentEvent event,
+	const InstrumentSite* site,
+	const void* ptr,
+	size_t len,
+	void* ctx
+) {
+	size_t* counts = ctx;
+	++counts[event];
+}
+
+void test_instrument(void) {
+	InstrumentSnapshot snap;
+	instrument_reset();
+
+	Slice text = slice_new((unsigned char*)"Saluton, mondo! Saluton, mondo!\n", 32);
+	Vec vec = vec_init(16, 1);
+	vec_push_slice(&vec, text);
+	Str* str = str_from_slice(vec_as_slice(&vec));
+	str_free(str);
+	vec_free(&vec);
+
+	instrument_snapshot(&snap);
+	printf("\nExpectation: Two allocations, one reallocation, two frees, and two copies of 32 bytes.\n");
+	printf("allocs: %llu, reallocs: %llu, frees: %llu, copies: %llu, bytes copied: %llu\n",
+		(unsigned long long)snap.total.allocs,
+		(unsigned long long)snap.total.reallocs,
+		(unsigned long long)snap.total.frees,
+		(unsigned long long)snap.total.copies,
+		(unsigned long long)snap.total.bytes_copied
+	);
+
+	InstrumentCounts vec_counts = instrument_module(&snap, "vec");
+	InstrumentCounts str_counts = instrument_module(&snap, "str");
+	printf("\nExpectation: The Vec reallocated and copied once; the Str allocated and copied once.\n");
+	printf("vec: %llu realloc, %llu copy; str: %llu alloc, %llu copy\n",
+		(unsigned long long)vec_counts.reallocs,
+		(unsigned long long)vec_counts.copies,
+		(unsigned long long)str_counts.allocs,
+		(unsigned long long)str_counts.copies
+	);
+
+	printf("\nExpectation: Each site names its module and source file.\n");
+	for (size_t idx = 0; idx < snap.sites_len; ++idx) {
+		const InstrumentSite* site = snap.sites[idx].site;
+		const char* file = strrchr(site->file, '/');
+		printf("%s: %s\n", site->module, file != NULL ? file + 1 : site->file);
+	}
+
+	instrument_reset();
+	instrument_snapshot(&snap);
+	printf("\nExpectation: Resetting leaves no sites and no work.\n");
+	printf("sites: %zu, allocs: %llu\n", snap.sites_len, (unsigned long long)snap.total.allocs);
+
+	size_t events[4] = { 0 };
+	instrument_set_trace(count_events, events);
+	Str* traced = str_from_slice(text);
+	str_free(traced);
+	instrument_set_trace(NULL, NULL);
+	printf("\nExpectation: The trace saw one allocation, one copy, and one free.\n");
+	printf("alloc: %zu, realloc: %zu, free: %zu, copy: %zu\n",
+		events[INSTRUMENT_ALLOC],
+		events[INSTRUMENT_REALLOC],
+		events[INSTRUMENT_FREE],
+		events[INSTRUMENT_COPY]
+	);
+}
+
+#else
+
+void test_instrument(void) {
+	printf("\nExpectation: Instrumentation is not compiled in.\n");
+	printf("Configure with -DWYZYRDRY_INSTRUMENT=ON to test it.\n");
+}
+
+#endif
@@ -0,0 +1,85 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+#define INTERN_TEST_THREADS 4
+#define INTERN_TEST_WORDS 1000
+
+typedef struct InternWorker {
+	Interner* interner;
+	size_t start;
+	Str* seen[INTERN_TEST_WORDS];
+} InternWorker;
+
+/**
+ * Intern every word of a shared vocabulary, starting at a different word in
+ * each thread so that threads race to create the same values.
+ */
+static void* intern_worker(void* arg) {
+	InternWorker* w = arg;
+	char buf[32];
+	for (size_t step = 0; step < INTERN_TEST_WORDS; ++step) {
+		size_t idx = (w->start + step) % INTERN_TEST_WORDS;
+		int len = sprintf(buf, "topic/%zu", idx);
+		w->seen[idx] = interner_intern(w->interner, slice_new((unsigned char*)buf, (size_t)len));
+	}
+	return NULL;
+}
+
+void test_intern(void) {
+	Interner interner;
+	bool init = interner_init(&interner);
+	printf("\nExpectation: The Interner initializes, empty.\n");
+	printf("Init: %d, len: %zu\n", init, interner_len(&interner));
+
+	char first[] = "temperature";
+	char second[] = "temperature";
+	Str* a = interner_intern(&interner, slice_new((unsigned char*)first, 11));
+	Str* b = interner_intern(&interner, slice_new((unsigned char*)second, 11));
+	Str* c = interner_intern(&interner, slice_new((unsigned char*)"pressure", 8));
+	printf("\nExpectation: Equal bytes from different buffers intern to one Str; others do not.\n");
+	printf("Same: %d, different: %d, len: %zu\n", a == b, a != c, interner_len(&interner));
+	str_debug_print(a);
+
+	printf("\nExpectation: Finding interned bytes gives the canonical Str; other bytes give nil.\n");
+	printf("Found: %d, missing: %p\n",
+		interner_find(&interner, slice_new((unsigned char*)"pressure", 8)) == c,
+		(void*)interner_find(&interner, slice_new((unsigned char*)"humidity", 8))
+	);
+
+	InternWorker workers[INTERN_TEST_THREADS];
+	pthread_t threads[INTERN_TEST_THREADS];
+	for (size_t idx = 0; idx < INTERN_TEST_THREADS; ++idx) {
+		workers[idx].interner = &interner;
+		workers[idx].start = idx * INTERN_TEST_WORDS / INTERN_TEST_THREADS;
+		pthread_create(&threads[idx], NULL, intern_worker, &workers[idx]);
+	}
+	for (size_t idx = 0; idx < INTERN_TEST_THREADS; ++idx) {
+		pthread_join(threads[idx], NULL);
+	}
+	size_t agree = 0;
+	for (size_t idx = 0; idx < INTERN_TEST_WORDS; ++idx) {
+		bool same = workers[0].seen[idx] != NULL;
+		for (size_t thread = 1; thread < INTERN_TEST_THREADS; ++thread) {
+			same = same && workers[thread].seen[idx] == workers[0].seen[idx];
+		}
+		agree += same;
+	}
+	printf("\nExpectation: 4 threads interning 1000 words agree on every pointer, for 1002 values.\n");
+	printf("Agree: %zu, len: %zu\n", agree, interner_len(&interner));
+
+	unsigned char* bulk = calloc(STR_MAX_LEN + 2, 1);
+	Str* longest = interner_intern(&interner, slice_new(bulk, STR_MAX_LEN));
+	Str* too_long = interner_intern(&interner, slice_new(bulk, STR_MAX_LEN + 1));
+	Str* too_long_wrap = interner_intern(&interner, slice_new(bulk, STR_MAX_LEN + 2));
+	printf("\nExpectation: %zu bytes intern as one Str, and one or two bytes more are refused.\n", STR_MAX_LEN);
+	printf("Longest len: %zu, one more: %p, two more: %p\n",
+		longest != NULL ? (size_t)longest->len : 0,
+		(void*)too_long,
+		(void*)too_long_wrap
+	);
+	free(bulk);
+
+	interner_free(&interner);
+}
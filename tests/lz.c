@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+/**
+ * Compress and decompress some bytes, and report the sizes and whether the
+ * bytes came back unchanged.
+ */
+static void roundtrip(const char* name, const Slice src) {
+	Vec packed = vec_init(16, 1);
+	Vec back = vec_init(16, 1);
+	lz_compress(&packed, src);
+	LzResult res = lz_decompress(&back, vec_as_slice(&packed), src.len);
+	int same = GET_VARIANT_TYPE(res) == ENUM_VAR(LzResult, Ok)
+		&& back.len == src.len
+		&& (src.len == 0 || memcmp(back.buf, src.ptr, src.len) == 0);
+	printf("%s: %zu -> %zu bytes, unchanged: %d\n", name, src.len, packed.len, same);
+	vec_free(&back);
+	vec_free(&packed);
+}
+
+void test_lz(void) {
+	Slice abc = slice_new((unsigned char*)"abcabcabcabcabcabcabcabc", 24);
+	Vec packed = vec_init(32, 1);
+	lz_compress(&packed, abc);
+	printf("\nExpectation: \"abc\" as literals, a match 3 back of 16 bytes, and the last 5 as literals.\n");
+	vec_debug_print(&packed);
+
+	printf("\nExpectation: Every input comes back unchanged; text and runs shrink, random bytes do not.\n");
+	size_t len = 1 << 16;
+	unsigned char* buf = malloc(len);
+	roundtrip("empty", slice_new(NULL, 0));
+	roundtrip("short", slice_new((unsigned char*)"Saluton!", 8));
+	memset(buf, 'z', len);
+	roundtrip("run", slice_new(buf, len));
+	size_t at = 0;
+	for (size_t idx = 0; at + 80 < len; ++idx) {
+		at += (size_t)snprintf(
+			(char*)&buf[at],
+			80,
+			"2024-05-01T12:%02zu:%02zu INFO request %zu served in %zu us\n",
+			idx / 60 % 60,
+			idx % 60,
+			idx,
+			idx * 37 % 1000
+		);
+	}
+	roundtrip("log text", slice_new(buf, at));
+	uint64_t state = 0x9E3779B97F4A7C15;
+	for (size_t idx = 0; idx < len; ++idx) {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		buf[idx] = (unsigned char)state;
+	}
+	roundtrip("random", slice_new(buf, len));
+	free(buf);
+
+	unsigned char out[64];
+	printf("\nExpectation: Truncated blocks, a block whose match reaches before the start, and a too-small buffer are all errors.\n");
+	LzResult cut = lz_decompress_into(slice_new(out, sizeof(out)), slice_new(packed.buf, packed.len - 1));
+	unsigned char early[6] = { 0x10, 'a', 0x02, 0x00, 0x00, 0x00 };
+	LzResult back = lz_decompress_into(slice_new(out, sizeof(out)), slice_new(early, sizeof(early)));
+	LzResult small = lz_decompress_into(slice_new(out, 10), vec_as_slice(&packed));
+	printf("Truncated: %d, before start: %d at %zu, too small: %d\n",
+		GET_VARIANT_TYPE(cut) == ENUM_VAR(LzResult, Err),
+		GET_VARIANT_TYPE(back) == ENUM_VAR(LzResult, Err),
+		GET_VARIANT_BODY(back, Err),
+		GET_VARIANT_TYPE(small) == ENUM_VAR(LzResult, Err)
+	);
+	vec_free(&packed);
+}
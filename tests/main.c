@@ -1,13 +1,34 @@
 #include <stdio.h>
 
+void test_arena(void);
+void test_base64(void);
+void test_broadcast(void);
+void test_cpu(void);
 void test_enum(void);
+void test_frame(void);
+void test_hash(void);
+void test_hex(void);
+void test_hist(void);
+void test_instrument(void);
+void test_intern(void);
+void test_lz(void);
+void test_map(void);
+void test_pages(void);
+void test_pool(void);
+void test_reactor(void);
 void test_ringbuf(void);
+void test_ringset(void);
+void test_rope(void);
 void test_slice(void);
+void test_split(void);
 void test_str(void);
+void test_utf8(void);
 void test_vec(void);
 
 int main(int argc, char* argv[]) {
-	printf("Testing Vec!\n");
+	printf("Testing CPU!\n");
+	test_cpu();
+	printf("\nTesting Vec!\n");
 	test_vec();
 	printf("\nTesting Slice!\n");
 	test_slice();
@@ -15,6 +36,42 @@ int main(int argc, char* argv[]) {
 	test_str();
 	printf("\nTesting Enum!\n");
 	test_enum();
+	printf("\nTesting Hash!\n");
+	test_hash();
+	printf("\nTesting Hex!\n");
+	test_hex();
+	printf("\nTesting Map!\n");
+	test_map();
+	printf("\nTesting Intern!\n");
+	test_intern();
 	printf("\nTesting Ringbuf!\n");
 	test_ringbuf();
+	printf("\nTesting Rope!\n");
+	test_rope();
+	printf("\nTesting Split!\n");
+	test_split();
+	printf("\nTesting Frame!\n");
+	test_frame();
+	printf("\nTesting LZ!\n");
+	test_lz();
+	printf("\nTesting Hist!\n");
+	test_hist();
+	printf("\nTesting Pool!\n");
+	test_pool();
+	printf("\nTesting Reactor!\n");
+	test_reactor();
+	printf("\nTesting RingSet!\n");
+	test_ringset();
+	printf("\nTesting Arena!\n");
+	test_arena();
+	printf("\nTesting Base64!\n");
+	test_base64();
+	printf("\nTesting Utf8!\n");
+	test_utf8();
+	printf("\nTesting Broadcast!\n");
+	test_broadcast();
+	printf("\nTesting Pages!\n");
+	test_pages();
+	printf("\nTesting Instrument!\n");
+	test_instrument();
 }
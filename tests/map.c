@@ -0,0 +1,138 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+/**
+ * Write a distinct key for a number into a buffer.
+ */
+static Slice key_for(char* buf, size_t num) {
+	int len = sprintf(buf, "key-%zu", num);
+	return slice_new((unsigned char*)buf, (size_t)len);
+}
+
+/**
+ * Count the keys below `count` whose values are present and correct.
+ */
+static size_t count_found(const Map* map, size_t count) {
+	char buf[32];
+	size_t ret = 0;
+	for (size_t idx = 0; idx < count; ++idx) {
+		void** val = map_get(map, key_for(buf, idx));
+		ret += val != NULL && *val == (void*)(uintptr_t)(idx + 1);
+	}
+	return ret;
+}
+
+void test_map(void) {
+	Map map = map_init(0, MAP_COPY_KEYS);
+	printf("\nExpectation: An empty Map with no capacity.\n");
+	map_debug_print(&map);
+
+	char greet[] = "Saluton";
+	map_insert(&map, slice_new((unsigned char*)greet, 7), (void*)1);
+	map_insert(&map, slice_new((unsigned char*)"mondo", 5), (void*)2);
+	/* Changing the caller's buffer must not change a copied key. */
+	greet[0] = 's';
+	printf("\nExpectation: Two entries in 16 slots, with keys \"Saluton\" and \"mondo\".\n");
+	map_debug_print(&map);
+
+	Str* str = str_from_slice(slice_new((unsigned char*)"mondo", 5));
+	void** val = map_get(&map, str_as_slice(str));
+	printf("\nExpectation: A Str key finds the value 2, and \"saluton\" is absent.\n");
+	printf("mondo: %p, saluton: %p\n",
+		val == NULL ? NULL : *val,
+		(void*)map_get(&map, slice_new((unsigned char*)greet, 7))
+	);
+	str_free(str);
+
+	bool inserted = true;
+	val = map_entry(&map, slice_new((unsigned char*)"Saluton", 7), &inserted);
+	*val = (void*)3;
+	printf("\nExpectation: map_entry finds the existing key and replaces its value with 3.\n");
+	printf("Inserted: %d, len: %zu, value: %p\n",
+		inserted,
+		map.len,
+		*map_get(&map, slice_new((unsigned char*)"Saluton", 7))
+	);
+
+	bool erased = map_erase(&map, slice_new((unsigned char*)"mondo", 5));
+	bool again = map_erase(&map, slice_new((unsigned char*)"mondo", 5));
+	printf("\nExpectation: Erasing a key succeeds once, then it is absent.\n");
+	printf("Erased: %d, again: %d, found: %d, len: %zu\n",
+		erased,
+		again,
+		map_get(&map, slice_new((unsigned char*)"mondo", 5)) != NULL,
+		map.len
+	);
+	map_free(&map);
+
+	size_t count = 100000;
+	char buf[32];
+	map = map_init(0, MAP_COPY_KEYS);
+	for (size_t idx = 0; idx < count; ++idx) {
+		map_insert(&map, key_for(buf, idx), (void*)(uintptr_t)(idx + 1));
+	}
+	printf("\nExpectation: 100000 keys are all found after growing from empty, in 131072 slots.\n");
+	printf("Len: %zu, cap: %zu, found: %zu\n", map.len, map.cap, count_found(&map, count));
+
+	for (size_t idx = 0; idx < count; idx += 2) {
+		map_erase(&map, key_for(buf, idx));
+	}
+	size_t odd = 0;
+	for (size_t idx = 1; idx < count; idx += 2) {
+		odd += map_get(&map, key_for(buf, idx)) != NULL;
+	}
+	printf("\nExpectation: Erasing the even keys leaves the 50000 odd keys.\n");
+	printf("Len: %zu, odd found: %zu\n", map.len, odd);
+
+	for (size_t round = 0; round < 4; ++round) {
+		for (size_t idx = 0; idx < count; idx += 2) {
+			map_insert(&map, key_for(buf, idx), (void*)(uintptr_t)(idx + 1));
+		}
+		for (size_t idx = 0; idx < count; idx += 2) {
+			map_erase(&map, key_for(buf, idx));
+		}
+	}
+	for (size_t idx = 0; idx < count; idx += 2) {
+		map_insert(&map, key_for(buf, idx), (void*)(uintptr_t)(idx + 1));
+	}
+	printf("\nExpectation: Churning the even keys reuses erased slots; all 100000 are found in 131072 slots.\n");
+	printf("Len: %zu, cap: %zu, found: %zu\n", map.len, map.cap, count_found(&map, count));
+
+	size_t visited = 0;
+	uintptr_t total = 0;
+	size_t cursor = 0;
+	MapEntry entry;
+	while (map_next(&map, &cursor, &entry)) {
+		++visited;
+		total += (uintptr_t)entry.value;
+	}
+	printf("\nExpectation: Iteration visits 100000 entries whose values sum to 5000050000.\n");
+	printf("Visited: %zu, sum: %llu\n", visited, (unsigned long long)total);
+
+	map_clear(&map);
+	printf("\nExpectation: Clearing keeps the capacity and finds nothing.\n");
+	printf("Len: %zu, cap: %zu, found: %zu\n", map.len, map.cap, count_found(&map, count));
+	map_free(&map);
+
+	Slice words[3] = {
+		slice_new((unsigned char*)"alpha", 5),
+		slice_new((unsigned char*)"beta", 4),
+		slice_new((unsigned char*)"", 0),
+	};
+	map = map_init(3, MAP_BORROW_KEYS);
+	for (size_t idx = 0; idx < 3; ++idx) {
+		map_insert(&map, words[idx], (void*)(uintptr_t)(idx + 1));
+	}
+	MapEntry first;
+	cursor = 0;
+	bool have = map_next(&map, &cursor, &first);
+	printf("\nExpectation: A borrowing Map keeps the caller's pointers, and finds the empty key.\n");
+	printf("Borrowed: %d, empty key: %d, reserved without growing: %d\n",
+		have && (first.key.ptr == words[0].ptr || first.key.ptr == words[1].ptr || first.key.len == 0),
+		map_get(&map, words[2]) != NULL,
+		map_reserve(&map, 10) && map.cap == 16
+	);
+	map_free(&map);
+}
@@ -0,0 +1,128 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+/**
+ * Check that every byte of a store is zero, then fill it, to show that it is
+ * all readable and writable.
+ */
+static bool check_store(const Slice store) {
+	for (size_t idx = 0; idx < store.len; ++idx) {
+		if (store.ptr[idx] != 0) {
+			return false;
+		}
+	}
+	memset(store.ptr, 0xA5, store.len);
+	return true;
+}
+
+static const char* huge_kind(unsigned int got) {
+	if ((got & PAGES_HUGETLB) != 0) {
+		return "explicit";
+	}
+	return (got & PAGES_HUGE) != 0 ? "transparent" : "none";
+}
+
+void test_pages(void) {
+	unsigned int got = 0;
+	Slice store = pages_alloc(10000, 0, PAGES_ANY_NODE, &got);
+	printf("\nExpectation: 10000 bytes round up to 3 ordinary pages, zeroed, mapped and nothing more.\n");
+	printf("Len: %zu, page aligned: %d, usable: %d, only mapped: %d\n",
+		store.len,
+		(uintptr_t)store.ptr % pages_round(1, 0) == 0,
+		check_store(store),
+		got == PAGES_MAPPED
+	);
+	pages_free(store);
+
+	store = pages_alloc(3 * 1024 * 1024, PAGES_HUGE | PAGES_PREFAULT, PAGES_ANY_NODE, &got);
+	printf("\nExpectation: A huge, prefaulted 3 MiB store rounds up to two aligned huge pages, whatever backs them.\n");
+	printf("Len: %zu, huge aligned: %d, usable: %d, prefaulted: %d, huge pages: %s\n",
+		store.len,
+		(uintptr_t)store.ptr % PAGES_HUGE_SIZE == 0,
+		check_store(store),
+		(got & PAGES_PREFAULT) != 0,
+		huge_kind(got)
+	);
+	pages_free(store);
+
+	store = pages_alloc(1024 * 1024, 0, 0, &got);
+	bool usable = check_store(store);
+	bool placed = (got & PAGES_NODE) != 0;
+	pages_free(store);
+	Slice stray = pages_alloc(1024 * 1024, 0, 4096, &got);
+	printf("\nExpectation: A store is placed on node 0, and one asked of a node that does not exist is still usable.\n");
+	printf("Node 0 placed: %d, usable: %d; node 4096 placed: %d, usable: %d\n",
+		placed,
+		usable,
+		(got & PAGES_NODE) != 0,
+		check_store(stray)
+	);
+	pages_free(stray);
+
+	RingBuf ring = ringbuf_init_pages(100000, PAGES_PREFAULT, 0);
+	size_t in_order = 0;
+	unsigned char out[64];
+	for (size_t num = 0; num < 10000; ++num) {
+		char text[32];
+		int len = snprintf(text, sizeof(text), "message %zu", num);
+		ringbuf_write_slice(&ring, slice_new((unsigned char*)text, (size_t)len));
+		StrLen read = ringbuf_read(&ring, slice_new(out, sizeof(out)));
+		in_order += read == (StrLen)len && memcmp(out, text, read) == 0;
+	}
+	printf("\nExpectation: A ring over 25 prefaulted pages passes 10000 messages through in order.\n");
+	printf("Store: %zu, mapped: %d, in order: %zu\n",
+		ring.store.len,
+		(ring.pages & PAGES_MAPPED) != 0,
+		in_order
+	);
+	ringbuf_free(&ring);
+
+	ring = ringbuf_init_pages(4096, 0, PAGES_ANY_NODE);
+	ringbuf_set_growth(&ring, 2, 1024 * 1024);
+	unsigned char msg[200];
+	for (size_t num = 0; num < 100; ++num) {
+		memset(msg, (int)num, sizeof(msg));
+		ringbuf_write_slice(&ring, slice_new(msg, sizeof(msg)));
+	}
+	size_t grown = ring.store.len;
+	in_order = 0;
+	for (size_t num = 0; num < 100; ++num) {
+		StrLen read = ringbuf_read(&ring, slice_new(msg, sizeof(msg)));
+		in_order += read == sizeof(msg) && msg[0] == (unsigned char)num && msg[199] == (unsigned char)num;
+	}
+	/* A lightly loaded ring shrinks once enough has passed through it. */
+	for (size_t num = 0; num < 1000; ++num) {
+		ringbuf_write_slice(&ring, slice_new(msg, sizeof(msg)));
+		ringbuf_read(&ring, slice_new(msg, sizeof(msg)));
+	}
+	printf("\nExpectation: A growing ring of pages grows from one page to 8, and back to one after a quiet spell.\n");
+	printf("Grown: %zu, in order: %zu of 100, shrunk: %zu\n", grown, in_order, ring.store.len);
+	ringbuf_free(&ring);
+
+	Vec vec = vec_init_pages(10, PAGES_HUGE, PAGES_ANY_NODE);
+	size_t first_cap = vec.cap;
+	unsigned char block[65536];
+	for (size_t num = 0; num < 48; ++num) {
+		memset(block, (int)num, sizeof(block));
+		vec_push_slice(&vec, slice_new(block, sizeof(block)));
+	}
+	size_t grown_cap = vec.cap;
+	bool intact = true;
+	for (size_t num = 0; num < 48; ++num) {
+		intact = intact && vec.buf[num * sizeof(block)] == (unsigned char)num;
+	}
+	vec.len = 100;
+	vec_trim(&vec);
+	printf("\nExpectation: A Vec of huge pages grows from 2 MiB to 4 MiB for 3 MiB of data, and trims to 2 MiB.\n");
+	printf("First: %zu, grown: %zu, intact: %d, trimmed: %zu, first byte: %u\n",
+		first_cap,
+		grown_cap,
+		intact,
+		vec.cap,
+		vec.buf[0]
+	);
+	vec_free(&vec);
+}
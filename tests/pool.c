@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+typedef struct PoolTestVisits {
+	unsigned char* seen;
+	size_t calls;
+} PoolTestVisits;
+
+/**
+ * Mark each index, spending longer on the low ones so that stealing is needed
+ * to balance the work.
+ */
+static void pool_test_visit(size_t start, size_t end, void* ctx) {
+	PoolTestVisits* visits = ctx;
+	for (size_t idx = start; idx < end; ++idx) {
+		volatile size_t spin = 0;
+		for (size_t rep = 0; rep < (idx < 1000 ? 200 : 1); ++rep) {
+			spin += rep;
+		}
+		++visits->seen[idx];
+	}
+	__atomic_add_fetch(&visits->calls, 1, __ATOMIC_RELAXED);
+}
+
+void test_pool(void) {
+	Pool pool;
+	pool_init(&pool, 4, 4096);
+	printf("\nExpectation: The pool has four threads and a 4096-byte grain.\n");
+	printf("threads: %zu, grain: %zu\n", pool.threads, pool.grain);
+
+	size_t len = 10000;
+	PoolTestVisits visits = { .seen = calloc(len, 1) };
+	pool_for(&pool, 0, len, 16, pool_test_visit, &visits);
+	size_t once = 0;
+	for (size_t idx = 0; idx < len; ++idx) {
+		once += visits.seen[idx] == 1;
+	}
+	printf("\nExpectation: Every index of an uneven loop is visited exactly once, in many chunks.\n");
+	printf("Visited once: %zu of %zu, many chunks: %d\n", once, len, visits.calls > 100);
+
+	visits.calls = 0;
+	pool_for(&pool, 0, 100, 0, pool_test_visit, &visits);
+	printf("\nExpectation: A range within the grain runs as a single call.\n");
+	printf("Calls: %zu\n", visits.calls);
+	free(visits.seen);
+
+	len = 1 << 20;
+	unsigned char* src = malloc(len);
+	unsigned char* dst = malloc(2 * len);
+	for (size_t idx = 0; idx < len; ++idx) {
+		src[idx] = (unsigned char)(idx * 2654435761u >> 13) | 1;
+	}
+	Slice data = slice_new(src, len);
+
+	size_t copied = pool_copy(&pool, slice_new(dst, len), data);
+	printf("\nExpectation: A 1 MiB copy matches its source.\n");
+	printf("Copied: %zu, equal: %d\n", copied, memcmp(dst, src, len) == 0);
+
+	pool_fill(&pool, slice_new(dst, len), 0xAB);
+	printf("\nExpectation: A fill sets every byte.\n");
+	printf("Filled: %zu\n", slice_count_byte(slice_new(dst, len), 0xAB));
+
+	src[len - 3] = 0;
+	src[700000] = 0;
+	printf("\nExpectation: Find reports the first of two zero bytes, and the length when absent.\n");
+	printf("First: %zu, absent: %zu\n", pool_find_byte(&pool, data, 0), pool_find_byte(&pool, data, 2));
+
+	printf("\nExpectation: Counts match a single-threaded count.\n");
+	printf("Equal: %d\n", pool_count_byte(&pool, data, 0x41) == slice_count_byte(data, 0x41));
+
+	uint32_t seed = hash_crc32c(0, slice_new((unsigned char*)"prefix", 6));
+	printf("\nExpectation: The parallel CRC-32C continues a checksum exactly as hash_crc32c() does.\n");
+	printf("Equal: %d\n", pool_crc32c(&pool, seed, data) == hash_crc32c(seed, data));
+
+	Vec hex = vec_init(2 * len, 1);
+	hex_encode(&hex, data);
+	size_t wrote = pool_hex_encode_into(&pool, slice_new(dst, 2 * len), data);
+	printf("\nExpectation: The parallel hex encoding matches hex_encode().\n");
+	printf("Wrote: %zu, equal: %d\n", wrote, memcmp(dst, hex.buf, 2 * len) == 0);
+
+	vec_free(&hex);
+	free(dst);
+	free(src);
+	pool_free(&pool);
+}
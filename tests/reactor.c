@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <wyzyrdry.h>
+
+void test_reactor(void) {
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+		printf("\nsocketpair() failed; skipping the Reactor tests.\n");
+		return;
+	}
+	size_t sz = 4096;
+	RingBuf out = ringbuf_init(slice_new(malloc(sz), sz));
+	RingBuf in = ringbuf_init(slice_new(malloc(sz), sz));
+	Reactor reactor;
+	reactor_init(&reactor);
+	bool added = reactor_add(&reactor, fds[0], &out, REACTOR_WRITE)
+		&& reactor_add(&reactor, fds[1], &in, REACTOR_READ);
+	printf("\nExpectation: Both ends of a socket pair are linked, and a second reader is refused.\n");
+	printf("Added: %d, second reader: %d\n",
+		added,
+		reactor_add(&reactor, fds[1], &in, REACTOR_READ)
+	);
+
+	const char* words[3] = { "alpha", "", "gamma ray" };
+	for (size_t idx = 0; idx < 3; ++idx) {
+		ringbuf_write_slice(&out, slice_new((unsigned char*)words[idx], strlen(words[idx])));
+	}
+	size_t moved = reactor_pump(&reactor);
+	printf("\nExpectation: Three messages are sent and three received, in order, including an empty one.\n");
+	printf("Moved: %zu, left to send: %zu, received:", moved, out.count);
+	unsigned char buf[256];
+	while (in.count > 0) {
+		StrLen got = ringbuf_read(&in, slice_new(buf, sizeof(buf)));
+		if (got == 0) {
+			/* `ringbuf_read()` leaves an empty message in place. */
+			ringbuf_pop(&in);
+		}
+		printf(" \"%.*s\"", (int)got, buf);
+	}
+	printf("\n");
+
+	/* A small receiving ring pushes back on the sender. */
+	size_t small_sz = 64;
+	RingBuf small = ringbuf_init(slice_new(malloc(small_sz), small_sz));
+	int pair[2];
+	socketpair(AF_UNIX, SOCK_STREAM, 0, pair);
+	reactor_add(&reactor, pair[1], &small, REACTOR_READ);
+	unsigned char msg[20];
+	for (size_t idx = 0; idx < 10; ++idx) {
+		memset(msg, 'a' + (int)idx, sizeof(msg));
+		unsigned char frame[sizeof(StrLen) + sizeof(msg)];
+		frame_encode_into(slice_new(frame, sizeof(frame)), slice_new(msg, sizeof(msg)));
+		write(pair[0], frame, sizeof(frame));
+	}
+	reactor_poll(&reactor, 100);
+	ReactorLink* link = reactor_link(&reactor, pair[1]);
+	printf("\nExpectation: A 64-byte ring takes two 20-byte messages, and reading stops while it is full.\n");
+	printf("Queued: %zu, still readable: %d\n", small.count, link->readable);
+	size_t seen = 0;
+	bool ordered = true;
+	while (small.count > 0) {
+		StrLen got = ringbuf_read(&small, slice_new(buf, sizeof(buf)));
+		ordered = ordered && got == sizeof(msg) && buf[0] == 'a' + seen;
+		++seen;
+		reactor_pump(&reactor);
+	}
+	printf("\nExpectation: Reading resumes as the ring is drained, and all ten arrive in order.\n");
+	printf("Received: %zu, in order: %d\n", seen, ordered);
+
+	/* Enough traffic to fill the socket and wrap both rings many times. */
+	size_t total = 2000;
+	size_t sent = 0;
+	size_t recvd = 0;
+	ordered = true;
+	while (recvd < total) {
+		while (sent < total) {
+			memset(buf, (unsigned char)sent, sizeof(buf));
+			StrLen len = (StrLen)(sent % 200 + 1);
+			if (ringbuf_space_free(&out) < str_size(len)) {
+				break;
+			}
+			ringbuf_write_slice(&out, slice_new(buf, len));
+			++sent;
+		}
+		if (reactor_poll(&reactor, 100) < 0) {
+			break;
+		}
+		while (in.count > 0) {
+			StrLen got = ringbuf_read(&in, slice_new(buf, sizeof(buf)));
+			ordered = ordered && got == recvd % 200 + 1 && buf[got - 1] == (unsigned char)recvd;
+			++recvd;
+		}
+		reactor_pump(&reactor);
+	}
+	printf("\nExpectation: 2000 messages of varied length pass through 4 KiB rings intact.\n");
+	printf("Received: %zu, intact: %d, left to send: %zu\n", recvd, ordered, out.count);
+
+	shutdown(fds[0], SHUT_WR);
+	reactor_poll(&reactor, 100);
+	printf("\nExpectation: The reading side closes when its peer shuts down.\n");
+	printf("Closed: %d\n", reactor_link(&reactor, fds[1])->in_closed);
+
+	RingBuf packed = ringbuf_init(slice_new(malloc(sz), sz));
+	ringbuf_set_compression(&packed, true, 0);
+	printf("\nExpectation: A compressing ring cannot be written from.\n");
+	printf("Added: %d\n", reactor_add(&reactor, pair[0], &packed, REACTOR_WRITE));
+
+	reactor_free(&reactor);
+	ringbuf_free(&packed);
+	ringbuf_free(&small);
+	ringbuf_free(&in);
+	ringbuf_free(&out);
+	close(pair[0]);
+	close(pair[1]);
+	close(fds[0]);
+	close(fds[1]);
+}
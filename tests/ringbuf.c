@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include <wyzyrdry.h>
 
 void test_ringbuf() {
@@ -65,4 +66,321 @@ void test_ringbuf() {
 	ringbuf_free(&rb);
 	printf("\nExpectation: RingBuf is zeroed and freed.\n");
 	ringbuf_debug_print(&rb);
-}
\ No newline at end of file
+
+	sz = 256;
+	rb = ringbuf_init(slice_new(malloc(sz), sz));
+	ringbuf_set_compression(&rb, true, 32);
+	unsigned char line[200];
+	for (size_t idx = 0; idx < sizeof(line); ++idx) {
+		line[idx] = (unsigned char)"GET /index.html 200\n"[idx % 20];
+	}
+	size_t fit = 0;
+	while (ringbuf_write_slice(&rb, slice_new(line, sizeof(line))) > 0) {
+		++fit;
+	}
+	ringbuf_write_slice(&rb, slice_new((unsigned char*)"short", 5));
+	printf("\nExpectation: A 256-byte RingBuf takes several 200-byte compressed messages, and refuses the rest.\n");
+	printf("Messages: %zu, bytes used: %zu, read length: %u\n",
+		fit,
+		ringbuf_space_used(&rb),
+		(unsigned)ringbuf_peek_read_len(&rb)
+	);
+
+	unsigned char out[256];
+	size_t same = 0;
+	/* Writes after each read move the messages round, so that some wrap. */
+	for (size_t idx = 0; idx < 20; ++idx) {
+		StrLen got = ringbuf_read(&rb, slice_new(out, sizeof(out)));
+		same += got == sizeof(line) && memcmp(out, line, sizeof(line)) == 0;
+		ringbuf_write_slice(&rb, slice_new(line, sizeof(line)));
+	}
+	printf("\nExpectation: Every message read back is the 200 bytes written, including those that wrapped.\n");
+	printf("Unchanged: %zu of 20\n", same);
+	printf("\nExpectation: Compression cannot change while messages are queued.\n");
+	printf("Changed: %d\n", ringbuf_set_compression(&rb, false, 0));
+
+	while (rb.count > 0) {
+		ringbuf_pop(&rb);
+	}
+	ringbuf_write_slice(&rb, slice_new(line, 0));
+	StrLen empty = ringbuf_read(&rb, slice_new(out, sizeof(out)));
+	printf("\nExpectation: An empty message is not read from a compressing queue, but stays until popped.\n");
+	printf("Read: %u, still queued: %zu\n", (unsigned)empty, rb.count);
+	ringbuf_pop(&rb);
+	ringbuf_write_slice(&rb, slice_new((unsigned char*)"short", 5));
+	StrLen got = ringbuf_read(&rb, slice_new(out, sizeof(out)));
+	printf("\nExpectation: A message under the threshold is stored with only its header byte.\n");
+	printf("Read: \"%.*s\", empty afterward: %d\n", (int)got, out, rb.count == 0);
+	ringbuf_free(&rb);
+
+	Hist* hist = malloc(sizeof(Hist));
+	hist_init(hist);
+	sz = 64;
+	rb = ringbuf_init(slice_new(malloc(sz), sz));
+	ringbuf_set_latency(&rb, hist);
+	ringbuf_write_slice(&rb, slice_new((unsigned char*)"abc", 3));
+	ringbuf_write_slice(&rb, slice_new((unsigned char*)"defgh", 5));
+	Slice peeked[2];
+	StrLen peeklen = ringbuf_peek_slices(&rb, peeked);
+	printf("\nExpectation: Stamped messages take 8 more bytes each, but peek as written.\n");
+	printf("Bytes used: %zu, length: %u, peek: \"%.*s\"\n",
+		ringbuf_space_used(&rb),
+		(unsigned)ringbuf_peek_len(&rb),
+		(int)peeklen,
+		peeked[0].ptr
+	);
+	printf("\nExpectation: Latency cannot be turned off while messages are queued.\n");
+	printf("Changed: %d\n", ringbuf_set_latency(&rb, NULL));
+
+	got = ringbuf_read(&rb, slice_new(out, sizeof(out)));
+	ringbuf_pop(&rb);
+	printf("\nExpectation: Reading and popping each records a latency.\n");
+	printf("Read: \"%.*s\", latencies: %llu\n", (int)got, out, (unsigned long long)hist->total);
+
+	same = 0;
+	Slice ten = slice_new((unsigned char*)"0123456789", 10);
+	/* 20-byte records in a 64-byte store, so that prefixes, stamps, and data all wrap. */
+	ringbuf_write_slice(&rb, ten);
+	for (size_t idx = 0; idx < 20; ++idx) {
+		ringbuf_write_slice(&rb, ten);
+		got = ringbuf_read(&rb, slice_new(out, sizeof(out)));
+		same += got == 10 && memcmp(out, ten.ptr, 10) == 0;
+	}
+	printf("\nExpectation: Stamped messages that wrap are read back unchanged.\n");
+	printf("Unchanged: %zu of 20, latencies: %llu\n", same, (unsigned long long)hist->total);
+	ringbuf_pop(&rb);
+
+	Hist* merged = malloc(sizeof(Hist));
+	hist_init(merged);
+	hist_merge(merged, hist);
+	hist_init(hist);
+	ringbuf_set_compression(&rb, true, 32);
+	for (size_t idx = 0; idx < 5; ++idx) {
+		ringbuf_write_slice(&rb, slice_new(line, 60));
+		got = ringbuf_read(&rb, slice_new(out, sizeof(out)));
+	}
+	hist_merge(merged, hist);
+	printf("\nExpectation: Compressed, stamped messages read back whole, and histograms merge.\n");
+	printf("Read: %u, unchanged: %d, latencies: %llu, merged: %llu, under a second: %d\n",
+		(unsigned)got,
+		memcmp(out, line, 60) == 0,
+		(unsigned long long)hist->total,
+		(unsigned long long)merged->total,
+		hist_percentile(merged, 100.0) < 1000000000u
+	);
+	ringbuf_free(&rb);
+	free(merged);
+	free(hist);
+
+	/* Three 10-byte messages in a 32-byte store put the third across the end. */
+	rb = ringbuf_init(slice_new(malloc(32), 32));
+	ringbuf_write_slice(&rb, ten);
+	ringbuf_write_slice(&rb, ten);
+	ringbuf_pop(&rb);
+	ringbuf_write_slice(&rb, slice_new((unsigned char*)"abcdefghij", 10));
+	ringbuf_write_slice(&rb, slice_new((unsigned char*)"xyz", 3));
+	RingBufCursor cursor = { .seen = 0, .pos = 0 };
+	Slice parts[2];
+	printf("\nExpectation: A walk visits each message in order without removing it; the second is split.\n");
+	while (ringbuf_next(&rb, &cursor, parts)) {
+		printf("\"%.*s\" + \"%.*s\"; ",
+			(int)parts[0].len, parts[0].ptr,
+			(int)parts[1].len, parts[1].ptr
+		);
+	}
+	printf("count: %zu\n", rb.count);
+	ringbuf_free(&rb);
+
+	/* A 256-byte store carries 4 KiB messages by reference. */
+	Arena arena = arena_init();
+	rb = ringbuf_init(slice_new(malloc(256), 256));
+	ringbuf_set_arena(&rb, &arena, 32);
+	unsigned char* large = malloc(4096);
+	for (size_t idx = 0; idx < 4096; ++idx) {
+		large[idx] = (unsigned char)(idx * 7);
+	}
+	StrLen pushed = ringbuf_write_slice(&rb, slice_new(large, 4096));
+	ringbuf_write_slice(&rb, ten);
+	printf("\nExpectation: A 4 KiB message is queued as a 17-byte descriptor in one block, and reads as 4096 bytes.\n");
+	printf("Pushed: %u, stored: %u, read length: %u, blocks: %zu\n",
+		(unsigned)pushed,
+		(unsigned)ringbuf_peek_len(&rb),
+		(unsigned)ringbuf_peek_read_len(&rb),
+		arena.live
+	);
+	unsigned char* back = malloc(4096);
+	got = ringbuf_read(&rb, slice_new(back, 4096));
+	printf("\nExpectation: Reading copies the message out and releases its block.\n");
+	printf("Read: %u, unchanged: %d, blocks: %zu\n",
+		(unsigned)got,
+		memcmp(back, large, 4096) == 0,
+		arena.live
+	);
+
+	ArenaRef ref;
+	bool took = ringbuf_read_ref(&rb, &ref);
+	printf("\nExpectation: An inline message is handed over in a block of its own.\n");
+	printf("Took: %d, \"%.*s\", blocks: %zu\n", took, (int)ref.len, ref.ptr, arena.live);
+	arena_release(&arena, ref);
+
+	ArenaRef filled = arena_alloc(&arena, 3000);
+	memset(filled.ptr, 0x5A, filled.len);
+	ringbuf_write_ref(&rb, filled);
+	ringbuf_read_ref(&rb, &ref);
+	printf("\nExpectation: A block written by reference is read back as the same block, without copying.\n");
+	printf("Same: %d, length: %u, queue empty: %d\n", ref.ptr == filled.ptr, ref.len, rb.count == 0);
+	arena_release(&arena, ref);
+
+	for (size_t idx = 0; idx < 5; ++idx) {
+		ringbuf_write_slice(&rb, slice_new(large, 2000 + idx));
+	}
+	ringbuf_pop(&rb);
+	size_t held = arena.live;
+	ringbuf_free(&rb);
+	printf("\nExpectation: Popping, and freeing the queue, release the blocks of its messages.\n");
+	printf("Held after a pop: %zu, after free: %zu\n", held, arena.live);
+
+	/* A 4-byte header, 7-byte body, and 2-byte trailer in a 48-byte store, so that every boundary wraps in turn. */
+	rb = ringbuf_init(slice_new(malloc(48), 48));
+	Slice pieces[3] = {
+		slice_new((unsigned char*)"HEAD", 4),
+		slice_new((unsigned char*)"payload", 7),
+		slice_new((unsigned char*)"\r\n", 2),
+	};
+	const char* joined = "HEADpayload\r\n";
+	same = 0;
+	for (size_t idx = 0; idx < 30; ++idx) {
+		ringbuf_write_gather(&rb, pieces, 3);
+		got = ringbuf_read(&rb, slice_new(out, sizeof(out)));
+		same += got == 13 && memcmp(out, joined, 13) == 0;
+	}
+	printf("\nExpectation: Gathered messages read back as their pieces joined, wherever the store wraps.\n");
+	printf("Unchanged: %zu of 30, queue empty: %d\n", same, rb.count == 0);
+
+	ringbuf_set_compression(&rb, true, 8);
+	Slice repeats[2] = { slice_new(line, 30), slice_new(line, 30) };
+	pushed = ringbuf_write_gather(&rb, repeats, 2);
+	printf("\nExpectation: A compressing queue compresses the gathered message as a whole.\n");
+	printf("Pushed: %u, compressed: %d, read length: %u\n",
+		(unsigned)pushed,
+		pushed < str_size(60),
+		(unsigned)ringbuf_peek_read_len(&rb)
+	);
+	ringbuf_free(&rb);
+
+	rb = ringbuf_init(slice_new(malloc(256), 256));
+	ringbuf_set_arena(&rb, &arena, 32);
+	Slice halves[2] = { slice_new(large, 1500), slice_new(&large[1500], 2596) };
+	ringbuf_write_gather(&rb, halves, 2);
+	ringbuf_read(&rb, slice_new(back, 4096));
+	printf("\nExpectation: A large gathered message is copied into one block and reads back whole.\n");
+	printf("Unchanged: %d, blocks: %zu\n", memcmp(back, large, 4096) == 0, arena.live);
+	ringbuf_free(&rb);
+
+	/* Start wrapped, so that growing must unwrap the messages. */
+	rb = ringbuf_init(slice_new(malloc(64), 64));
+	printf("\nExpectation: Growth by a factor of 1 is refused, and by 2 up to 4096 bytes is accepted.\n");
+	printf("Factor 1: %d, factor 2: %d\n", ringbuf_set_growth(&rb, 1, 4096), ringbuf_set_growth(&rb, 2, 4096));
+	char text[32];
+	for (size_t idx = 0; idx < 3; ++idx) {
+		ringbuf_write_slice(&rb, slice_new(line, 20));
+	}
+	ringbuf_pop(&rb);
+	ringbuf_pop(&rb);
+	for (size_t idx = 0; idx < 200; ++idx) {
+		int len = snprintf(text, sizeof(text), "message %zu", idx);
+		ringbuf_write_slice(&rb, slice_new((unsigned char*)text, (size_t)len));
+	}
+	size_t grown = rb.store.len;
+	ringbuf_pop(&rb);
+	same = 0;
+	for (size_t idx = 0; idx < 200; ++idx) {
+		int len = snprintf(text, sizeof(text), "message %zu", idx);
+		got = ringbuf_read(&rb, slice_new(out, sizeof(out)));
+		same += got == (StrLen)len && memcmp(out, text, (size_t)len) == 0;
+	}
+	printf("\nExpectation: 200 messages grow a 64-byte store to 4096 bytes, and read back in order.\n");
+	printf("Store: %zu, in order: %zu of 200, queue empty: %d\n", grown, same, rb.count == 0);
+
+	while (ringbuf_fits(&rb, 20)) {
+		ringbuf_write_slice(&rb, slice_new(line, 20));
+	}
+	pushed = ringbuf_write_slice(&rb, slice_new(line, 20));
+	printf("\nExpectation: 186 messages fill 4096 bytes, and the next is refused.\n");
+	printf("Count: %zu, used: %zu, store: %zu, pushed: %u\n",
+		rb.count,
+		ringbuf_space_used(&rb),
+		rb.store.len,
+		(unsigned)pushed
+	);
+
+	while (rb.count > 1) {
+		ringbuf_pop(&rb);
+	}
+	size_t steps[4];
+	for (size_t round = 0; round < 4; ++round) {
+		for (size_t idx = 0; idx < 200; ++idx) {
+			ringbuf_write_slice(&rb, slice_new(line, 20));
+			ringbuf_pop(&rb);
+		}
+		steps[round] = rb.store.len;
+	}
+	printf("\nExpectation: A lightly loaded queue shrinks step by step, back to its first 64 bytes, keeping its messages.\n");
+	printf("Store: %zu, %zu, %zu, %zu, count: %zu, first: %u\n",
+		steps[0],
+		steps[1],
+		steps[2],
+		steps[3],
+		rb.count,
+		(unsigned)ringbuf_peek_len(&rb)
+	);
+
+	while (ringbuf_space_free(&rb) >= str_size(20)) {
+		ringbuf_write_slice(&rb, slice_new(line, 20));
+	}
+	Slice head[2];
+	ringbuf_peek_slices(&rb, head);
+	pushed = ringbuf_write_gather(&rb, head, 2);
+	ringbuf_pop(&rb);
+	size_t count = rb.count;
+	while (rb.count > 1) {
+		ringbuf_pop(&rb);
+	}
+	got = ringbuf_read(&rb, slice_new(out, sizeof(out)));
+	printf("\nExpectation: The head message of a full queue can be written back into it, growing it, and reads back unchanged.\n");
+	printf("Pushed: %u, count: %zu, unchanged: %d\n",
+		(unsigned)pushed,
+		count,
+		got == 20 && memcmp(out, line, 20) == 0
+	);
+	ringbuf_free(&rb);
+
+	rb = ringbuf_init(slice_new(malloc(64), 64));
+	ringbuf_set_growth(&rb, 2, 1 << 20);
+	ringbuf_set_arena(&rb, &arena, 8);
+	size_t accepted = 0;
+	size_t fitted = 0;
+	for (size_t idx = 0; idx < 100; ++idx) {
+		fitted += ringbuf_fits(&rb, 100);
+		accepted += ringbuf_write_slice(&rb, slice_new(&large[idx], 100)) > 0;
+	}
+	grown = rb.store.len;
+	same = 0;
+	for (size_t idx = 0; idx < 100; ++idx) {
+		got = ringbuf_read(&rb, slice_new(back, 4096));
+		same += got == 100 && memcmp(back, &large[idx], 100) == 0;
+	}
+	printf("\nExpectation: A growing queue with an Arena grows for its references, taking all 100 messages it said fit.\n");
+	printf("Fitted: %zu, accepted: %zu, grew: %d, in order: %zu, blocks: %zu\n",
+		fitted,
+		accepted,
+		grown > 64,
+		same,
+		arena.live
+	);
+	ringbuf_free(&rb);
+
+	free(back);
+	free(large);
+	arena_free(&arena);
+}
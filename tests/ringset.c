@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+void test_ringset(void) {
+	size_t sz = 4096;
+	RingBuf rings[3];
+	for (size_t idx = 0; idx < 3; ++idx) {
+		rings[idx] = ringbuf_init(slice_new(malloc(sz), sz));
+	}
+	unsigned char buf[256];
+	memset(buf, 0x41, sizeof(buf));
+
+	RingSet set = ringset_init(RINGSET_PRIORITY);
+	for (size_t idx = 0; idx < 3; ++idx) {
+		ringset_add(&set, &rings[idx], 0);
+	}
+	ringset_write_slice(&set, 2, slice_new(buf, 3));
+	ringset_write_slice(&set, 0, slice_new(buf, 1));
+	ringset_write_slice(&set, 0, slice_new(buf, 2));
+	printf("\nExpectation: Priority mode drains ring 0 before ring 2, then reports none.\n");
+	printf("Served:");
+	for (size_t id = ringset_next(&set); id != RINGSET_NONE; id = ringset_next(&set)) {
+		printf(" %zu (%u bytes)", id, (unsigned)ringbuf_read(&rings[id], slice_new(buf, sizeof(buf))));
+	}
+	printf("\n");
+
+	ringbuf_write_slice(&rings[1], slice_new(buf, 4));
+	size_t unmarked = ringset_next(&set);
+	ringset_mark(&set, 1);
+	size_t marked = ringset_next(&set);
+	ringbuf_pop(&rings[1]);
+	printf("\nExpectation: A ring written directly is found once it is marked.\n");
+	printf("Before: %d, after: %zu\n", unmarked == RINGSET_NONE, marked);
+	ringset_free(&set);
+
+	/* Ring 0 sends 200-byte messages and ring 1 20-byte ones, with equal quanta. */
+	set = ringset_init(RINGSET_FAIR);
+	ringset_add(&set, &rings[0], 200);
+	ringset_add(&set, &rings[1], 200);
+	ringset_add(&set, &rings[2], 600);
+	size_t bytes[3] = { 0, 0, 0 };
+	size_t lens[3] = { 200, 20, 20 };
+	for (size_t round = 0; round < 1000; ++round) {
+		for (size_t idx = 0; idx < 3; ++idx) {
+			while (ringbuf_space_free(&rings[idx]) >= str_size((StrLen)lens[idx])) {
+				ringset_write_slice(&set, idx, slice_new(buf, lens[idx]));
+			}
+		}
+		size_t id = ringset_next(&set);
+		bytes[id] += ringbuf_read(&rings[id], slice_new(buf, sizeof(buf)));
+	}
+	printf("\nExpectation: Busy rings share bytes by quantum, about 1:1:3, whatever their message sizes.\n");
+	printf("Bytes: %zu, %zu, %zu\n", bytes[0], bytes[1], bytes[2]);
+	ringset_free(&set);
+	for (size_t idx = 0; idx < 3; ++idx) {
+		ringbuf_free(&rings[idx]);
+	}
+
+	/* Many idle rings cost nothing to pass over. */
+	size_t many = RINGSET_MAX;
+	RingBuf* idle = malloc(many * sizeof(RingBuf));
+	set = ringset_init(RINGSET_FAIR);
+	for (size_t idx = 0; idx < many; ++idx) {
+		idle[idx] = ringbuf_init(slice_new(malloc(16), 16));
+		ringset_add(&set, &idle[idx], 64);
+	}
+	printf("\nExpectation: The set is full at %d rings.\n", RINGSET_MAX);
+	printf("Another: %d\n", ringset_add(&set, &idle[0], 64) == RINGSET_NONE);
+	ringset_write_slice(&set, 7, slice_new(buf, 5));
+	ringset_write_slice(&set, 4000, slice_new(buf, 5));
+	ringset_write_slice(&set, 130, slice_new(buf, 5));
+	printf("\nExpectation: Among %d rings, the three with messages are served in turn.\n", RINGSET_MAX);
+	printf("Served:");
+	for (size_t id = ringset_next(&set); id != RINGSET_NONE; id = ringset_next(&set)) {
+		ringbuf_pop(&idle[id]);
+		printf(" %zu", id);
+	}
+	printf("\n");
+	for (size_t idx = 0; idx < many; ++idx) {
+		ringbuf_free(&idle[idx]);
+	}
+	free(idle);
+	ringset_free(&set);
+}
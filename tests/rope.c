@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <wyzyrdry.h>
+
+void test_rope(void) {
+	Rope rope = rope_init(8);
+	printf("\nExpectation: An empty Rope with no chunks, whose first chunk will hold at least 8 bytes.\n");
+	rope_debug_print(&rope);
+
+	rope_push_slice(&rope, slice_new((unsigned char*)"Saluton, ", 9));
+	rope_push_slice(&rope, slice_new((unsigned char*)"mondo!", 6));
+	rope_push_byte(&rope, '\n');
+	printf("\nExpectation: \"Saluton, mondo!\\n\" in a first chunk grown to fit 9 bytes, and one of 16.\n");
+	rope_debug_print(&rope);
+
+	unsigned char* first = rope_slice_at(&rope, 0).ptr;
+	for (size_t idx = 0; idx < 1000; ++idx) {
+		rope_push_slice(&rope, slice_new((unsigned char*)"0123456789", 10));
+	}
+	printf("\nExpectation: Appending 10000 bytes does not move the first chunk; the Rope holds 10016 bytes.\n");
+	printf("Same first chunk: %d, len: %zu\n", rope_slice_at(&rope, 0).ptr == first, rope.len);
+
+	Slice at = rope_slice_at(&rope, 9);
+	printf("\nExpectation: The run at offset 9 is \"mondo!\\n\" plus digits, to the end of its chunk.\n");
+	printf("%.7s, len: %zu\n", at.ptr, at.len);
+
+	unsigned char buf[12];
+	size_t got = rope_read(&rope, 10010, slice_new(buf, sizeof(buf)));
+	printf("\nExpectation: Reading 12 bytes at offset 10010 gets the last 6, \"456789\".\n");
+	printf("%.*s, read: %zu\n", (int)got, buf, got);
+
+	size_t total = 0;
+	size_t chunks = 0;
+	size_t cursor = 0;
+	Slice part;
+	while (rope_next(&rope, &cursor, &part)) {
+		total += part.len;
+		++chunks;
+	}
+	struct iovec iov[16];
+	size_t iovs = rope_iovec(&rope, 5, iov, 16);
+	size_t iov_total = 0;
+	for (size_t idx = 0; idx < iovs; ++idx) {
+		iov_total += iov[idx].iov_len;
+	}
+	printf("\nExpectation: Iteration covers all 10016 bytes in 11 chunks; an iovec from offset 5 covers the other 10011.\n");
+	printf("Chunks: %zu, bytes: %zu, iovecs: %zu, iovec bytes: %zu\n", chunks, total, iovs, iov_total);
+
+	Vec flat = rope_flatten(&rope);
+	printf("\nExpectation: Flattening gives one Vec of 10016 bytes in order, and empties the Rope.\n");
+	printf("Len: %zu, starts: %.16s, ends: %.10s, rope len: %zu, chunks: %zu\n",
+		flat.len,
+		flat.buf,
+		&flat.buf[flat.len - 10],
+		rope.len,
+		rope_chunk_count(&rope)
+	);
+	vec_free(&flat);
+	rope_free(&rope);
+}
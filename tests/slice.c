@@ -4,6 +4,9 @@
 
 char greet[] = "Saluton, mondo!\n";
 
+void test_slice_search(void);
+void test_slice_iter(void);
+
 void print_char_as_text(unsigned char c) {
 	printf("%c", c);
 }
@@ -19,4 +22,232 @@ void test_slice() {
 
 	printf("\nExpectation: Iterate over the slice to print it as text.\n");
 	slice_for_each(slice, print_char_as_text);
+
+	test_slice_search();
+	test_slice_iter();
+}
+
+/**
+ * Run every search kernel over all offsets and lengths of a buffer, checking
+ * each against a byte-at-a-time answer. Returns the number of disagreements.
+ */
+static size_t check_search_kernels(void) {
+	unsigned char buf[300];
+	unsigned char alt[300];
+	for (size_t idx = 0; idx < sizeof(buf); ++idx) {
+		buf[idx] = (unsigned char)('a' + idx % 23);
+	}
+	buf[97] = '\n';
+	buf[250] = ';';
+	buf[251] = '\n';
+	memcpy(alt, buf, sizeof(buf));
+	alt[180] = 'Z';
+	Slice set = slice_new((unsigned char*)";\n", 2);
+	Slice needle = slice_new(&buf[240], 12);
+	size_t errors = 0;
+	for (size_t start = 0; start < 80; ++start) {
+		for (size_t len = 0; start + len <= sizeof(buf); len += 7) {
+			Slice s = slice_new(&buf[start], len);
+			Slice o = slice_new(&alt[start], len);
+			size_t byte = len;
+			size_t any = len;
+			size_t sub = len;
+			size_t count = 0;
+			size_t diff = len;
+			for (size_t idx = len; idx-- > 0;) {
+				if (s.ptr[idx] == '\n') {
+					byte = idx;
+					any = idx;
+					++count;
+				}
+				if (s.ptr[idx] == ';') {
+					any = idx;
+				}
+				if (s.ptr[idx] != o.ptr[idx]) {
+					diff = idx;
+				}
+				if (idx + needle.len <= len && memcmp(&s.ptr[idx], needle.ptr, needle.len) == 0) {
+					sub = idx;
+				}
+			}
+			int cmp = diff < len ? (s.ptr[diff] < o.ptr[diff] ? -1 : 1) : 0;
+			errors += slice_find_byte(s, '\n') != byte;
+			errors += slice_find_any(s, set) != any;
+			errors += slice_find_subslice(s, needle) != sub;
+			errors += slice_count_byte(s, '\n') != count;
+			errors += slice_eq(s, o) != (diff == len);
+			errors += slice_cmp(s, o) != cmp;
+		}
+	}
+	return errors;
+}
+
+void test_slice_search() {
+	Slice text = slice_new((unsigned char*)"GET /index.html HTTP/1.1\r\nHost: a\r\n\r\n", 37);
+
+	printf("\nExpectation: The first CR is at 24, the first ':' or ' ' at 3.\n");
+	printf("CR: %zu, any of \": \": %zu\n",
+		slice_find_byte(text, '\r'),
+		slice_find_any(text, slice_new((unsigned char*)": ", 2))
+	);
+
+	printf("\nExpectation: The header break is at 33, and there are 3 LFs.\n");
+	printf("CRLFCRLF: %zu, LF count: %zu\n",
+		slice_find_subslice(text, slice_new((unsigned char*)"\r\n\r\n", 4)),
+		slice_count_byte(text, '\n')
+	);
+
+	printf("\nExpectation: Absent bytes report the Slice length, 37.\n");
+	printf("'#': %zu, \"HTTP/2\": %zu\n",
+		slice_find_byte(text, '#'),
+		slice_find_subslice(text, slice_new((unsigned char*)"HTTP/2", 6))
+	);
+
+	Slice get = slice_new((unsigned char*)"GET", 3);
+	Slice put = slice_new((unsigned char*)"PUT", 3);
+	printf("\nExpectation: GET == GET, GET < PUT, GET > GE.\n");
+	printf("eq: %d, cmp: %d, cmp: %d\n",
+		slice_eq(get, slice_new(text.ptr, 3)),
+		slice_cmp(get, put),
+		slice_cmp(get, slice_new(get.ptr, 2))
+	);
+
+	printf("\nExpectation: Every kernel agrees with the byte-at-a-time answers.\n");
+	unsigned int old = cpu_restrict(0);
+	printf("scalar errors: %zu\n", check_search_kernels());
+	cpu_restrict(CPU_SSE2);
+	printf("SSE2 errors: %zu\n", check_search_kernels());
+	cpu_restrict(CPU_SSE2 | CPU_AVX2);
+	printf("AVX2 errors: %zu\n", check_search_kernels());
+	cpu_restrict(old);
+	printf("best errors: %zu\n", check_search_kernels());
+}
+
+static void count_vowels(unsigned char c, void* ctx) {
+	size_t* count = ctx;
+	*count += c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u';
+}
+
+static void count_chunks(const Slice chunk, void* ctx) {
+	size_t* counts = ctx;
+	counts[0] += 1;
+	counts[1] = chunk.len;
+}
+
+static uint64_t fnv1a(uint64_t acc, unsigned char c, void* ctx) {
+	(void)ctx;
+	return (acc ^ c) * 0x100000001B3ULL;
+}
+
+static uint64_t sum_chunk(uint64_t acc, const Slice chunk, void* ctx) {
+	(void)ctx;
+	SLICE_FOR_EACH(p, chunk) {
+		acc += *p;
+	}
+	return acc;
+}
+
+/**
+ * Run every transform kernel over all byte values at many offsets and lengths,
+ * checking each against a byte-at-a-time answer. Returns the number of wrong
+ * output bytes.
+ */
+static size_t check_map_kernels(const unsigned char table[256]) {
+	unsigned char src[600];
+	unsigned char dst[600];
+	for (size_t idx = 0; idx < sizeof(src); ++idx) {
+		src[idx] = (unsigned char)(idx * 7);
+	}
+	size_t errors = 0;
+	for (size_t len = 0; len + 3 <= sizeof(src); len += 37) {
+		Slice in = slice_new(&src[3], len);
+		Slice out = slice_new(dst, len);
+		slice_map_into(out, in, table);
+		for (size_t idx = 0; idx < len; ++idx) {
+			errors += dst[idx] != table[in.ptr[idx]];
+		}
+		slice_to_ascii_lower(out, in);
+		for (size_t idx = 0; idx < len; ++idx) {
+			unsigned char c = in.ptr[idx];
+			errors += dst[idx] != (c >= 'A' && c <= 'Z' ? c + 32 : c);
+		}
+		slice_to_ascii_upper(out, in);
+		for (size_t idx = 0; idx < len; ++idx) {
+			unsigned char c = in.ptr[idx];
+			errors += dst[idx] != (c >= 'a' && c <= 'z' ? c - 32 : c);
+		}
+	}
+	return errors;
+}
+
+void test_slice_iter() {
+	Slice greet = slice_new((unsigned char*)"Saluton, mondo!", 15);
+
+	size_t us = 0;
+	SLICE_FOR_EACH(p, greet) {
+		if (*p == ',') {
+			break;
+		}
+		us += *p == 'u';
+	}
+	printf("\nExpectation: One 'u' before the comma.\n");
+	printf("u: %zu\n", us);
+
+	size_t vowels = 0;
+	slice_for_each_with(greet, count_vowels, &vowels);
+	printf("\nExpectation: Five vowels counted through a context pointer.\n");
+	printf("Vowels: %zu\n", vowels);
+
+	unsigned char big[150];
+	for (size_t idx = 0; idx < sizeof(big); ++idx) {
+		big[idx] = (unsigned char)idx;
+	}
+	size_t chunks[2] = { 0, 0 };
+	slice_for_each_chunk(slice_new(big, sizeof(big)), count_chunks, chunks);
+	printf("\nExpectation: 150 bytes arrive as three blocks, the last of 22 bytes.\n");
+	printf("Blocks: %zu, last: %zu\n", chunks[0], chunks[1]);
+
+	printf("\nExpectation: The sum of 0..149 by blocks is 11175.\n");
+	printf("Chunked sum: %llu\n",
+		(unsigned long long)slice_fold_chunks(slice_new(big, sizeof(big)), 0, sum_chunk, NULL)
+	);
+
+	printf("\nExpectation: The FNV-1a hash of \"a\" is AF63DC4C8601EC8C.\n");
+	printf("FNV-1a: %016llX\n",
+		(unsigned long long)slice_fold(slice_new((unsigned char*)"a", 1), 0xCBF29CE484222325ULL, fnv1a, NULL)
+	);
+
+	unsigned char rot13[256];
+	for (size_t idx = 0; idx < 256; ++idx) {
+		unsigned char c = (unsigned char)idx;
+		if ((c >= 'a' && c <= 'm') || (c >= 'A' && c <= 'M')) {
+			c += 13;
+		}
+		else if ((c >= 'n' && c <= 'z') || (c >= 'N' && c <= 'Z')) {
+			c -= 13;
+		}
+		rot13[idx] = c;
+	}
+	unsigned char buf[15];
+	Slice out = slice_new(buf, sizeof(buf));
+	printf("\nExpectation: Translated, folded down, and folded up.\n");
+	slice_map_into(out, greet, rot13);
+	printf("%.*s\n", (int)out.len, out.ptr);
+	slice_to_ascii_lower(out, greet);
+	printf("%.*s\n", (int)out.len, out.ptr);
+	slice_to_ascii_upper(out, greet);
+	printf("%.*s\n", (int)out.len, out.ptr);
+
+	printf("\nExpectation: A destination that is too short receives nothing.\n");
+	printf("Written: %zu\n", slice_to_ascii_lower(slice_new(buf, 3), greet));
+
+	printf("\nExpectation: Every transform kernel agrees with the byte-at-a-time answers.\n");
+	unsigned int old = cpu_restrict(0);
+	printf("scalar errors: %zu\n", check_map_kernels(rot13));
+	cpu_restrict(CPU_SSE2);
+	printf("SSE2 errors: %zu\n", check_map_kernels(rot13));
+	cpu_restrict(CPU_SSE2 | CPU_AVX2);
+	printf("AVX2 errors: %zu\n", check_map_kernels(rot13));
+	cpu_restrict(old);
+	printf("best errors: %zu\n", check_map_kernels(rot13));
 }
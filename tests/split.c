@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+/**
+ * Print every record available from the current input, and whether each was
+ * returned in place.
+ */
+static void print_records(Splitter* s, const Slice piece) {
+	Slice rec;
+	while (splitter_next(s, &rec)) {
+		int in_place = rec.ptr >= piece.ptr && rec.ptr <= piece.ptr + piece.len;
+		printf("\"%.*s\" (%s) ", (int)rec.len, rec.ptr, in_place ? "in place" : "stitched");
+	}
+	printf("\n");
+}
+
+/**
+ * Fold the records of a text, split in pieces of varying size, into one value
+ * so that different piece sizes can be compared.
+ */
+static uint64_t digest_records(const Slice text, size_t step) {
+	Splitter s = splitter_init(slice_new((unsigned char*)"\n\0", 2));
+	Hasher h = hasher_init(0);
+	Slice rec;
+	for (size_t idx = 0; idx < text.len; idx += step) {
+		size_t len = text.len - idx < step ? text.len - idx : step;
+		splitter_feed(&s, slice_new(&text.ptr[idx], len));
+		while (splitter_next(&s, &rec)) {
+			hasher_update(&h, rec);
+			hasher_update(&h, slice_new((unsigned char*)"|", 1));
+		}
+	}
+	if (splitter_finish(&s, &rec)) {
+		hasher_update(&h, rec);
+	}
+	splitter_free(&s);
+	return hasher_finish(&h);
+}
+
+void test_split(void) {
+	Splitter s = splitter_init(slice_new((unsigned char*)"\n", 1));
+	Slice pieces[3] = {
+		slice_new((unsigned char*)"ab\ncd", 5),
+		slice_new((unsigned char*)"ef\n\ngh", 6),
+		slice_new((unsigned char*)"\nij", 3),
+	};
+	printf("\nExpectation: \"ab\" in place; \"cdef\" stitched and \"\" in place; \"gh\" stitched, as it ends in the last piece.\n");
+	for (size_t idx = 0; idx < 3; ++idx) {
+		splitter_feed(&s, pieces[idx]);
+		print_records(&s, pieces[idx]);
+	}
+	Slice rec;
+	printf("\nExpectation: The stream ends with the unterminated record \"ij\".\n");
+	if (splitter_finish(&s, &rec)) {
+		printf("\"%.*s\"\n", (int)rec.len, rec.ptr);
+	}
+	splitter_free(&s);
+
+	size_t len = 10000;
+	unsigned char* text = malloc(len);
+	for (size_t idx = 0; idx < len; ++idx) {
+		size_t mix = idx * 2654435761u >> 7;
+		text[idx] = mix % 23 == 0 ? '\n' : mix % 37 == 0 ? '\0' : (unsigned char)('a' + mix % 26);
+	}
+	uint64_t whole = digest_records(slice_new(text, len), len);
+	size_t agree = 0;
+	size_t steps[5] = { 1, 7, 64, 333, 4096 };
+	for (size_t idx = 0; idx < 5; ++idx) {
+		agree += digest_records(slice_new(text, len), steps[idx]) == whole;
+	}
+	printf("\nExpectation: Splitting in pieces of 1, 7, 64, 333, and 4096 bytes yields the same records as all at once.\n");
+	printf("Agree: %zu of 5\n", agree);
+	free(text);
+
+	size_t sz = 24;
+	RingBuf rb = ringbuf_init(slice_new(malloc(sz), sz));
+	ringbuf_write_slice(&rb, slice_new((unsigned char*)"one\ntw", 6));
+	ringbuf_write_slice(&rb, slice_new((unsigned char*)"o\nthr", 5));
+	s = splitter_init(slice_new((unsigned char*)"\n", 1));
+	printf("\nExpectation: The first two messages yield \"one\" and \"two\", then hold \"thr\".\n");
+	while (splitter_next_ringbuf(&s, &rb, &rec)) {
+		printf("\"%.*s\" ", (int)rec.len, rec.ptr);
+	}
+	printf("\nMessages left: %zu\n", rb.count);
+
+	/* The ring was emptied, so these start at the front of the store again. */
+	ringbuf_write_slice(&rb, slice_new((unsigned char*)"ee\nfour\n", 8));
+	ringbuf_write_slice(&rb, slice_new((unsigned char*)"five\nsix\n", 9));
+	printf("\nExpectation: \"three\" stitched across messages, then \"four\" and \"five\".\n");
+	for (size_t idx = 0; idx < 3; ++idx) {
+		splitter_next_ringbuf(&s, &rb, &rec);
+		printf("\"%.*s\" ", (int)rec.len, rec.ptr);
+	}
+	printf("\n");
+
+	/* The first of those has been popped, so this one wraps. */
+	ringbuf_write_slice(&rb, slice_new((unsigned char*)"seven\n", 6));
+	printf("\nExpectation: \"six\", then \"seven\" from a message that wraps, leaving the ring empty.\n");
+	printf("Wraps: %d\n", rb.tail < rb.head);
+	while (splitter_next_ringbuf(&s, &rb, &rec)) {
+		printf("\"%.*s\" ", (int)rec.len, rec.ptr);
+	}
+	printf("\nMessages left: %zu\n", rb.count);
+	splitter_free(&s);
+	ringbuf_free(&rb);
+}
@@ -22,6 +22,32 @@ void test_str(void) {
 	slice_debug_print(greet);
 	str_debug_print(slice1);
 
+	Slice pieces[3] = {
+		slice_new((unsigned char*)"Saluton", 7),
+		slice_new(NULL, 0),
+		slice_new((unsigned char*)", mondo!\n", 9),
+	};
+	Str* gathered = str_from_slices(pieces, 3);
+	printf("\nExpectation: A new Str is formed from three Slices, one of them empty, with the same length and content as the single Slice.\n");
+	printf("Str len: %zu, Slice len: %zu.\n", (size_t)gathered->len, greet.len);
+	str_debug_print(gathered);
+	str_free(gathered);
+
+	unsigned char* bulk = calloc(STR_MAX_LEN + 1, 1);
+	Slice halves[2] = {
+		slice_new(bulk, STR_MAX_LEN / 2),
+		slice_new(bulk, STR_MAX_LEN - STR_MAX_LEN / 2),
+	};
+	Str* longest = str_from_slices(halves, 2);
+	halves[1].len += 1;
+	Str* too_long = str_from_slices(halves, 2);
+	printf("\nExpectation: Slices totalling %zu bytes form a Str, and one byte more is refused.\n", STR_MAX_LEN);
+	printf("Longest len: %zu, one more: %p\n", longest != NULL ? (size_t)longest->len : 0, (void*)too_long);
+	if (longest != NULL) {
+		str_free(longest);
+	}
+	free(bulk);
+
 	/*
 	 * Note: Ownership of the memory is going to get WEIRD. This is a scenario
 	 * where Rust would offer significant help.
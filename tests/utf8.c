@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <string.h>
+#include <wyzyrdry.h>
+
+void test_utf8(void) {
+	const char* hello = "h\xC3\xA9llo, w\xC3\xB6rld \xE2\x82\xAC \xF0\x9D\x84\x9E";
+	Slice text = slice_new((unsigned char*)hello, strlen(hello));
+	printf("\nExpectation: \"h\xC3\xA9llo, w\xC3\xB6rld \xE2\x82\xAC \xF0\x9D\x84\x9E\" is valid, 23 bytes, 16 code points, and not ASCII.\n");
+	printf("Valid: %d, len: %zu, count: %zu, ascii: %d\n",
+		slice_validate_utf8(text),
+		text.len,
+		utf8_count(text),
+		utf8_is_ascii(text)
+	);
+
+	const char* bad[10] = {
+		"\xC0\xAF",         /* overlong '/' */
+		"\xE0\x80\xAF",     /* overlong '/' */
+		"\xF0\x8F\xBF\xBF", /* overlong U+FFFF */
+		"\xED\xA0\x80",     /* surrogate U+D800 */
+		"\xF4\x90\x80\x80", /* U+110000 */
+		"\xF5\x80\x80\x80", /* lead byte past F4 */
+		"\x80",             /* stray continuation */
+		"\xE2\x82",         /* truncated */
+		"\xE2\x82\x41",     /* truncated by ASCII */
+		"\xC3\xA9\xA9",     /* one continuation too many */
+	};
+	size_t offset[10] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 2 };
+	unsigned char buf[256];
+	printf("\nExpectation: Every kernel finds each of 10 errors at each of 100 positions, after both ASCII and multi-byte text: 2000 of 2000.\n");
+	unsigned int old = cpu_restrict(0);
+	unsigned int levels[3] = { 0, CPU_SSE2 | CPU_SSSE3, CPU_SSE2 | CPU_SSSE3 | CPU_AVX2 };
+	for (size_t lvl = 0; lvl < 3; ++lvl) {
+		cpu_restrict(levels[lvl]);
+		size_t found = 0;
+		for (size_t fill = 0; fill < 2; ++fill) {
+			for (size_t idx = 0; idx < 10; ++idx) {
+				for (size_t pos = 0; pos < 100; ++pos) {
+					/* Fill with 'a' or with two-byte 'é', ending on a whole
+					 * character. */
+					for (size_t at = 0; at < sizeof(buf); ++at) {
+						buf[at] = fill == 0 ? 'a' : (at % 2 == 0 ? 0xC3 : 0xA9);
+					}
+					size_t start = fill == 0 ? pos : pos & ~(size_t)1;
+					size_t len = strlen(bad[idx]);
+					memcpy(&buf[start], bad[idx], len);
+					found += utf8_validate(slice_new(buf, 200)) == start + offset[idx];
+				}
+			}
+		}
+		printf("Level %#x finds: %zu of 2000\n", levels[lvl], found);
+	}
+
+	printf("\nExpectation: Every kernel finds a sequence cut short at the end of every length up to 100.\n");
+	for (size_t lvl = 0; lvl < 3; ++lvl) {
+		cpu_restrict(levels[lvl]);
+		size_t found = 0;
+		for (size_t len = 1; len <= 100; ++len) {
+			memset(buf, 'a', len);
+			buf[len - 1] = 0xF0;
+			found += utf8_validate(slice_new(buf, len)) == len - 1;
+		}
+		printf("Level %#x finds: %zu of 100\n", levels[lvl], found);
+	}
+
+	/* Text of one- to four-byte characters, mixed. */
+	unsigned char mixed[1024];
+	size_t mixed_len = 0;
+	const char* chars[5] = { "a", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9D\x84\x9E", "\xED\x9F\xBF" };
+	for (size_t idx = 0; mixed_len + 4 <= sizeof(mixed); ++idx) {
+		const char* chr = chars[(idx * 7 + idx / 3) % 5];
+		memcpy(&mixed[mixed_len], chr, strlen(chr));
+		mixed_len += strlen(chr);
+	}
+	printf("\nExpectation: Every kernel agrees with the portable code when any byte of mixed text is replaced by any of 8 values: 8168 of 8168.\n");
+	unsigned char values[8] = { 0x00, 0x41, 0x80, 0xA0, 0xBF, 0xC2, 0xED, 0xF4 };
+	unsigned char copy[1024];
+	for (size_t lvl = 0; lvl < 3; ++lvl) {
+		size_t same = 0;
+		for (size_t pos = 0; pos < mixed_len; ++pos) {
+			for (size_t val = 0; val < 8; ++val) {
+				memcpy(copy, mixed, mixed_len);
+				copy[pos] = values[val];
+				Slice src = slice_new(copy, mixed_len);
+				cpu_restrict(0);
+				size_t expect = utf8_validate(src);
+				cpu_restrict(levels[lvl]);
+				same += utf8_validate(src) == expect;
+			}
+		}
+		printf("Level %#x matches: %zu of %zu\n", levels[lvl], same, 8 * mixed_len);
+	}
+
+	printf("\nExpectation: Every kernel counts code points and checks for ASCII as the portable code does, for every length up to 300.\n");
+	for (size_t lvl = 0; lvl < 3; ++lvl) {
+		size_t same = 0;
+		for (size_t len = 0; len <= 300; ++len) {
+			Slice src = slice_new(&mixed[700 - len], len);
+			Slice plain = slice_new(buf, len < sizeof(buf) ? len : sizeof(buf));
+			memset(buf, 'a', sizeof(buf));
+			cpu_restrict(0);
+			size_t count = utf8_count(src);
+			bool ascii = utf8_is_ascii(src);
+			cpu_restrict(levels[lvl]);
+			same += utf8_count(src) == count
+				&& utf8_is_ascii(src) == ascii
+				&& utf8_is_ascii(plain);
+		}
+		printf("Level %#x matches: %zu of 301\n", levels[lvl], same);
+	}
+	cpu_restrict(old);
+
+	printf("\nExpectation: Mixed text survives the trip to UTF-16 and back, and \"\xE2\x82\xAC\" is the unit 0x20AC while \"\xF0\x9D\x84\x9E\" is 0xD834 0xDD1E.\n");
+	Vec wide = vec_init(64, 1);
+	Vec back = vec_init(64, 1);
+	Utf8Result res = utf8_to_utf16(&wide, slice_new(mixed, mixed_len));
+	Utf8Result res2 = utf16_to_utf8(&back, vec_as_slice(&wide));
+	printf("Ok: %d, round trip: %d\n",
+		GET_VARIANT_TYPE(res) == ENUM_VAR(Utf8Result, Ok)
+			&& GET_VARIANT_TYPE(res2) == ENUM_VAR(Utf8Result, Ok),
+		slice_eq(vec_as_slice(&back), slice_new(mixed, mixed_len))
+	);
+	wide.len = 0;
+	utf8_to_utf16(&wide, slice_new((unsigned char*)"\xE2\x82\xAC\xF0\x9D\x84\x9E", 7));
+	uint16_t units[3] = { 0, 0, 0 };
+	memcpy(units, wide.buf, wide.len < sizeof(units) ? wide.len : sizeof(units));
+	printf("Units: %zu, %#x %#x %#x\n", wide.len / 2, units[0], units[1], units[2]);
+
+	printf("\nExpectation: An unpaired surrogate at byte 4, a reversed pair at byte 0, and an odd final byte at 6 are errors, and the Vec is unchanged.\n");
+	uint16_t lone[3] = { 'a', 'b', 0xD800 };
+	uint16_t reversed[2] = { 0xDD1E, 0xD834 };
+	uint16_t odd[4] = { 'a', 'b', 'c', 'd' };
+	Slice cases[3] = {
+		slice_new((unsigned char*)lone, sizeof(lone)),
+		slice_new((unsigned char*)reversed, sizeof(reversed)),
+		slice_new((unsigned char*)odd, 7),
+	};
+	for (size_t idx = 0; idx < 3; ++idx) {
+		back.len = 0;
+		res = utf16_to_utf8(&back, cases[idx]);
+		printf("Err: %d, index: %zu, len: %zu\n",
+			GET_VARIANT_TYPE(res) == ENUM_VAR(Utf8Result, Err),
+			GET_VARIANT_BODY(res, Err),
+			back.len
+		);
+	}
+
+	printf("\nExpectation: A surrogate encoded in UTF-8 at byte 3 is an error for UTF-16 as well.\n");
+	wide.len = 0;
+	res = utf8_to_utf16(&wide, slice_new((unsigned char*)"abc\xED\xA0\x80", 6));
+	printf("Err: %d, index: %zu, len: %zu\n",
+		GET_VARIANT_TYPE(res) == ENUM_VAR(Utf8Result, Err),
+		GET_VARIANT_BODY(res, Err),
+		wide.len
+	);
+
+	vec_free(&back);
+	vec_free(&wide);
+}